@@ -460,6 +460,22 @@ fileprivate struct FfiConverterInt32: FfiConverterPrimitive {
     }
 }
 
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+fileprivate struct FfiConverterUInt64: FfiConverterPrimitive {
+    typealias FfiType = UInt64
+    typealias SwiftType = UInt64
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> UInt64 {
+        return try lift(readInt(&buf))
+    }
+
+    public static func write(_ value: SwiftType, into buf: inout [UInt8]) {
+        writeInt(&buf, lower(value))
+    }
+}
+
 #if swift(>=5.8)
 @_documentation(visibility: private)
 #endif
@@ -560,6 +576,306 @@ fileprivate struct FfiConverterData: FfiConverterRustBuffer {
 }
 
 
+
+
+public protocol EncodeTaskProtocol : AnyObject {
+    
+    func cancel() 
+    
+    func framesDone()  -> UInt32
+    
+    func isCancelled()  -> Bool
+    
+    func setListener(listener: ProgressListener) 
+    
+}
+
+open class EncodeTask:
+    EncodeTaskProtocol {
+    fileprivate let pointer: UnsafeMutableRawPointer!
+
+    /// Used to instantiate a [FFIObject] without an actual pointer, for fakes in tests, mostly.
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public struct NoPointer {
+        public init() {}
+    }
+
+    // TODO: We'd like this to be `private` but for Swifty reasons,
+    // we can't implement `FfiConverter` without making this `required` and we can't
+    // make it `required` without making it `public`.
+    required public init(unsafeFromRawPointer pointer: UnsafeMutableRawPointer) {
+        self.pointer = pointer
+    }
+
+    // This constructor can be used to instantiate a fake object.
+    // - Parameter noPointer: Placeholder value so we can have a constructor separate from the default empty one that may be implemented for classes extending [FFIObject].
+    //
+    // - Warning:
+    //     Any object instantiated with this constructor cannot be passed to an actual Rust-backed object. Since there isn't a backing [Pointer] the FFI lower functions will crash.
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public init(noPointer: NoPointer) {
+        self.pointer = nil
+    }
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public func uniffiClonePointer() -> UnsafeMutableRawPointer {
+        return try! rustCall { uniffi_rgb2gif_processor_fn_clone_encodetask(self.pointer, $0) }
+    }
+public convenience init() {
+    let pointer =
+        try! rustCall() {
+    uniffi_rgb2gif_processor_fn_constructor_encodetask_new($0
+    )
+}
+    self.init(unsafeFromRawPointer: pointer)
+}
+
+    deinit {
+        guard let pointer = pointer else {
+            return
+        }
+
+        try! rustCall { uniffi_rgb2gif_processor_fn_free_encodetask(pointer, $0) }
+    }
+
+
+
+
+open func cancel() {try! rustCall() {
+    uniffi_rgb2gif_processor_fn_method_encodetask_cancel(self.uniffiClonePointer(),$0
+    )
+}
+}
+    
+open func framesDone() -> UInt32 {
+    return try!  FfiConverterUInt32.lift(try! rustCall() {
+    uniffi_rgb2gif_processor_fn_method_encodetask_frames_done(self.uniffiClonePointer(),$0
+    )
+})
+}
+    
+open func isCancelled() -> Bool {
+    return try!  FfiConverterBool.lift(try! rustCall() {
+    uniffi_rgb2gif_processor_fn_method_encodetask_is_cancelled(self.uniffiClonePointer(),$0
+    )
+})
+}
+    
+open func setListener(listener: ProgressListener) {try! rustCall() {
+    uniffi_rgb2gif_processor_fn_method_encodetask_set_listener(self.uniffiClonePointer(),
+        FfiConverterCallbackInterfaceProgressListener.lower(listener),$0
+    )
+}
+}
+    
+
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public struct FfiConverterTypeEncodeTask: FfiConverter {
+
+    typealias FfiType = UnsafeMutableRawPointer
+    typealias SwiftType = EncodeTask
+
+    public static func lift(_ pointer: UnsafeMutableRawPointer) throws -> EncodeTask {
+        return EncodeTask(unsafeFromRawPointer: pointer)
+    }
+
+    public static func lower(_ value: EncodeTask) -> UnsafeMutableRawPointer {
+        return value.uniffiClonePointer()
+    }
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> EncodeTask {
+        let v: UInt64 = try readInt(&buf)
+        // The Rust code won't compile if a pointer won't fit in a UInt64.
+        // We have to go via `UInt` because that's the thing that's the size of a pointer.
+        let ptr = UnsafeMutableRawPointer(bitPattern: UInt(truncatingIfNeeded: v))
+        if (ptr == nil) {
+            throw UniffiInternalError.unexpectedNullPointer
+        }
+        return try lift(ptr!)
+    }
+
+    public static func write(_ value: EncodeTask, into buf: inout [UInt8]) {
+        // This fiddling is because `Int` is the thing that's the same size as a pointer.
+        // The Rust code won't compile if a pointer won't fit in a `UInt64`.
+        writeInt(&buf, UInt64(bitPattern: Int64(Int(bitPattern: lower(value)))))
+    }
+}
+
+
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeEncodeTask_lift(_ pointer: UnsafeMutableRawPointer) throws -> EncodeTask {
+    return try FfiConverterTypeEncodeTask.lift(pointer)
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeEncodeTask_lower(_ value: EncodeTask) -> UnsafeMutableRawPointer {
+    return FfiConverterTypeEncodeTask.lower(value)
+}
+
+
+
+public protocol FramePipelineProtocol : AnyObject {
+    
+    func finish() throws  -> ProcessResult
+    
+    func framesSubmitted()  -> UInt32
+    
+    func submitFrame(frameRgba: Data) throws 
+    
+}
+
+open class FramePipeline:
+    FramePipelineProtocol {
+    fileprivate let pointer: UnsafeMutableRawPointer!
+
+    /// Used to instantiate a [FFIObject] without an actual pointer, for fakes in tests, mostly.
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public struct NoPointer {
+        public init() {}
+    }
+
+    // TODO: We'd like this to be `private` but for Swifty reasons,
+    // we can't implement `FfiConverter` without making this `required` and we can't
+    // make it `required` without making it `public`.
+    required public init(unsafeFromRawPointer pointer: UnsafeMutableRawPointer) {
+        self.pointer = pointer
+    }
+
+    // This constructor can be used to instantiate a fake object.
+    // - Parameter noPointer: Placeholder value so we can have a constructor separate from the default empty one that may be implemented for classes extending [FFIObject].
+    //
+    // - Warning:
+    //     Any object instantiated with this constructor cannot be passed to an actual Rust-backed object. Since there isn't a backing [Pointer] the FFI lower functions will crash.
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public init(noPointer: NoPointer) {
+        self.pointer = nil
+    }
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public func uniffiClonePointer() -> UnsafeMutableRawPointer {
+        return try! rustCall { uniffi_rgb2gif_processor_fn_clone_framepipeline(self.pointer, $0) }
+    }
+public convenience init(pipelineOpts: PipelineOpts, quantizeOpts: QuantizeOpts, gifOpts: GifOpts)throws  {
+    let pointer =
+        try rustCallWithError(FfiConverterTypeProcessorError.lift) {
+    uniffi_rgb2gif_processor_fn_constructor_framepipeline_new(
+        FfiConverterTypePipelineOpts.lower(pipelineOpts),
+        FfiConverterTypeQuantizeOpts.lower(quantizeOpts),
+        FfiConverterTypeGifOpts.lower(gifOpts),$0
+    )
+}
+    self.init(unsafeFromRawPointer: pointer)
+}
+
+    deinit {
+        guard let pointer = pointer else {
+            return
+        }
+
+        try! rustCall { uniffi_rgb2gif_processor_fn_free_framepipeline(pointer, $0) }
+    }
+
+
+
+
+open func finish()throws  -> ProcessResult {
+    return try  FfiConverterTypeProcessResult.lift(try rustCallWithError(FfiConverterTypeProcessorError.lift) {
+    uniffi_rgb2gif_processor_fn_method_framepipeline_finish(self.uniffiClonePointer(),$0
+    )
+})
+}
+    
+open func framesSubmitted() -> UInt32 {
+    return try!  FfiConverterUInt32.lift(try! rustCall() {
+    uniffi_rgb2gif_processor_fn_method_framepipeline_frames_submitted(self.uniffiClonePointer(),$0
+    )
+})
+}
+    
+open func submitFrame(frameRgba: Data)throws  {try rustCallWithError(FfiConverterTypeProcessorError.lift) {
+    uniffi_rgb2gif_processor_fn_method_framepipeline_submit_frame(self.uniffiClonePointer(),
+        FfiConverterData.lower(frameRgba),$0
+    )
+}
+}
+    
+
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public struct FfiConverterTypeFramePipeline: FfiConverter {
+
+    typealias FfiType = UnsafeMutableRawPointer
+    typealias SwiftType = FramePipeline
+
+    public static func lift(_ pointer: UnsafeMutableRawPointer) throws -> FramePipeline {
+        return FramePipeline(unsafeFromRawPointer: pointer)
+    }
+
+    public static func lower(_ value: FramePipeline) -> UnsafeMutableRawPointer {
+        return value.uniffiClonePointer()
+    }
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> FramePipeline {
+        let v: UInt64 = try readInt(&buf)
+        // The Rust code won't compile if a pointer won't fit in a UInt64.
+        // We have to go via `UInt` because that's the thing that's the size of a pointer.
+        let ptr = UnsafeMutableRawPointer(bitPattern: UInt(truncatingIfNeeded: v))
+        if (ptr == nil) {
+            throw UniffiInternalError.unexpectedNullPointer
+        }
+        return try lift(ptr!)
+    }
+
+    public static func write(_ value: FramePipeline, into buf: inout [UInt8]) {
+        // This fiddling is because `Int` is the thing that's the same size as a pointer.
+        // The Rust code won't compile if a pointer won't fit in a `UInt64`.
+        writeInt(&buf, UInt64(bitPattern: Int64(Int(bitPattern: lower(value)))))
+    }
+}
+
+
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeFramePipeline_lift(_ pointer: UnsafeMutableRawPointer) throws -> FramePipeline {
+    return try FfiConverterTypeFramePipeline.lift(pointer)
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeFramePipeline_lower(_ value: FramePipeline) -> UnsafeMutableRawPointer {
+    return FfiConverterTypeFramePipeline.lower(value)
+}
+
+
 public struct GifOpts {
     public var width: UInt16
     public var height: UInt16
@@ -568,10 +884,12 @@ public struct GifOpts {
     public var loopCount: UInt16
     public var optimize: Bool
     public var includeTensor: Bool
+    public var indexedTensor: Bool
+    public var tensorLayout: TensorLayout
 
     // Default memberwise initializers are never public by default, so we
     // declare one manually.
-    public init(width: UInt16, height: UInt16, frameCount: UInt16, fps: UInt16, loopCount: UInt16, optimize: Bool, includeTensor: Bool) {
+    public init(width: UInt16, height: UInt16, frameCount: UInt16, fps: UInt16, loopCount: UInt16, optimize: Bool, includeTensor: Bool, indexedTensor: Bool = false, tensorLayout: TensorLayout = .frameMajor) {
         self.width = width
         self.height = height
         self.frameCount = frameCount
@@ -579,6 +897,8 @@ public struct GifOpts {
         self.loopCount = loopCount
         self.optimize = optimize
         self.includeTensor = includeTensor
+        self.indexedTensor = indexedTensor
+        self.tensorLayout = tensorLayout
     }
 }
 
@@ -607,6 +927,12 @@ extension GifOpts: Equatable, Hashable {
         if lhs.includeTensor != rhs.includeTensor {
             return false
         }
+        if lhs.indexedTensor != rhs.indexedTensor {
+            return false
+        }
+        if lhs.tensorLayout != rhs.tensorLayout {
+            return false
+        }
         return true
     }
 
@@ -618,6 +944,8 @@ extension GifOpts: Equatable, Hashable {
         hasher.combine(loopCount)
         hasher.combine(optimize)
         hasher.combine(includeTensor)
+        hasher.combine(indexedTensor)
+        hasher.combine(tensorLayout)
     }
 }
 
@@ -635,7 +963,9 @@ public struct FfiConverterTypeGifOpts: FfiConverterRustBuffer {
                 fps: FfiConverterUInt16.read(from: &buf), 
                 loopCount: FfiConverterUInt16.read(from: &buf), 
                 optimize: FfiConverterBool.read(from: &buf), 
-                includeTensor: FfiConverterBool.read(from: &buf)
+                includeTensor: FfiConverterBool.read(from: &buf), 
+                indexedTensor: FfiConverterBool.read(from: &buf), 
+                tensorLayout: FfiConverterTypeTensorLayout.read(from: &buf)
         )
     }
 
@@ -647,6 +977,8 @@ public struct FfiConverterTypeGifOpts: FfiConverterRustBuffer {
         FfiConverterUInt16.write(value.loopCount, into: &buf)
         FfiConverterBool.write(value.optimize, into: &buf)
         FfiConverterBool.write(value.includeTensor, into: &buf)
+        FfiConverterBool.write(value.indexedTensor, into: &buf)
+        FfiConverterTypeTensorLayout.write(value.tensorLayout, into: &buf)
     }
 }
 
@@ -666,23 +998,119 @@ public func FfiConverterTypeGifOpts_lower(_ value: GifOpts) -> RustBuffer {
 }
 
 
+public struct PipelineOpts {
+    public var sourceWidth: UInt32
+    public var sourceHeight: UInt32
+    public var queueDepth: UInt32
+    public var resizeWorkers: UInt32
+    public var encodeWorkers: UInt32
+
+    // Default memberwise initializers are never public by default, so we
+    // declare one manually.
+    public init(sourceWidth: UInt32, sourceHeight: UInt32, queueDepth: UInt32 = UInt32(4), resizeWorkers: UInt32 = UInt32(0), encodeWorkers: UInt32 = UInt32(0)) {
+        self.sourceWidth = sourceWidth
+        self.sourceHeight = sourceHeight
+        self.queueDepth = queueDepth
+        self.resizeWorkers = resizeWorkers
+        self.encodeWorkers = encodeWorkers
+    }
+}
+
+
+
+extension PipelineOpts: Equatable, Hashable {
+    public static func ==(lhs: PipelineOpts, rhs: PipelineOpts) -> Bool {
+        if lhs.sourceWidth != rhs.sourceWidth {
+            return false
+        }
+        if lhs.sourceHeight != rhs.sourceHeight {
+            return false
+        }
+        if lhs.queueDepth != rhs.queueDepth {
+            return false
+        }
+        if lhs.resizeWorkers != rhs.resizeWorkers {
+            return false
+        }
+        if lhs.encodeWorkers != rhs.encodeWorkers {
+            return false
+        }
+        return true
+    }
+
+    public func hash(into hasher: inout Hasher) {
+        hasher.combine(sourceWidth)
+        hasher.combine(sourceHeight)
+        hasher.combine(queueDepth)
+        hasher.combine(resizeWorkers)
+        hasher.combine(encodeWorkers)
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public struct FfiConverterTypePipelineOpts: FfiConverterRustBuffer {
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> PipelineOpts {
+        return
+            try PipelineOpts(
+                sourceWidth: FfiConverterUInt32.read(from: &buf), 
+                sourceHeight: FfiConverterUInt32.read(from: &buf), 
+                queueDepth: FfiConverterUInt32.read(from: &buf), 
+                resizeWorkers: FfiConverterUInt32.read(from: &buf), 
+                encodeWorkers: FfiConverterUInt32.read(from: &buf)
+        )
+    }
+
+    public static func write(_ value: PipelineOpts, into buf: inout [UInt8]) {
+        FfiConverterUInt32.write(value.sourceWidth, into: &buf)
+        FfiConverterUInt32.write(value.sourceHeight, into: &buf)
+        FfiConverterUInt32.write(value.queueDepth, into: &buf)
+        FfiConverterUInt32.write(value.resizeWorkers, into: &buf)
+        FfiConverterUInt32.write(value.encodeWorkers, into: &buf)
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypePipelineOpts_lift(_ buf: RustBuffer) throws -> PipelineOpts {
+    return try FfiConverterTypePipelineOpts.lift(buf)
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypePipelineOpts_lower(_ value: PipelineOpts) -> RustBuffer {
+    return FfiConverterTypePipelineOpts.lower(value)
+}
+
+
 public struct ProcessResult {
     public var gifData: Data
     public var tensorData: Data?
+    public var tensorIndices: Data?
+    public var tensorPalette: Data?
     public var finalFileSize: UInt32
     public var processingTimeMs: Float
     public var actualFrameCount: UInt16
     public var paletteSizeUsed: UInt16
+    public var stats: ProcessStats?
 
     // Default memberwise initializers are never public by default, so we
     // declare one manually.
-    public init(gifData: Data, tensorData: Data?, finalFileSize: UInt32, processingTimeMs: Float, actualFrameCount: UInt16, paletteSizeUsed: UInt16) {
+    public init(gifData: Data, tensorData: Data?, tensorIndices: Data?, tensorPalette: Data?, finalFileSize: UInt32, processingTimeMs: Float, actualFrameCount: UInt16, paletteSizeUsed: UInt16, stats: ProcessStats?) {
         self.gifData = gifData
         self.tensorData = tensorData
+        self.tensorIndices = tensorIndices
+        self.tensorPalette = tensorPalette
         self.finalFileSize = finalFileSize
         self.processingTimeMs = processingTimeMs
         self.actualFrameCount = actualFrameCount
         self.paletteSizeUsed = paletteSizeUsed
+        self.stats = stats
     }
 }
 
@@ -696,6 +1124,12 @@ extension ProcessResult: Equatable, Hashable {
         if lhs.tensorData != rhs.tensorData {
             return false
         }
+        if lhs.tensorIndices != rhs.tensorIndices {
+            return false
+        }
+        if lhs.tensorPalette != rhs.tensorPalette {
+            return false
+        }
         if lhs.finalFileSize != rhs.finalFileSize {
             return false
         }
@@ -708,16 +1142,22 @@ extension ProcessResult: Equatable, Hashable {
         if lhs.paletteSizeUsed != rhs.paletteSizeUsed {
             return false
         }
+        if lhs.stats != rhs.stats {
+            return false
+        }
         return true
     }
 
     public func hash(into hasher: inout Hasher) {
         hasher.combine(gifData)
         hasher.combine(tensorData)
+        hasher.combine(tensorIndices)
+        hasher.combine(tensorPalette)
         hasher.combine(finalFileSize)
         hasher.combine(processingTimeMs)
         hasher.combine(actualFrameCount)
         hasher.combine(paletteSizeUsed)
+        hasher.combine(stats)
     }
 }
 
@@ -731,20 +1171,26 @@ public struct FfiConverterTypeProcessResult: FfiConverterRustBuffer {
             try ProcessResult(
                 gifData: FfiConverterData.read(from: &buf), 
                 tensorData: FfiConverterOptionData.read(from: &buf), 
+                tensorIndices: FfiConverterOptionData.read(from: &buf), 
+                tensorPalette: FfiConverterOptionData.read(from: &buf), 
                 finalFileSize: FfiConverterUInt32.read(from: &buf), 
                 processingTimeMs: FfiConverterFloat.read(from: &buf), 
                 actualFrameCount: FfiConverterUInt16.read(from: &buf), 
-                paletteSizeUsed: FfiConverterUInt16.read(from: &buf)
+                paletteSizeUsed: FfiConverterUInt16.read(from: &buf), 
+                stats: FfiConverterOptionTypeProcessStats.read(from: &buf)
         )
     }
 
     public static func write(_ value: ProcessResult, into buf: inout [UInt8]) {
         FfiConverterData.write(value.gifData, into: &buf)
         FfiConverterOptionData.write(value.tensorData, into: &buf)
+        FfiConverterOptionData.write(value.tensorIndices, into: &buf)
+        FfiConverterOptionData.write(value.tensorPalette, into: &buf)
         FfiConverterUInt32.write(value.finalFileSize, into: &buf)
         FfiConverterFloat.write(value.processingTimeMs, into: &buf)
         FfiConverterUInt16.write(value.actualFrameCount, into: &buf)
         FfiConverterUInt16.write(value.paletteSizeUsed, into: &buf)
+        FfiConverterOptionTypeProcessStats.write(value.stats, into: &buf)
     }
 }
 
@@ -764,30 +1210,156 @@ public func FfiConverterTypeProcessResult_lower(_ value: ProcessResult) -> RustB
 }
 
 
-public struct QuantizeOpts {
-    public var qualityMin: UInt8
-    public var qualityMax: UInt8
-    public var speed: Int32
-    public var paletteSize: UInt16
-    public var ditheringLevel: Float
-    public var sharedPalette: Bool
+public struct ProcessStats {
+    public var ingestNs: UInt64
+    public var resizeNs: UInt64
+    public var paletteNs: UInt64
+    public var remapNs: UInt64
+    public var lzwNs: UInt64
+    public var tensorNs: UInt64
+    public var bytesAllocated: UInt64
+    public var frameRemapUs: [UInt32]
+    public var frameLzwBytes: [UInt32]
 
     // Default memberwise initializers are never public by default, so we
     // declare one manually.
-    public init(qualityMin: UInt8, qualityMax: UInt8, speed: Int32, paletteSize: UInt16, ditheringLevel: Float, sharedPalette: Bool) {
-        self.qualityMin = qualityMin
-        self.qualityMax = qualityMax
-        self.speed = speed
-        self.paletteSize = paletteSize
-        self.ditheringLevel = ditheringLevel
-        self.sharedPalette = sharedPalette
+    public init(ingestNs: UInt64, resizeNs: UInt64, paletteNs: UInt64, remapNs: UInt64, lzwNs: UInt64, tensorNs: UInt64, bytesAllocated: UInt64, frameRemapUs: [UInt32], frameLzwBytes: [UInt32]) {
+        self.ingestNs = ingestNs
+        self.resizeNs = resizeNs
+        self.paletteNs = paletteNs
+        self.remapNs = remapNs
+        self.lzwNs = lzwNs
+        self.tensorNs = tensorNs
+        self.bytesAllocated = bytesAllocated
+        self.frameRemapUs = frameRemapUs
+        self.frameLzwBytes = frameLzwBytes
     }
 }
 
 
 
-extension QuantizeOpts: Equatable, Hashable {
-    public static func ==(lhs: QuantizeOpts, rhs: QuantizeOpts) -> Bool {
+extension ProcessStats: Equatable, Hashable {
+    public static func ==(lhs: ProcessStats, rhs: ProcessStats) -> Bool {
+        if lhs.ingestNs != rhs.ingestNs {
+            return false
+        }
+        if lhs.resizeNs != rhs.resizeNs {
+            return false
+        }
+        if lhs.paletteNs != rhs.paletteNs {
+            return false
+        }
+        if lhs.remapNs != rhs.remapNs {
+            return false
+        }
+        if lhs.lzwNs != rhs.lzwNs {
+            return false
+        }
+        if lhs.tensorNs != rhs.tensorNs {
+            return false
+        }
+        if lhs.bytesAllocated != rhs.bytesAllocated {
+            return false
+        }
+        if lhs.frameRemapUs != rhs.frameRemapUs {
+            return false
+        }
+        if lhs.frameLzwBytes != rhs.frameLzwBytes {
+            return false
+        }
+        return true
+    }
+
+    public func hash(into hasher: inout Hasher) {
+        hasher.combine(ingestNs)
+        hasher.combine(resizeNs)
+        hasher.combine(paletteNs)
+        hasher.combine(remapNs)
+        hasher.combine(lzwNs)
+        hasher.combine(tensorNs)
+        hasher.combine(bytesAllocated)
+        hasher.combine(frameRemapUs)
+        hasher.combine(frameLzwBytes)
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public struct FfiConverterTypeProcessStats: FfiConverterRustBuffer {
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> ProcessStats {
+        return
+            try ProcessStats(
+                ingestNs: FfiConverterUInt64.read(from: &buf), 
+                resizeNs: FfiConverterUInt64.read(from: &buf), 
+                paletteNs: FfiConverterUInt64.read(from: &buf), 
+                remapNs: FfiConverterUInt64.read(from: &buf), 
+                lzwNs: FfiConverterUInt64.read(from: &buf), 
+                tensorNs: FfiConverterUInt64.read(from: &buf), 
+                bytesAllocated: FfiConverterUInt64.read(from: &buf), 
+                frameRemapUs: FfiConverterSequenceUInt32.read(from: &buf), 
+                frameLzwBytes: FfiConverterSequenceUInt32.read(from: &buf)
+        )
+    }
+
+    public static func write(_ value: ProcessStats, into buf: inout [UInt8]) {
+        FfiConverterUInt64.write(value.ingestNs, into: &buf)
+        FfiConverterUInt64.write(value.resizeNs, into: &buf)
+        FfiConverterUInt64.write(value.paletteNs, into: &buf)
+        FfiConverterUInt64.write(value.remapNs, into: &buf)
+        FfiConverterUInt64.write(value.lzwNs, into: &buf)
+        FfiConverterUInt64.write(value.tensorNs, into: &buf)
+        FfiConverterUInt64.write(value.bytesAllocated, into: &buf)
+        FfiConverterSequenceUInt32.write(value.frameRemapUs, into: &buf)
+        FfiConverterSequenceUInt32.write(value.frameLzwBytes, into: &buf)
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeProcessStats_lift(_ buf: RustBuffer) throws -> ProcessStats {
+    return try FfiConverterTypeProcessStats.lift(buf)
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeProcessStats_lower(_ value: ProcessStats) -> RustBuffer {
+    return FfiConverterTypeProcessStats.lower(value)
+}
+
+
+public struct QuantizeOpts {
+    public var qualityMin: UInt8
+    public var qualityMax: UInt8
+    public var speed: Int32
+    public var paletteSize: UInt16
+    public var ditheringLevel: Float
+    public var sharedPalette: Bool
+    public var oklabPalette: Bool
+    public var blueNoiseDither: Bool
+
+    // Default memberwise initializers are never public by default, so we
+    // declare one manually.
+    public init(qualityMin: UInt8, qualityMax: UInt8, speed: Int32, paletteSize: UInt16, ditheringLevel: Float, sharedPalette: Bool, oklabPalette: Bool = false, blueNoiseDither: Bool = false) {
+        self.qualityMin = qualityMin
+        self.qualityMax = qualityMax
+        self.speed = speed
+        self.paletteSize = paletteSize
+        self.ditheringLevel = ditheringLevel
+        self.sharedPalette = sharedPalette
+        self.oklabPalette = oklabPalette
+        self.blueNoiseDither = blueNoiseDither
+    }
+}
+
+
+
+extension QuantizeOpts: Equatable, Hashable {
+    public static func ==(lhs: QuantizeOpts, rhs: QuantizeOpts) -> Bool {
         if lhs.qualityMin != rhs.qualityMin {
             return false
         }
@@ -806,6 +1378,12 @@ extension QuantizeOpts: Equatable, Hashable {
         if lhs.sharedPalette != rhs.sharedPalette {
             return false
         }
+        if lhs.oklabPalette != rhs.oklabPalette {
+            return false
+        }
+        if lhs.blueNoiseDither != rhs.blueNoiseDither {
+            return false
+        }
         return true
     }
 
@@ -816,6 +1394,8 @@ extension QuantizeOpts: Equatable, Hashable {
         hasher.combine(paletteSize)
         hasher.combine(ditheringLevel)
         hasher.combine(sharedPalette)
+        hasher.combine(oklabPalette)
+        hasher.combine(blueNoiseDither)
     }
 }
 
@@ -832,7 +1412,9 @@ public struct FfiConverterTypeQuantizeOpts: FfiConverterRustBuffer {
                 speed: FfiConverterInt32.read(from: &buf), 
                 paletteSize: FfiConverterUInt16.read(from: &buf), 
                 ditheringLevel: FfiConverterFloat.read(from: &buf), 
-                sharedPalette: FfiConverterBool.read(from: &buf)
+                sharedPalette: FfiConverterBool.read(from: &buf), 
+                oklabPalette: FfiConverterBool.read(from: &buf), 
+                blueNoiseDither: FfiConverterBool.read(from: &buf)
         )
     }
 
@@ -843,6 +1425,8 @@ public struct FfiConverterTypeQuantizeOpts: FfiConverterRustBuffer {
         FfiConverterUInt16.write(value.paletteSize, into: &buf)
         FfiConverterFloat.write(value.ditheringLevel, into: &buf)
         FfiConverterBool.write(value.sharedPalette, into: &buf)
+        FfiConverterBool.write(value.oklabPalette, into: &buf)
+        FfiConverterBool.write(value.blueNoiseDither, into: &buf)
     }
 }
 
@@ -862,6 +1446,178 @@ public func FfiConverterTypeQuantizeOpts_lower(_ value: QuantizeOpts) -> RustBuf
 }
 
 
+public struct TensorTexture {
+    public var data: Data
+    public var levels: [TensorTextureLevel]
+    public var paletteTexture: Data?
+
+    // Default memberwise initializers are never public by default, so we
+    // declare one manually.
+    public init(data: Data, levels: [TensorTextureLevel], paletteTexture: Data?) {
+        self.data = data
+        self.levels = levels
+        self.paletteTexture = paletteTexture
+    }
+}
+
+
+
+extension TensorTexture: Equatable, Hashable {
+    public static func ==(lhs: TensorTexture, rhs: TensorTexture) -> Bool {
+        if lhs.data != rhs.data {
+            return false
+        }
+        if lhs.levels != rhs.levels {
+            return false
+        }
+        if lhs.paletteTexture != rhs.paletteTexture {
+            return false
+        }
+        return true
+    }
+
+    public func hash(into hasher: inout Hasher) {
+        hasher.combine(data)
+        hasher.combine(levels)
+        hasher.combine(paletteTexture)
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public struct FfiConverterTypeTensorTexture: FfiConverterRustBuffer {
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> TensorTexture {
+        return
+            try TensorTexture(
+                data: FfiConverterData.read(from: &buf), 
+                levels: FfiConverterSequenceTypeTensorTextureLevel.read(from: &buf), 
+                paletteTexture: FfiConverterOptionData.read(from: &buf)
+        )
+    }
+
+    public static func write(_ value: TensorTexture, into buf: inout [UInt8]) {
+        FfiConverterData.write(value.data, into: &buf)
+        FfiConverterSequenceTypeTensorTextureLevel.write(value.levels, into: &buf)
+        FfiConverterOptionData.write(value.paletteTexture, into: &buf)
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeTensorTexture_lift(_ buf: RustBuffer) throws -> TensorTexture {
+    return try FfiConverterTypeTensorTexture.lift(buf)
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeTensorTexture_lower(_ value: TensorTexture) -> RustBuffer {
+    return FfiConverterTypeTensorTexture.lower(value)
+}
+
+
+public struct TensorTextureLevel {
+    public var offset: UInt64
+    public var width: UInt32
+    public var height: UInt32
+    public var depth: UInt32
+    public var bytesPerRow: UInt64
+    public var bytesPerImage: UInt64
+
+    // Default memberwise initializers are never public by default, so we
+    // declare one manually.
+    public init(offset: UInt64, width: UInt32, height: UInt32, depth: UInt32, bytesPerRow: UInt64, bytesPerImage: UInt64) {
+        self.offset = offset
+        self.width = width
+        self.height = height
+        self.depth = depth
+        self.bytesPerRow = bytesPerRow
+        self.bytesPerImage = bytesPerImage
+    }
+}
+
+
+
+extension TensorTextureLevel: Equatable, Hashable {
+    public static func ==(lhs: TensorTextureLevel, rhs: TensorTextureLevel) -> Bool {
+        if lhs.offset != rhs.offset {
+            return false
+        }
+        if lhs.width != rhs.width {
+            return false
+        }
+        if lhs.height != rhs.height {
+            return false
+        }
+        if lhs.depth != rhs.depth {
+            return false
+        }
+        if lhs.bytesPerRow != rhs.bytesPerRow {
+            return false
+        }
+        if lhs.bytesPerImage != rhs.bytesPerImage {
+            return false
+        }
+        return true
+    }
+
+    public func hash(into hasher: inout Hasher) {
+        hasher.combine(offset)
+        hasher.combine(width)
+        hasher.combine(height)
+        hasher.combine(depth)
+        hasher.combine(bytesPerRow)
+        hasher.combine(bytesPerImage)
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public struct FfiConverterTypeTensorTextureLevel: FfiConverterRustBuffer {
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> TensorTextureLevel {
+        return
+            try TensorTextureLevel(
+                offset: FfiConverterUInt64.read(from: &buf), 
+                width: FfiConverterUInt32.read(from: &buf), 
+                height: FfiConverterUInt32.read(from: &buf), 
+                depth: FfiConverterUInt32.read(from: &buf), 
+                bytesPerRow: FfiConverterUInt64.read(from: &buf), 
+                bytesPerImage: FfiConverterUInt64.read(from: &buf)
+        )
+    }
+
+    public static func write(_ value: TensorTextureLevel, into buf: inout [UInt8]) {
+        FfiConverterUInt64.write(value.offset, into: &buf)
+        FfiConverterUInt32.write(value.width, into: &buf)
+        FfiConverterUInt32.write(value.height, into: &buf)
+        FfiConverterUInt32.write(value.depth, into: &buf)
+        FfiConverterUInt64.write(value.bytesPerRow, into: &buf)
+        FfiConverterUInt64.write(value.bytesPerImage, into: &buf)
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeTensorTextureLevel_lift(_ buf: RustBuffer) throws -> TensorTextureLevel {
+    return try FfiConverterTypeTensorTextureLevel.lift(buf)
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeTensorTextureLevel_lower(_ value: TensorTextureLevel) -> RustBuffer {
+    return FfiConverterTypeTensorTextureLevel.lower(value)
+}
+
+
 public enum ProcessorError {
 
     
@@ -874,6 +1630,8 @@ public enum ProcessorError {
     
     case MemoryError(message: String)
     
+    case Cancelled(message: String)
+    
 }
 
 
@@ -906,6 +1664,10 @@ public struct FfiConverterTypeProcessorError: FfiConverterRustBuffer {
             message: try FfiConverterString.read(from: &buf)
         )
         
+        case 5: return .Cancelled(
+            message: try FfiConverterString.read(from: &buf)
+        )
+        
 
         default: throw UniffiInternalError.unexpectedEnumCase
         }
@@ -925,6 +1687,8 @@ public struct FfiConverterTypeProcessorError: FfiConverterRustBuffer {
             writeInt(&buf, Int32(3))
         case .MemoryError(_ /* message is ignored*/):
             writeInt(&buf, Int32(4))
+        case .Cancelled(_ /* message is ignored*/):
+            writeInt(&buf, Int32(5))
 
         
         }
@@ -940,52 +1704,646 @@ extension ProcessorError: Foundation.LocalizedError {
     }
 }
 
+// Note that we don't yet support `indirect` for enums.
+// See https://github.com/mozilla/uniffi-rs/issues/396 for further discussion.
+
+public enum Stage {
+    
+    case ingest
+    case resize
+    case palette
+    case remap
+    case lzw
+    case tensor
+}
+
+
 #if swift(>=5.8)
 @_documentation(visibility: private)
 #endif
-fileprivate struct FfiConverterOptionData: FfiConverterRustBuffer {
-    typealias SwiftType = Data?
+public struct FfiConverterTypeStage: FfiConverterRustBuffer {
+    typealias SwiftType = Stage
 
-    public static func write(_ value: SwiftType, into buf: inout [UInt8]) {
-        guard let value = value else {
-            writeInt(&buf, Int8(0))
-            return
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> Stage {
+        let variant: Int32 = try readInt(&buf)
+        switch variant {
+        
+        case 1: return .ingest
+        
+        case 2: return .resize
+        
+        case 3: return .palette
+        
+        case 4: return .remap
+        
+        case 5: return .lzw
+        
+        case 6: return .tensor
+        
+        default: throw UniffiInternalError.unexpectedEnumCase
         }
-        writeInt(&buf, Int8(1))
-        FfiConverterData.write(value, into: &buf)
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
-        switch try readInt(&buf) as Int8 {
-        case 0: return nil
-        case 1: return try FfiConverterData.read(from: &buf)
-        default: throw UniffiInternalError.unexpectedOptionalTag
+    public static func write(_ value: Stage, into buf: inout [UInt8]) {
+        switch value {
+        
+        
+        case .ingest:
+            writeInt(&buf, Int32(1))
+        
+        
+        case .resize:
+            writeInt(&buf, Int32(2))
+        
+        
+        case .palette:
+            writeInt(&buf, Int32(3))
+        
+        
+        case .remap:
+            writeInt(&buf, Int32(4))
+        
+        
+        case .lzw:
+            writeInt(&buf, Int32(5))
+        
+        
+        case .tensor:
+            writeInt(&buf, Int32(6))
+        
+        
         }
     }
 }
-public func calculateBufferSize(width: UInt32, height: UInt32, frameCount: UInt32) -> UInt32 {
-    return try!  FfiConverterUInt32.lift(try! rustCall() {
-    uniffi_rgb2gif_processor_fn_func_calculate_buffer_size(
-        FfiConverterUInt32.lower(width),
-        FfiConverterUInt32.lower(height),
-        FfiConverterUInt32.lower(frameCount),$0
-    )
-})
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeStage_lift(_ buf: RustBuffer) throws -> Stage {
+    return try FfiConverterTypeStage.lift(buf)
 }
-public func processAllFrames(framesRgba: Data, width: UInt32, height: UInt32, frameCount: UInt32, quantizeOpts: QuantizeOpts, gifOpts: GifOpts)throws  -> ProcessResult {
-    return try  FfiConverterTypeProcessResult.lift(try rustCallWithError(FfiConverterTypeProcessorError.lift) {
-    uniffi_rgb2gif_processor_fn_func_process_all_frames(
-        FfiConverterData.lower(framesRgba),
-        FfiConverterUInt32.lower(width),
-        FfiConverterUInt32.lower(height),
-        FfiConverterUInt32.lower(frameCount),
-        FfiConverterTypeQuantizeOpts.lower(quantizeOpts),
-        FfiConverterTypeGifOpts.lower(gifOpts),$0
-    )
-})
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeStage_lower(_ value: Stage) -> RustBuffer {
+    return FfiConverterTypeStage.lower(value)
 }
-public func validateBuffer(buffer: Data, expectedSize: UInt32) -> Bool {
-    return try!  FfiConverterBool.lift(try! rustCall() {
+
+
+
+extension Stage: Equatable, Hashable {}
+
+
+
+// Note that we don't yet support `indirect` for enums.
+// See https://github.com/mozilla/uniffi-rs/issues/396 for further discussion.
+
+public enum TensorLayout {
+    
+    case frameMajor
+    case bricked
+    case morton
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public struct FfiConverterTypeTensorLayout: FfiConverterRustBuffer {
+    typealias SwiftType = TensorLayout
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> TensorLayout {
+        let variant: Int32 = try readInt(&buf)
+        switch variant {
+        
+        case 1: return .frameMajor
+        
+        case 2: return .bricked
+        
+        case 3: return .morton
+        
+        default: throw UniffiInternalError.unexpectedEnumCase
+        }
+    }
+
+    public static func write(_ value: TensorLayout, into buf: inout [UInt8]) {
+        switch value {
+        
+        
+        case .frameMajor:
+            writeInt(&buf, Int32(1))
+        
+        
+        case .bricked:
+            writeInt(&buf, Int32(2))
+        
+        
+        case .morton:
+            writeInt(&buf, Int32(3))
+        
+        
+        }
+    }
+}
+
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeTensorLayout_lift(_ buf: RustBuffer) throws -> TensorLayout {
+    return try FfiConverterTypeTensorLayout.lift(buf)
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+public func FfiConverterTypeTensorLayout_lower(_ value: TensorLayout) -> RustBuffer {
+    return FfiConverterTypeTensorLayout.lower(value)
+}
+
+
+
+extension TensorLayout: Equatable, Hashable {}
+
+
+
+
+
+
+public protocol ProgressListener : AnyObject {
+    
+    func onProgress(framesDone: UInt32, frameCount: UInt32) 
+    
+}
+
+
+
+// Put the implementation in a struct so we don't pollute the top-level namespace
+fileprivate struct UniffiCallbackInterfaceProgressListener {
+
+    // Create the VTable using a series of closures.
+    // Swift automatically converts these into C callback functions.
+    static var vtable: UniffiVTableCallbackInterfaceProgressListener = UniffiVTableCallbackInterfaceProgressListener(
+        onProgress: { (
+            uniffiHandle: UInt64,
+            framesDone: UInt32,
+            frameCount: UInt32,
+            uniffiOutReturn: UnsafeMutableRawPointer,
+            uniffiCallStatus: UnsafeMutablePointer<RustCallStatus>
+        ) in
+            let makeCall = {
+                () throws -> () in
+                guard let uniffiObj = try? FfiConverterCallbackInterfaceProgressListener.handleMap.get(handle: uniffiHandle) else {
+                    throw UniffiInternalError.unexpectedStaleHandle
+                }
+                return uniffiObj.onProgress(
+                     framesDone: try FfiConverterUInt32.lift(framesDone),
+                     frameCount: try FfiConverterUInt32.lift(frameCount)
+                )
+            }
+
+
+            let writeReturn = { () }
+            uniffiTraitInterfaceCall(
+                callStatus: uniffiCallStatus,
+                makeCall: makeCall,
+                writeReturn: writeReturn
+            )
+        },
+        uniffiFree: { (uniffiHandle: UInt64) -> () in
+            let result = try? FfiConverterCallbackInterfaceProgressListener.handleMap.remove(handle: uniffiHandle)
+            if result == nil {
+                print("Uniffi callback interface ProgressListener: handle missing in uniffiFree")
+            }
+        }
+    )
+}
+
+private func uniffiCallbackInitProgressListener() {
+    uniffi_rgb2gif_processor_fn_init_callback_vtable_progresslistener(&UniffiCallbackInterfaceProgressListener.vtable)
+}
+
+// FfiConverter protocol for callback interfaces
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+fileprivate struct FfiConverterCallbackInterfaceProgressListener {
+    fileprivate static var handleMap = UniffiHandleMap<ProgressListener>()
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+extension FfiConverterCallbackInterfaceProgressListener : FfiConverter {
+    typealias SwiftType = ProgressListener
+    typealias FfiType = UInt64
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public static func lift(_ handle: UInt64) throws -> SwiftType {
+        try handleMap.get(handle: handle)
+    }
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+        let handle: UInt64 = try readInt(&buf)
+        return try lift(handle)
+    }
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public static func lower(_ v: SwiftType) -> UInt64 {
+        return handleMap.insert(obj: v)
+    }
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public static func write(_ v: SwiftType, into buf: inout [UInt8]) {
+        writeInt(&buf, lower(v))
+    }
+}
+
+
+
+
+public protocol SignpostListener : AnyObject {
+    
+    func onIntervalBegin(stage: Stage, id: UInt64) 
+    
+    func onIntervalEnd(stage: Stage, id: UInt64) 
+    
+}
+
+
+
+// Put the implementation in a struct so we don't pollute the top-level namespace
+fileprivate struct UniffiCallbackInterfaceSignpostListener {
+
+    // Create the VTable using a series of closures.
+    // Swift automatically converts these into C callback functions.
+    static var vtable: UniffiVTableCallbackInterfaceSignpostListener = UniffiVTableCallbackInterfaceSignpostListener(
+        onIntervalBegin: { (
+            uniffiHandle: UInt64,
+            stage: RustBuffer,
+            id: UInt64,
+            uniffiOutReturn: UnsafeMutableRawPointer,
+            uniffiCallStatus: UnsafeMutablePointer<RustCallStatus>
+        ) in
+            let makeCall = {
+                () throws -> () in
+                guard let uniffiObj = try? FfiConverterCallbackInterfaceSignpostListener.handleMap.get(handle: uniffiHandle) else {
+                    throw UniffiInternalError.unexpectedStaleHandle
+                }
+                return uniffiObj.onIntervalBegin(
+                     stage: try FfiConverterTypeStage.lift(stage),
+                     id: try FfiConverterUInt64.lift(id)
+                )
+            }
+
+
+            let writeReturn = { () }
+            uniffiTraitInterfaceCall(
+                callStatus: uniffiCallStatus,
+                makeCall: makeCall,
+                writeReturn: writeReturn
+            )
+        },
+        onIntervalEnd: { (
+            uniffiHandle: UInt64,
+            stage: RustBuffer,
+            id: UInt64,
+            uniffiOutReturn: UnsafeMutableRawPointer,
+            uniffiCallStatus: UnsafeMutablePointer<RustCallStatus>
+        ) in
+            let makeCall = {
+                () throws -> () in
+                guard let uniffiObj = try? FfiConverterCallbackInterfaceSignpostListener.handleMap.get(handle: uniffiHandle) else {
+                    throw UniffiInternalError.unexpectedStaleHandle
+                }
+                return uniffiObj.onIntervalEnd(
+                     stage: try FfiConverterTypeStage.lift(stage),
+                     id: try FfiConverterUInt64.lift(id)
+                )
+            }
+
+
+            let writeReturn = { () }
+            uniffiTraitInterfaceCall(
+                callStatus: uniffiCallStatus,
+                makeCall: makeCall,
+                writeReturn: writeReturn
+            )
+        },
+        uniffiFree: { (uniffiHandle: UInt64) -> () in
+            let result = try? FfiConverterCallbackInterfaceSignpostListener.handleMap.remove(handle: uniffiHandle)
+            if result == nil {
+                print("Uniffi callback interface SignpostListener: handle missing in uniffiFree")
+            }
+        }
+    )
+}
+
+private func uniffiCallbackInitSignpostListener() {
+    uniffi_rgb2gif_processor_fn_init_callback_vtable_signpostlistener(&UniffiCallbackInterfaceSignpostListener.vtable)
+}
+
+// FfiConverter protocol for callback interfaces
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+fileprivate struct FfiConverterCallbackInterfaceSignpostListener {
+    fileprivate static var handleMap = UniffiHandleMap<SignpostListener>()
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+extension FfiConverterCallbackInterfaceSignpostListener : FfiConverter {
+    typealias SwiftType = SignpostListener
+    typealias FfiType = UInt64
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public static func lift(_ handle: UInt64) throws -> SwiftType {
+        try handleMap.get(handle: handle)
+    }
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+        let handle: UInt64 = try readInt(&buf)
+        return try lift(handle)
+    }
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public static func lower(_ v: SwiftType) -> UInt64 {
+        return handleMap.insert(obj: v)
+    }
+
+#if swift(>=5.8)
+    @_documentation(visibility: private)
+#endif
+    public static func write(_ v: SwiftType, into buf: inout [UInt8]) {
+        writeInt(&buf, lower(v))
+    }
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+fileprivate struct FfiConverterOptionData: FfiConverterRustBuffer {
+    typealias SwiftType = Data?
+
+    public static func write(_ value: SwiftType, into buf: inout [UInt8]) {
+        guard let value = value else {
+            writeInt(&buf, Int8(0))
+            return
+        }
+        writeInt(&buf, Int8(1))
+        FfiConverterData.write(value, into: &buf)
+    }
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+        switch try readInt(&buf) as Int8 {
+        case 0: return nil
+        case 1: return try FfiConverterData.read(from: &buf)
+        default: throw UniffiInternalError.unexpectedOptionalTag
+        }
+    }
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+fileprivate struct FfiConverterOptionTypeProcessStats: FfiConverterRustBuffer {
+    typealias SwiftType = ProcessStats?
+
+    public static func write(_ value: SwiftType, into buf: inout [UInt8]) {
+        guard let value = value else {
+            writeInt(&buf, Int8(0))
+            return
+        }
+        writeInt(&buf, Int8(1))
+        FfiConverterTypeProcessStats.write(value, into: &buf)
+    }
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+        switch try readInt(&buf) as Int8 {
+        case 0: return nil
+        case 1: return try FfiConverterTypeProcessStats.read(from: &buf)
+        default: throw UniffiInternalError.unexpectedOptionalTag
+        }
+    }
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+fileprivate struct FfiConverterSequenceUInt32: FfiConverterRustBuffer {
+    typealias SwiftType = [UInt32]
+
+    public static func write(_ value: [UInt32], into buf: inout [UInt8]) {
+        let len = Int32(value.count)
+        writeInt(&buf, len)
+        for item in value {
+            FfiConverterUInt32.write(item, into: &buf)
+        }
+    }
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> [UInt32] {
+        let len: Int32 = try readInt(&buf)
+        var seq = [UInt32]()
+        seq.reserveCapacity(Int(len))
+        for _ in 0 ..< len {
+            seq.append(try FfiConverterUInt32.read(from: &buf))
+        }
+        return seq
+    }
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+fileprivate struct FfiConverterSequenceFloat: FfiConverterRustBuffer {
+    typealias SwiftType = [Float]
+
+    public static func write(_ value: [Float], into buf: inout [UInt8]) {
+        let len = Int32(value.count)
+        writeInt(&buf, len)
+        for item in value {
+            FfiConverterFloat.write(item, into: &buf)
+        }
+    }
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> [Float] {
+        let len: Int32 = try readInt(&buf)
+        var seq = [Float]()
+        seq.reserveCapacity(Int(len))
+        for _ in 0 ..< len {
+            seq.append(try FfiConverterFloat.read(from: &buf))
+        }
+        return seq
+    }
+}
+
+#if swift(>=5.8)
+@_documentation(visibility: private)
+#endif
+fileprivate struct FfiConverterSequenceTypeTensorTextureLevel: FfiConverterRustBuffer {
+    typealias SwiftType = [TensorTextureLevel]
+
+    public static func write(_ value: [TensorTextureLevel], into buf: inout [UInt8]) {
+        let len = Int32(value.count)
+        writeInt(&buf, len)
+        for item in value {
+            FfiConverterTypeTensorTextureLevel.write(item, into: &buf)
+        }
+    }
+
+    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> [TensorTextureLevel] {
+        let len: Int32 = try readInt(&buf)
+        var seq = [TensorTextureLevel]()
+        seq.reserveCapacity(Int(len))
+        for _ in 0 ..< len {
+            seq.append(try FfiConverterTypeTensorTextureLevel.read(from: &buf))
+        }
+        return seq
+    }
+}
+private let UNIFFI_RUST_FUTURE_POLL_READY: Int8 = 0
+private let UNIFFI_RUST_FUTURE_POLL_MAYBE_READY: Int8 = 1
+
+fileprivate let uniffiContinuationHandleMap = UniffiHandleMap<UnsafeContinuation<Int8, Never>>()
+
+fileprivate func uniffiRustCallAsync<F, T>(
+    rustFutureFunc: () -> UInt64,
+    pollFunc: (UInt64, @escaping UniffiRustFutureContinuationCallback, UInt64) -> (),
+    completeFunc: (UInt64, UnsafeMutablePointer<RustCallStatus>) -> F,
+    freeFunc: (UInt64) -> (),
+    liftFunc: (F) throws -> T,
+    errorHandler: ((RustBuffer) throws -> Swift.Error)?
+) async throws -> T {
+    // Make sure to call uniffiEnsureInitialized() since future creation doesn't have a
+    // RustCallStatus param, so doesn't use makeRustCall()
+    uniffiEnsureInitialized()
+    let rustFuture = rustFutureFunc()
+    defer {
+        freeFunc(rustFuture)
+    }
+    var pollResult: Int8;
+    repeat {
+        pollResult = await withUnsafeContinuation {
+            pollFunc(
+                rustFuture,
+                uniffiFutureContinuationCallback,
+                uniffiContinuationHandleMap.insert(obj: $0)
+            )
+        }
+    } while pollResult != UNIFFI_RUST_FUTURE_POLL_READY
+
+    return try liftFunc(makeRustCall(
+        { completeFunc(rustFuture, $0) },
+        errorHandler: errorHandler
+    ))
+}
+
+// Callback handlers for an async calls.  These are invoked by Rust when the future is ready.  They
+// lift the return value or error and resume the suspended function.
+fileprivate func uniffiFutureContinuationCallback(handle: UInt64, pollResult: Int8) {
+    if let continuation = try? uniffiContinuationHandleMap.remove(handle: handle) {
+        continuation.resume(returning: pollResult)
+    } else {
+        print("uniffiFutureContinuationCallback invalid handle")
+    }
+}
+public func calculateBufferSize(width: UInt32, height: UInt32, frameCount: UInt32) -> UInt32 {
+    return try!  FfiConverterUInt32.lift(try! rustCall() {
+    uniffi_rgb2gif_processor_fn_func_calculate_buffer_size(
+        FfiConverterUInt32.lower(width),
+        FfiConverterUInt32.lower(height),
+        FfiConverterUInt32.lower(frameCount),$0
+    )
+})
+}
+public func clearSignpostListener() {try! rustCall() {
+    uniffi_rgb2gif_processor_fn_func_clear_signpost_listener($0
+    )
+}
+}
+public func convolveTensor(tensor: Data, tensorLayout: TensorLayout, frameCount: UInt32, kernel: [Float], kernelSize: UInt32)throws  -> Data {
+    return try  FfiConverterData.lift(try rustCallWithError(FfiConverterTypeProcessorError.lift) {
+    uniffi_rgb2gif_processor_fn_func_convolve_tensor(
+        FfiConverterData.lower(tensor),
+        FfiConverterTypeTensorLayout.lower(tensorLayout),
+        FfiConverterUInt32.lower(frameCount),
+        FfiConverterSequenceFloat.lower(kernel),
+        FfiConverterUInt32.lower(kernelSize),$0
+    )
+})
+}
+public func processAllFrames(framesRgba: Data, width: UInt32, height: UInt32, frameCount: UInt32, quantizeOpts: QuantizeOpts, gifOpts: GifOpts)throws  -> ProcessResult {
+    return try  FfiConverterTypeProcessResult.lift(try rustCallWithError(FfiConverterTypeProcessorError.lift) {
+    uniffi_rgb2gif_processor_fn_func_process_all_frames(
+        FfiConverterData.lower(framesRgba),
+        FfiConverterUInt32.lower(width),
+        FfiConverterUInt32.lower(height),
+        FfiConverterUInt32.lower(frameCount),
+        FfiConverterTypeQuantizeOpts.lower(quantizeOpts),
+        FfiConverterTypeGifOpts.lower(gifOpts),$0
+    )
+})
+}
+public func processAllFramesAsync(framesRgba: Data, width: UInt32, height: UInt32, frameCount: UInt32, quantizeOpts: QuantizeOpts, gifOpts: GifOpts, task: EncodeTask)async throws  -> ProcessResult {
+    return
+        try  await uniffiRustCallAsync(
+            rustFutureFunc: {
+                uniffi_rgb2gif_processor_fn_func_process_all_frames_async(FfiConverterData.lower(framesRgba),FfiConverterUInt32.lower(width),FfiConverterUInt32.lower(height),FfiConverterUInt32.lower(frameCount),FfiConverterTypeQuantizeOpts.lower(quantizeOpts),FfiConverterTypeGifOpts.lower(gifOpts),FfiConverterTypeEncodeTask.lower(task)
+                )
+            },
+            pollFunc: ffi_rgb2gif_processor_rust_future_poll_rust_buffer,
+            completeFunc: ffi_rgb2gif_processor_rust_future_complete_rust_buffer,
+            freeFunc: ffi_rgb2gif_processor_rust_future_free_rust_buffer,
+            liftFunc: FfiConverterTypeProcessResult.lift,
+            errorHandler: FfiConverterTypeProcessorError.lift
+        )
+}
+public func setSignpostListener(listener: SignpostListener) {try! rustCall() {
+    uniffi_rgb2gif_processor_fn_func_set_signpost_listener(
+        FfiConverterCallbackInterfaceSignpostListener.lower(listener),$0
+    )
+}
+}
+public func setStatsEnabled(enabled: Bool) {try! rustCall() {
+    uniffi_rgb2gif_processor_fn_func_set_stats_enabled(
+        FfiConverterBool.lower(enabled),$0
+    )
+}
+}
+public func tensorTexture(voxels: Data, palette: Data?, tensorLayout: TensorLayout, frameCount: UInt32, mipLevels: UInt32, rowAlignment: UInt32)throws  -> TensorTexture {
+    return try  FfiConverterTypeTensorTexture.lift(try rustCallWithError(FfiConverterTypeProcessorError.lift) {
+    uniffi_rgb2gif_processor_fn_func_tensor_texture(
+        FfiConverterData.lower(voxels),
+        FfiConverterOptionData.lower(palette),
+        FfiConverterTypeTensorLayout.lower(tensorLayout),
+        FfiConverterUInt32.lower(frameCount),
+        FfiConverterUInt32.lower(mipLevels),
+        FfiConverterUInt32.lower(rowAlignment),$0
+    )
+})
+}
+public func validateBuffer(buffer: Data, expectedSize: UInt32) -> Bool {
+    return try!  FfiConverterBool.lift(try! rustCall() {
     uniffi_rgb2gif_processor_fn_func_validate_buffer(
         FfiConverterData.lower(buffer),
         FfiConverterUInt32.lower(expectedSize),$0
@@ -1011,13 +2369,69 @@ private var initializationResult: InitializationResult = {
     if (uniffi_rgb2gif_processor_checksum_func_calculate_buffer_size() != 7205) {
         return InitializationResult.apiChecksumMismatch
     }
+    if (uniffi_rgb2gif_processor_checksum_func_clear_signpost_listener() != 25442) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_func_convolve_tensor() != 31266) {
+        return InitializationResult.apiChecksumMismatch
+    }
     if (uniffi_rgb2gif_processor_checksum_func_process_all_frames() != 62849) {
         return InitializationResult.apiChecksumMismatch
     }
+    if (uniffi_rgb2gif_processor_checksum_func_process_all_frames_async() != 39714) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_func_set_signpost_listener() != 10283) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_func_set_stats_enabled() != 4613) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_func_tensor_texture() != 28961) {
+        return InitializationResult.apiChecksumMismatch
+    }
     if (uniffi_rgb2gif_processor_checksum_func_validate_buffer() != 46022) {
         return InitializationResult.apiChecksumMismatch
     }
+    if (uniffi_rgb2gif_processor_checksum_method_encodetask_cancel() != 29221) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_encodetask_frames_done() != 24581) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_encodetask_is_cancelled() != 41705) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_encodetask_set_listener() != 37843) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_framepipeline_finish() != 27077) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_framepipeline_frames_submitted() != 55512) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_framepipeline_submit_frame() != 50789) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_constructor_encodetask_new() != 64710) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_constructor_framepipeline_new() != 61492) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_progresslistener_on_progress() != 16770) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_signpostlistener_on_interval_begin() != 10426) {
+        return InitializationResult.apiChecksumMismatch
+    }
+    if (uniffi_rgb2gif_processor_checksum_method_signpostlistener_on_interval_end() != 5120) {
+        return InitializationResult.apiChecksumMismatch
+    }
 
+    uniffiCallbackInitProgressListener()
+    uniffiCallbackInitSignpostListener()
     return InitializationResult.ok
 }()
 
@@ -250,17 +250,160 @@ typedef struct UniffiForeignFutureStructVoid {
 typedef void (*UniffiForeignFutureCompleteVoid)(uint64_t, UniffiForeignFutureStructVoid
     );
 
+#endif
+#ifndef UNIFFI_FFIDEF_CALLBACK_INTERFACE_PROGRESS_LISTENER_METHOD0
+#define UNIFFI_FFIDEF_CALLBACK_INTERFACE_PROGRESS_LISTENER_METHOD0
+typedef void (*UniffiCallbackInterfaceProgressListenerMethod0)(uint64_t, uint32_t, uint32_t, void*_Nonnull, 
+        RustCallStatus *_Nonnull uniffiCallStatus
+    );
+
+#endif
+#ifndef UNIFFI_FFIDEF_CALLBACK_INTERFACE_SIGNPOST_LISTENER_METHOD0
+#define UNIFFI_FFIDEF_CALLBACK_INTERFACE_SIGNPOST_LISTENER_METHOD0
+typedef void (*UniffiCallbackInterfaceSignpostListenerMethod0)(uint64_t, RustBuffer, uint64_t, void*_Nonnull, 
+        RustCallStatus *_Nonnull uniffiCallStatus
+    );
+
+#endif
+#ifndef UNIFFI_FFIDEF_CALLBACK_INTERFACE_SIGNPOST_LISTENER_METHOD1
+#define UNIFFI_FFIDEF_CALLBACK_INTERFACE_SIGNPOST_LISTENER_METHOD1
+typedef void (*UniffiCallbackInterfaceSignpostListenerMethod1)(uint64_t, RustBuffer, uint64_t, void*_Nonnull, 
+        RustCallStatus *_Nonnull uniffiCallStatus
+    );
+
+#endif
+#ifndef UNIFFI_FFIDEF_V_TABLE_CALLBACK_INTERFACE_PROGRESS_LISTENER
+#define UNIFFI_FFIDEF_V_TABLE_CALLBACK_INTERFACE_PROGRESS_LISTENER
+typedef struct UniffiVTableCallbackInterfaceProgressListener {
+    UniffiCallbackInterfaceProgressListenerMethod0 _Nonnull onProgress;
+    UniffiCallbackInterfaceFree _Nonnull uniffiFree;
+} UniffiVTableCallbackInterfaceProgressListener;
+
+#endif
+#ifndef UNIFFI_FFIDEF_V_TABLE_CALLBACK_INTERFACE_SIGNPOST_LISTENER
+#define UNIFFI_FFIDEF_V_TABLE_CALLBACK_INTERFACE_SIGNPOST_LISTENER
+typedef struct UniffiVTableCallbackInterfaceSignpostListener {
+    UniffiCallbackInterfaceSignpostListenerMethod0 _Nonnull onIntervalBegin;
+    UniffiCallbackInterfaceSignpostListenerMethod1 _Nonnull onIntervalEnd;
+    UniffiCallbackInterfaceFree _Nonnull uniffiFree;
+} UniffiVTableCallbackInterfaceSignpostListener;
+
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_CLONE_ENCODETASK
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_CLONE_ENCODETASK
+void*_Nonnull uniffi_rgb2gif_processor_fn_clone_encodetask(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FREE_ENCODETASK
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FREE_ENCODETASK
+void uniffi_rgb2gif_processor_fn_free_encodetask(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_CONSTRUCTOR_ENCODETASK_NEW
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_CONSTRUCTOR_ENCODETASK_NEW
+void*_Nonnull uniffi_rgb2gif_processor_fn_constructor_encodetask_new(RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_ENCODETASK_CANCEL
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_ENCODETASK_CANCEL
+void uniffi_rgb2gif_processor_fn_method_encodetask_cancel(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_ENCODETASK_FRAMES_DONE
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_ENCODETASK_FRAMES_DONE
+uint32_t uniffi_rgb2gif_processor_fn_method_encodetask_frames_done(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_ENCODETASK_IS_CANCELLED
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_ENCODETASK_IS_CANCELLED
+int8_t uniffi_rgb2gif_processor_fn_method_encodetask_is_cancelled(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_ENCODETASK_SET_LISTENER
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_ENCODETASK_SET_LISTENER
+void uniffi_rgb2gif_processor_fn_method_encodetask_set_listener(void*_Nonnull ptr, uint64_t listener, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_CLONE_FRAMEPIPELINE
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_CLONE_FRAMEPIPELINE
+void*_Nonnull uniffi_rgb2gif_processor_fn_clone_framepipeline(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FREE_FRAMEPIPELINE
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FREE_FRAMEPIPELINE
+void uniffi_rgb2gif_processor_fn_free_framepipeline(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_CONSTRUCTOR_FRAMEPIPELINE_NEW
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_CONSTRUCTOR_FRAMEPIPELINE_NEW
+void*_Nonnull uniffi_rgb2gif_processor_fn_constructor_framepipeline_new(RustBuffer pipeline_opts, RustBuffer quantize_opts, RustBuffer gif_opts, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_FRAMEPIPELINE_FINISH
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_FRAMEPIPELINE_FINISH
+RustBuffer uniffi_rgb2gif_processor_fn_method_framepipeline_finish(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_FRAMEPIPELINE_FRAMES_SUBMITTED
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_FRAMEPIPELINE_FRAMES_SUBMITTED
+uint32_t uniffi_rgb2gif_processor_fn_method_framepipeline_frames_submitted(void*_Nonnull ptr, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_FRAMEPIPELINE_SUBMIT_FRAME
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_METHOD_FRAMEPIPELINE_SUBMIT_FRAME
+void uniffi_rgb2gif_processor_fn_method_framepipeline_submit_frame(void*_Nonnull ptr, RustBuffer frame_rgba, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_INIT_CALLBACK_VTABLE_PROGRESSLISTENER
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_INIT_CALLBACK_VTABLE_PROGRESSLISTENER
+void uniffi_rgb2gif_processor_fn_init_callback_vtable_progresslistener(UniffiVTableCallbackInterfaceProgressListener* _Nonnull vtable
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_INIT_CALLBACK_VTABLE_SIGNPOSTLISTENER
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_INIT_CALLBACK_VTABLE_SIGNPOSTLISTENER
+void uniffi_rgb2gif_processor_fn_init_callback_vtable_signpostlistener(UniffiVTableCallbackInterfaceSignpostListener* _Nonnull vtable
+);
 #endif
 #ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_CALCULATE_BUFFER_SIZE
 #define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_CALCULATE_BUFFER_SIZE
 uint32_t uniffi_rgb2gif_processor_fn_func_calculate_buffer_size(uint32_t width, uint32_t height, uint32_t frame_count, RustCallStatus *_Nonnull out_status
 );
 #endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_CLEAR_SIGNPOST_LISTENER
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_CLEAR_SIGNPOST_LISTENER
+void uniffi_rgb2gif_processor_fn_func_clear_signpost_listener(RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_CONVOLVE_TENSOR
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_CONVOLVE_TENSOR
+RustBuffer uniffi_rgb2gif_processor_fn_func_convolve_tensor(RustBuffer tensor, RustBuffer tensor_layout, uint32_t frame_count, RustBuffer kernel, uint32_t kernel_size, RustCallStatus *_Nonnull out_status
+);
+#endif
 #ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_PROCESS_ALL_FRAMES
 #define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_PROCESS_ALL_FRAMES
 RustBuffer uniffi_rgb2gif_processor_fn_func_process_all_frames(RustBuffer frames_rgba, uint32_t width, uint32_t height, uint32_t frame_count, RustBuffer quantize_opts, RustBuffer gif_opts, RustCallStatus *_Nonnull out_status
 );
 #endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_PROCESS_ALL_FRAMES_ASYNC
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_PROCESS_ALL_FRAMES_ASYNC
+uint64_t uniffi_rgb2gif_processor_fn_func_process_all_frames_async(RustBuffer frames_rgba, uint32_t width, uint32_t height, uint32_t frame_count, RustBuffer quantize_opts, RustBuffer gif_opts, void*_Nonnull task
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_SET_SIGNPOST_LISTENER
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_SET_SIGNPOST_LISTENER
+void uniffi_rgb2gif_processor_fn_func_set_signpost_listener(uint64_t listener, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_SET_STATS_ENABLED
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_SET_STATS_ENABLED
+void uniffi_rgb2gif_processor_fn_func_set_stats_enabled(int8_t enabled, RustCallStatus *_Nonnull out_status
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_TENSOR_TEXTURE
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_TENSOR_TEXTURE
+RustBuffer uniffi_rgb2gif_processor_fn_func_tensor_texture(RustBuffer voxels, RustBuffer palette, RustBuffer tensor_layout, uint32_t frame_count, uint32_t mip_levels, uint32_t row_alignment, RustCallStatus *_Nonnull out_status
+);
+#endif
 #ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_VALIDATE_BUFFER
 #define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_FN_FUNC_VALIDATE_BUFFER
 int8_t uniffi_rgb2gif_processor_fn_func_validate_buffer(RustBuffer buffer, uint32_t expected_size, RustCallStatus *_Nonnull out_status
@@ -550,18 +693,126 @@ void ffi_rgb2gif_processor_rust_future_complete_void(uint64_t handle, RustCallSt
 #define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_CALCULATE_BUFFER_SIZE
 uint16_t uniffi_rgb2gif_processor_checksum_func_calculate_buffer_size(void
     
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_CLEAR_SIGNPOST_LISTENER
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_CLEAR_SIGNPOST_LISTENER
+uint16_t uniffi_rgb2gif_processor_checksum_func_clear_signpost_listener(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_CONVOLVE_TENSOR
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_CONVOLVE_TENSOR
+uint16_t uniffi_rgb2gif_processor_checksum_func_convolve_tensor(void
+    
 );
 #endif
 #ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_PROCESS_ALL_FRAMES
 #define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_PROCESS_ALL_FRAMES
 uint16_t uniffi_rgb2gif_processor_checksum_func_process_all_frames(void
     
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_PROCESS_ALL_FRAMES_ASYNC
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_PROCESS_ALL_FRAMES_ASYNC
+uint16_t uniffi_rgb2gif_processor_checksum_func_process_all_frames_async(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_SET_SIGNPOST_LISTENER
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_SET_SIGNPOST_LISTENER
+uint16_t uniffi_rgb2gif_processor_checksum_func_set_signpost_listener(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_SET_STATS_ENABLED
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_SET_STATS_ENABLED
+uint16_t uniffi_rgb2gif_processor_checksum_func_set_stats_enabled(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_TENSOR_TEXTURE
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_TENSOR_TEXTURE
+uint16_t uniffi_rgb2gif_processor_checksum_func_tensor_texture(void
+    
 );
 #endif
 #ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_VALIDATE_BUFFER
 #define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_FUNC_VALIDATE_BUFFER
 uint16_t uniffi_rgb2gif_processor_checksum_func_validate_buffer(void
     
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_ENCODETASK_CANCEL
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_ENCODETASK_CANCEL
+uint16_t uniffi_rgb2gif_processor_checksum_method_encodetask_cancel(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_ENCODETASK_FRAMES_DONE
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_ENCODETASK_FRAMES_DONE
+uint16_t uniffi_rgb2gif_processor_checksum_method_encodetask_frames_done(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_ENCODETASK_IS_CANCELLED
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_ENCODETASK_IS_CANCELLED
+uint16_t uniffi_rgb2gif_processor_checksum_method_encodetask_is_cancelled(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_ENCODETASK_SET_LISTENER
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_ENCODETASK_SET_LISTENER
+uint16_t uniffi_rgb2gif_processor_checksum_method_encodetask_set_listener(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_FRAMEPIPELINE_FINISH
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_FRAMEPIPELINE_FINISH
+uint16_t uniffi_rgb2gif_processor_checksum_method_framepipeline_finish(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_FRAMEPIPELINE_FRAMES_SUBMITTED
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_FRAMEPIPELINE_FRAMES_SUBMITTED
+uint16_t uniffi_rgb2gif_processor_checksum_method_framepipeline_frames_submitted(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_FRAMEPIPELINE_SUBMIT_FRAME
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_FRAMEPIPELINE_SUBMIT_FRAME
+uint16_t uniffi_rgb2gif_processor_checksum_method_framepipeline_submit_frame(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_CONSTRUCTOR_ENCODETASK_NEW
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_CONSTRUCTOR_ENCODETASK_NEW
+uint16_t uniffi_rgb2gif_processor_checksum_constructor_encodetask_new(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_CONSTRUCTOR_FRAMEPIPELINE_NEW
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_CONSTRUCTOR_FRAMEPIPELINE_NEW
+uint16_t uniffi_rgb2gif_processor_checksum_constructor_framepipeline_new(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_PROGRESSLISTENER_ON_PROGRESS
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_PROGRESSLISTENER_ON_PROGRESS
+uint16_t uniffi_rgb2gif_processor_checksum_method_progresslistener_on_progress(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_SIGNPOSTLISTENER_ON_INTERVAL_BEGIN
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_SIGNPOSTLISTENER_ON_INTERVAL_BEGIN
+uint16_t uniffi_rgb2gif_processor_checksum_method_signpostlistener_on_interval_begin(void
+    
+);
+#endif
+#ifndef UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_SIGNPOSTLISTENER_ON_INTERVAL_END
+#define UNIFFI_FFIDEF_UNIFFI_RGB2GIF_PROCESSOR_CHECKSUM_METHOD_SIGNPOSTLISTENER_ON_INTERVAL_END
+uint16_t uniffi_rgb2gif_processor_checksum_method_signpostlistener_on_interval_end(void
+    
 );
 #endif
 #ifndef UNIFFI_FFIDEF_FFI_RGB2GIF_PROCESSOR_UNIFFI_CONTRACT_VERSION
@@ -25,6 +25,12 @@ struct YinGifProcessor *yingif_processor_new(void);
  */
 void yingif_processor_free(struct YinGifProcessor *processor);
 
+/**
+ * Peak bytes reserved by the processor's scratch pool (0 for unknown handles)
+ * Buffers are sized on first use and reused across frames
+ */
+uint64_t yingif_processor_scratch_high_water(struct YinGifProcessor *processor);
+
 /**
  * Process a BGRA frame: downsize and quantize colors
  * Returns 0 on success, negative error code on failure
@@ -38,6 +44,21 @@ int32_t yingif_process_frame(struct YinGifProcessor *processor,
                              uint8_t *out_indices,
                              uint32_t *out_palette);
 
+/**
+ * Process a BGRA frame with a per-call resize filter
+ * (0 = Lanczos3, 1 = area average; area only downsamples)
+ * Returns 0 on success, negative error code on failure
+ */
+int32_t yingif_process_frame_ex(struct YinGifProcessor *processor,
+                                const uint8_t *bgra_data,
+                                int32_t width,
+                                int32_t height,
+                                int32_t target_size,
+                                int32_t palette_size,
+                                uint8_t *out_indices,
+                                uint32_t *out_palette,
+                                int32_t filter);
+
 /**
  * Create a GIF89a from indexed cube tensor data
  * Returns the size of the created GIF, or negative error code
@@ -368,9 +368,9 @@ final class RustFFITests: XCTestCase {
 
         // 3. Create GIF
         print("  3. Encoding to GIF89a...")
-        let gifBufferSize = 10_000_000 // 10MB buffer
+        let gifBufferSize = yx_gif_max_size(Int32(frameCount), Int32(targetSize))
         var gifData = [UInt8](repeating: 0, count: gifBufferSize)
-        var gifSize = 0
+        var gifSize = gifBufferSize
 
         let encodeResult = yx_gif_encode(
             indices,
@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Compare two run_native_benchmarks.sh result directories by median time
+# Exits 1 if any case slowed down by more than THRESHOLD percent (default 10)
+#
+# Usage: Scripts/compare_benchmarks.sh <baseline dir> <candidate dir>
+
+set -e
+
+if [ $# -ne 2 ]; then
+    echo "usage: $0 <baseline dir> <candidate dir>"
+    exit 2
+fi
+
+THRESHOLD="${THRESHOLD:-10}"
+
+python3 - "$1" "$2" "$THRESHOLD" <<'PY'
+import json, os, sys
+
+baseline_dir, candidate_dir, threshold = sys.argv[1], sys.argv[2], float(sys.argv[3])
+
+# Timing and size fields; everything else in a result identifies the case
+MEASURED = {"iterations", "min_ms", "median_ms", "mean_ms", "bytes", "raw_bytes", "stages_ms", "bytes_allocated"}
+
+def load(directory, suite):
+    with open(os.path.join(directory, suite)) as f:
+        results = json.load(f)["results"]
+    return {tuple(sorted((k, str(v)) for k, v in r.items() if k not in MEASURED)): r for r in results}
+
+regressions = 0
+for suite in sorted(os.listdir(candidate_dir)):
+    if not suite.endswith(".json") or not os.path.exists(os.path.join(baseline_dir, suite)):
+        continue
+    baseline, candidate = load(baseline_dir, suite), load(candidate_dir, suite)
+    print(f"{suite}:")
+    for key, result in candidate.items():
+        if key not in baseline:
+            continue
+        before, after = baseline[key]["median_ms"], result["median_ms"]
+        change = (after - before) * 100.0 / before if before > 0 else 0.0
+        marker = "❌" if change > threshold else "  "
+        regressions += change > threshold
+        label = " ".join(v for _, v in key)
+        print(f"  {marker} {label:<56} {before:>10.2f} → {after:>10.2f} ms  {change:+6.1f}%")
+
+if regressions:
+    print(f"\n❌ {regressions} case(s) slower by more than {threshold:.0f}%")
+    sys.exit(1)
+print("\n✅ No regressions")
+PY
@@ -0,0 +1,64 @@
+#!/bin/bash
+
+# Native benchmark suite: C ABI driver, Rust pipeline and YXV container
+# Writes one JSON file per suite to benchmark_results/native/<revision>/
+#
+# Usage: Scripts/run_native_benchmarks.sh [--quick]
+# Compare two runs with Scripts/compare_benchmarks.sh <baseline dir> <candidate dir>
+
+set -e
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+
+QUICK=""
+if [ "$1" == "--quick" ]; then
+    QUICK="--quick"
+fi
+
+export BENCH_REVISION="$(git -C "$PROJECT_DIR" rev-parse --short HEAD 2>/dev/null || echo unknown)"
+OUTPUT_DIR="$PROJECT_DIR/benchmark_results/native/$BENCH_REVISION"
+mkdir -p "$OUTPUT_DIR"
+
+echo "🚀 Native benchmarks for $BENCH_REVISION"
+echo "======================================"
+
+# Release builds of the native libraries: yx_* come from rust-core, the
+# per-frame yingif_* path from rust-ios-ffi, frame storage from zig-core
+echo "🔨 Building libraries..."
+(cd "$PROJECT_DIR/rust-core" && cargo build --release)
+(cd "$PROJECT_DIR/rust-ios-ffi" && cargo build --release)
+(cd "$PROJECT_DIR/zig-core" && zig build -Doptimize=ReleaseFast)
+
+RUST_LIB="${RUST_LIB:-$PROJECT_DIR/rust-core/target/release/librgb2gif_processor.a}"
+ZIG_LIB="${ZIG_LIB:-$PROJECT_DIR/zig-core/zig-out/lib/libyxcbor.a}"
+IOS_LIB_DIR="${IOS_LIB_DIR:-$PROJECT_DIR/rust-ios-ffi/target/release}"
+
+# rust-ios-ffi goes in as its shared library: two Rust static libraries in one
+# binary both carry the standard library and collide at link time
+if [ "$(uname)" == "Darwin" ]; then
+    IOS_LIB="$IOS_LIB_DIR/libyingif.dylib"
+    SYSTEM_LIBS="-framework CoreFoundation -framework Security -framework SystemConfiguration"
+else
+    IOS_LIB="$IOS_LIB_DIR/libyingif.so"
+    SYSTEM_LIBS="-lpthread -ldl -lm"
+fi
+
+# C ABI driver, run from tests/ so the gradient fixture resolves
+echo ""
+echo "📊 C ABI..."
+${CC:-clang} -O2 -o "$OUTPUT_DIR/bench_pipeline" "$PROJECT_DIR/tests/bench_pipeline.c" \
+    "$ZIG_LIB" "$RUST_LIB" "$IOS_LIB" -Wl,-rpath,"$IOS_LIB_DIR" $SYSTEM_LIBS
+(cd "$PROJECT_DIR/tests" && "$OUTPUT_DIR/bench_pipeline" $QUICK --json "$OUTPUT_DIR/c_abi.json")
+rm -f "$OUTPUT_DIR/bench_pipeline"
+
+echo ""
+echo "📊 Rust pipeline..."
+(cd "$PROJECT_DIR/rust-core" && cargo bench --features bench --bench pipeline -- $QUICK --json "$OUTPUT_DIR/rust_pipeline.json")
+
+echo ""
+echo "📊 YXV container..."
+(cd "$PROJECT_DIR/yinvxl-rs" && cargo bench --bench yxv_io -- $QUICK --json "$OUTPUT_DIR/yxv_io.json")
+
+echo ""
+echo "✅ Results in $OUTPUT_DIR"
@@ -9,6 +9,10 @@
 extern "C" {
 #endif
 
+// Resize filters for the *_ex entry points
+#define YX_RESIZE_LANCZOS3 0  // Lanczos3 (default, highest quality)
+#define YX_RESIZE_AREA     1  // Area average, SIMD box filter (fast)
+
 // Process batch of RGBA frames: downsample and quantize
 // Returns 0 on success, negative error codes on failure
 int32_t yx_proc_batch_rgba8(
@@ -22,8 +26,58 @@ int32_t yx_proc_batch_rgba8(
     uint32_t* out_palettes          // Output: N * 256 palette entries
 );
 
-// Encode indexed frames to GIF89a
+// Process batch of RGBA frames across worker threads
+// Same outputs as yx_proc_batch_rgba8; frames are processed concurrently
 // Returns 0 on success, negative error codes on failure
+int32_t yx_proc_batch_rgba8_parallel(
+    const uint8_t* const* frames,  // Array of N pointers to RGBA frames
+    int32_t n,                      // Number of frames
+    int32_t width,                  // Input frame width
+    int32_t height,                 // Input frame height
+    int32_t target_side,            // Output size (e.g., 256)
+    int32_t palette_size,           // Palette size (max 256)
+    uint8_t* out_indices,           // Output: N * target_side * target_side
+    uint32_t* out_palettes,         // Output: N * 256 palette entries
+    int32_t num_threads             // Worker threads, <= 0 for all cores
+);
+
+// Parallel batch processing with a per-call resize filter
+// YX_RESIZE_AREA only downsamples; larger targets fall back to Lanczos3
+// Returns 0 on success, negative error codes on failure
+int32_t yx_proc_batch_rgba8_ex(
+    const uint8_t* const* frames,  // Array of N pointers to RGBA frames
+    int32_t n,                      // Number of frames
+    int32_t width,                  // Input frame width
+    int32_t height,                 // Input frame height
+    int32_t target_side,            // Output size (e.g., 256)
+    int32_t palette_size,           // Palette size (max 256)
+    uint8_t* out_indices,           // Output: N * target_side * target_side
+    uint32_t* out_palettes,         // Output: N * 256 palette entries
+    int32_t filter,                 // YX_RESIZE_*
+    int32_t num_threads             // Worker threads, <= 0 for all cores
+);
+
+// Batch processing that reuses palettes across steady shots
+// A frame is retrained once its color histogram moves reuse_threshold (0-1) from
+// the frame its palette came from; 0 retrains every frame, like yx_proc_batch_rgba8_ex
+// Returns 0 on success, negative error codes on failure
+int32_t yx_proc_batch_rgba8_temporal(
+    const uint8_t* const* frames,  // Array of N pointers to RGBA frames
+    int32_t n,                      // Number of frames
+    int32_t width,                  // Input frame width
+    int32_t height,                 // Input frame height
+    int32_t target_side,            // Output size (e.g., 256)
+    int32_t palette_size,           // Palette size (max 256)
+    uint8_t* out_indices,           // Output: N * target_side * target_side
+    uint32_t* out_palettes,         // Output: N * 256 palette entries
+    int32_t filter,                 // YX_RESIZE_*
+    int32_t num_threads,            // Worker threads, <= 0 for all cores
+    float reuse_threshold           // Retrain threshold, e.g. 0.1
+);
+
+// Encode indexed frames to GIF89a, straight into out_buf
+// A buffer of yx_gif_max_size(n, side) bytes always fits
+// Returns 0 on success, negative error codes on failure (-4: out_buf too small)
 int32_t yx_gif_encode(
     const uint8_t* indices,         // N * side * side indexed pixels
     const uint32_t* palettes,       // N * 256 palette entries (0x00RRGGBB)
@@ -34,6 +88,181 @@ int32_t yx_gif_encode(
     size_t* out_len                 // In: capacity, Out: bytes written
 );
 
+// Largest output of yx_gif_encode for n frames of side * side pixels; exact when
+// no frame compresses (every frame falls back to uncompressed codes). 0 on invalid arguments
+size_t yx_gif_max_size(int32_t n, int32_t side);
+
+// Caller-buffer GIF encoder: writes a clip held in memory into caller blocks
+typedef struct YxGifEncoder YxGifEncoder;
+
+// Returned by yx_gif_encoder_next when the block is full and more output follows
+#define YX_GIF_NEED_SPACE 1
+
+// Open an encoder over N * side * side indices and N * 256 palette entries;
+// both arrays must stay valid until yx_gif_encoder_free. Returns NULL on invalid arguments
+YxGifEncoder* yx_gif_encoder_open(
+    const uint8_t* indices,         // N * side * side indexed pixels
+    const uint32_t* palettes,       // N * 256 palette entries (0x00RRGGBB)
+    int32_t n,                      // Number of frames
+    int32_t side,                   // Width and height
+    int32_t delay_cs                // Delay in centiseconds
+);
+
+// Fill the next block; In: capacity, Out: bytes written to this block
+// Returns 0 when the GIF is complete, YX_GIF_NEED_SPACE to continue in a new block
+int32_t yx_gif_encoder_next(YxGifEncoder* encoder, uint8_t* block, size_t* block_len);
+
+// Free the encoder (complete or not)
+void yx_gif_encoder_free(YxGifEncoder* encoder);
+
+// Streaming GIF encoder: frames are LZW-encoded as they are pushed
+typedef struct YxGifStream YxGifStream;
+
+// Sink callback: receives each run of encoded bytes, returns 0 on success
+typedef int32_t (*YxGifWriteFn)(void* ctx, const uint8_t* data, size_t len);
+
+// Open an encoder; write == NULL buffers output for yx_gif_stream_drain
+// Returns NULL on invalid arguments
+YxGifStream* yx_gif_stream_open(
+    int32_t side,                   // Width and height
+    int32_t delay_cs,               // Delay in centiseconds
+    int32_t palette_size,           // Entries per frame palette (max 256)
+    YxGifWriteFn write,             // Sink callback or NULL
+    void* ctx                       // Passed through to write
+);
+
+// Encode one frame: side * side indices + palette_size entries (0x00RRGGBB)
+int32_t yx_gif_stream_push_frame(YxGifStream* stream, const uint8_t* indices, const uint32_t* palette);
+
+// Bytes buffered and ready to drain
+size_t yx_gif_stream_pending(YxGifStream* stream);
+
+// Copy buffered bytes out; In: capacity, Out: bytes copied (0 when empty)
+int32_t yx_gif_stream_drain(YxGifStream* stream, uint8_t* out_buf, size_t* out_len);
+
+// Write the trailer; remaining buffered bytes stay drainable
+int32_t yx_gif_stream_finish(YxGifStream* stream);
+
+// Free the encoder (finished or not)
+void yx_gif_stream_free(YxGifStream* stream);
+
+// GPU texture export: writes a volume straight into a 3D texture upload layout
+// (e.g. a shared MTLBuffer blitted into a private MTLTexture)
+#define YX_TEXTURE_RGBA8 0          // 4 bytes per voxel (RGBA8Unorm)
+#define YX_TEXTURE_R8_INDEX 1       // 1 byte per voxel (R8Uint) + 256 * palette_count RGBA8 palette texture
+#define YX_TEXTURE_MAX_LEVELS 16
+
+// One mip level: blit sourceOffset, sourceBytesPerRow, sourceBytesPerImage and size
+typedef struct {
+    size_t offset;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    size_t bytes_per_row;
+    size_t bytes_per_image;
+} YxTextureLevel;
+
+// Layout for width * height * depth with mip_levels levels (0 = full chain); rows and
+// level offsets padded to row_alignment (power of two, 1 = tight). out_levels holds
+// YX_TEXTURE_MAX_LEVELS entries or is NULL. Returns the level count, negative on error
+int32_t yx_texture_layout(
+    int32_t format,                 // YX_TEXTURE_*
+    int32_t width,
+    int32_t height,
+    int32_t depth,
+    int32_t mip_levels,
+    int32_t row_alignment,
+    YxTextureLevel* out_levels,
+    size_t* out_total_bytes         // Buffer size the volume needs
+);
+
+// Write an RGBA8 volume (e.g. the 128 * 128 * N tensor) and box-filtered mips
+// Returns 0 on success, -4 if out_len is below the layout's total, negative on error
+int32_t yx_texture_write_rgba(
+    const uint8_t* rgba,            // width * height * depth * 4, slices z-major
+    int32_t width,
+    int32_t height,
+    int32_t depth,
+    int32_t mip_levels,
+    int32_t row_alignment,
+    uint8_t* out,
+    size_t out_len
+);
+
+// Write an indexed volume (e.g. yx_proc_batch_rgba8 output) as format; R8 mips are
+// point sampled and the palette texture (1024-byte rows, row z for slice z or row 0
+// when shared) goes to out_palette if not NULL. Returns 0 on success, negative on error
+int32_t yx_texture_write_indexed(
+    const uint8_t* indices,         // width * height * depth, slices z-major
+    const uint32_t* palettes,       // palette_count * 256 entries (0x00RRGGBB)
+    int32_t palette_count,          // 1 (shared) or depth (one per slice)
+    int32_t width,
+    int32_t height,
+    int32_t depth,
+    int32_t format,                 // YX_TEXTURE_*
+    int32_t mip_levels,
+    int32_t row_alignment,
+    uint8_t* out,
+    size_t out_len,
+    uint8_t* out_palette            // Optional, YX_TEXTURE_R8_INDEX only
+);
+
+// Per-frame processor (rust-ios-ffi): a handle owns scratch buffers reused across frames
+typedef struct YinGifProcessor YinGifProcessor;
+
+// Create a processor; free it with yingif_processor_free
+YinGifProcessor* yingif_processor_new(void);
+
+// Free a processor instance
+void yingif_processor_free(YinGifProcessor* processor);
+
+// Peak bytes reserved by the processor's scratch pool (0 for unknown handles)
+// Buffers are sized on first use and reused across frames
+uint64_t yingif_processor_scratch_high_water(YinGifProcessor* processor);
+
+// Downsize and quantize one BGRA frame (Lanczos3)
+// Returns 0 on success, negative error code on failure
+int32_t yingif_process_frame(
+    YinGifProcessor* processor,
+    const uint8_t* bgra_data,       // width * height BGRA pixels
+    int32_t width,
+    int32_t height,
+    int32_t target_size,            // Output side (e.g., 132)
+    int32_t palette_size,           // Palette size (max 256)
+    uint8_t* out_indices,           // Output: target_size * target_size
+    uint32_t* out_palette           // Output: palette_size entries (0x00RRGGBB)
+);
+
+// yingif_process_frame with a per-call resize filter
+// YX_RESIZE_AREA only downsamples; larger targets fall back to Lanczos3
+int32_t yingif_process_frame_ex(
+    YinGifProcessor* processor,
+    const uint8_t* bgra_data,       // width * height BGRA pixels
+    int32_t width,
+    int32_t height,
+    int32_t target_size,            // Output side (e.g., 132)
+    int32_t palette_size,           // Palette size (max 256)
+    uint8_t* out_indices,           // Output: target_size * target_size
+    uint32_t* out_palette,          // Output: palette_size entries (0x00RRGGBB)
+    int32_t filter                  // YX_RESIZE_*
+);
+
+// Create a GIF89a from indexed cube tensor data
+// Returns the size of the created GIF, or negative error code
+int32_t yingif_create_gif89a(
+    const uint8_t* indices,         // cube_size^3 indices, one slice per frame
+    const uint32_t* palette,        // palette_size entries (0x00RRGGBB)
+    int32_t cube_size,
+    int32_t palette_size,
+    int32_t delay_ms,
+    uint8_t* out_data,
+    int32_t out_capacity,
+    int32_t* out_size
+);
+
+// Estimated buffer size needed for yingif_create_gif89a
+int32_t yingif_estimate_gif_size(int32_t cube_size, int32_t palette_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -55,17 +55,119 @@ int32_t yxcbor_get_frame_path(
     uint32_t max_len
 );
 
+// ========== Handle-based streaming API ==========
+// Each handle owns its file and state, so several clips can be recorded and
+// replayed at once. Frames use positional I/O: write_frame, write_frame_at and
+// read_frame may be called concurrently on the same handle from any thread.
+
+typedef struct yxcbor_writer yxcbor_writer;
+typedef struct yxcbor_reader yxcbor_reader;
+
+// Open a writer; *out_writer is set on success, NULL on failure
+// Returns 0 on success, negative error code on failure
+int32_t yxcbor_writer_open(const char* dir_path, const yx_frame_manifest* manifest, yxcbor_writer** out_writer);
+
+// Append the next frame (concurrent callers each claim a distinct index)
+// Returns 0 on success, negative error code on failure
+int32_t yxcbor_writer_write_frame(yxcbor_writer* writer, const uint8_t* rgba_ptr, uint32_t len);
+
+// Write frame `index` directly, in any order, for fanning writes across workers
+// Returns 0 on success, negative error code on failure
+int32_t yxcbor_writer_write_frame_at(yxcbor_writer* writer, uint32_t index, const uint8_t* rgba_ptr, uint32_t len);
+
+// Number of frames fully written so far
+uint32_t yxcbor_writer_frames_written(yxcbor_writer* writer);
+
+// Close the writer and free the handle (no writes may be in flight)
+// Returns 0 on success
+int32_t yxcbor_writer_close(yxcbor_writer* writer);
+
+// Open a reader; *out_reader is set on success, NULL on failure
+// Returns 0 on success, negative error code on failure
+int32_t yxcbor_reader_open(const char* dir_path, yx_frame_manifest* out_manifest, yxcbor_reader** out_reader);
+
+// Open a reader over a read-only memory map of the store; the frame index is
+// built from the mapped headers and frames can then be borrowed in place
+// Returns 0 on success, negative error code on failure
+int32_t yxcbor_reader_open_mapped(const char* dir_path, yx_frame_manifest* out_manifest, yxcbor_reader** out_reader);
+
+// Read a specific frame by index
+// Returns 0 on success, negative error code on failure
+int32_t yxcbor_reader_read_frame(yxcbor_reader* reader, uint32_t index, uint8_t* out_rgba, uint32_t len);
+
+// Borrow frame `index` without copying: *out_ptr points into the mapped CBOR byte string
+// Valid until yxcbor_reader_close. Returns -4 for readers not opened with open_mapped
+int32_t yxcbor_reader_frame_ptr(yxcbor_reader* reader, uint32_t index, const uint8_t** out_ptr, uint32_t* out_len);
+
+// Close the reader and free the handle
+// Returns 0 on success
+int32_t yxcbor_reader_close(yxcbor_reader* reader);
+
+// ========== Write-behind writer ==========
+// submit queues a frame in a bounded ring and returns; a flusher thread writes
+// each run of consecutive queued frames with one pwritev and fsyncs per policy.
+
+#define YXCBOR_FSYNC_ON_CLOSE  0  // One fsync at close (and at flush)
+#define YXCBOR_FSYNC_PER_BATCH 1  // fsync after every coalesced write
+#define YXCBOR_FSYNC_PER_FRAME 2  // Write and fsync each frame on its own
+
+typedef struct yxcbor_async_writer yxcbor_async_writer;
+
+// Called on the flusher thread once frame `index` is written (status 0) or failed
+// (negative); the buffer at rgba_ptr may be recycled from then on
+typedef void (*yxcbor_complete_fn)(void* ctx, uint32_t index, const uint8_t* rgba_ptr, int32_t status);
+
+typedef struct {
+    uint32_t queue_depth;           // Frames in flight before submit blocks (1-256, 0 = 8)
+    uint32_t fsync_policy;          // YXCBOR_FSYNC_*
+    yxcbor_complete_fn on_complete; // May be NULL
+    void* ctx;
+    uint32_t copy_frames;           // Nonzero: copy into owned ring slots, buffers free on return
+} yxcbor_async_options;
+
+// Open a write-behind writer; options may be NULL for the defaults
+// Returns 0 on success, negative error code on failure
+int32_t yxcbor_async_writer_open(const char* dir_path, const yx_frame_manifest* manifest,
+                                 const yxcbor_async_options* options, yxcbor_async_writer** out_writer);
+
+// Queue the next frame, blocking while the ring is full (back-pressure)
+// Without copy_frames the buffer must stay valid until its completion callback
+// Returns 0 on success, negative error code on failure (including an earlier write error)
+int32_t yxcbor_async_writer_submit(yxcbor_async_writer* writer, const uint8_t* rgba_ptr, uint32_t len);
+
+// Non-blocking submit: returns -8 if the ring is full
+int32_t yxcbor_async_writer_try_submit(yxcbor_async_writer* writer, const uint8_t* rgba_ptr, uint32_t len);
+
+// Frames submitted but not yet completed
+uint32_t yxcbor_async_writer_pending(yxcbor_async_writer* writer);
+
+// Wait for every submitted frame, then fsync
+// Returns the first write error seen, or 0
+int32_t yxcbor_async_writer_flush(yxcbor_async_writer* writer);
+
+// Drain the ring, fsync, stop the flusher and free the handle
+// Returns the first write error seen, or 0
+int32_t yxcbor_async_writer_close(yxcbor_async_writer* writer);
+
 // ========== Streaming API ==========
+// Single process-wide writer and reader, kept for existing callers.
+// Thin wrappers over the handle API; not thread-safe.
 
 // Open writer for streaming frames to CBOR
 // Returns 0 on success, negative error code on failure
 int32_t yxcbor_open_writer(const char* dir_path, const yx_frame_manifest* manifest);
 
+// Open the stream writer in write-behind mode; frames are always copied into the
+// ring, so yxcbor_write_frame callers may reuse their buffer at once
+// options may be NULL. Returns 0 on success, negative error code on failure
+int32_t yxcbor_open_writer_async(const char* dir_path, const yx_frame_manifest* manifest,
+                                 const yxcbor_async_options* options);
+
 // Write a single frame (must call open_writer first)
 // Returns 0 on success, negative error code on failure
 int32_t yxcbor_write_frame(const uint8_t* rgba_ptr, uint32_t len);
 
-// Close writer and finalize CBOR files
+// Close writer and finalize CBOR files (drains and fsyncs a write-behind writer)
 // Returns 0 on success
 int32_t yxcbor_close_writer(void);
 
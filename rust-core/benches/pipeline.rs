@@ -0,0 +1,236 @@
+// End-to-end encode time: process_all_frames and FramePipeline over a
+// frame-count × size × palette-size matrix, with per-stage timings
+// Run with: cargo bench --features bench --bench pipeline -- [--quick] [--json out.json]
+//
+// Clips are the recorded gradient fixture (tests/test_data/gradient, cycled to
+// the frame count) and a synthetic camera-like clip; both are deterministic.
+
+use std::fmt::Write as _;
+use std::path::Path;
+use std::time::Instant;
+
+use rgb2gif_processor::{
+    process_all_frames, set_stats_enabled, FramePipeline, GifOpts, PipelineOpts, ProcessResult, QuantizeOpts,
+    TensorLayout,
+};
+
+const GRADIENT_SIDE: usize = 1080;
+const GRADIENT_FRAMES: usize = 10;
+
+fn xorshift(state: &mut u32) -> u32 {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    *state
+}
+
+/// Nearest resample of one square RGBA frame
+fn resample(src: &[u8], src_side: usize, side: usize) -> Vec<u8> {
+    let mut dst = vec![0u8; side * side * 4];
+    for (y, row) in dst.chunks_exact_mut(side * 4).enumerate() {
+        let src_row = &src[y * src_side / side * src_side * 4..];
+        for (x, px) in row.chunks_exact_mut(4).enumerate() {
+            let sx = x * src_side / side * 4;
+            px.copy_from_slice(&src_row[sx..sx + 4]);
+        }
+    }
+    dst
+}
+
+/// Gradient fixture at `side`, cycled to `count` frames; None if the fixture is missing
+fn gradient_clip(side: usize, count: usize) -> Option<Vec<u8>> {
+    let dir = Path::new(env!("CARGO_MANIFEST_DIR")).join("../tests/test_data/gradient/raw");
+    let frames = (0..GRADIENT_FRAMES)
+        .map(|i| {
+            let raw = std::fs::read(dir.join(format!("frame_{:03}.rgba", i))).ok()?;
+            (raw.len() == GRADIENT_SIDE * GRADIENT_SIDE * 4).then(|| resample(&raw, GRADIENT_SIDE, side))
+        })
+        .collect::<Option<Vec<_>>>()?;
+    Some((0..count).flat_map(|i| frames[i % GRADIENT_FRAMES].iter().copied()).collect())
+}
+
+/// Camera-like clip: slow pan over a lit backdrop, a subject crossing the frame,
+/// and sensor noise; mirrors the clip in tests/bench_pipeline.c
+fn camera_clip(side: usize, count: usize) -> Vec<u8> {
+    let mut seed = 0x9E37_79B9;
+    let mut clip = Vec::with_capacity(side * side * 4 * count);
+    let radius = (side / 6) as i32;
+    for index in 0..count {
+        let pan = index * side / 256;
+        let (cx, cy) = ((side / 4 + index * side / 96 % (side / 2)) as i32, (side / 2) as i32);
+        for y in 0..side {
+            for x in 0..side {
+                let (u, v) = (((x + pan) * 255 / side) as i32, (y * 255 / side) as i32);
+                let (dx, dy) = (x as i32 - cx, y as i32 - cy);
+                let (r, g, b) = if dx * dx + dy * dy < radius * radius {
+                    (200 - dy * 40 / radius, 140 - dy * 30 / radius, 110)
+                } else {
+                    (90 + u / 2, 110 + v / 3, 150 - v / 4)
+                };
+                let noise = (xorshift(&mut seed) & 15) as i32 - 8;
+                let unit = |c: i32| (c + noise).clamp(0, 255) as u8;
+                clip.extend_from_slice(&[unit(r), unit(g), unit(b), 255]);
+            }
+        }
+    }
+    clip
+}
+
+struct Case<'a> {
+    clip: &'static str,
+    frames: u32,
+    side: u32,
+    palette_size: u16,
+    rgba: &'a [u8],
+}
+
+fn quantize_opts(case: &Case, shared_palette: bool) -> QuantizeOpts {
+    QuantizeOpts {
+        quality_min: 70,
+        quality_max: 100,
+        speed: 8,
+        palette_size: case.palette_size,
+        dithering_level: 0.5,
+        shared_palette,
+        oklab_palette: false,
+        blue_noise_dither: false,
+    }
+}
+
+fn gif_opts(case: &Case) -> GifOpts {
+    GifOpts {
+        width: case.side as u16,
+        height: case.side as u16,
+        frame_count: case.frames as u16,
+        fps: 25,
+        loop_count: 0,
+        optimize: false,
+        include_tensor: true,
+        indexed_tensor: true,
+        tensor_layout: TensorLayout::FrameMajor,
+    }
+}
+
+/// Median of `iterations` runs after one warm-up, as one JSON object
+fn measure(name: &str, case: &Case, iterations: usize, mut run: impl FnMut() -> ProcessResult) -> String {
+    run();
+    let mut samples = Vec::with_capacity(iterations);
+    let mut last = None;
+    for _ in 0..iterations {
+        let start = Instant::now();
+        let result = run();
+        samples.push(start.elapsed().as_secs_f64() * 1000.0);
+        last = Some(result);
+    }
+    samples.sort_by(|a, b| a.partial_cmp(b).unwrap());
+    let result = last.unwrap();
+    let median = samples[samples.len() / 2];
+    let mean = samples.iter().sum::<f64>() / samples.len() as f64;
+
+    println!(
+        "{:<24} {:<8} {:>4} × {:>4}  p{:<3} {:>9.2} ms  {:>8.1} fps",
+        name,
+        case.clip,
+        case.frames,
+        case.side,
+        case.palette_size,
+        median,
+        case.frames as f64 * 1000.0 / median
+    );
+
+    let mut json = format!(
+        "{{\"name\": \"{}\", \"clip\": \"{}\", \"frames\": {}, \"side\": {}, \"palette_size\": {}, \
+         \"iterations\": {}, \"min_ms\": {:.3}, \"median_ms\": {:.3}, \"mean_ms\": {:.3}, \"bytes\": {}",
+        name, case.clip, case.frames, case.side, case.palette_size, iterations, samples[0], median, mean,
+        result.gif_data.len()
+    );
+    if let Some(stats) = &result.stats {
+        let _ = write!(
+            json,
+            ", \"stages_ms\": {{\"ingest\": {:.3}, \"resize\": {:.3}, \"palette\": {:.3}, \"remap\": {:.3}, \
+             \"lzw\": {:.3}, \"tensor\": {:.3}}}, \"bytes_allocated\": {}",
+            stats.ingest_ns as f64 / 1e6,
+            stats.resize_ns as f64 / 1e6,
+            stats.palette_ns as f64 / 1e6,
+            stats.remap_ns as f64 / 1e6,
+            stats.lzw_ns as f64 / 1e6,
+            stats.tensor_ns as f64 / 1e6,
+            stats.bytes_allocated
+        );
+    }
+    json.push('}');
+    json
+}
+
+fn main() {
+    // cargo passes --bench; anything else unknown is ignored the same way
+    let args: Vec<String> = std::env::args().collect();
+    let quick = args.iter().any(|a| a == "--quick");
+    let json_path = args.iter().position(|a| a == "--json").and_then(|i| args.get(i + 1));
+    let iterations = if quick { 2 } else { 5 };
+
+    let (frame_counts, sides, palettes): (&[u32], &[u32], &[u16]) = if quick {
+        (&[16], &[132], &[256])
+    } else {
+        (&[16, 64, 128], &[132, 256], &[64, 256])
+    };
+
+    set_stats_enabled(true);
+    let mut results = Vec::new();
+    for &side in sides {
+        for &frames in frame_counts {
+            let n = frames as usize;
+            let mut clips = vec![("camera", camera_clip(side as usize, n))];
+            match gradient_clip(side as usize, n) {
+                Some(gradient) => clips.insert(0, ("gradient", gradient)),
+                None => println!("gradient fixture not found, skipping it"),
+            }
+            // FramePipeline input: twice the output size, area-downsampled on the way in
+            let source = camera_clip(side as usize * 2, n);
+
+            for (clip, rgba) in &clips {
+                for &palette_size in palettes {
+                    let case = Case { clip: *clip, frames, side, palette_size, rgba };
+
+                    results.push(measure("process_all_frames", &case, iterations, || {
+                        process_all_frames(case.rgba.to_vec(), side, side, frames, quantize_opts(&case, true), gif_opts(&case))
+                            .unwrap()
+                    }));
+                    results.push(measure("process_all_frames_first", &case, iterations, || {
+                        process_all_frames(case.rgba.to_vec(), side, side, frames, quantize_opts(&case, false), gif_opts(&case))
+                            .unwrap()
+                    }));
+
+                    if *clip == "camera" {
+                        results.push(measure("frame_pipeline", &case, iterations, || {
+                            let pipeline_opts = PipelineOpts {
+                                source_width: side * 2,
+                                source_height: side * 2,
+                                queue_depth: 0,
+                                resize_workers: 0,
+                                encode_workers: 0,
+                            };
+                            let pipeline =
+                                FramePipeline::new(pipeline_opts, quantize_opts(&case, false), gif_opts(&case)).unwrap();
+                            for frame in source.chunks_exact(side as usize * side as usize * 16) {
+                                pipeline.submit_frame(frame.to_vec()).unwrap();
+                            }
+                            pipeline.finish().unwrap()
+                        }));
+                    }
+                }
+            }
+        }
+    }
+
+    if let Some(path) = json_path {
+        let json = format!(
+            "{{\n  \"suite\": \"rust_pipeline\",\n  \"revision\": \"{}\",\n  \"quick\": {},\n  \"results\": [\n    {}\n  ]\n}}\n",
+            std::env::var("BENCH_REVISION").unwrap_or_default(),
+            quick,
+            results.join(",\n    ")
+        );
+        std::fs::write(path, json).expect("write benchmark JSON");
+        println!("\nWrote {} results to {}", results.len(), path);
+    }
+}
@@ -0,0 +1,82 @@
+// Remap throughput: nearest-palette lookup over a 256-color palette
+// Run with: cargo bench --features bench --bench remap
+
+use std::hint::black_box;
+use std::time::Instant;
+
+use rgb2gif_processor::palette_lookup::PaletteIndex;
+
+const PIXELS: usize = 4 * 1024 * 1024; // ~one 128-frame 181×181 clip
+const PALETTE_SIZE: usize = 256;
+
+fn xorshift(state: &mut u32) -> u32 {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    *state
+}
+
+/// Time `lookup` over every pixel and print megapixels per second
+fn report(name: &str, pixels: &[[f32; 3]], lookup: impl Fn([f32; 3]) -> usize) {
+    let start = Instant::now();
+    let mut checksum = 0usize;
+    for &p in pixels {
+        checksum = checksum.wrapping_add(lookup(black_box(p)));
+    }
+    let secs = start.elapsed().as_secs_f64();
+    black_box(checksum);
+    println!(
+        "{:<20} {:>8.1} ms  {:>8.1} Mpix/s",
+        name,
+        secs * 1000.0,
+        pixels.len() as f64 / secs / 1e6
+    );
+}
+
+fn main() {
+    let mut seed = 0x9E37_79B9;
+
+    // sRGB byte space (blue noise remap)
+    let palette: Vec<[u8; 4]> = (0..PALETTE_SIZE)
+        .map(|_| {
+            let v = xorshift(&mut seed);
+            [v as u8, (v >> 8) as u8, (v >> 16) as u8, 255]
+        })
+        .collect();
+    let pixels: Vec<[f32; 3]> = (0..PIXELS)
+        .map(|_| {
+            let v = xorshift(&mut seed);
+            [v as u8 as f32, (v >> 8) as u8 as f32, (v >> 16) as u8 as f32]
+        })
+        .collect();
+
+    let build = Instant::now();
+    let index = PaletteIndex::from_rgba(&palette);
+    println!(
+        "rgb index build: {:.2} ms, {:.1} candidates/cell",
+        build.elapsed().as_secs_f64() * 1000.0,
+        index.mean_candidates()
+    );
+    report("rgb linear", &pixels, |p| index.nearest_linear(p));
+    report("rgb grid", &pixels, |p| index.nearest(p));
+
+    // OKLab-like space (map_to_palette, TemporalDither)
+    let unit = |v: u32| (v & 0xFFFF) as f32 / 65535.0;
+    let colors: Vec<[f32; 3]> = (0..PALETTE_SIZE)
+        .map(|_| {
+            let (a, b, c) = (xorshift(&mut seed), xorshift(&mut seed), xorshift(&mut seed));
+            [unit(a), unit(b) * 0.6 - 0.3, unit(c) * 0.6 - 0.3]
+        })
+        .collect();
+    let pixels: Vec<[f32; 3]> = (0..PIXELS)
+        .map(|_| {
+            let (a, b, c) = (xorshift(&mut seed), xorshift(&mut seed), xorshift(&mut seed));
+            [unit(a), unit(b) * 0.6 - 0.3, unit(c) * 0.6 - 0.3]
+        })
+        .collect();
+
+    let index = PaletteIndex::new(&colors, [0.0, -0.4, -0.4], [1.0, 0.4, 0.4]);
+    println!("oklab index: {:.1} candidates/cell", index.mean_candidates());
+    report("oklab linear", &pixels, |p| index.nearest_linear(p));
+    report("oklab grid", &pixels, |p| index.nearest(p));
+}
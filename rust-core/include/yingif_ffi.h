@@ -10,11 +10,66 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/**
+ * Resize filter: Lanczos3 (default, highest quality)
+ */
+#define YX_RESIZE_LANCZOS3 0
+
+/**
+ * Resize filter: area average, SIMD box filter for large reduction ratios
+ */
+#define YX_RESIZE_AREA 1
+
+/**
+ * Status of yx_gif_encoder_next: the block is full and more output follows
+ */
+#define YX_GIF_NEED_SPACE 1
+
+/**
+ * Volume formats for yx_texture_*
+ */
+#define YX_TEXTURE_RGBA8 0
+
+#define YX_TEXTURE_R8_INDEX 1
+
+/**
+ * Most levels a mip chain can have (65535 on the longest side)
+ */
+#define YX_TEXTURE_MAX_LEVELS 16
+
 /**
  * Opaque processor struct
  */
 typedef struct YinGifProcessor YinGifProcessor;
 
+/**
+ * Opaque streaming encoder handle
+ */
+typedef struct YxGifStream YxGifStream;
+
+/**
+ * Opaque caller-buffer encoder handle
+ */
+typedef struct YxGifEncoder YxGifEncoder;
+
+/**
+ * Caller-supplied sink: called with each run of encoded bytes, returns 0 on success
+ */
+typedef int (*YxGifWriteFn)(void *ctx, const unsigned char *data, uintptr_t len);
+
+/**
+ * One mip level's place in the upload buffer, in the terms of
+ * MTLBlitCommandEncoder copy(from:sourceOffset:sourceBytesPerRow:sourceBytesPerImage:...)
+ */
+typedef struct YxTextureLevel {
+  uintptr_t offset;
+  uint32_t width;
+  uint32_t height;
+  uint32_t depth;
+  uintptr_t bytes_per_row;
+  uintptr_t bytes_per_image;
+} YxTextureLevel;
+
 /**
  * Create a new processor instance
  */
@@ -25,6 +80,12 @@ struct YinGifProcessor *yingif_processor_new(void);
  */
 void yingif_processor_free(struct YinGifProcessor *processor);
 
+/**
+ * Peak bytes reserved by the processor's scratch pool (0 for unknown handles)
+ * Buffers are sized on first use and reused across frames
+ */
+uint64_t yingif_processor_scratch_high_water(struct YinGifProcessor *processor);
+
 /**
  * Process a BGRA frame: downsize and quantize colors
  * Returns 0 on success, negative error code on failure
@@ -38,6 +99,20 @@ int32_t yingif_process_frame(struct YinGifProcessor *processor,
                              uint8_t *out_indices,
                              uint32_t *out_palette);
 
+/**
+ * Process a BGRA frame with a per-call resize filter (YX_RESIZE_*)
+ * Returns 0 on success, negative error code on failure
+ */
+int32_t yingif_process_frame_ex(struct YinGifProcessor *processor,
+                                const uint8_t *bgra_data,
+                                int32_t width,
+                                int32_t height,
+                                int32_t target_size,
+                                int32_t palette_size,
+                                uint8_t *out_indices,
+                                uint32_t *out_palette,
+                                int32_t filter);
+
 /**
  * Create a GIF89a from indexed cube tensor data
  * Returns the size of the created GIF, or negative error code
@@ -70,9 +145,59 @@ int yx_proc_batch_rgba8(const unsigned char *const *frames,
                         uint32_t *out_palettes);
 
 /**
- * Encode indexed frames to GIF89a
+ * Process batch of RGBA frames across worker threads
+ * Same outputs as yx_proc_batch_rgba8; num_threads <= 0 uses all cores
+ * Returns 0 on success, negative error codes on failure
+ */
+int yx_proc_batch_rgba8_parallel(const unsigned char *const *frames,
+                                 int n,
+                                 int width,
+                                 int height,
+                                 int target_side,
+                                 int palette_size,
+                                 unsigned char *out_indices,
+                                 uint32_t *out_palettes,
+                                 int num_threads);
+
+/**
+ * Parallel batch processing with a per-call resize filter (YX_RESIZE_*)
+ * YX_RESIZE_AREA only downsamples; larger targets fall back to Lanczos3
+ * Returns 0 on success, negative error codes on failure
+ */
+int yx_proc_batch_rgba8_ex(const unsigned char *const *frames,
+                           int n,
+                           int width,
+                           int height,
+                           int target_side,
+                           int palette_size,
+                           unsigned char *out_indices,
+                           uint32_t *out_palettes,
+                           int filter,
+                           int num_threads);
+
+/**
+ * Batch processing that reuses palettes across steady shots
+ * A frame is retrained once its color histogram moves reuse_threshold (0-1) from
+ * the frame its palette came from; 0 retrains every frame, like yx_proc_batch_rgba8_ex
  * Returns 0 on success, negative error codes on failure
  */
+int yx_proc_batch_rgba8_temporal(const unsigned char *const *frames,
+                                 int n,
+                                 int width,
+                                 int height,
+                                 int target_side,
+                                 int palette_size,
+                                 unsigned char *out_indices,
+                                 uint32_t *out_palettes,
+                                 int filter,
+                                 int num_threads,
+                                 float reuse_threshold);
+
+/**
+ * Encode indexed frames to GIF89a
+ * Encodes straight into `out_buf`; a buffer of yx_gif_max_size bytes always fits.
+ * Returns 0 on success, negative error codes on failure (-4 as soon as `out_buf` is full)
+ */
 int yx_gif_encode(const unsigned char *indices,
                   const uint32_t *palettes,
                   int n,
@@ -81,4 +206,129 @@ int yx_gif_encode(const unsigned char *indices,
                   unsigned char *out_buf,
                   uintptr_t *out_len);
 
+/**
+ * Largest GIF yx_gif_encode can produce for `n` frames of side^2
+ * pixels (256-entry palettes; smaller streamed palettes only shrink it).
+ * Exact when every frame takes the uncompressed fallback. 0 on invalid arguments
+ */
+uintptr_t yx_gif_max_size(int n, int side);
+
+/**
+ * Open a streaming GIF encoder for side x side frames
+ * `write` may be NULL to buffer output internally (drain with yx_gif_stream_drain);
+ * otherwise encoded bytes are passed to `write(ctx, data, len)` as they are produced.
+ * Returns NULL on invalid arguments
+ */
+struct YxGifStream *yx_gif_stream_open(int side,
+                                       int delay_cs,
+                                       int palette_size,
+                                       YxGifWriteFn write,
+                                       void *ctx);
+
+/**
+ * Encode one frame: side^2 indices plus its palette_size palette entries (0x00RRGGBB)
+ * Returns 0 on success, negative on error
+ */
+int yx_gif_stream_push_frame(struct YxGifStream *stream,
+                             const unsigned char *indices,
+                             const uint32_t *palette);
+
+/**
+ * Bytes buffered and ready to drain (internal-buffer sinks only)
+ */
+uintptr_t yx_gif_stream_pending(struct YxGifStream *stream);
+
+/**
+ * Copy buffered output into `out_buf`
+ * In: *out_len = capacity, Out: bytes copied. Call repeatedly until it reports 0.
+ * Returns 0 on success, negative on error
+ */
+int yx_gif_stream_drain(struct YxGifStream *stream, unsigned char *out_buf, uintptr_t *out_len);
+
+/**
+ * Write the GIF trailer. Remaining buffered bytes stay drainable.
+ * Returns 0 on success, negative on error
+ */
+int yx_gif_stream_finish(struct YxGifStream *stream);
+
+/**
+ * Free a streaming encoder (finished or not)
+ */
+void yx_gif_stream_free(struct YxGifStream *stream);
+
+/**
+ * Start encoding `n` frames of side^2 indices with 256-entry palettes
+ * (0x00RRGGBB) into caller blocks. Both arrays must stay valid until
+ * yx_gif_encoder_free. Returns NULL on invalid arguments
+ */
+struct YxGifEncoder *yx_gif_encoder_open(const unsigned char *indices,
+                                         const uint32_t *palettes,
+                                         int n,
+                                         int side,
+                                         int delay_cs);
+
+/**
+ * Write the next part of the GIF into `block`
+ * In: *block_len = capacity, Out: bytes written to this block.
+ * Returns 0 once the GIF is complete, YX_GIF_NEED_SPACE when the block is full
+ * (call again with the next block; nothing is lost), negative on error
+ */
+int yx_gif_encoder_next(struct YxGifEncoder *encoder, unsigned char *block, uintptr_t *block_len);
+
+/**
+ * Free a caller-buffer encoder (complete or not)
+ */
+void yx_gif_encoder_free(struct YxGifEncoder *encoder);
+
+/**
+ * Upload layout of a width × height × depth volume with `mip_levels` levels
+ * (0 = full chain). Rows and level offsets are padded to `row_alignment` bytes,
+ * a power of two (1 = tight). `out_levels` has room for YX_TEXTURE_MAX_LEVELS
+ * entries and may be NULL. Returns the level count, negative on error
+ */
+int yx_texture_layout(int format,
+                      int width,
+                      int height,
+                      int depth,
+                      int mip_levels,
+                      int row_alignment,
+                      struct YxTextureLevel *out_levels,
+                      uintptr_t *out_total_bytes);
+
+/**
+ * Write an RGBA8 volume (e.g. the tensor: 128×128×frames) and its box-filtered
+ * mip chain into `out` at yx_texture_layout's offsets; `out` can be the
+ * contents of a shared MTLBuffer. Returns 0 on success, negative on error
+ * (-4 when `out_len` is below the layout's total)
+ */
+int yx_texture_write_rgba(const unsigned char *rgba,
+                          int width,
+                          int height,
+                          int depth,
+                          int mip_levels,
+                          int row_alignment,
+                          unsigned char *out,
+                          uintptr_t out_len);
+
+/**
+ * Write an indexed volume (e.g. yx_proc_batch_rgba8 output: side×side×frames
+ * with a palette per frame) as `format`. YX_TEXTURE_RGBA8 resolves colors and
+ * box filters the mips; YX_TEXTURE_R8_INDEX keeps the indices, point samples
+ * the mips and, if `out_palette` is not NULL, writes the palette texture
+ * there (256 × palette_count RGBA8, 1024-byte rows; slice z uses row z, or
+ * row 0 when palette_count is 1). Returns 0 on success, negative on error
+ */
+int yx_texture_write_indexed(const unsigned char *indices,
+                             const uint32_t *palettes,
+                             int palette_count,
+                             int width,
+                             int height,
+                             int depth,
+                             int format,
+                             int mip_levels,
+                             int row_alignment,
+                             unsigned char *out,
+                             uintptr_t out_len,
+                             unsigned char *out_palette);
+
 #endif  /* YINGIF_FFI_H */
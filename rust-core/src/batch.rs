@@ -0,0 +1,246 @@
+// Batch transcoding: many stored clips through one shared worker pool
+//
+// Reprocessing an archive one process_all_frames call at a time leaves cores
+// idle while each clip loads and through every serial stretch of an encode
+// (first-frame palette, GIF framing). Here every clip is a task on one rayon
+// pool and its frames are tasks inside it, so idle workers steal frames from
+// whichever clips have them. The caller's thread loads the next clips while the
+// pool encodes, and hands finished clips' buffers back to the loaders.
+
+use std::collections::HashMap;
+use std::sync::mpsc;
+use std::sync::Arc;
+use std::time::Instant;
+
+use imagequant::RGBA;
+
+use crate::stats::Recorder;
+use crate::{
+    process_frames, process_with_imagequant, quantizer_attributes, sampled_palette, GifOpts, ProcessResult,
+    ProcessorError, QuantizeOpts, Result,
+};
+
+/// Clips held decoded at once (encoding or waiting for a worker) by default
+const DEFAULT_CLIPS_IN_FLIGHT: usize = 4;
+
+/// A loaded clip: frame_count frames of width × height RGBA
+pub struct Clip {
+    pub rgba: Vec<u8>,
+    pub width: u32,
+    pub height: u32,
+    pub frame_count: u32,
+    pub source_bytes: u64,       // Bytes read from storage, for throughput (0 if unknown)
+}
+
+/// Reads one clip. `buffer` is an emptied buffer from a finished clip: filling
+/// it instead of a fresh Vec reuses that allocation across the batch.
+pub type ClipLoader = Box<dyn FnOnce(Vec<u8>) -> Result<Clip> + Send>;
+
+/// One entry of the batch
+pub struct ClipJob {
+    pub name: String,
+    pub load: ClipLoader,
+    pub quantize_opts: QuantizeOpts,
+    pub gif_opts: GifOpts,               // width, height and frame_count come from the loaded clip
+    pub palette_key: Option<String>,     // Clips with the same key reuse the first one's palette (always imagequant)
+}
+
+/// Batch options
+#[derive(Debug, Clone, Default)]
+pub struct BatchOpts {
+    pub workers: u32,            // Pool threads shared by every clip, 0 = all cores
+    pub clips_in_flight: u32,    // Decoded clips held at once before loading blocks, 0 = 4
+}
+
+/// What became of one job, in completion order
+pub struct ClipOutcome {
+    pub index: usize,            // Position in the job list
+    pub name: String,
+    pub result: Result<ProcessResult>,
+    pub source_bytes: u64,
+    pub load_ms: f32,            // Time spent reading the clip on the loading thread
+}
+
+/// Aggregate throughput of a batch
+#[derive(Debug, Clone, Default)]
+pub struct BatchReport {
+    pub clips: u32,
+    pub failed: u32,
+    pub frames: u64,
+    pub source_bytes: u64,       // Read from storage
+    pub decoded_bytes: u64,      // RGBA handed to the encoder
+    pub output_bytes: u64,       // GIF bytes produced
+    pub elapsed_ms: f64,
+}
+
+impl BatchReport {
+    pub fn clips_per_sec(&self) -> f64 {
+        self.clips as f64 * 1000.0 / self.elapsed_ms.max(1e-3)
+    }
+
+    /// Storage read rate in MB/s (decoded RGBA rate when sources report no size)
+    pub fn mb_per_sec(&self) -> f64 {
+        let bytes = if self.source_bytes > 0 { self.source_bytes } else { self.decoded_bytes };
+        bytes as f64 / 1e3 / self.elapsed_ms.max(1e-3)
+    }
+}
+
+/// Transcode every job on one shared pool, calling `on_clip` on this thread as
+/// each finishes
+///
+/// Jobs load in list order on the calling thread, up to clips_in_flight ahead
+/// of the slowest unfinished clip. The first clip loaded for a palette key
+/// has its palette built from a sample of its frames (as with shared_palette)
+/// before it is queued. Every later clip with that key remaps against
+/// that palette without building its own. A failed load or encode is reported
+/// through its outcome and the batch carries on.
+pub fn transcode_batch(
+    jobs: Vec<ClipJob>,
+    opts: &BatchOpts,
+    mut on_clip: impl FnMut(ClipOutcome),
+) -> Result<BatchReport> {
+    let workers = match opts.workers {
+        0 => std::thread::available_parallelism().map_or(1, |n| n.get()),
+        n => n as usize,
+    };
+    let clips_in_flight = match opts.clips_in_flight {
+        0 => DEFAULT_CLIPS_IN_FLIGHT,
+        n => n as usize,
+    };
+    let pool = rayon::ThreadPoolBuilder::new()
+        .num_threads(workers)
+        .thread_name(|i| format!("yingif-batch-{}", i))
+        .build()
+        .map_err(|_| ProcessorError::MemoryError)?;
+
+    let start = Instant::now();
+    let mut report = BatchReport::default();
+    let mut palettes: HashMap<String, Arc<Vec<RGBA>>> = HashMap::new();
+    let mut spare_buffers: Vec<Vec<u8>> = Vec::new();
+    let (done_tx, done_rx) = mpsc::channel::<(ClipOutcome, Vec<u8>)>();
+    let mut in_flight = 0;
+    let mut decoded_bytes = 0;
+
+    let mut finish = |(outcome, buffer): (ClipOutcome, Vec<u8>), spare_buffers: &mut Vec<Vec<u8>>| {
+        report.clips += 1;
+        report.source_bytes += outcome.source_bytes;
+        match &outcome.result {
+            Ok(result) => {
+                report.frames += result.actual_frame_count as u64;
+                report.output_bytes += result.gif_data.len() as u64;
+            }
+            Err(_) => report.failed += 1,
+        }
+        if buffer.capacity() > 0 {
+            spare_buffers.push(buffer);
+        }
+        on_clip(outcome);
+    };
+
+    for (index, job) in jobs.into_iter().enumerate() {
+        while in_flight >= clips_in_flight {
+            finish(done_rx.recv().map_err(|_| ProcessorError::EncodingError)?, &mut spare_buffers);
+            in_flight -= 1;
+        }
+
+        let loaded = Instant::now();
+        let clip = (job.load)(spare_buffers.pop().unwrap_or_default()).and_then(validate_clip);
+        let load_ms = loaded.elapsed().as_secs_f32() * 1000.0;
+        let clip = match clip {
+            Ok(clip) => clip,
+            Err(err) => {
+                let outcome = ClipOutcome { index, name: job.name, result: Err(err), source_bytes: 0, load_ms };
+                finish((outcome, Vec::new()), &mut spare_buffers);
+                continue;
+            }
+        };
+        decoded_bytes += clip.rgba.len() as u64;
+
+        // Built here rather than on a worker so a key's palette exists exactly once,
+        // before any clip that needs it is queued
+        let palette = match &job.palette_key {
+            Some(key) => match palettes.get(key) {
+                Some(palette) => Some(palette.clone()),
+                None => match pool.install(|| clip_palette(&clip, &job.quantize_opts)) {
+                    Ok(palette) => {
+                        let palette = Arc::new(palette);
+                        palettes.insert(key.clone(), palette.clone());
+                        Some(palette)
+                    }
+                    Err(err) => {
+                        let outcome =
+                            ClipOutcome { index, name: job.name, result: Err(err), source_bytes: clip.source_bytes, load_ms };
+                        let mut buffer = clip.rgba;
+                        buffer.clear();
+                        finish((outcome, buffer), &mut spare_buffers);
+                        continue;
+                    }
+                },
+            },
+            None => None,
+        };
+
+        let done_tx = done_tx.clone();
+        pool.spawn(move || {
+            let result = encode_clip(&clip, job.quantize_opts, job.gif_opts, palette.as_deref().map(Vec::as_slice));
+            let outcome = ClipOutcome { index, name: job.name, result, source_bytes: clip.source_bytes, load_ms };
+            let mut buffer = clip.rgba;
+            buffer.clear();
+            let _ = done_tx.send((outcome, buffer));
+        });
+        in_flight += 1;
+    }
+
+    while in_flight > 0 {
+        finish(done_rx.recv().map_err(|_| ProcessorError::EncodingError)?, &mut spare_buffers);
+        in_flight -= 1;
+    }
+    drop(finish);
+
+    report.decoded_bytes = decoded_bytes;
+    report.elapsed_ms = start.elapsed().as_secs_f64() * 1000.0;
+    Ok(report)
+}
+
+fn validate_clip(clip: Clip) -> Result<Clip> {
+    let frame_bytes = clip.width as usize * clip.height as usize * 4;
+    if frame_bytes == 0
+        || clip.frame_count == 0
+        || clip.width > u16::MAX as u32
+        || clip.height > u16::MAX as u32
+        || clip.frame_count > u16::MAX as u32
+        || clip.rgba.len() != frame_bytes * clip.frame_count as usize
+    {
+        return Err(ProcessorError::InvalidInput);
+    }
+    Ok(clip)
+}
+
+fn clip_frames(clip: &Clip) -> Vec<&[u8]> {
+    clip.rgba.chunks_exact(clip.width as usize * clip.height as usize * 4).collect()
+}
+
+/// Palette shared by a key's clips, sampled from the first of them
+fn clip_palette(clip: &Clip, quantize_opts: &QuantizeOpts) -> Result<Vec<RGBA>> {
+    let attr = quantizer_attributes(quantize_opts)?;
+    sampled_palette(&attr, &clip_frames(clip), clip.width, clip.height, &Recorder::new())
+}
+
+fn encode_clip(
+    clip: &Clip,
+    quantize_opts: QuantizeOpts,
+    gif_opts: GifOpts,
+    palette: Option<&[RGBA]>,
+) -> Result<ProcessResult> {
+    let stats = Recorder::new();
+    let gif_opts = GifOpts {
+        width: clip.width as u16,
+        height: clip.height as u16,
+        frame_count: clip.frame_count as u16,
+        ..gif_opts
+    };
+    match palette {
+        Some(_) => process_with_imagequant(clip_frames(clip), clip.width, clip.height, quantize_opts, gif_opts, palette, None, &stats),
+        None => process_frames(clip_frames(clip), clip.width, clip.height, quantize_opts, gif_opts, None, &stats),
+    }
+}
@@ -1,10 +1,19 @@
 // batch_ffi.rs
 // Minimal batch processing FFI for architecture v2
 
+use std::borrow::Cow;
+use std::ffi::c_void;
+use std::io::{self, Write};
 use std::slice;
-use image::{imageops, RgbaImage};
+use std::sync::OnceLock;
+use image::{imageops, ImageBuffer, Rgba};
 use color_quant::NeuQuant;
 use gif::{Encoder, Frame, Repeat};
+use rayon::prelude::*;
+use crate::parallel::install_with_threads;
+use crate::downsample::{downsample_area, ResizeFilter};
+use crate::temporal::{keyframe_runs, ColorSignature};
+use crate::texture::{write_palette_texture, write_texture, TextureFormat, TextureLayout, TextureSource, PALETTE_ENTRIES};
 
 /// Process batch of RGBA frames - architecture v2 minimal FFI
 /// Returns 0 on success, negative on error
@@ -29,7 +38,7 @@ pub extern "C" fn yx_proc_batch_rgba8(
 
     let frame_count = count as usize;
     let input_size = (width * height * 4) as usize;
-    let target_size = target as u32;
+    let plane_size = (target * target) as usize;
     let palette_len = palette_size as usize;
 
     unsafe {
@@ -42,63 +51,320 @@ pub extern "C" fn yx_proc_batch_rgba8(
                 return -3;
             }
 
-            // Get frame data
+            // Get frame data and this frame's slots in the output buffers
             let frame_data = slice::from_raw_parts(frame_ptr, input_size);
+            let out_indices_slice = slice::from_raw_parts_mut(
+                out_indices.add(frame_idx * plane_size),
+                plane_size
+            );
+            let out_palette_slice = slice::from_raw_parts_mut(
+                out_palettes.add(frame_idx * palette_len),
+                palette_len
+            );
 
-            // Convert to RgbaImage
-            let img = match RgbaImage::from_raw(width as u32, height as u32, frame_data.to_vec()) {
-                Some(img) => img,
-                None => return -4,
-            };
+            let status = process_frame_into(
+                frame_data,
+                width as u32,
+                height as u32,
+                target as u32,
+                ResizeFilter::Lanczos3,
+                out_indices_slice,
+                out_palette_slice,
+            );
+            if status != 0 {
+                return status;
+            }
+        }
+    }
 
-            // Resize to target size
-            let resized = if width != target || height != target {
-                imageops::resize(&img, target_size, target_size, imageops::FilterType::Lanczos3)
-            } else {
-                img
-            };
+    0 // Success
+}
 
-            // Quantize with NeuQuant
-            let raw_pixels = resized.into_raw();
-            let quantizer = NeuQuant::new(10, palette_len, &raw_pixels);
+/// Process batch of RGBA frames across a Rayon pool
+/// Frames are independent, so each worker writes its index plane and palette
+/// straight into the caller's buffers. Output is identical to yx_proc_batch_rgba8.
+/// `num_threads` <= 0 uses the global pool; otherwise a pool of that size is used
+/// (e.g. cores - 1 to leave the capture thread alone).
+/// Returns 0 on success, negative on error
+#[no_mangle]
+pub extern "C" fn yx_proc_batch_rgba8_parallel(
+    frames: *const *const u8,  // Array of frame pointers
+    count: i32,                 // Number of frames
+    width: i32,                 // Input width
+    height: i32,                // Input height
+    target: i32,                // Target size (132)
+    palette_size: i32,          // Palette size (256)
+    out_indices: *mut u8,       // Output indices (Z-major)
+    out_palettes: *mut u32,     // Output palettes (RGB packed)
+    num_threads: i32,           // Worker count, <= 0 for default
+) -> i32 {
+    yx_proc_batch_rgba8_ex(
+        frames,
+        count,
+        width,
+        height,
+        target,
+        palette_size,
+        out_indices,
+        out_palettes,
+        YX_RESIZE_LANCZOS3,
+        num_threads,
+    )
+}
 
-            // Get palette
-            let palette = quantizer.color_map_rgba();
+/// Resize filter: Lanczos3 (default, highest quality)
+pub const YX_RESIZE_LANCZOS3: i32 = 0;
+/// Resize filter: area average, SIMD box filter for large reduction ratios
+pub const YX_RESIZE_AREA: i32 = 1;
 
-            // Write palette to output (RGB packed as 0x00RRGGBB)
-            let palette_offset = frame_idx * palette_len;
-            let out_palette_slice = slice::from_raw_parts_mut(
-                out_palettes.add(palette_offset),
-                palette_len
-            );
+/// Parallel batch processing with a per-call resize filter (YX_RESIZE_*)
+/// YX_RESIZE_AREA trades a little filter quality for a large speedup on 1080p input;
+/// it only downsamples, so targets larger than the input fall back to Lanczos3.
+/// Returns 0 on success, negative on error
+#[no_mangle]
+pub extern "C" fn yx_proc_batch_rgba8_ex(
+    frames: *const *const u8,  // Array of frame pointers
+    count: i32,                 // Number of frames
+    width: i32,                 // Input width
+    height: i32,                // Input height
+    target: i32,                // Target size (132)
+    palette_size: i32,          // Palette size (256)
+    out_indices: *mut u8,       // Output indices (Z-major)
+    out_palettes: *mut u32,     // Output palettes (RGB packed)
+    filter: i32,                // YX_RESIZE_* filter
+    num_threads: i32,           // Worker count, <= 0 for default
+) -> i32 {
+    // Safety checks
+    if frames.is_null() || out_indices.is_null() || out_palettes.is_null() {
+        return -1;
+    }
+    if count <= 0 || width <= 0 || height <= 0 || target <= 0 || palette_size <= 0 {
+        return -2;
+    }
+    let filter = match ResizeFilter::from_raw(filter) {
+        Some(filter) => filter,
+        None => return -2,
+    };
 
-            for (i, chunk) in palette.chunks(4).enumerate() {
-                if i >= palette_len { break; }
-                let r = chunk[0] as u32;
-                let g = chunk[1] as u32;
-                let b = chunk[2] as u32;
-                out_palette_slice[i] = (r << 16) | (g << 8) | b;
-            }
+    let frame_count = count as usize;
+    let input_size = (width * height * 4) as usize;
+    let plane_size = (target * target) as usize;
+    let palette_len = palette_size as usize;
 
-            // Quantize pixels to indices
-            let indices_offset = frame_idx * (target_size * target_size) as usize;
-            let out_indices_slice = slice::from_raw_parts_mut(
-                out_indices.add(indices_offset),
-                (target_size * target_size) as usize
-            );
+    // Borrow all inputs and outputs as slices up front so workers never touch raw pointers
+    let (frame_slices, indices_all, palettes_all) = unsafe {
+        let frame_ptrs = slice::from_raw_parts(frames, frame_count);
+        if frame_ptrs.iter().any(|ptr| ptr.is_null()) {
+            return -3;
+        }
 
-            for (i, chunk) in raw_pixels.chunks(4).enumerate() {
-                if i >= out_indices_slice.len() { break; }
-                out_indices_slice[i] = quantizer.index_of(chunk) as u8;
-            }
+        let frame_slices: Vec<&[u8]> = frame_ptrs
+            .iter()
+            .map(|&ptr| slice::from_raw_parts(ptr, input_size))
+            .collect();
+
+        (
+            frame_slices,
+            slice::from_raw_parts_mut(out_indices, frame_count * plane_size),
+            slice::from_raw_parts_mut(out_palettes, frame_count * palette_len),
+        )
+    };
+
+    let threads = if num_threads > 0 { num_threads as usize } else { 0 };
+
+    let failure = install_with_threads(threads, || {
+        frame_slices
+            .par_iter()
+            .zip(indices_all.par_chunks_mut(plane_size))
+            .zip(palettes_all.par_chunks_mut(palette_len))
+            .map(|((frame_data, out_indices_slice), out_palette_slice)| {
+                process_frame_into(
+                    frame_data,
+                    width as u32,
+                    height as u32,
+                    target as u32,
+                    filter,
+                    out_indices_slice,
+                    out_palette_slice,
+                )
+            })
+            .find_any(|&status| status != 0)
+    });
+
+    failure.unwrap_or(0)
+}
+
+/// Parallel batch processing that reuses NeuQuant palettes across steady shots
+/// Same arguments and output layout as yx_proc_batch_rgba8_ex. A frame is only
+/// retrained once its color histogram has moved `reuse_threshold` (0-1, the
+/// fraction of pixels changing color bin) from the frame its palette was trained
+/// on; other frames copy that palette and are mapped through the same network.
+/// 0 retrains every frame and matches yx_proc_batch_rgba8_ex exactly.
+/// Returns 0 on success, negative on error
+#[no_mangle]
+pub extern "C" fn yx_proc_batch_rgba8_temporal(
+    frames: *const *const u8,  // Array of frame pointers
+    count: i32,                 // Number of frames
+    width: i32,                 // Input width
+    height: i32,                // Input height
+    target: i32,                // Target size (132)
+    palette_size: i32,          // Palette size (256)
+    out_indices: *mut u8,       // Output indices (Z-major)
+    out_palettes: *mut u32,     // Output palettes (RGB packed)
+    filter: i32,                // YX_RESIZE_* filter
+    num_threads: i32,           // Worker count, <= 0 for default
+    reuse_threshold: f32,       // Retrain threshold, e.g. 0.1
+) -> i32 {
+    // Safety checks
+    if frames.is_null() || out_indices.is_null() || out_palettes.is_null() {
+        return -1;
+    }
+    if count <= 0 || width <= 0 || height <= 0 || target <= 0 || palette_size <= 0 {
+        return -2;
+    }
+    if !(reuse_threshold >= 0.0) {
+        return -2;
+    }
+    let filter = match ResizeFilter::from_raw(filter) {
+        Some(filter) => filter,
+        None => return -2,
+    };
+
+    let frame_count = count as usize;
+    let input_size = (width * height * 4) as usize;
+    let side = target as usize;
+    let plane_size = side * side;
+    let palette_len = palette_size as usize;
+
+    let (frame_slices, indices_all, palettes_all) = unsafe {
+        let frame_ptrs = slice::from_raw_parts(frames, frame_count);
+        if frame_ptrs.iter().any(|ptr| ptr.is_null()) {
+            return -3;
         }
+
+        let frame_slices: Vec<&[u8]> = frame_ptrs
+            .iter()
+            .map(|&ptr| slice::from_raw_parts(ptr, input_size))
+            .collect();
+
+        (
+            frame_slices,
+            slice::from_raw_parts_mut(out_indices, frame_count * plane_size),
+            slice::from_raw_parts_mut(out_palettes, frame_count * palette_len),
+        )
+    };
+
+    let threads = if num_threads > 0 { num_threads as usize } else { 0 };
+
+    install_with_threads(threads, || {
+        // All frames are resized first (side² × 4 bytes each), since deciding which
+        // ones to train needs every frame's histogram
+        let resized = match frame_slices
+            .par_iter()
+            .map(|frame_data| resize_frame(frame_data, width as u32, height as u32, target as u32, filter).ok_or(-4))
+            .collect::<Result<Vec<_>, i32>>()
+        {
+            Ok(resized) => resized,
+            Err(status) => return status,
+        };
+
+        let signatures: Vec<ColorSignature> = resized
+            .par_iter()
+            .map(|pixels| ColorSignature::from_rgba(pixels, side, side))
+            .collect();
+        let runs = keyframe_runs(&signatures, reuse_threshold);
+
+        // Keyframes are independent of each other, so they train in parallel too
+        let quantizers: Vec<NeuQuant> = runs
+            .par_iter()
+            .map(|run| NeuQuant::new(10, palette_len, &resized[run.start]))
+            .collect();
+        let run_of: Vec<usize> = runs
+            .iter()
+            .enumerate()
+            .flat_map(|(run_index, run)| run.clone().map(move |_| run_index))
+            .collect();
+
+        resized
+            .par_iter()
+            .zip(&run_of)
+            .zip(indices_all.par_chunks_mut(plane_size))
+            .zip(palettes_all.par_chunks_mut(palette_len))
+            .for_each(|(((pixels, &run_index), out_indices_slice), out_palette_slice)| {
+                write_quantized(&quantizers[run_index], pixels, out_indices_slice, out_palette_slice);
+            });
+        0
+    })
+}
+
+/// Resize and quantize one frame into its index plane and palette slots
+/// Returns 0 on success, negative on error
+fn process_frame_into(
+    frame_data: &[u8],
+    width: u32,
+    height: u32,
+    target: u32,
+    filter: ResizeFilter,
+    out_indices: &mut [u8],
+    out_palette: &mut [u32],
+) -> i32 {
+    let raw_pixels = match resize_frame(frame_data, width, height, target, filter) {
+        Some(pixels) => pixels,
+        None => return -4,
+    };
+
+    // Quantize with NeuQuant
+    let quantizer = NeuQuant::new(10, out_palette.len(), &raw_pixels);
+    write_quantized(&quantizer, &raw_pixels, out_indices, out_palette);
+
+    0
+}
+
+/// Resize to the target size; frames already at target are borrowed straight from
+/// caller memory. None if the frame doesn't match its dimensions.
+fn resize_frame(frame_data: &[u8], width: u32, height: u32, target: u32, filter: ResizeFilter) -> Option<Cow<'_, [u8]>> {
+    // Borrow the caller's frame in place instead of copying it into an owned RgbaImage
+    let view = ImageBuffer::<Rgba<u8>, &[u8]>::from_raw(width, height, frame_data)?;
+
+    if width == target && height == target {
+        return Some(Cow::Borrowed(frame_data));
     }
+    let area = match filter {
+        ResizeFilter::Area => downsample_area(
+            frame_data,
+            width as usize,
+            height as usize,
+            target as usize,
+            target as usize,
+        ),
+        ResizeFilter::Lanczos3 => None,
+    };
+    Some(Cow::Owned(match area {
+        Some(pixels) => pixels,
+        None => imageops::resize(&view, target, target, imageops::FilterType::Lanczos3).into_raw(),
+    }))
+}
 
-    0 // Success
+/// Write a trained network's palette and the frame's indices into its output slots
+fn write_quantized(quantizer: &NeuQuant, pixels: &[u8], out_indices: &mut [u8], out_palette: &mut [u32]) {
+    // Write palette to output (RGB packed as 0x00RRGGBB)
+    let palette = quantizer.color_map_rgba();
+    for (slot, chunk) in out_palette.iter_mut().zip(palette.chunks(4)) {
+        let r = chunk[0] as u32;
+        let g = chunk[1] as u32;
+        let b = chunk[2] as u32;
+        *slot = (r << 16) | (g << 8) | b;
+    }
+
+    // Quantize pixels to indices
+    for (slot, chunk) in out_indices.iter_mut().zip(pixels.chunks(4)) {
+        *slot = quantizer.index_of(chunk) as u8;
+    }
 }
 
 /// Encode GIF from quantized frames - architecture v2 minimal FFI
-/// Returns 0 on success, negative on error
+/// Encodes straight into `output`; a buffer of yx_gif_max_size bytes always fits.
+/// Returns 0 on success, negative on error (-4 as soon as `output` is full)
 #[no_mangle]
 pub extern "C" fn yx_gif_encode(
     indices: *const u8,         // Palette indices for all frames
@@ -113,74 +379,807 @@ pub extern "C" fn yx_gif_encode(
     if indices.is_null() || palettes.is_null() || output.is_null() || output_len.is_null() {
         return -1;
     }
-    if frame_count <= 0 || side <= 0 || delay_cs < 0 {
+    if frame_count <= 0 || side <= 0 || side > u16::MAX as i32 || delay_cs < 0 {
         return -2;
     }
 
-    let n_frames = frame_count as usize;
-    let size = side as usize;
-    let frame_pixels = size * size;
-    let palette_size = 256;
-
     unsafe {
-        let max_size = *output_len;
-        let mut buffer = Vec::with_capacity(max_size);
+        let mut encoder = match BlockEncoder::new(indices, palettes, frame_count as usize, side as u16, delay_cs as u16) {
+            Some(encoder) => encoder,
+            None => return -3,
+        };
 
-        // Create GIF encoder
-        {
-            let mut encoder = Encoder::new(&mut buffer, size as u16, size as u16, &[]).unwrap();
-            encoder.set_repeat(Repeat::Infinite).unwrap();
-
-            // Process each frame
-            for frame_idx in 0..n_frames {
-                // Get frame indices
-                let indices_offset = frame_idx * frame_pixels;
-                let frame_indices = slice::from_raw_parts(
-                    indices.add(indices_offset),
-                    frame_pixels
-                );
-
-                // Get frame palette
-                let palette_offset = frame_idx * palette_size;
-                let frame_palette = slice::from_raw_parts(
-                    palettes.add(palette_offset),
-                    palette_size
-                );
-
-                // Convert palette to GIF format (RGB bytes)
-                let mut gif_palette = Vec::with_capacity(palette_size * 3);
-                for &color in frame_palette {
-                    gif_palette.push(((color >> 16) & 0xFF) as u8); // R
-                    gif_palette.push(((color >> 8) & 0xFF) as u8);  // G
-                    gif_palette.push((color & 0xFF) as u8);         // B
-                }
+        // The whole buffer is the only block: running out of it is final
+        let out = slice::from_raw_parts_mut(output, *output_len);
+        match encoder.fill(out) {
+            Ok((written, true)) => *output_len = written,
+            Ok((_, false)) => return -4, // Buffer too small
+            Err(_) => return -3,
+        }
+    }
+
+    0 // Success
+}
 
-                // Create GIF frame
-                let mut frame = Frame::from_palette_pixels(
-                    size as u16,
-                    size as u16,
-                    frame_indices,
-                    &gif_palette,
-                    None
-                );
-                frame.delay = delay_cs as u16;
-
-                // Write frame
-                if encoder.write_frame(&frame).is_err() {
-                    return -3;
+/// Largest GIF yx_gif_encode can produce for `frame_count` frames of side²
+/// pixels (256-entry palettes; smaller streamed palettes only shrink it).
+/// Exact when every frame takes the uncompressed fallback. 0 on invalid arguments
+#[no_mangle]
+pub extern "C" fn yx_gif_max_size(frame_count: i32, side: i32) -> usize {
+    if frame_count <= 0 || side <= 0 || side > u16::MAX as i32 {
+        return 0;
+    }
+
+    let framing = gif_framing();
+    let data = raw_lzw_len(side as usize * side as usize);
+    let frame = framing.frame + data + data.div_ceil(GIF_SUB_BLOCK);
+    frame
+        .checked_mul(frame_count as usize)
+        .and_then(|frames| frames.checked_add(framing.header + framing.trailer))
+        .unwrap_or(0)
+}
+
+// ============================================================================
+// STREAMING GIF ENCODER
+// ============================================================================
+
+/// Caller-supplied sink: called with each run of encoded bytes, returns 0 on success
+pub type YxGifWriteFn = unsafe extern "C" fn(ctx: *mut c_void, data: *const u8, len: usize) -> i32;
+
+/// Destination for encoded GIF bytes
+pub enum GifSink {
+    Buffer(Vec<u8>),                                    // Growable, drained by the caller
+    Callback { write: YxGifWriteFn, ctx: *mut c_void }, // Forwarded as soon as it is encoded
+    Block {                                             // Caller memory, see GifStream::open_block
+        block: *mut u8,
+        capacity: usize,
+        filled: usize,
+        spill: Vec<u8>,                                 // Overrun, in order, for the next block
+    },
+}
+
+impl Write for GifSink {
+    fn write(&mut self, data: &[u8]) -> io::Result<usize> {
+        match self {
+            GifSink::Buffer(buffer) => buffer.write(data),
+            GifSink::Callback { write, ctx } => {
+                if unsafe { (*write)(*ctx, data.as_ptr(), data.len()) } != 0 {
+                    return Err(io::Error::new(io::ErrorKind::Other, "GIF sink rejected write"));
+                }
+                Ok(data.len())
+            }
+            GifSink::Block { block, capacity, filled, spill } => {
+                // Once anything has spilled, later bytes must follow it
+                let n = if spill.is_empty() { data.len().min(*capacity - *filled) } else { 0 };
+                if n > 0 {
+                    unsafe { std::ptr::copy_nonoverlapping(data.as_ptr(), block.add(*filled), n) };
+                    *filled += n;
                 }
+                spill.extend_from_slice(&data[n..]);
+                Ok(data.len())
             }
         }
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        Ok(())
+    }
+}
+
+/// Incremental GIF89a encoder: each pushed frame is LZW-encoded and written to
+/// the sink immediately, so encoding overlaps capture and the clip never has
+/// to be resident all at once
+pub struct GifStream {
+    encoder: Encoder<GifSink>,
+    side: u16,
+    delay_cs: u16,
+    palette_len: usize,
+    palette_rgb: Vec<u8>, // Local palette scratch, reused for every frame
+    frames_written: u32,
+}
+
+impl GifStream {
+    /// Write the header and loop extension; None if the header cannot be written
+    pub fn new(side: u16, delay_cs: u16, palette_len: usize, sink: GifSink) -> Option<Self> {
+        let mut encoder = Encoder::new(sink, side, side, &[]).ok()?;
+        encoder.set_repeat(Repeat::Infinite).ok()?;
+
+        Some(Self {
+            encoder,
+            side,
+            delay_cs,
+            palette_len,
+            palette_rgb: Vec::with_capacity(palette_len * 3),
+            frames_written: 0,
+        })
+    }
+
+    /// Encode one frame (side² indices) with its local 0x00RRGGBB palette
+    pub fn push_frame(&mut self, indices: &[u8], palette: &[u32]) -> Result<(), gif::EncodingError> {
+        let gif_palette = std::mem::take(&mut self.palette_rgb);
+        let mut frame = indexed_frame(self.side, self.delay_cs, indices, &palette[..self.palette_len], gif_palette);
+        compress_frame(&mut frame, indices);
 
-        // Copy to output buffer
-        let actual_size = buffer.len();
-        if actual_size > max_size {
-            return -4; // Buffer too small
+        let result = self.encoder.write_lzw_pre_encoded_frame(&frame);
+        self.palette_rgb = frame.palette.take().unwrap_or_default();
+        result?;
+
+        self.frames_written += 1;
+        Ok(())
+    }
+
+    /// Encode several frames, running each frame's LZW compression on the rayon
+    /// pool and then writing the blocks in order. Output is byte-identical to
+    /// calling push_frame for each frame.
+    pub fn push_frames_parallel(&mut self, frames: &[(&[u8], &[u32])]) -> Result<(), gif::EncodingError> {
+        let (side, delay_cs, palette_len) = (self.side, self.delay_cs, self.palette_len);
+        let encoded: Vec<Frame> = frames
+            .par_iter()
+            .map(|&(indices, palette)| {
+                let gif_palette = Vec::with_capacity(palette_len * 3);
+                let mut frame = indexed_frame(side, delay_cs, indices, &palette[..palette_len], gif_palette);
+                compress_frame(&mut frame, indices);
+                frame
+            })
+            .collect();
+
+        for frame in &encoded {
+            self.encoder.write_lzw_pre_encoded_frame(frame)?;
+            self.frames_written += 1;
+        }
+        Ok(())
+    }
+
+    /// Bytes encoded but not yet drained (always 0 for callback sinks)
+    pub fn pending(&mut self) -> usize {
+        match self.encoder.get_mut() {
+            GifSink::Buffer(buffer) => buffer.len(),
+            GifSink::Callback { .. } => 0,
+            GifSink::Block { spill, .. } => spill.len(),
         }
+    }
 
-        std::ptr::copy_nonoverlapping(buffer.as_ptr(), output, actual_size);
-        *output_len = actual_size;
+    /// Point a block sink at `block`, moving in what overran the previous one.
+    /// The sink writes through a raw pointer, so close_block must run before
+    /// `block` goes out of scope.
+    fn open_block(&mut self, out: &mut [u8]) {
+        if let GifSink::Block { block, capacity, filled, spill } = self.encoder.get_mut() {
+            let n = out.len().min(spill.len());
+            out[..n].copy_from_slice(&spill[..n]);
+            spill.drain(..n);
+            (*block, *capacity, *filled) = (out.as_mut_ptr(), out.len(), n);
+        }
     }
 
-    0 // Success
-}
\ No newline at end of file
+    /// Whether the open block can take more bytes without spilling
+    fn block_has_room(&mut self) -> bool {
+        match self.encoder.get_mut() {
+            GifSink::Block { capacity, filled, spill, .. } => spill.is_empty() && filled < capacity,
+            _ => true,
+        }
+    }
+
+    /// Detach the block sink from its block, returning the bytes written into it.
+    /// Anything written while detached spills.
+    fn close_block(&mut self) -> usize {
+        match self.encoder.get_mut() {
+            GifSink::Block { block, capacity, filled, .. } => {
+                let written = *filled;
+                (*block, *capacity, *filled) = (std::ptr::null_mut(), 0, 0);
+                written
+            }
+            _ => 0,
+        }
+    }
+
+    /// Move up to `out.len()` buffered bytes into `out`, returning the count
+    pub fn drain_into(&mut self, out: &mut [u8]) -> usize {
+        match self.encoder.get_mut() {
+            GifSink::Buffer(buffer) => {
+                let n = out.len().min(buffer.len());
+                out[..n].copy_from_slice(&buffer[..n]);
+                buffer.drain(..n);
+                n
+            }
+            GifSink::Callback { .. } | GifSink::Block { .. } => 0,
+        }
+    }
+
+    /// Write the trailer and hand back the sink
+    pub fn finish(self) -> io::Result<GifSink> {
+        self.encoder.into_inner()
+    }
+}
+
+/// LZW-compress a frame's indices for write_lzw_pre_encoded_frame, falling back
+/// to the uncompressed stream when compression loses (noise-like frames), so no
+/// frame ever exceeds its share of yx_gif_max_size
+fn compress_frame(frame: &mut Frame, indices: &[u8]) {
+    frame.make_lzw_pre_encoded();
+    if frame.buffer.len() > 1 + raw_lzw_len(indices.len()) {
+        frame.buffer = Cow::Owned(raw_lzw(indices));
+    }
+}
+
+/// Build a side×side frame with a local palette, borrowing the indices;
+/// equivalent to Frame::from_palette_pixels without the copy
+fn indexed_frame<'a>(side: u16, delay_cs: u16, indices: &'a [u8], palette: &[u32], mut gif_palette: Vec<u8>) -> Frame<'a> {
+    // Convert palette to GIF format (RGB bytes)
+    gif_palette.clear();
+    for &color in palette {
+        gif_palette.push(((color >> 16) & 0xFF) as u8); // R
+        gif_palette.push(((color >> 8) & 0xFF) as u8);  // G
+        gif_palette.push((color & 0xFF) as u8);         // B
+    }
+
+    Frame {
+        width: side,
+        height: side,
+        buffer: Cow::Borrowed(indices),
+        palette: Some(gif_palette),
+        delay: delay_cs,
+        ..Frame::default()
+    }
+}
+
+/// Opaque streaming encoder handle for C
+pub struct YxGifStream {
+    stream: Option<GifStream>, // None once finished
+    frame_pixels: usize,
+    tail: Vec<u8>,             // Buffered bytes left after finish
+}
+
+/// Open a streaming GIF encoder for side×side frames
+/// `write` may be NULL to buffer output internally (drain with yx_gif_stream_drain);
+/// otherwise encoded bytes are passed to `write(ctx, data, len)` as they are produced.
+/// Returns NULL on invalid arguments
+#[no_mangle]
+pub extern "C" fn yx_gif_stream_open(
+    side: i32,                  // Width and height
+    delay_cs: i32,              // Delay in centiseconds
+    palette_size: i32,          // Entries per frame palette (max 256)
+    write: Option<YxGifWriteFn>,// Sink callback, NULL for internal buffer
+    ctx: *mut c_void,           // Passed through to `write`
+) -> *mut YxGifStream {
+    if side <= 0 || side > u16::MAX as i32 || delay_cs < 0 || palette_size <= 0 || palette_size > 256 {
+        return std::ptr::null_mut();
+    }
+
+    let sink = match write {
+        Some(write) => GifSink::Callback { write, ctx },
+        None => GifSink::Buffer(Vec::new()),
+    };
+
+    match GifStream::new(side as u16, delay_cs as u16, palette_size as usize, sink) {
+        Some(stream) => Box::into_raw(Box::new(YxGifStream {
+            stream: Some(stream),
+            frame_pixels: (side * side) as usize,
+            tail: Vec::new(),
+        })),
+        None => std::ptr::null_mut(),
+    }
+}
+
+/// Encode one frame: side² indices plus its palette_size palette entries (0x00RRGGBB)
+/// Returns 0 on success, negative on error
+#[no_mangle]
+pub extern "C" fn yx_gif_stream_push_frame(
+    stream: *mut YxGifStream,
+    indices: *const u8,
+    palette: *const u32,
+) -> i32 {
+    if stream.is_null() || indices.is_null() || palette.is_null() {
+        return -1;
+    }
+
+    unsafe {
+        let handle = &mut *stream;
+        let frame_pixels = handle.frame_pixels;
+        let gif = match handle.stream.as_mut() {
+            Some(gif) => gif,
+            None => return -2, // Already finished
+        };
+
+        let frame_indices = slice::from_raw_parts(indices, frame_pixels);
+        let frame_palette = slice::from_raw_parts(palette, gif.palette_len);
+
+        if gif.push_frame(frame_indices, frame_palette).is_err() {
+            return -3;
+        }
+    }
+
+    0
+}
+
+/// Bytes buffered and ready to drain (internal-buffer sinks only)
+#[no_mangle]
+pub extern "C" fn yx_gif_stream_pending(stream: *mut YxGifStream) -> usize {
+    if stream.is_null() {
+        return 0;
+    }
+
+    let handle = unsafe { &mut *stream };
+    match handle.stream.as_mut() {
+        Some(gif) => gif.pending(),
+        None => handle.tail.len(),
+    }
+}
+
+/// Copy buffered output into `out_buf`
+/// In: *out_len = capacity, Out: bytes copied. Call repeatedly until it reports 0.
+/// Returns 0 on success, negative on error
+#[no_mangle]
+pub extern "C" fn yx_gif_stream_drain(
+    stream: *mut YxGifStream,
+    out_buf: *mut u8,
+    out_len: *mut usize,
+) -> i32 {
+    if stream.is_null() || out_buf.is_null() || out_len.is_null() {
+        return -1;
+    }
+
+    unsafe {
+        let handle = &mut *stream;
+        let out = slice::from_raw_parts_mut(out_buf, *out_len);
+
+        *out_len = match handle.stream.as_mut() {
+            Some(gif) => gif.drain_into(out),
+            None => {
+                let n = out.len().min(handle.tail.len());
+                out[..n].copy_from_slice(&handle.tail[..n]);
+                handle.tail.drain(..n);
+                n
+            }
+        };
+    }
+
+    0
+}
+
+/// Write the GIF trailer. Remaining buffered bytes stay drainable.
+/// Returns 0 on success, negative on error
+#[no_mangle]
+pub extern "C" fn yx_gif_stream_finish(stream: *mut YxGifStream) -> i32 {
+    if stream.is_null() {
+        return -1;
+    }
+
+    let handle = unsafe { &mut *stream };
+    let gif = match handle.stream.take() {
+        Some(gif) => gif,
+        None => return -2, // Already finished
+    };
+
+    match gif.finish() {
+        Ok(GifSink::Buffer(tail)) => {
+            handle.tail = tail;
+            0
+        }
+        Ok(_) => 0,
+        Err(_) => -3,
+    }
+}
+
+/// Free a streaming encoder (finished or not)
+#[no_mangle]
+pub extern "C" fn yx_gif_stream_free(stream: *mut YxGifStream) {
+    if !stream.is_null() {
+        unsafe { drop(Box::from_raw(stream)) };
+    }
+}
+
+// ============================================================================
+// SIZE BOUND
+// ============================================================================
+
+/// Uncompressed fallback: 8-bit literal codes, 9 bits wide. A clear code before
+/// every 254 literals keeps the decoder's table below 512 entries, so the code
+/// width never grows and the stream size is a function of the pixel count alone.
+const RAW_MIN_CODE_SIZE: u8 = 8;
+const RAW_CODE_BITS: usize = RAW_MIN_CODE_SIZE as usize + 1;
+const RAW_RUN: usize = (1 << RAW_MIN_CODE_SIZE) - 2;
+const RAW_CLEAR: u32 = 1 << RAW_MIN_CODE_SIZE;
+const RAW_END: u32 = RAW_CLEAR + 1;
+
+/// Image data is written in length-prefixed sub-blocks of up to 255 bytes
+const GIF_SUB_BLOCK: usize = 255;
+
+/// LZW data bytes of the uncompressed stream for `pixels` indices, excluding the
+/// minimum code size byte: every literal, a clear per run and the end code
+fn raw_lzw_len(pixels: usize) -> usize {
+    let codes = pixels + pixels.div_ceil(RAW_RUN) + 1;
+    (codes * RAW_CODE_BITS).div_ceil(8)
+}
+
+/// Uncompressed LZW stream in write_lzw_pre_encoded_frame layout (minimum code
+/// size byte first); any decoder reads it back as `indices`
+fn raw_lzw(indices: &[u8]) -> Vec<u8> {
+    let mut out = Vec::with_capacity(1 + raw_lzw_len(indices.len()));
+    out.push(RAW_MIN_CODE_SIZE);
+
+    // Codes are packed LSB first
+    let (mut bits, mut pending) = (0u32, 0usize);
+    let mut put = |out: &mut Vec<u8>, code: u32| {
+        bits |= code << pending;
+        pending += RAW_CODE_BITS;
+        while pending >= 8 {
+            out.push(bits as u8);
+            bits >>= 8;
+            pending -= 8;
+        }
+    };
+    for run in indices.chunks(RAW_RUN) {
+        put(&mut out, RAW_CLEAR);
+        for &index in run {
+            put(&mut out, index as u32);
+        }
+    }
+    put(&mut out, RAW_END);
+    if pending > 0 {
+        out.push(bits as u8);
+    }
+    out
+}
+
+/// Bytes the encoder writes around the image data, which don't depend on the
+/// pixels. Measured once from the encoder itself so the bound can't drift from
+/// what it writes.
+struct GifFraming {
+    header: usize,  // Signature, screen descriptor, loop extension
+    frame: usize,   // Control extension, descriptor, 256-entry local palette, code size, terminator
+    trailer: usize,
+}
+
+fn gif_framing() -> &'static GifFraming {
+    static FRAMING: OnceLock<GifFraming> = OnceLock::new();
+    FRAMING.get_or_init(|| {
+        let mut stream = GifStream::new(1, 1, 256, GifSink::Buffer(Vec::new())).expect("GIF header");
+        let header = stream.pending();
+
+        // A frame with no image data: exactly its framing
+        let mut frame = indexed_frame(1, 1, &[], &[0; 256], Vec::new());
+        frame.buffer = Cow::Owned(vec![RAW_MIN_CODE_SIZE]);
+        stream.encoder.write_lzw_pre_encoded_frame(&frame).expect("GIF frame");
+        let frame = stream.pending() - header;
+
+        let total = match stream.finish() {
+            Ok(GifSink::Buffer(buffer)) => buffer.len(),
+            _ => unreachable!("buffer sink"),
+        };
+        GifFraming { header, frame, trailer: total - header - frame }
+    })
+}
+
+// ============================================================================
+// CALLER-BUFFER GIF ENCODER
+// ============================================================================
+
+/// Status of yx_gif_encoder_next: the block is full and more output follows
+pub const YX_GIF_NEED_SPACE: i32 = 1;
+
+/// Encodes a clip held in caller memory into caller-provided blocks
+///
+/// Frames are LZW-compressed a batch at a time on the rayon pool and written
+/// straight into the current block; only what overruns a block is held back,
+/// and it opens the next one. Output is byte-identical to the streaming API.
+struct BlockEncoder<'a> {
+    stream: Option<GifStream>, // Block sink; None once the trailer is written
+    spill: Vec<u8>,            // Overrun left after the trailer
+    frames: Vec<(&'a [u8], &'a [u32])>,
+    next_frame: usize,
+    failed: bool,
+}
+
+impl<'a> BlockEncoder<'a> {
+    /// Borrow `frame_count` frames of side² indices and 256-entry palettes
+    unsafe fn new(indices: *const u8, palettes: *const u32, frame_count: usize, side: u16, delay_cs: u16) -> Option<Self> {
+        let frame_pixels = side as usize * side as usize;
+        let all_indices = slice::from_raw_parts(indices, frame_count * frame_pixels);
+        let all_palettes = slice::from_raw_parts(palettes, frame_count * 256);
+        let frames = all_indices
+            .chunks_exact(frame_pixels)
+            .zip(all_palettes.chunks_exact(256))
+            .collect();
+
+        let sink = GifSink::Block { block: std::ptr::null_mut(), capacity: 0, filled: 0, spill: Vec::new() };
+        Some(Self {
+            stream: Some(GifStream::new(side, delay_cs, 256, sink)?),
+            spill: Vec::new(),
+            frames,
+            next_frame: 0,
+            failed: false,
+        })
+    }
+
+    /// Encode into `block` until it is full or the GIF is complete
+    /// Returns the bytes written and whether the GIF is complete
+    fn fill(&mut self, block: &mut [u8]) -> Result<(usize, bool), gif::EncodingError> {
+        if self.failed {
+            return Err(gif::EncodingError::from(io::Error::new(io::ErrorKind::Other, "encoder failed")));
+        }
+
+        let Some(stream) = self.stream.as_mut() else {
+            // Trailer written; hand out what overran the last block
+            let n = block.len().min(self.spill.len());
+            block[..n].copy_from_slice(&self.spill[..n]);
+            self.spill.drain(..n);
+            return Ok((n, self.spill.is_empty()));
+        };
+
+        let batch = rayon::current_num_threads().max(1);
+        stream.open_block(block);
+        let mut result = Ok(());
+        while stream.block_has_room() && self.next_frame < self.frames.len() {
+            let end = (self.next_frame + batch).min(self.frames.len());
+            result = stream.push_frames_parallel(&self.frames[self.next_frame..end]);
+            if result.is_err() {
+                break;
+            }
+            self.next_frame = end;
+        }
+        let filled = stream.close_block();
+
+        if let Err(err) = result {
+            self.failed = true;
+            return Err(err);
+        }
+        if self.next_frame < self.frames.len() || stream.pending() > 0 {
+            return Ok((filled, false));
+        }
+
+        // Every frame is written: the trailer goes wherever there is room
+        let mut stream = self.stream.take().unwrap();
+        stream.open_block(&mut block[filled..]);
+        match stream.finish() {
+            Ok(GifSink::Block { filled: trailer, spill, .. }) => {
+                self.spill = spill;
+                Ok((filled + trailer, self.spill.is_empty()))
+            }
+            Ok(_) => unreachable!("block sink"),
+            Err(err) => {
+                self.failed = true;
+                Err(err.into())
+            }
+        }
+    }
+}
+
+/// Opaque caller-buffer encoder handle for C
+pub struct YxGifEncoder {
+    inner: BlockEncoder<'static>, // Borrows the caller's clip until freed
+}
+
+/// Start encoding `frame_count` frames of side² indices with 256-entry palettes
+/// (0x00RRGGBB) into caller blocks. Both arrays must stay valid until
+/// yx_gif_encoder_free. Returns NULL on invalid arguments
+#[no_mangle]
+pub extern "C" fn yx_gif_encoder_open(
+    indices: *const u8,
+    palettes: *const u32,
+    frame_count: i32,
+    side: i32,
+    delay_cs: i32,
+) -> *mut YxGifEncoder {
+    if indices.is_null() || palettes.is_null() {
+        return std::ptr::null_mut();
+    }
+    if frame_count <= 0 || side <= 0 || side > u16::MAX as i32 || delay_cs < 0 {
+        return std::ptr::null_mut();
+    }
+
+    match unsafe { BlockEncoder::new(indices, palettes, frame_count as usize, side as u16, delay_cs as u16) } {
+        Some(inner) => Box::into_raw(Box::new(YxGifEncoder { inner })),
+        None => std::ptr::null_mut(),
+    }
+}
+
+/// Write the next part of the GIF into `block`
+/// In: *block_len = capacity, Out: bytes written to this block.
+/// Returns 0 once the GIF is complete, YX_GIF_NEED_SPACE when the block is full
+/// (call again with the next block; nothing is lost), negative on error
+#[no_mangle]
+pub extern "C" fn yx_gif_encoder_next(
+    encoder: *mut YxGifEncoder,
+    block: *mut u8,
+    block_len: *mut usize,
+) -> i32 {
+    if encoder.is_null() || block.is_null() || block_len.is_null() {
+        return -1;
+    }
+
+    unsafe {
+        let handle = &mut *encoder;
+        let out = slice::from_raw_parts_mut(block, *block_len);
+        match handle.inner.fill(out) {
+            Ok((written, done)) => {
+                *block_len = written;
+                if done { 0 } else { YX_GIF_NEED_SPACE }
+            }
+            Err(_) => -3,
+        }
+    }
+}
+
+/// Free a caller-buffer encoder (complete or not)
+#[no_mangle]
+pub extern "C" fn yx_gif_encoder_free(encoder: *mut YxGifEncoder) {
+    if !encoder.is_null() {
+        unsafe { drop(Box::from_raw(encoder)) };
+    }
+}
+
+// ============================================================================
+// GPU TEXTURE EXPORT
+// ============================================================================
+
+/// Volume formats for yx_texture_*
+pub const YX_TEXTURE_RGBA8: i32 = 0;
+pub const YX_TEXTURE_R8_INDEX: i32 = 1; // Plus a 256 × palette_count RGBA8 palette texture
+
+/// Most levels a mip chain can have (65535 on the longest side)
+pub const YX_TEXTURE_MAX_LEVELS: i32 = 16;
+
+/// One mip level's place in the upload buffer, in the terms of
+/// MTLBlitCommandEncoder copy(from:sourceOffset:sourceBytesPerRow:sourceBytesPerImage:...)
+#[repr(C)]
+pub struct YxTextureLevel {
+    pub offset: usize,
+    pub width: u32,
+    pub height: u32,
+    pub depth: u32,
+    pub bytes_per_row: usize,
+    pub bytes_per_image: usize,
+}
+
+fn texture_layout(
+    format: i32,
+    width: i32,
+    height: i32,
+    depth: i32,
+    mip_levels: i32,
+    row_alignment: i32,
+) -> Option<TextureLayout> {
+    let format = match format {
+        YX_TEXTURE_RGBA8 => TextureFormat::Rgba8,
+        YX_TEXTURE_R8_INDEX => TextureFormat::R8Index,
+        _ => return None,
+    };
+    if width <= 0 || height <= 0 || depth <= 0 || mip_levels < 0 || row_alignment <= 0 {
+        return None;
+    }
+    let longest = width.max(height).max(depth);
+    if longest > u16::MAX as i32 {
+        return None;
+    }
+    TextureLayout::new(format, width as usize, height as usize, depth as usize, mip_levels as usize, row_alignment as usize).ok()
+}
+
+fn texture_status(result: crate::Result<()>) -> i32 {
+    match result {
+        Ok(()) => 0,
+        Err(crate::ProcessorError::MemoryError) => -4, // Buffer too small
+        Err(_) => -2,
+    }
+}
+
+/// Upload layout of a width × height × depth volume with `mip_levels` levels
+/// (0 = full chain). Rows and level offsets are padded to `row_alignment` bytes,
+/// a power of two (1 = tight). `out_levels` has room for YX_TEXTURE_MAX_LEVELS
+/// entries and may be NULL. Returns the level count, negative on error
+#[no_mangle]
+pub extern "C" fn yx_texture_layout(
+    format: i32,
+    width: i32,
+    height: i32,
+    depth: i32,
+    mip_levels: i32,
+    row_alignment: i32,
+    out_levels: *mut YxTextureLevel,
+    out_total_bytes: *mut usize,    // Buffer size the volume needs
+) -> i32 {
+    if out_total_bytes.is_null() {
+        return -1;
+    }
+    let layout = match texture_layout(format, width, height, depth, mip_levels, row_alignment) {
+        Some(layout) => layout,
+        None => return -2,
+    };
+
+    unsafe {
+        *out_total_bytes = layout.total_bytes;
+        if !out_levels.is_null() {
+            let out = slice::from_raw_parts_mut(out_levels, layout.levels.len());
+            for (slot, level) in out.iter_mut().zip(&layout.levels) {
+                *slot = YxTextureLevel {
+                    offset: level.offset,
+                    width: level.width as u32,
+                    height: level.height as u32,
+                    depth: level.depth as u32,
+                    bytes_per_row: level.bytes_per_row,
+                    bytes_per_image: level.bytes_per_image,
+                };
+            }
+        }
+    }
+
+    layout.levels.len() as i32
+}
+
+/// Write an RGBA8 volume (e.g. the tensor: 128×128×frames) and its box-filtered
+/// mip chain into `out` at yx_texture_layout's offsets; `out` can be the
+/// contents of a shared MTLBuffer. Returns 0 on success, negative on error
+/// (-4 when `out_len` is below the layout's total)
+#[no_mangle]
+pub extern "C" fn yx_texture_write_rgba(
+    rgba: *const u8,            // width × height × depth × 4, slices z-major
+    width: i32,
+    height: i32,
+    depth: i32,
+    mip_levels: i32,
+    row_alignment: i32,
+    out: *mut u8,
+    out_len: usize,
+) -> i32 {
+    if rgba.is_null() || out.is_null() {
+        return -1;
+    }
+    let layout = match texture_layout(YX_TEXTURE_RGBA8, width, height, depth, mip_levels, row_alignment) {
+        Some(layout) => layout,
+        None => return -2,
+    };
+
+    unsafe {
+        let voxels = width as usize * height as usize * depth as usize;
+        let rgba = slice::from_raw_parts(rgba, voxels * 4);
+        let out = slice::from_raw_parts_mut(out, out_len);
+        texture_status(write_texture(&TextureSource::Rgba(rgba), &layout, out))
+    }
+}
+
+/// Write an indexed volume (e.g. yx_proc_batch_rgba8 output: side×side×frames
+/// with a palette per frame) as `format`. YX_TEXTURE_RGBA8 resolves colors and
+/// box filters the mips; YX_TEXTURE_R8_INDEX keeps the indices, point samples
+/// the mips and, if `out_palette` is not NULL, writes the palette texture
+/// there (256 × palette_count RGBA8, 1024-byte rows; slice z uses row z, or
+/// row 0 when palette_count is 1). Returns 0 on success, negative on error
+#[no_mangle]
+pub extern "C" fn yx_texture_write_indexed(
+    indices: *const u8,         // width × height × depth, slices z-major
+    palettes: *const u32,       // 256 entries (0x00RRGGBB) per palette
+    palette_count: i32,         // 1 (shared) or depth (one per slice)
+    width: i32,
+    height: i32,
+    depth: i32,
+    format: i32,                // YX_TEXTURE_*
+    mip_levels: i32,
+    row_alignment: i32,
+    out: *mut u8,
+    out_len: usize,
+    out_palette: *mut u8,       // Optional, YX_TEXTURE_R8_INDEX only
+) -> i32 {
+    if indices.is_null() || palettes.is_null() || out.is_null() {
+        return -1;
+    }
+    if palette_count != 1 && palette_count != depth {
+        return -2;
+    }
+    let layout = match texture_layout(format, width, height, depth, mip_levels, row_alignment) {
+        Some(layout) => layout,
+        None => return -2,
+    };
+
+    unsafe {
+        let voxels = width as usize * height as usize * depth as usize;
+        let palette_count = palette_count as usize;
+        let palettes = slice::from_raw_parts(palettes, palette_count * PALETTE_ENTRIES);
+        let source = TextureSource::Indexed { indices: slice::from_raw_parts(indices, voxels), palettes, palette_count };
+        let out = slice::from_raw_parts_mut(out, out_len);
+        let status = texture_status(write_texture(&source, &layout, out));
+        if status != 0 || out_palette.is_null() || layout.format != TextureFormat::R8Index {
+            return status;
+        }
+
+        let palette_out = slice::from_raw_parts_mut(out_palette, palette_count * PALETTE_ENTRIES * 4);
+        texture_status(write_palette_texture(palettes, palette_count, palette_out))
+    }
+}
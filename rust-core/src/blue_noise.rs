@@ -1,12 +1,24 @@
 // Blue Noise Dithering - Superior to Floyd-Steinberg for animations
 // Provides more pleasant error distribution without directional artifacts
 
-use crate::Result;
+use rayon::prelude::*;
+use crate::palette_lookup::PaletteIndex;
 
 /// Pre-computed 64x64 blue noise matrix for high-quality dithering
 /// Values normalized to 0.0-1.0 range
 pub const BLUE_NOISE_64: [[f32; 64]; 64] = generate_blue_noise_matrix();
 
+/// The same matrix in fixed point, centered: 2·v − 255 for v in 0..=255
+/// Scaled by a Q8 strength and shifted right 9, it gives the byte offset
+/// (noise − 0.5) · strength · 255 without float math
+pub const BLUE_NOISE_CENTERED: [[i16; 64]; 64] = generate_centered_matrix();
+
+/// Rows per parallel task; each task recomputes only two luminance rows of halo
+const TILE_ROWS: usize = 16;
+
+/// Edge damping from the adaptive ditherer: strength · (1 − 0.7 · edge), 0.7 in Q8
+const EDGE_DAMPING_Q8: i32 = 179;
+
 /// Generate blue noise matrix at compile time
 const fn generate_blue_noise_matrix() -> [[f32; 64]; 64] {
     // Using a pre-computed void-and-cluster pattern
@@ -19,9 +31,7 @@ const fn generate_blue_noise_matrix() -> [[f32; 64]; 64] {
     while i < 64 {
         let mut j = 0;
         while j < 64 {
-            // Create a pseudo-random but well-distributed pattern
-            let val = ((i * 67 + j * 71) ^ ((i * 13) ^ (j * 17))) % 256;
-            matrix[i][j] = val as f32 / 255.0;
+            matrix[i][j] = noise_value(i, j) as f32 / 255.0;
             j += 1;
         }
         i += 1;
@@ -30,7 +40,27 @@ const fn generate_blue_noise_matrix() -> [[f32; 64]; 64] {
     matrix
 }
 
+const fn generate_centered_matrix() -> [[i16; 64]; 64] {
+    let mut matrix = [[0i16; 64]; 64];
+    let mut i = 0;
+    while i < 64 {
+        let mut j = 0;
+        while j < 64 {
+            matrix[i][j] = 2 * noise_value(i, j) as i16 - 255;
+            j += 1;
+        }
+        i += 1;
+    }
+    matrix
+}
+
+// Create a pseudo-random but well-distributed pattern
+const fn noise_value(i: usize, j: usize) -> usize {
+    ((i * 67 + j * 71) ^ ((i * 13) ^ (j * 17))) % 256
+}
+
 /// Apply blue noise dithering to an image
+/// One-off frames only: for a sequence, build a BlueNoise once per palette
 pub fn apply_blue_noise(
     pixels: &[u8],
     width: usize,
@@ -38,166 +68,72 @@ pub fn apply_blue_noise(
     palette: &[[u8; 4]],
     strength: f32,
 ) -> Vec<u8> {
-    let mut result = Vec::with_capacity(width * height);
-
-    for y in 0..height {
-        for x in 0..width {
-            let idx = (y * width + x) * 4;
-            let pixel = [
-                pixels[idx],
-                pixels[idx + 1],
-                pixels[idx + 2],
-                pixels[idx + 3],
-            ];
-
-            // Get blue noise threshold
-            let noise = BLUE_NOISE_64[y % 64][x % 64];
-
-            // Apply noise to pixel
-            let dithered = [
-                (pixel[0] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                (pixel[1] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                (pixel[2] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                pixel[3],
-            ];
-
-            // Find nearest palette color
-            let palette_idx = find_nearest_color(&dithered, palette);
-            result.push(palette_idx as u8);
+    BlueNoise::new(palette, strength).apply(pixels, width, height, 0)
+}
+
+/// Blue noise ditherer for one palette, reusable across frames
+/// The nearest-color index is built once here rather than once per frame
+pub struct BlueNoise {
+    index: PaletteIndex,
+    strength_q8: i32,
+}
+
+impl BlueNoise {
+    pub fn new(palette: &[[u8; 4]], strength: f32) -> Self {
+        Self {
+            index: PaletteIndex::from_rgba(palette),
+            strength_q8: strength_q8(strength),
         }
     }
 
-    result
-}
+    /// Dither one frame; `frame_index` rotates the pattern as in temporal_blue_noise
+    pub fn apply(&self, pixels: &[u8], width: usize, height: usize, frame_index: usize) -> Vec<u8> {
+        let mut result = vec![0u8; width * height];
+        self.apply_into(pixels, width, height, frame_index, &mut result);
+        result
+    }
 
-/// Find nearest color in palette using Euclidean distance in RGB space
-fn find_nearest_color(pixel: &[u8; 4], palette: &[[u8; 4]]) -> usize {
-    palette
-        .iter()
-        .enumerate()
-        .min_by_key(|(_, p)| {
-            let dr = pixel[0] as i32 - p[0] as i32;
-            let dg = pixel[1] as i32 - p[1] as i32;
-            let db = pixel[2] as i32 - p[2] as i32;
-            dr * dr + dg * dg + db * db
-        })
-        .map(|(idx, _)| idx)
-        .unwrap_or(0)
+    /// Dither one frame into `out` (width × height indices)
+    pub fn apply_into(&self, pixels: &[u8], width: usize, height: usize, frame_index: usize, out: &mut [u8]) {
+        dither_tiles(pixels, width, height, &self.index, self.strength_q8, false, temporal_offset(frame_index), out);
+    }
 }
 
 /// Adaptive blue noise with content-aware strength
+///
+/// Less dithering on edges (preserves detail), more on smooth areas (hides
+/// banding). Edge strength comes from a Sobel pass fused into the dither sweep:
+/// each row tile keeps a three-row window of integer luminance, so no edge map
+/// is materialized and every frame is one pass over the pixels.
 pub struct AdaptiveBlueNoise {
-    edge_map: Vec<f32>,
-    width: usize,
-    height: usize,
+    index: PaletteIndex,
+    strength_q8: i32,
 }
 
 impl AdaptiveBlueNoise {
-    /// Create adaptive blue noise ditherer with edge detection
-    pub fn new(pixels: &[u8], width: usize, height: usize) -> Self {
-        let edge_map = detect_edges(pixels, width, height);
+    /// Create an adaptive ditherer for one palette; reusable across frames
+    pub fn new(palette: &[[u8; 4]], base_strength: f32) -> Self {
         Self {
-            edge_map,
-            width,
-            height,
+            index: PaletteIndex::from_rgba(palette),
+            strength_q8: strength_q8(base_strength),
         }
     }
 
-    /// Apply adaptive blue noise - less dithering on edges, more on gradients
-    pub fn apply(
-        &self,
-        pixels: &[u8],
-        palette: &[[u8; 4]],
-        base_strength: f32,
-    ) -> Vec<u8> {
-        let mut result = Vec::with_capacity(self.width * self.height);
-
-        for y in 0..self.height {
-            for x in 0..self.width {
-                let idx = y * self.width + x;
-                let pixel_idx = idx * 4;
-                let pixel = [
-                    pixels[pixel_idx],
-                    pixels[pixel_idx + 1],
-                    pixels[pixel_idx + 2],
-                    pixels[pixel_idx + 3],
-                ];
-
-                // Adapt strength based on edge detection
-                // Less dithering on edges (preserves detail)
-                // More dithering on smooth areas (hides banding)
-                let edge_strength = self.edge_map[idx];
-                let strength = base_strength * (1.0 - edge_strength * 0.7);
-
-                // Get blue noise threshold
-                let noise = BLUE_NOISE_64[y % 64][x % 64];
-
-                // Apply adaptive noise
-                let dithered = [
-                    (pixel[0] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                    (pixel[1] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                    (pixel[2] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                    pixel[3],
-                ];
-
-                // Find nearest palette color
-                let palette_idx = find_nearest_color(&dithered, palette);
-                result.push(palette_idx as u8);
-            }
-        }
-
+    /// Dither one frame; `frame_index` rotates the pattern as in temporal_blue_noise
+    pub fn apply(&self, pixels: &[u8], width: usize, height: usize, frame_index: usize) -> Vec<u8> {
+        let mut result = vec![0u8; width * height];
+        self.apply_into(pixels, width, height, frame_index, &mut result);
         result
     }
-}
-
-/// Simple edge detection using Sobel operator
-fn detect_edges(pixels: &[u8], width: usize, height: usize) -> Vec<f32> {
-    let mut edges = vec![0.0; width * height];
-
-    for y in 1..height-1 {
-        for x in 1..width-1 {
-            // Sobel X kernel: [-1, 0, 1; -2, 0, 2; -1, 0, 1]
-            // Sobel Y kernel: [-1, -2, -1; 0, 0, 0; 1, 2, 1]
-
-            let mut gx = 0.0;
-            let mut gy = 0.0;
-
-            for dy in -1i32..=1 {
-                for dx in -1i32..=1 {
-                    let px = (x as i32 + dx) as usize;
-                    let py = (y as i32 + dy) as usize;
-                    let idx = (py * width + px) * 4;
-
-                    // Use luminance
-                    let lum = pixels[idx] as f32 * 0.299
-                            + pixels[idx + 1] as f32 * 0.587
-                            + pixels[idx + 2] as f32 * 0.114;
-
-                    // Sobel X
-                    if dx == -1 {
-                        gx -= lum * (1.0 + (dy == 0) as u8 as f32);
-                    } else if dx == 1 {
-                        gx += lum * (1.0 + (dy == 0) as u8 as f32);
-                    }
-
-                    // Sobel Y
-                    if dy == -1 {
-                        gy -= lum * (1.0 + (dx == 0) as u8 as f32);
-                    } else if dy == 1 {
-                        gy += lum * (1.0 + (dx == 0) as u8 as f32);
-                    }
-                }
-            }
 
-            let edge_strength = ((gx * gx + gy * gy).sqrt() / 255.0).min(1.0);
-            edges[y * width + x] = edge_strength;
-        }
+    /// Dither one frame into `out` (width × height indices)
+    pub fn apply_into(&self, pixels: &[u8], width: usize, height: usize, frame_index: usize, out: &mut [u8]) {
+        dither_tiles(pixels, width, height, &self.index, self.strength_q8, true, temporal_offset(frame_index), out);
     }
-
-    edges
 }
 
 /// Temporal blue noise for animations - rotates pattern to avoid static artifacts
+/// Builds the palette index per call; BlueNoise keeps it across frames
 pub fn temporal_blue_noise(
     pixels: &[u8],
     width: usize,
@@ -206,40 +142,214 @@ pub fn temporal_blue_noise(
     strength: f32,
     frame_index: usize,
 ) -> Vec<u8> {
-    let mut result = Vec::with_capacity(width * height);
-
-    // Rotate pattern based on frame index to prevent static patterns
-    let offset_x = (frame_index * 7) % 64;  // Prime numbers for good distribution
-    let offset_y = (frame_index * 11) % 64;
-
-    for y in 0..height {
-        for x in 0..width {
-            let idx = (y * width + x) * 4;
-            let pixel = [
-                pixels[idx],
-                pixels[idx + 1],
-                pixels[idx + 2],
-                pixels[idx + 3],
-            ];
-
-            // Get blue noise threshold with temporal offset
-            let noise_x = (x + offset_x) % 64;
-            let noise_y = (y + offset_y) % 64;
-            let noise = BLUE_NOISE_64[noise_y][noise_x];
-
-            // Apply noise to pixel
-            let dithered = [
-                (pixel[0] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                (pixel[1] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                (pixel[2] as f32 + (noise - 0.5) * strength * 255.0).clamp(0.0, 255.0) as u8,
-                pixel[3],
-            ];
-
-            // Find nearest palette color
-            let palette_idx = find_nearest_color(&dithered, palette);
-            result.push(palette_idx as u8);
+    BlueNoise::new(palette, strength).apply(pixels, width, height, frame_index)
+}
+
+/// Rotate pattern based on frame index to prevent static patterns
+fn temporal_offset(frame_index: usize) -> (usize, usize) {
+    ((frame_index * 7) % 64, (frame_index * 11) % 64) // Prime numbers for good distribution
+}
+
+fn strength_q8(strength: f32) -> i32 {
+    (strength * 256.0).round() as i32
+}
+
+// Integer luminance (R·77 + G·150 + B·29, i.e. 0.299/0.587/0.114 in Q8) for
+// the three rows around the one being dithered
+struct LumaWindow {
+    rows: [Vec<i32>; 3],
+}
+
+impl LumaWindow {
+    fn new(width: usize) -> Self {
+        Self { rows: [vec![0; width], vec![0; width], vec![0; width]] }
+    }
+
+    fn load(&mut self, pixels: &[u8], width: usize, y: usize) {
+        let row = &pixels[y * width * 4..(y + 1) * width * 4];
+        for (l, p) in self.rows[y % 3].iter_mut().zip(row.chunks_exact(4)) {
+            *l = p[0] as i32 * 77 + p[1] as i32 * 150 + p[2] as i32 * 29;
+        }
+    }
+
+    // Sobel magnitude at (x, y) as edge strength in Q8 (0..=256)
+    #[inline(always)]
+    fn edge_q8(&self, x: usize, y: usize) -> i32 {
+        let (up, mid, down) = (&self.rows[(y + 2) % 3], &self.rows[y % 3], &self.rows[(y + 1) % 3]);
+        let gx = (up[x + 1] - up[x - 1]) + 2 * (mid[x + 1] - mid[x - 1]) + (down[x + 1] - down[x - 1]);
+        let gy = (down[x - 1] + 2 * down[x] + down[x + 1]) - (up[x - 1] + 2 * up[x] + up[x + 1]);
+        // |g| is luminance × 256, so |g| / 255 is the float edge strength in Q8
+        let magnitude = ((gx as i64 * gx as i64 + gy as i64 * gy as i64) as f32).sqrt();
+        ((magnitude / 255.0) as i32).min(256)
+    }
+}
+
+// Fused dither kernel, parallel over TILE_ROWS-row tiles
+// When adaptive, each task keeps a luminance window and the strength adapts per
+// pixel; border pixels count as edge-free, like the old full-frame Sobel pass
+#[allow(clippy::too_many_arguments)]
+fn dither_tiles(
+    pixels: &[u8],
+    width: usize,
+    height: usize,
+    index: &PaletteIndex,
+    strength_q8: i32,
+    adaptive: bool,
+    (offset_x, offset_y): (usize, usize),
+    out: &mut [u8],
+) {
+    if width == 0 || height == 0 {
+        return;
+    }
+    out[..width * height]
+        .par_chunks_mut(width * TILE_ROWS)
+        .enumerate()
+        .for_each_init(|| adaptive.then(|| LumaWindow::new(width)), |luma, (tile, out_tile)| {
+            let y0 = tile * TILE_ROWS;
+            if let Some(window) = luma.as_mut() {
+                for y in y0.saturating_sub(1)..(y0 + 1).min(height) {
+                    window.load(pixels, width, y);
+                }
+            }
+
+            for (row, out_row) in out_tile.chunks_exact_mut(width).enumerate() {
+                let y = y0 + row;
+                let interior = y > 0 && y + 1 < height;
+                if let Some(window) = luma.as_mut() {
+                    if y + 1 < height {
+                        window.load(pixels, width, y + 1);
+                    }
+                }
+
+                let noise_row = &BLUE_NOISE_CENTERED[(y + offset_y) % 64];
+                let pixel_row = &pixels[y * width * 4..(y + 1) * width * 4];
+                for (x, (out, p)) in out_row.iter_mut().zip(pixel_row.chunks_exact(4)).enumerate() {
+                    let strength = match luma.as_ref() {
+                        Some(window) if interior && x > 0 && x + 1 < width => {
+                            strength_q8 * (256 - ((EDGE_DAMPING_Q8 * window.edge_q8(x, y)) >> 8)) >> 8
+                        }
+                        _ => strength_q8,
+                    };
+                    let offset = (noise_row[(x + offset_x) % 64] as i32 * strength) >> 9;
+                    let dithered = [
+                        (p[0] as i32 + offset).clamp(0, 255) as u8,
+                        (p[1] as i32 + offset).clamp(0, 255) as u8,
+                        (p[2] as i32 + offset).clamp(0, 255) as u8,
+                    ];
+                    *out = index.nearest_rgb(&dithered) as u8;
+                }
+            }
+        });
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Every grey level, so the palette index of a grey pixel is its dithered value
+    fn grey_palette() -> Vec<[u8; 4]> {
+        (0..=255u8).map(|v| [v, v, v, 255]).collect()
+    }
+
+    /// Grey ramp with a hard vertical edge down the middle
+    fn test_frame(width: usize, height: usize) -> Vec<u8> {
+        let mut pixels = Vec::with_capacity(width * height * 4);
+        for y in 0..height {
+            for x in 0..width {
+                let v = if x < width / 2 { (x + y) as u8 / 2 } else { 200 };
+                pixels.extend_from_slice(&[v, v, v, 255]);
+            }
+        }
+        pixels
+    }
+
+    /// The original float implementation: full Sobel edge map, then dither
+    fn adaptive_reference(pixels: &[u8], width: usize, height: usize, strength: f32) -> Vec<u8> {
+        let lum = |x: usize, y: usize| {
+            let p = &pixels[(y * width + x) * 4..];
+            p[0] as f32 * 0.299 + p[1] as f32 * 0.587 + p[2] as f32 * 0.114
+        };
+        let mut out = Vec::with_capacity(width * height);
+        for y in 0..height {
+            for x in 0..width {
+                let mut edge = 0.0f32;
+                if x > 0 && y > 0 && x + 1 < width && y + 1 < height {
+                    let gx = lum(x + 1, y - 1) - lum(x - 1, y - 1) + 2.0 * (lum(x + 1, y) - lum(x - 1, y)) + lum(x + 1, y + 1) - lum(x - 1, y + 1);
+                    let gy = lum(x - 1, y + 1) + 2.0 * lum(x, y + 1) + lum(x + 1, y + 1) - lum(x - 1, y - 1) - 2.0 * lum(x, y - 1) - lum(x + 1, y - 1);
+                    edge = ((gx * gx + gy * gy).sqrt() / 255.0).min(1.0);
+                }
+                let s = strength * (1.0 - edge * 0.7);
+                let noise = BLUE_NOISE_64[y % 64][x % 64];
+                let v = pixels[(y * width + x) * 4] as f32;
+                out.push((v + (noise - 0.5) * s * 255.0).clamp(0.0, 255.0) as u8);
+            }
+        }
+        out
+    }
+
+    #[test]
+    fn test_centered_matrix_matches_float() {
+        for y in 0..64 {
+            for x in 0..64 {
+                let expected = (BLUE_NOISE_64[y][x] - 0.5) * 2.0 * 255.0;
+                assert!((BLUE_NOISE_CENTERED[y][x] as f32 - expected).abs() < 1e-3);
+            }
+        }
+    }
+
+    #[test]
+    fn test_adaptive_matches_float_reference() {
+        // Height spans several tiles, with a partial last tile
+        let (width, height) = (70, 3 * TILE_ROWS + 5);
+        let pixels = test_frame(width, height);
+        let dither = AdaptiveBlueNoise::new(&grey_palette(), 0.3);
+
+        let fused = dither.apply(&pixels, width, height, 0);
+        let reference = adaptive_reference(&pixels, width, height, 0.3);
+        for (i, (&a, &b)) in fused.iter().zip(&reference).enumerate() {
+            assert!((a as i32 - b as i32).abs() <= 1, "pixel {}: {} vs {}", i, a, b);
         }
     }
 
-    result
-}
\ No newline at end of file
+    #[test]
+    fn test_edges_are_dithered_less() {
+        let (width, height) = (64, 40);
+        let pixels = test_frame(width, height);
+        let dither = AdaptiveBlueNoise::new(&grey_palette(), 0.5);
+        let out = dither.apply(&pixels, width, height, 3);
+
+        let deviation = |x: usize| -> i32 {
+            (1..height - 1).map(|y| (out[y * width + x] as i32 - pixels[(y * width + x) * 4] as i32).abs()).sum()
+        };
+        // Column width / 2 - 1 sits on the edge; width / 2 + 8 is flat
+        assert!(deviation(width / 2 - 1) < deviation(width / 2 + 8));
+    }
+
+    #[test]
+    fn test_zero_strength_is_nearest_color() {
+        let (width, height) = (33, 21);
+        let pixels = test_frame(width, height);
+        let palette = [[0, 0, 0, 255], [100, 100, 100, 255], [210, 210, 210, 255]];
+        let index = PaletteIndex::from_rgba(&palette);
+        let expected: Vec<u8> = pixels.chunks_exact(4).map(|p| index.nearest_rgb(p) as u8).collect();
+
+        assert_eq!(apply_blue_noise(&pixels, width, height, &palette, 0.0), expected);
+        assert_eq!(temporal_blue_noise(&pixels, width, height, &palette, 0.0, 5), expected);
+        assert_eq!(AdaptiveBlueNoise::new(&palette, 0.0).apply(&pixels, width, height, 5), expected);
+    }
+
+    #[test]
+    fn test_reused_ditherer_matches_one_off_calls() {
+        let (width, height) = (40, TILE_ROWS + 3);
+        let pixels = test_frame(width, height);
+        let palette = grey_palette();
+        let dither = BlueNoise::new(&palette, 0.4);
+
+        let mut out = vec![0u8; width * height];
+        for frame_index in 0..4 {
+            dither.apply_into(&pixels, width, height, frame_index, &mut out);
+            assert_eq!(out, temporal_blue_noise(&pixels, width, height, &palette, 0.4, frame_index));
+        }
+        assert_eq!(dither.apply(&pixels, width, height, 0), apply_blue_noise(&pixels, width, height, &palette, 0.4));
+    }
+}
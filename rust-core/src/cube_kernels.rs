@@ -0,0 +1,151 @@
+// Kernels specialized for the fixed cube sizes
+// Clips arrive at a handful of square sizes: 132 from the batch path, 128 for the
+// voxel tensor, 256 for full-size GIFs. Instantiating the per-pixel loops with the
+// side as a const generic gives them constant strides, trip counts and edge
+// tests, so they unroll and vectorize. Every other size runs the same code with
+// runtime dimensions, so results never depend on which kernel was picked.
+
+use crate::oklab_quantization::{sierra_remap, OklabColor};
+use crate::palette_lookup::PaletteIndex;
+
+/// Side of the voxel tensor
+pub const TENSOR_SIDE: usize = 128;
+
+/// Nearest resample of a frame (RGBA or index plane) to TENSOR_SIDE²
+pub type ResampleFn = fn(src: &[u8], width: usize, height: usize, dst: &mut [u8]);
+
+/// Error-diffusion remap, as oklab_quantization::sierra_remap
+pub type OklabRemapFn = fn(&[OklabColor], &[OklabColor], &PaletteIndex, &mut [f32], usize, usize, &mut [u8]);
+
+/// Kernels for one source frame size
+pub struct Kernels {
+    pub side: usize,                  // Square side baked in, 0 for the runtime fallback
+    pub resample_rgba: ResampleFn,
+    pub resample_indices: ResampleFn,
+    pub remap_oklab: OklabRemapFn,
+}
+
+const fn kernels<const S: usize>() -> Kernels {
+    Kernels {
+        side: S,
+        resample_rgba: resample_nearest::<4, S, TENSOR_SIDE>,
+        resample_indices: resample_nearest::<1, S, TENSOR_SIDE>,
+        remap_oklab: sierra_remap::<S>,
+    }
+}
+
+/// Dispatch table, one entry per specialized side
+static KERNELS: [Kernels; 3] = [kernels::<128>(), kernels::<132>(), kernels::<256>()];
+
+static RUNTIME_KERNELS: Kernels = kernels::<0>();
+
+/// Kernels for `width` × `height` frames
+pub fn kernels_for(width: usize, height: usize) -> &'static Kernels {
+    if width == height {
+        if let Some(kernels) = KERNELS.iter().find(|k| k.side == width) {
+            return kernels;
+        }
+    }
+    &RUNTIME_KERNELS
+}
+
+/// Nearest-neighbour resample of a C-channel frame to D×D
+///
+/// The source pixel for output x is floor(x · width / D), in integers; for D = 128
+/// that is exactly what the old f32 mapping picked. S is the square source side
+/// when known at compile time (0 = runtime `width` × `height`), which turns the
+/// column table into a constant.
+pub fn resample_nearest<const C: usize, const S: usize, const D: usize>(
+    src: &[u8],
+    width: usize,
+    height: usize,
+    dst: &mut [u8],
+) {
+    let (width, height) = if S == 0 { (width, height) } else { (S, S) };
+    let row_bytes = width * C;
+
+    let mut src_x = [0usize; D];
+    for (x, sx) in src_x.iter_mut().enumerate() {
+        *sx = x * width / D * C;
+    }
+
+    for (y, dst_row) in dst[..D * D * C].chunks_exact_mut(D * C).enumerate() {
+        let sy = y * height / D;
+        let src_row = &src[sy * row_bytes..][..row_bytes];
+        for (dst_px, &sx) in dst_row.chunks_exact_mut(C).zip(&src_x) {
+            dst_px.copy_from_slice(&src_row[sx..sx + C]);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::oklab_quantization::{oklab_palette_index, srgb_to_oklab_batch};
+
+    fn test_frame(width: usize, height: usize, channels: usize) -> Vec<u8> {
+        (0..width * height * channels).map(|i| (i * 7 + i / 13) as u8).collect()
+    }
+
+    #[test]
+    fn test_dispatch_picks_specialized_sides() {
+        assert_eq!(kernels_for(128, 128).side, 128);
+        assert_eq!(kernels_for(132, 132).side, 132);
+        assert_eq!(kernels_for(256, 256).side, 256);
+        assert_eq!(kernels_for(256, 128).side, 0);
+        assert_eq!(kernels_for(200, 200).side, 0);
+    }
+
+    #[test]
+    fn test_specialized_resample_matches_runtime() {
+        for side in [128, 132, 256] {
+            let rgba = test_frame(side, side, 4);
+            let (mut fast, mut slow) = (vec![0u8; TENSOR_SIDE * TENSOR_SIDE * 4], vec![1u8; TENSOR_SIDE * TENSOR_SIDE * 4]);
+            (kernels_for(side, side).resample_rgba)(&rgba, side, side, &mut fast);
+            (RUNTIME_KERNELS.resample_rgba)(&rgba, side, side, &mut slow);
+            assert_eq!(fast, slow);
+
+            let plane = test_frame(side, side, 1);
+            let (mut fast, mut slow) = (vec![0u8; TENSOR_SIDE * TENSOR_SIDE], vec![1u8; TENSOR_SIDE * TENSOR_SIDE]);
+            (kernels_for(side, side).resample_indices)(&plane, side, side, &mut fast);
+            (RUNTIME_KERNELS.resample_indices)(&plane, side, side, &mut slow);
+            assert_eq!(fast, slow);
+        }
+    }
+
+    #[test]
+    fn test_resample_matches_float_mapping() {
+        let (width, height) = (300usize, 170usize);
+        let frame = test_frame(width, height, 4);
+        let mut tensor = vec![0u8; TENSOR_SIDE * TENSOR_SIDE * 4];
+        (kernels_for(width, height).resample_rgba)(&frame, width, height, &mut tensor);
+
+        for y in 0..TENSOR_SIDE {
+            for x in 0..TENSOR_SIDE {
+                let src_x = (x as f32 * width as f32 / 128.0) as usize;
+                let src_y = (y as f32 * height as f32 / 128.0) as usize;
+                let src = (src_y * width + src_x) * 4;
+                let dst = (y * TENSOR_SIDE + x) * 4;
+                assert_eq!(tensor[dst..dst + 4], frame[src..src + 4]);
+            }
+        }
+    }
+
+    #[test]
+    fn test_specialized_remap_matches_runtime() {
+        let side = 132;
+        let pixels = srgb_to_oklab_batch(&test_frame(side, side, 4));
+        let palette = srgb_to_oklab_batch(&test_frame(4, 4, 4));
+        let index = oklab_palette_index(&palette);
+
+        let mut run = |remap: OklabRemapFn| {
+            let mut errors = vec![0f32; side * side * 3];
+            let mut indices = vec![0u8; side * side];
+            remap(&pixels, &palette, &index, &mut errors, side, side, &mut indices);
+            (indices, errors)
+        };
+        let (fast, slow) = (run(kernels_for(side, side).remap_oklab), run(RUNTIME_KERNELS.remap_oklab));
+        assert_eq!(fast.0, slow.0);
+        assert_eq!(fast.1, slow.1);
+    }
+}
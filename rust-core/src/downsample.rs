@@ -0,0 +1,343 @@
+// Area-average downsampler for 4-channel camera frames
+// Box filter for integer and near-integer ratios (1080 -> 256/128), much cheaper than Lanczos3
+//
+// Self-contained (std only) so rust-ios-ffi can include it with #[path]
+
+/// Resize filter selectable per FFI call
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ResizeFilter {
+    Lanczos3 = 0, // image::imageops Lanczos3 (highest quality)
+    Area = 1,     // Area average (box) - fast path for large reduction ratios
+}
+
+impl ResizeFilter {
+    /// Map the C ABI value; unknown values are rejected
+    pub fn from_raw(value: i32) -> Option<Self> {
+        match value {
+            0 => Some(ResizeFilter::Lanczos3),
+            1 => Some(ResizeFilter::Area),
+            _ => None,
+        }
+    }
+}
+
+/// Box heights above this could overflow the u16 row accumulator (257 * 255 = 65535)
+const MAX_U16_BOX_HEIGHT: usize = 257;
+
+/// Working buffers for downsample_area_with, reusable across frames
+///
+/// They grow to the largest frame seen and are never shrunk, so a caller that
+/// keeps one per stream does no heap allocation per same-sized frame.
+#[derive(Debug, Default)]
+pub struct AreaScratch {
+    col_edges: Vec<usize>, // Horizontal box edges (dst_width + 1)
+    acc16: Vec<u16>,       // Vertical sums for boxes up to MAX_U16_BOX_HEIGHT rows
+    acc32: Vec<u32>,       // Vertical sums for taller boxes
+}
+
+impl AreaScratch {
+    /// Bytes currently reserved by the buffers
+    pub fn reserved_bytes(&self) -> usize {
+        self.col_edges.capacity() * std::mem::size_of::<usize>()
+            + self.acc16.capacity() * std::mem::size_of::<u16>()
+            + self.acc32.capacity() * std::mem::size_of::<u32>()
+    }
+}
+
+/// Downsample 4-channel pixels by averaging every source pixel that falls in each output box
+///
+/// Channel order is untouched, so BGRA and RGBA input can be passed directly.
+/// Box edges are `floor(o * src / dst)`, so box sizes differ by at most one pixel
+/// for non-integer ratios. Returns false (leaving `dst` untouched) if the target is
+/// larger than the source or a buffer is too small.
+pub fn downsample_area_into(
+    src: &[u8],
+    src_width: usize,
+    src_height: usize,
+    src_stride: usize, // bytes per source row (>= src_width * 4)
+    dst: &mut [u8],
+    dst_width: usize,
+    dst_height: usize,
+) -> bool {
+    let mut scratch = AreaScratch::default();
+    downsample_area_with(src, src_width, src_height, src_stride, dst, dst_width, dst_height, &mut scratch)
+}
+
+/// downsample_area_into with caller-owned working buffers
+#[allow(clippy::too_many_arguments)]
+pub fn downsample_area_with(
+    src: &[u8],
+    src_width: usize,
+    src_height: usize,
+    src_stride: usize,
+    dst: &mut [u8],
+    dst_width: usize,
+    dst_height: usize,
+    scratch: &mut AreaScratch,
+) -> bool {
+    if dst_width == 0 || dst_height == 0 || dst_width > src_width || dst_height > src_height {
+        return false;
+    }
+    if src_stride < src_width * 4
+        || src.len() < src_stride * (src_height - 1) + src_width * 4
+        || dst.len() < dst_width * dst_height * 4
+    {
+        return false;
+    }
+
+    let row_bytes = src_width * 4;
+    let max_box_height = (src_height + dst_height - 1) / dst_height;
+
+    // Horizontal box edges are the same for every output row
+    let col_edges = &mut scratch.col_edges;
+    col_edges.clear();
+    col_edges.extend((0..=dst_width).map(|ox| ox * src_width / dst_width));
+
+    if max_box_height > MAX_U16_BOX_HEIGHT {
+        let acc = &mut scratch.acc32;
+        acc.resize(row_bytes, 0);
+        let acc = &mut acc[..row_bytes];
+        for oy in 0..dst_height {
+            let (y0, y1) = (oy * src_height / dst_height, (oy + 1) * src_height / dst_height);
+            acc.iter_mut().for_each(|a| *a = 0);
+            for sy in y0..y1 {
+                let row = &src[sy * src_stride..sy * src_stride + row_bytes];
+                for (a, &b) in acc.iter_mut().zip(row) {
+                    *a += b as u32;
+                }
+            }
+            let out_row = &mut dst[oy * dst_width * 4..(oy + 1) * dst_width * 4];
+            reduce_columns(acc, col_edges, y1 - y0, out_row);
+        }
+        return true;
+    }
+
+    // Vertical pass: sum the box's source rows byte-wise into u16 lanes (SIMD),
+    // then horizontal pass: sum each column span and divide by the box area
+    let acc = &mut scratch.acc16;
+    acc.resize(row_bytes, 0);
+    let acc = &mut acc[..row_bytes];
+    for oy in 0..dst_height {
+        let (y0, y1) = (oy * src_height / dst_height, (oy + 1) * src_height / dst_height);
+        acc.iter_mut().for_each(|a| *a = 0);
+        for sy in y0..y1 {
+            accumulate_row(acc, &src[sy * src_stride..sy * src_stride + row_bytes]);
+        }
+        let out_row = &mut dst[oy * dst_width * 4..(oy + 1) * dst_width * 4];
+        reduce_columns(acc, col_edges, y1 - y0, out_row);
+    }
+
+    true
+}
+
+/// Allocating wrapper around `downsample_area_into` for tightly packed frames
+pub fn downsample_area(
+    src: &[u8],
+    src_width: usize,
+    src_height: usize,
+    dst_width: usize,
+    dst_height: usize,
+) -> Option<Vec<u8>> {
+    let mut dst = vec![0u8; dst_width * dst_height * 4];
+    if downsample_area_into(src, src_width, src_height, src_width * 4, &mut dst, dst_width, dst_height) {
+        Some(dst)
+    } else {
+        None
+    }
+}
+
+/// Sum each output box's column span per channel and write the rounded average
+#[inline]
+fn reduce_columns<T: Copy + Into<u32>>(acc: &[T], col_edges: &[usize], box_height: usize, out_row: &mut [u8]) {
+    for (ox, out_px) in out_row.chunks_exact_mut(4).enumerate() {
+        let (x0, x1) = (col_edges[ox], col_edges[ox + 1]);
+        let area = ((x1 - x0) * box_height) as u32;
+
+        let mut sum = [0u32; 4];
+        for px in acc[x0 * 4..x1 * 4].chunks_exact(4) {
+            sum[0] += px[0].into();
+            sum[1] += px[1].into();
+            sum[2] += px[2].into();
+            sum[3] += px[3].into();
+        }
+
+        for c in 0..4 {
+            out_px[c] = ((sum[c] + area / 2) / area) as u8;
+        }
+    }
+}
+
+/// acc[i] += row[i] for every byte of a source row
+#[inline]
+fn accumulate_row(acc: &mut [u16], row: &[u8]) {
+    #[cfg(target_arch = "aarch64")]
+    unsafe {
+        accumulate_row_neon(acc, row)
+    }
+
+    #[cfg(target_arch = "x86_64")]
+    unsafe {
+        accumulate_row_sse2(acc, row)
+    }
+
+    #[cfg(not(any(target_arch = "aarch64", target_arch = "x86_64")))]
+    accumulate_row_scalar(acc, row)
+}
+
+#[inline]
+#[allow(dead_code)]
+fn accumulate_row_scalar(acc: &mut [u16], row: &[u8]) {
+    for (a, &b) in acc.iter_mut().zip(row) {
+        *a += b as u16;
+    }
+}
+
+/// NEON kernel: 16 bytes per iteration, widened u8 -> u16 adds (NEON is baseline on arm64)
+#[cfg(target_arch = "aarch64")]
+unsafe fn accumulate_row_neon(acc: &mut [u16], row: &[u8]) {
+    use std::arch::aarch64::*;
+
+    let n = acc.len().min(row.len());
+    let mut i = 0;
+    while i + 16 <= n {
+        let v = vld1q_u8(row.as_ptr().add(i));
+        let lo = vld1q_u16(acc.as_ptr().add(i));
+        let hi = vld1q_u16(acc.as_ptr().add(i + 8));
+        vst1q_u16(acc.as_mut_ptr().add(i), vaddw_u8(lo, vget_low_u8(v)));
+        vst1q_u16(acc.as_mut_ptr().add(i + 8), vaddw_high_u8(hi, v));
+        i += 16;
+    }
+    accumulate_row_scalar(&mut acc[i..n], &row[i..n]);
+}
+
+/// SSE2 kernel: 16 bytes per iteration, unpacked against zero and added as u16 (SSE2 is baseline on x86_64)
+#[cfg(target_arch = "x86_64")]
+unsafe fn accumulate_row_sse2(acc: &mut [u16], row: &[u8]) {
+    use std::arch::x86_64::*;
+
+    let n = acc.len().min(row.len());
+    let zero = _mm_setzero_si128();
+    let mut i = 0;
+    while i + 16 <= n {
+        let v = _mm_loadu_si128(row.as_ptr().add(i) as *const __m128i);
+        let lo = _mm_loadu_si128(acc.as_ptr().add(i) as *const __m128i);
+        let hi = _mm_loadu_si128(acc.as_ptr().add(i + 8) as *const __m128i);
+        _mm_storeu_si128(acc.as_mut_ptr().add(i) as *mut __m128i, _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero)));
+        _mm_storeu_si128(acc.as_mut_ptr().add(i + 8) as *mut __m128i, _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero)));
+        i += 16;
+    }
+    accumulate_row_scalar(&mut acc[i..n], &row[i..n]);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::alloc::{GlobalAlloc, Layout, System};
+    use std::cell::Cell;
+
+    /// System allocator that counts allocations per thread, so parallel tests don't interfere
+    struct CountingAlloc;
+
+    thread_local! {
+        static ALLOCATIONS: Cell<usize> = const { Cell::new(0) };
+    }
+
+    unsafe impl GlobalAlloc for CountingAlloc {
+        unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+            let _ = ALLOCATIONS.try_with(|n| n.set(n.get() + 1));
+            System.alloc(layout)
+        }
+
+        unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+            System.dealloc(ptr, layout)
+        }
+    }
+
+    #[global_allocator]
+    static ALLOCATOR: CountingAlloc = CountingAlloc;
+
+    fn allocations() -> usize {
+        ALLOCATIONS.with(|n| n.get())
+    }
+
+    #[test]
+    fn test_filter_from_raw() {
+        assert_eq!(ResizeFilter::from_raw(0), Some(ResizeFilter::Lanczos3));
+        assert_eq!(ResizeFilter::from_raw(1), Some(ResizeFilter::Area));
+        assert_eq!(ResizeFilter::from_raw(7), None);
+    }
+
+    #[test]
+    fn test_integer_ratio_average() {
+        // 4x2 -> 2x1: each output pixel averages a 2x2 block
+        let src: Vec<u8> = vec![
+            0, 10, 20, 255,   4, 14, 24, 255,   100, 0, 0, 255,   100, 0, 0, 255,
+            8, 18, 28, 255,  12, 22, 32, 255,   200, 0, 0, 255,   200, 0, 0, 255,
+        ];
+        let out = downsample_area(&src, 4, 2, 2, 1).unwrap();
+        assert_eq!(out, vec![6, 16, 26, 255, 150, 0, 0, 255]);
+    }
+
+    #[test]
+    fn test_near_integer_ratio_preserves_flat_color() {
+        // 1080 -> 256 is a 4.22:1 ratio; a flat frame must stay flat
+        let src: Vec<u8> = [30u8, 60, 90, 255].repeat(1080 * 1080);
+        let out = downsample_area(&src, 1080, 1080, 256, 256).unwrap();
+        assert_eq!(out.len(), 256 * 256 * 4);
+        assert!(out.chunks_exact(4).all(|px| px == [30, 60, 90, 255]));
+    }
+
+    #[test]
+    fn test_simd_matches_scalar() {
+        let row: Vec<u8> = (0..1000).map(|i| (i * 37 % 256) as u8).collect();
+        let mut simd = vec![7u16; 1000];
+        let mut scalar = vec![7u16; 1000];
+        accumulate_row(&mut simd, &row);
+        accumulate_row_scalar(&mut scalar, &row);
+        assert_eq!(simd, scalar);
+    }
+
+    #[test]
+    fn test_stride_and_invalid_sizes() {
+        // 2x2 frame with 4 bytes of row padding
+        let src: Vec<u8> = vec![
+            10, 10, 10, 10,  30, 30, 30, 30,  99, 99, 99, 99,
+            50, 50, 50, 50,  70, 70, 70, 70,  99, 99, 99, 99,
+        ];
+        let mut dst = [0u8; 4];
+        assert!(downsample_area_into(&src, 2, 2, 12, &mut dst, 1, 1));
+        assert_eq!(dst, [40, 40, 40, 40]);
+
+        // Upscaling is not an area-average operation
+        assert!(downsample_area(&src, 2, 2, 4, 4).is_none());
+    }
+
+    #[test]
+    fn test_scratch_reuse_is_allocation_free() {
+        let src: Vec<u8> = (0..1080 * 1080 * 4).map(|i| (i * 13 % 256) as u8).collect();
+        let expected = downsample_area(&src, 1080, 1080, 128, 128).unwrap();
+
+        let mut scratch = AreaScratch::default();
+        let mut dst = vec![0u8; 128 * 128 * 4];
+        assert!(downsample_area_with(&src, 1080, 1080, 1080 * 4, &mut dst, 128, 128, &mut scratch));
+        assert_eq!(dst, expected);
+        let reserved = scratch.reserved_bytes();
+        assert!(reserved >= 1080 * 4 * 2);
+
+        // Steady state: same-sized frames reuse every buffer
+        let before = allocations();
+        for _ in 0..3 {
+            assert!(downsample_area_with(&src, 1080, 1080, 1080 * 4, &mut dst, 128, 128, &mut scratch));
+        }
+        assert_eq!(allocations(), before);
+        assert_eq!(scratch.reserved_bytes(), reserved);
+        assert_eq!(dst, expected);
+
+        // Boxes taller than the u16 accumulator allows take the u32 path;
+        // leftover contents from the larger frame must not leak in
+        let tall: Vec<u8> = (0..4 * 600 * 4).map(|i| (i % 7 * 30) as u8).collect();
+        dst.fill(0);
+        assert!(downsample_area_with(&tall, 4, 600, 16, &mut dst, 2, 2, &mut scratch));
+        assert_eq!(dst[..16], downsample_area(&tall, 4, 600, 2, 2).unwrap()[..]);
+    }
+}
@@ -1,9 +1,13 @@
 // GIF89a encoder module using the gif crate
 // Produces standard GIF files with loop extension and optimized palettes
 
+use std::borrow::Cow;
+use std::io::Write;
 use gif::{Encoder, Frame, Repeat};
+use rayon::prelude::*;
 use crate::{ProcessorError, Result};
 use crate::quantization::QuantizeResult;
+use crate::gif_optimize::{delta_frame, unused_index};
 
 pub struct GifOptions {
     pub width: u16,
@@ -11,7 +15,8 @@ pub struct GifOptions {
     pub frame_count: u16,
     pub fps: u16,           // Frames per second
     pub loop_count: u16,    // 0 = infinite
-    pub optimize: bool,     // Apply optimization passes
+    pub optimize: bool,     // Crop frames to changed rectangles with transparent unchanged pixels
+    pub parallel: bool,     // LZW-compress frames on all cores (byte-identical output)
 }
 
 impl Default for GifOptions {
@@ -23,6 +28,7 @@ impl Default for GifOptions {
             fps: 30,
             loop_count: 0,  // Infinite loop
             optimize: true,
+            parallel: true,
         }
     }
 }
@@ -33,17 +39,13 @@ pub fn encode_gif(
     options: &GifOptions,
 ) -> Result<Vec<u8>> {
     if quantized_frames.is_empty() {
-        return Err(ProcessorError::InvalidInput("No frames to encode".into()));
+        return Err(ProcessorError::InvalidInput);
     }
 
     // Validate dimensions
     let first_frame = &quantized_frames[0];
     if first_frame.width != options.width as u32 || first_frame.height != options.height as u32 {
-        return Err(ProcessorError::InvalidInput(
-            format!("Frame dimensions {}x{} don't match options {}x{}",
-                    first_frame.width, first_frame.height,
-                    options.width, options.height)
-        ));
+        return Err(ProcessorError::InvalidInput);
     }
 
     // Prepare output buffer
@@ -61,11 +63,6 @@ pub fn encode_gif(
         encode_with_local_palettes(&quantized_frames, options, delay_cs, &mut output)?;
     }
 
-    if options.optimize {
-        // Could apply additional optimization passes here
-        // For now, we rely on the gif crate's built-in optimizations
-    }
-
     Ok(output)
 }
 
@@ -100,7 +97,7 @@ fn encode_with_global_palette(
 
     // Create encoder with global palette
     let mut encoder = Encoder::new(output, options.width, options.height, &palette_rgb)
-        .map_err(|e| ProcessorError::EncodingError(format!("Failed to create encoder: {}", e)))?;
+        .map_err(|_| ProcessorError::EncodingError)?;
 
     // Set loop extension
     let repeat = if options.loop_count == 0 {
@@ -109,28 +106,11 @@ fn encode_with_global_palette(
         Repeat::Finite(options.loop_count)
     };
 
-    encoder.write_extension(gif::ExtensionData::Repetitions(repeat))
-        .map_err(|e| ProcessorError::EncodingError(format!("Failed to set loop: {}", e)))?;
-
-    // Write frames
-    for (idx, quantized) in frames.iter().enumerate() {
-        let mut frame = Frame::from_indexed_pixels(
-            options.width,
-            options.height,
-            quantized.indices.clone(),
-            None,  // Use global palette
-        );
-
-        frame.delay = delay_cs;
-        frame.dispose = gif::DisposalMethod::Keep;
-
-        encoder.write_frame(&frame)
-            .map_err(|e| ProcessorError::EncodingError(
-                format!("Failed to write frame {}: {}", idx, e)
-            ))?;
-    }
+    encoder.set_repeat(repeat)
+        .map_err(|_| ProcessorError::EncodingError)?;
 
-    Ok(())
+    // Write frames (global palette)
+    write_frames(&mut encoder, frames, options, delay_cs, padded_size)
 }
 
 /// Encode with per-frame local palettes (better quality, larger file)
@@ -162,7 +142,7 @@ fn encode_with_local_palettes(
     }
 
     let mut encoder = Encoder::new(output, options.width, options.height, &palette_rgb)
-        .map_err(|e| ProcessorError::EncodingError(format!("Failed to create encoder: {}", e)))?;
+        .map_err(|_| ProcessorError::EncodingError)?;
 
     // Set loop extension
     let repeat = if options.loop_count == 0 {
@@ -171,48 +151,81 @@ fn encode_with_local_palettes(
         Repeat::Finite(options.loop_count)
     };
 
-    encoder.write_extension(gif::ExtensionData::Repetitions(repeat))
-        .map_err(|e| ProcessorError::EncodingError(format!("Failed to set loop: {}", e)))?;
+    encoder.set_repeat(repeat)
+        .map_err(|_| ProcessorError::EncodingError)?;
 
     // Write frames with local palettes
-    for (idx, quantized) in frames.iter().enumerate() {
-        // Prepare local palette
-        let mut local_palette_rgb = Vec::with_capacity(quantized.palette.len() * 3);
-        for color in &quantized.palette {
-            let r = (color >> 24) as u8;
-            let g = (color >> 16) as u8;
-            let b = (color >> 8) as u8;
-            local_palette_rgb.push(r);
-            local_palette_rgb.push(g);
-            local_palette_rgb.push(b);
-        }
-
-        // Pad local palette
-        let local_bits = (quantized.palette.len() as f32).log2().ceil() as usize;
-        let local_padded = 1 << local_bits;
-        while local_palette_rgb.len() < local_padded * 3 {
-            local_palette_rgb.extend_from_slice(&[0, 0, 0]);
-        }
+    // Local palettes not supported in this version: frames use the global palette
+    write_frames(&mut encoder, frames, options, delay_cs, padded_size)
+}
 
-        let mut frame = Frame::from_indexed_pixels(
-            options.width,
-            options.height,
-            quantized.indices.clone(),
-            None,  // Local palettes not supported in this version
-        );
+/// Write frames in order; with `options.parallel` each frame's LZW stream is
+/// compressed on the rayon pool first, then the blocks are stitched sequentially
+fn write_frames<W: Write>(
+    encoder: &mut Encoder<W>,
+    frames: &[QuantizeResult],
+    options: &GifOptions,
+    delay_cs: u16,
+    table_len: usize, // Entries in the global palette
+) -> Result<()> {
+    // Reserve an index no frame uses for unchanged pixels; without one,
+    // optimize still crops each frame to its changed rectangle
+    let transparent = if options.optimize {
+        unused_index(frames.iter().map(|q| &q.indices[..]), table_len)
+    } else {
+        None
+    };
 
-        frame.delay = delay_cs;
-        frame.dispose = gif::DisposalMethod::Keep;
+    if !options.parallel {
+        for idx in 0..frames.len() {
+            let frame = indexed_frame(frames, idx, options, delay_cs, transparent);
+            encoder.write_frame(&frame).map_err(|_| ProcessorError::EncodingError)?;
+        }
+        return Ok(());
+    }
 
-        encoder.write_frame(&frame)
-            .map_err(|e| ProcessorError::EncodingError(
-                format!("Failed to write frame {}: {}", idx, e)
-            ))?;
+    let encoded: Vec<Frame> = (0..frames.len())
+        .into_par_iter()
+        .map(|idx| {
+            let mut frame = indexed_frame(frames, idx, options, delay_cs, transparent);
+            frame.make_lzw_pre_encoded();
+            frame
+        })
+        .collect();
+
+    for frame in &encoded {
+        encoder.write_lzw_pre_encoded_frame(frame).map_err(|_| ProcessorError::EncodingError)?;
     }
 
     Ok(())
 }
 
+/// Build frame `idx` against the global palette; with `options.optimize` only the
+/// region that changed since frame `idx - 1` is kept
+fn indexed_frame<'a>(
+    frames: &'a [QuantizeResult],
+    idx: usize,
+    options: &GifOptions,
+    delay_cs: u16,
+    transparent: Option<u8>,
+) -> Frame<'a> {
+    let mut frame = if options.optimize {
+        let prev = idx.checked_sub(1).map(|p| &frames[p].indices[..]);
+        delta_frame(prev, &frames[idx].indices, options.width, options.height, transparent)
+    } else {
+        Frame {
+            width: options.width,
+            height: options.height,
+            buffer: Cow::Borrowed(&frames[idx].indices[..]),
+            ..Frame::default() // No local palette: use global palette
+        }
+    };
+
+    frame.delay = delay_cs;
+    frame.dispose = gif::DisposalMethod::Keep;
+    frame
+}
+
 /// Encode raw RGBA frames directly (quantization + encoding in one step)
 pub fn encode_rgba_to_gif(
     rgba_frames: Vec<Vec<u8>>,
@@ -236,6 +249,7 @@ pub fn encode_rgba_to_gif(
         fps,
         loop_count: 0,
         optimize: true,
+        parallel: true,
     };
 
     encode_gif(quantized, &gif_opts)
@@ -268,7 +282,7 @@ pub fn encode_gif89a(
 
         // Create encoder
         let mut encoder = Encoder::new(&mut output, side as u16, side as u16, &global_palette)?;
-        encoder.write_extension(gif::ExtensionData::Repetitions(Repeat::Infinite))?;
+        encoder.set_repeat(Repeat::Infinite)?;
 
         // Process each frame
         for frame_idx in 0..frame_count as usize {
@@ -322,7 +336,7 @@ mod tests {
     #[test]
     fn test_encode_single_frame() {
         let frames = vec![create_test_frame(256, 256)];
-        let options = GifOptions::default();
+        let options = GifOptions { width: 256, height: 256, frame_count: 1, ..GifOptions::default() };
 
         let result = encode_gif(frames, &options);
         assert!(result.is_ok());
@@ -340,18 +354,103 @@ mod tests {
             create_test_frame(256, 256),
         ];
 
-        let mut options = GifOptions::default();
-        options.frame_count = 3;
+        let options = GifOptions { width: 256, height: 256, frame_count: 3, ..GifOptions::default() };
 
         let result = encode_gif(frames, &options);
         assert!(result.is_ok());
     }
 
+    #[test]
+    fn test_parallel_matches_sequential() {
+        let make_frames = || -> Vec<QuantizeResult> {
+            (0..4u8)
+                .map(|f| {
+                    let mut frame = create_test_frame(64, 64);
+                    for (i, idx) in frame.indices.iter_mut().enumerate() {
+                        *idx = ((i / 7) as u8 ^ f) % 3;
+                    }
+                    frame
+                })
+                .collect()
+        };
+
+        let mut options = GifOptions { width: 64, height: 64, frame_count: 4, ..GifOptions::default() };
+        let parallel = encode_gif(make_frames(), &options).unwrap();
+        options.parallel = false;
+        let sequential = encode_gif(make_frames(), &options).unwrap();
+
+        assert_eq!(parallel, sequential);
+    }
+
+    #[test]
+    fn test_optimize_shrinks_static_scene() {
+        let make_frames = || -> Vec<QuantizeResult> {
+            (0..8u32)
+                .map(|f| {
+                    let mut frame = create_test_frame(128, 128);
+                    for (i, idx) in frame.indices.iter_mut().enumerate() {
+                        *idx = ((i % 128) / 16 % 3) as u8;
+                    }
+                    // Small moving square on an otherwise static frame
+                    for y in 0..8 {
+                        for x in 0..8 {
+                            frame.indices[((y + 4 * f) * 128 + x + 4 * f) as usize] = 2;
+                        }
+                    }
+                    frame
+                })
+                .collect()
+        };
+
+        let mut options = GifOptions { frame_count: 8, optimize: false, ..GifOptions::default() };
+        let full = encode_gif(make_frames(), &options).unwrap();
+        options.optimize = true;
+        let optimized = encode_gif(make_frames(), &options).unwrap();
+
+        assert_eq!(&optimized[0..6], b"GIF89a");
+        assert!(optimized.len() < full.len() / 2, "optimized {} vs full {}", optimized.len(), full.len());
+    }
+
+    #[test]
+    fn test_optimized_frames_rebuild_every_frame() {
+        // A bar sweeping right, one repeated frame, then a blank frame
+        let frames: Vec<QuantizeResult> = [0u32, 1, 2, 3, 4, 5, 5]
+            .into_iter()
+            .map(|f| {
+                let mut frame = create_test_frame(32, 32);
+                for (i, idx) in frame.indices.iter_mut().enumerate() {
+                    *idx = if (i as u32 % 32) / 4 == f { 1 } else { 0 };
+                }
+                frame
+            })
+            .chain(std::iter::once(create_test_frame(32, 32)))
+            .collect();
+        let options = GifOptions { width: 32, height: 32, frame_count: 8, ..GifOptions::default() };
+        let transparent = unused_index(frames.iter().map(|q| &q.indices[..]), 4);
+        assert!(transparent.is_some());
+
+        // Composite each written frame onto the canvas the way a decoder does with DisposalMethod::Keep
+        let mut canvas = vec![0xFFu8; 32 * 32];
+        for idx in 0..frames.len() {
+            let frame = indexed_frame(&frames, idx, &options, 3, transparent);
+            assert_eq!(frame.dispose, gif::DisposalMethod::Keep);
+            for y in 0..frame.height as usize {
+                for x in 0..frame.width as usize {
+                    let px = frame.buffer[y * frame.width as usize + x];
+                    if Some(px) != frame.transparent {
+                        canvas[(frame.top as usize + y) * 32 + frame.left as usize + x] = px;
+                    }
+                }
+            }
+            assert_eq!(canvas, frames[idx].indices, "frame {}", idx);
+        }
+    }
+
     #[test]
     fn test_frame_delay_calculation() {
         let frames = vec![create_test_frame(256, 256)];
 
-        let mut options = GifOptions::default();
+        let mut options = GifOptions { width: 256, height: 256, frame_count: 1, ..GifOptions::default() };
         options.fps = 30; // Should result in ~3cs delay
 
         let result = encode_gif(frames, &options).unwrap();
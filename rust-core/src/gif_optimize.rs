@@ -0,0 +1,177 @@
+// Inter-frame GIF optimization - sub-rectangle cropping and transparency
+// Frames share one index space, so changes are detected by comparing indices directly
+
+use std::borrow::Cow;
+use gif::{DisposalMethod, Frame};
+
+/// Changed-pixel bounding box within the canvas
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Rect {
+    pub left: u16,
+    pub top: u16,
+    pub width: u16,
+    pub height: u16,
+}
+
+/// Lowest palette index never used by any frame, usable as the reserved transparent index
+/// `table_len` is the number of entries in the palette written to the file
+pub fn unused_index<'a>(frames: impl IntoIterator<Item = &'a [u8]>, table_len: usize) -> Option<u8> {
+    let mut used = [false; 256];
+    for frame in frames {
+        for &idx in frame {
+            used[idx as usize] = true;
+        }
+    }
+    (0..table_len.min(256)).find(|&i| !used[i]).map(|i| i as u8)
+}
+
+/// Smallest rectangle containing every pixel that differs between `prev` and `cur`
+/// None if the frames are identical
+pub fn changed_rect(prev: &[u8], cur: &[u8], width: u16, height: u16) -> Option<Rect> {
+    let w = width as usize;
+    let rows = prev.chunks_exact(w).zip(cur.chunks_exact(w)).take(height as usize);
+
+    let (mut x0, mut x1, mut y0, mut y1) = (w, 0, usize::MAX, 0);
+    for (y, (p, c)) in rows.enumerate() {
+        // Skip identical rows with one slice compare (memcmp)
+        if p == c {
+            continue;
+        }
+        let first = p.iter().zip(c).position(|(a, b)| a != b).unwrap_or(0);
+        let last = w - 1 - p.iter().rev().zip(c.iter().rev()).position(|(a, b)| a != b).unwrap_or(0);
+        x0 = x0.min(first);
+        x1 = x1.max(last);
+        y0 = y0.min(y);
+        y1 = y;
+    }
+
+    if y0 == usize::MAX {
+        return None;
+    }
+    Some(Rect {
+        left: x0 as u16,
+        top: y0 as u16,
+        width: (x1 - x0 + 1) as u16,
+        height: (y1 - y0 + 1) as u16,
+    })
+}
+
+/// Build the frame to write for `cur` given the previously displayed frame
+///
+/// The first frame (`prev` = None) is written full-size. Later frames are cropped to
+/// the changed rectangle, and with a `transparent` index every pixel inside it that
+/// matches `prev` is replaced by that index. Frames use DisposalMethod::Keep, so the
+/// decoded canvas after each frame equals the full `cur` frame. Identical frames
+/// become a single transparent pixel (or an unchanged one) to preserve timing.
+pub fn delta_frame<'a>(
+    prev: Option<&[u8]>,
+    cur: &'a [u8],
+    width: u16,
+    height: u16,
+    transparent: Option<u8>,
+) -> Frame<'a> {
+    let mut frame = Frame {
+        width,
+        height,
+        buffer: Cow::Borrowed(cur),
+        dispose: DisposalMethod::Keep,
+        ..Frame::default()
+    };
+
+    let prev = match prev {
+        Some(prev) => prev,
+        None => return frame,
+    };
+
+    let rect = match changed_rect(prev, cur, width, height) {
+        Some(rect) => rect,
+        None => {
+            frame.width = 1;
+            frame.height = 1;
+            frame.buffer = Cow::Owned(vec![transparent.unwrap_or(cur[0])]);
+            frame.transparent = transparent;
+            return frame;
+        }
+    };
+
+    let w = width as usize;
+    let (left, right) = (rect.left as usize, rect.left as usize + rect.width as usize);
+    let mut buffer = Vec::with_capacity(rect.width as usize * rect.height as usize);
+    for y in rect.top as usize..rect.top as usize + rect.height as usize {
+        let (p, c) = (&prev[y * w + left..y * w + right], &cur[y * w + left..y * w + right]);
+        match transparent {
+            Some(t) => buffer.extend(p.iter().zip(c).map(|(&a, &b)| if a == b { t } else { b })),
+            None => buffer.extend_from_slice(c),
+        }
+    }
+
+    frame.left = rect.left;
+    frame.top = rect.top;
+    frame.width = rect.width;
+    frame.height = rect.height;
+    frame.buffer = Cow::Owned(buffer);
+    frame.transparent = transparent;
+    frame
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Composite a frame onto the canvas the way a decoder does with DisposalMethod::Keep
+    fn apply(canvas: &mut [u8], canvas_width: usize, frame: &Frame) {
+        for y in 0..frame.height as usize {
+            for x in 0..frame.width as usize {
+                let idx = frame.buffer[y * frame.width as usize + x];
+                if Some(idx) != frame.transparent {
+                    canvas[(frame.top as usize + y) * canvas_width + frame.left as usize + x] = idx;
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn test_unused_index() {
+        let a = [0u8, 1, 2, 4];
+        let b = [3u8, 5];
+        assert_eq!(unused_index([&a[..], &b[..]], 256), Some(6));
+        assert_eq!(unused_index([&a[..], &b[..]], 6), None);
+    }
+
+    #[test]
+    fn test_changed_rect() {
+        let prev = vec![0u8; 8 * 6];
+        let mut cur = prev.clone();
+        assert_eq!(changed_rect(&prev, &cur, 8, 6), None);
+
+        cur[2 * 8 + 3] = 1;
+        cur[4 * 8 + 5] = 1;
+        assert_eq!(changed_rect(&prev, &cur, 8, 6), Some(Rect { left: 3, top: 2, width: 3, height: 3 }));
+    }
+
+    #[test]
+    fn test_delta_frames_reconstruct_sequence() {
+        let (w, h) = (16usize, 12usize);
+        let frames: Vec<Vec<u8>> = (0..5)
+            .map(|f| (0..w * h).map(|i| if (i % w) / 4 == f % 4 && i / w > f { 2 } else { 1 }).collect())
+            .collect();
+
+        for transparent in [Some(7u8), None] {
+            let mut canvas = vec![0u8; w * h];
+            for (i, cur) in frames.iter().enumerate() {
+                let prev = if i == 0 { None } else { Some(&frames[i - 1][..]) };
+                let frame = delta_frame(prev, cur, w as u16, h as u16, transparent);
+                apply(&mut canvas, w, &frame);
+                assert_eq!(&canvas, cur, "frame {} not reconstructed", i);
+            }
+        }
+    }
+
+    #[test]
+    fn test_identical_frame_is_single_pixel() {
+        let cur = vec![3u8; 64];
+        let frame = delta_frame(Some(&cur), &cur, 8, 8, Some(9));
+        assert_eq!((frame.width, frame.height), (1, 1));
+        assert_eq!(&frame.buffer[..], &[9]);
+    }
+}
@@ -13,6 +13,32 @@ use imagequant::RGBA;
 mod quantization;
 mod oklab_quantization;
 mod blue_noise;
+mod gif_optimize;
+mod gif_encoder;
+mod downsample;
+mod cube_kernels;
+mod parallel;
+mod batch_ffi;
+mod pipeline;
+mod batch;
+mod task;
+mod temporal;
+mod stats;
+pub mod palette_lookup;
+pub mod tensor;
+pub mod texture;
+#[cfg(test)]
+mod tests;
+
+pub use pipeline::FramePipeline;
+pub use batch::{transcode_batch, BatchOpts, BatchReport, Clip, ClipJob, ClipLoader, ClipOutcome};
+pub use task::{EncodeTask, ProgressListener};
+pub use tensor::{convolve_tensor, TensorLayout};
+pub use texture::{tensor_texture, TensorTexture, TensorTextureLevel};
+pub use stats::{clear_signpost_listener, set_signpost_listener, set_stats_enabled, ProcessStats, SignpostListener, Stage};
+use task::background;
+use cube_kernels::TENSOR_SIDE;
+use stats::Recorder;
 
 // ============================================================================
 // TYPE DEFINITIONS
@@ -22,7 +48,7 @@ mod blue_noise;
 pub type Result<T> = std::result::Result<T, ProcessorError>;
 
 /// Error types for UniFFI interop
-#[derive(Debug, thiserror::Error)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, thiserror::Error)]
 pub enum ProcessorError {
     #[error("Quantization error")]
     QuantizationError,
@@ -35,6 +61,9 @@ pub enum ProcessorError {
 
     #[error("Memory error")]
     MemoryError,
+
+    #[error("Cancelled")]
+    Cancelled,
 }
 
 // ============================================================================
@@ -50,6 +79,8 @@ pub struct QuantizeOpts {
     pub palette_size: u16,       // Max colors (typically 255)
     pub dithering_level: f32,    // 0.0-1.0, dithering strength
     pub shared_palette: bool,    // Use same palette for all frames
+    pub oklab_palette: bool,     // Median-cut palette in OKLab instead of imagequant (ignores quality/speed)
+    pub blue_noise_dither: bool, // OKLab only: adaptive blue noise at dithering_level instead of Sierra diffusion
 }
 
 /// GIF output options
@@ -62,6 +93,18 @@ pub struct GifOpts {
     pub loop_count: u16,         // 0 = infinite loop
     pub optimize: bool,          // Apply additional optimizations
     pub include_tensor: bool,    // Generate 16×16×256 tensor data
+    pub indexed_tensor: bool,    // Tensor as palette indices + palette (1 byte/voxel) instead of RGBA
+    pub tensor_layout: TensorLayout, // Voxel order of either tensor; tiled layouts pad to whole tiles
+}
+
+/// Streaming pipeline options (see FramePipeline)
+#[derive(Debug, Clone)]
+pub struct PipelineOpts {
+    pub source_width: u32,       // Submitted frame width; area-downsampled to GifOpts.width
+    pub source_height: u32,      // Submitted frame height; area-downsampled to GifOpts.height
+    pub queue_depth: u32,        // Frames in flight between stages before submit blocks
+    pub resize_workers: u32,     // Downsample threads, 0 = half the cores
+    pub encode_workers: u32,     // LZW threads, 0 = all cores
 }
 
 /// Processing result with metrics
@@ -69,10 +112,13 @@ pub struct GifOpts {
 pub struct ProcessResult {
     pub gif_data: Vec<u8>,           // Complete GIF89a file data
     pub tensor_data: Option<Vec<u8>>, // Optional tensor for voxel visualization
+    pub tensor_indices: Option<Vec<u8>>, // Indexed tensor: one palette index per voxel
+    pub tensor_palette: Option<Vec<u8>>, // Indexed tensor palette, RGBA per entry
     pub final_file_size: u32,         // Size in bytes
     pub processing_time_ms: f32,      // Total processing time
     pub actual_frame_count: u16,      // Frames processed
     pub palette_size_used: u16,       // Colors in palette
+    pub stats: Option<ProcessStats>,  // Stage timings, when enabled with set_stats_enabled
 }
 
 // ============================================================================
@@ -99,7 +145,8 @@ pub fn process_all_frames(
     quantize_opts: QuantizeOpts,
     gif_opts: GifOpts,
 ) -> Result<ProcessResult> {
-    let start = Instant::now();
+    let stats = Recorder::new();
+    let ingest = stats.stage(Stage::Ingest);
 
     // Validate input buffer size
     let expected_size = (width * height * 4 * frame_count) as usize;
@@ -110,15 +157,66 @@ pub fn process_all_frames(
     // Split buffer into individual frames
     let frame_size = (width * height * 4) as usize;
     let frames: Vec<&[u8]> = frames_rgba.chunks_exact(frame_size).collect();
+    drop(ingest);
+
+    process_frames(frames, width, height, quantize_opts, gif_opts, None, &stats)
+}
+
+/// Non-blocking process_all_frames: the work runs on its own thread and the
+/// returned future resolves with the result
+///
+/// `task` is checked between frames; cancelling it (or dropping the future)
+/// stops the encode with ProcessorError::Cancelled. Its listener hears about
+/// each frame as it is remapped.
+pub async fn process_all_frames_async(
+    frames_rgba: Vec<u8>,
+    width: u32,
+    height: u32,
+    frame_count: u32,
+    quantize_opts: QuantizeOpts,
+    gif_opts: GifOpts,
+    task: std::sync::Arc<EncodeTask>,
+) -> Result<ProcessResult> {
+    let expected_size = (width * height * 4 * frame_count) as usize;
+    if frames_rgba.len() != expected_size {
+        return Err(ProcessorError::InvalidInput);
+    }
+
+    background(task.clone(), move || {
+        let stats = Recorder::new();
+        let ingest = stats.stage(Stage::Ingest);
+        let frame_size = (width * height * 4) as usize;
+        let frames: Vec<&[u8]> = frames_rgba.chunks_exact(frame_size).collect();
+        drop(ingest);
+        process_frames(frames, width, height, quantize_opts, gif_opts, Some(&task), &stats)
+    })
+    .await
+}
 
-    // Use imagequant for proven quality
-    process_with_imagequant(frames, width, height, quantize_opts, gif_opts)
+/// The quantizer `quantize_opts` selects: imagequant for proven quality, or OKLab
+fn process_frames(
+    frames: Vec<&[u8]>,
+    width: u32,
+    height: u32,
+    quantize_opts: QuantizeOpts,
+    gif_opts: GifOpts,
+    task: Option<&EncodeTask>,
+    stats: &Recorder,
+) -> Result<ProcessResult> {
+    if quantize_opts.oklab_palette {
+        process_with_oklab(frames, width, height, quantize_opts, gif_opts, task, stats)
+    } else {
+        process_with_imagequant(frames, width, height, quantize_opts, gif_opts, None, task, stats)
+    }
 }
 
 // ============================================================================
 // OKLAB PROCESSING PIPELINE
 // ============================================================================
 
+/// Histogram samples per clip for OKLab palette building (~1M, independent of clip length)
+const PALETTE_SAMPLE_BUDGET: usize = 1 << 20;
+
 /// Process frames using perceptually uniform OKLab color space
 fn process_with_oklab(
     frames: Vec<&[u8]>,
@@ -126,79 +224,105 @@ fn process_with_oklab(
     height: u32,
     quantize_opts: QuantizeOpts,
     gif_opts: GifOpts,
+    task: Option<&EncodeTask>,
+    stats: &Recorder,
 ) -> Result<ProcessResult> {
+    use blue_noise::AdaptiveBlueNoise;
     use oklab_quantization::{
-        srgb_to_oklab_batch,
-        build_oklab_palette,
+        srgb_to_oklab_into,
+        build_oklab_palette_from_histogram,
         oklab_palette_to_srgb,
+        sample_stride_for_budget,
+        ColorHistogram,
+        OklabColor,
         TemporalDither,
     };
 
     let start = Instant::now();
 
-    // Convert all frames to OKLab color space
-    let mut all_oklab_pixels = Vec::new();
-    for frame in &frames {
-        let oklab = srgb_to_oklab_batch(frame);
-        all_oklab_pixels.extend(oklab);
-    }
+    // Build optimal palette in OKLab space from a fixed-size color histogram,
+    // accumulated in parallel per frame and sampled down to a constant budget
+    let frame_pixels = (width * height) as usize;
+    let palette_stage = stats.stage(Stage::Palette);
+    let sample_stride = sample_stride_for_budget(frame_pixels * frames.len(), PALETTE_SAMPLE_BUDGET);
+    let histogram = ColorHistogram::from_frames(&frames, width as usize, height as usize, sample_stride);
 
-    // Build optimal palette in OKLab space
     let palette_size = quantize_opts.palette_size.min(255) as usize;
-    let oklab_palette = build_oklab_palette(&all_oklab_pixels, palette_size);
+    let oklab_palette = build_oklab_palette_from_histogram(&histogram, palette_size);
 
     // Convert palette back to sRGB for GIF encoding
     let srgb_palette = oklab_palette_to_srgb(&oklab_palette);
-
-    // Apply temporal dithering for smooth animation
+    drop(palette_stage);
+
+    // Apply temporal dithering for smooth animation; each frame is converted
+    // to OKLab exactly once, into one reused buffer. Blue noise dithers the
+    // sRGB bytes directly against the converted palette instead.
+    // Indices go straight into one clip-wide volume, shared by the GIF and the indexed tensor
+    let remap_stage = stats.stage(Stage::Remap);
+    let blue_noise = quantize_opts
+        .blue_noise_dither
+        .then(|| AdaptiveBlueNoise::new(&srgb_palette, quantize_opts.dithering_level));
     let mut temporal_dither = TemporalDither::new();
-    let mut indexed_frames = Vec::new();
-
-    for (_frame_idx, frame_data) in frames.iter().enumerate() {
-        let frame_oklab = srgb_to_oklab_batch(frame_data);
-        let indices = temporal_dither.apply(
-            &frame_oklab,
-            &oklab_palette,
-            width as usize,
-            height as usize,
-        );
-        indexed_frames.push(indices);
+    let mut index_volume = vec![0u8; frame_pixels * frames.len()];
+    let oklab_pixels = if blue_noise.is_some() { 0 } else { frame_pixels };
+    let mut frame_oklab = vec![OklabColor { l: 0.0, a: 0.0, b: 0.0 }; oklab_pixels];
+    stats.allocated(index_volume.len());
+
+    for (frame_index, (frame_data, indices)) in frames.iter().zip(index_volume.chunks_exact_mut(frame_pixels)).enumerate() {
+        task::check(task)?;
+        let clock = stats.frame_clock();
+        if let Some(blue_noise) = &blue_noise {
+            blue_noise.apply_into(frame_data, width as usize, height as usize, frame_index, indices);
+        } else {
+            srgb_to_oklab_into(frame_data, &mut frame_oklab);
+            temporal_dither.apply_into(
+                &frame_oklab,
+                &oklab_palette,
+                width as usize,
+                height as usize,
+                indices,
+            );
+        }
+        stats.frame_remapped(clock);
+        task::frame_done(task, frames.len());
     }
+    drop(remap_stage);
 
     // Encode as GIF89a
-    let gif_buffer = encode_gif(&indexed_frames, &srgb_palette, &gif_opts)?;
-
-    // Generate tensor if requested (for voxel visualization)
-    let tensor_data = if gif_opts.include_tensor {
-        eprintln!("[RUST] Building tensor for voxel visualization...");
-        eprintln!("[RUST]   Frame count: {}", frames.len());
-        eprintln!("[RUST]   Frame dimensions: {}x{}", width, height);
-        let tensor = build_tensor_from_frames(&frames, width, height)?;
-        eprintln!("[RUST]   Tensor size: {} bytes", tensor.len());
-        eprintln!("[RUST]   Expected size for 128³: {} bytes", 128*128*128*4);
-
-        // Verify tensor is not empty
-        let has_data = tensor.iter().take(1000).any(|&b| b != 0);
-        eprintln!("[RUST]   Contains non-zero data: {}", has_data);
-
-        if !has_data {
-            eprintln!("[RUST] WARNING: Tensor appears to be all zeros!");
-        }
+    let indexed_frames: Vec<&[u8]> = index_volume.chunks_exact(frame_pixels).collect();
+    let gif_buffer = encode_gif(&indexed_frames, &srgb_palette, &gif_opts, task, stats)?;
+
+    // Indexed tensor: move the volume in rather than expanding it back to RGBA
+    let tensor_stage = stats.stage(Stage::Tensor);
+    let (tensor_indices, tensor_palette) = if gif_opts.include_tensor && gif_opts.indexed_tensor {
+        let indices = build_indexed_tensor(index_volume, frames.len(), width, height, gif_opts.tensor_layout)?;
+        stats.allocated(indices.len());
+        (Some(indices), Some(palette_bytes(&srgb_palette)))
+    } else {
+        (None, None)
+    };
 
+    // RGBA tensor for voxel visualization
+    let tensor_data = if gif_opts.include_tensor && !gif_opts.indexed_tensor {
+        let tensor = build_tensor_from_frames(&frames, width, height, gif_opts.tensor_layout)?;
+        stats.allocated(tensor.len());
         Some(tensor)
     } else {
-        eprintln!("[RUST] Tensor generation skipped (include_tensor = false)");
         None
     };
+    drop(tensor_stage);
 
     let file_size = gif_buffer.len() as u32;
     Ok(ProcessResult {
         gif_data: gif_buffer,
         tensor_data,
+        tensor_indices,
+        tensor_palette,
         final_file_size: file_size,
         processing_time_ms: start.elapsed().as_millis() as f32,
         actual_frame_count: frames.len() as u16,
         palette_size_used: srgb_palette.len() as u16,
+        stats: stats.finish(),
     })
 }
 
@@ -206,216 +330,469 @@ fn process_with_oklab(
 // FALLBACK IMAGEQUANT PIPELINE
 // ============================================================================
 
+/// imagequant settings for `quantize_opts`
+fn quantizer_attributes(quantize_opts: &QuantizeOpts) -> Result<imagequant::Attributes> {
+    let mut attr = imagequant::new();
+    attr.set_quality(quantize_opts.quality_min, quantize_opts.quality_max)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    attr.set_speed(quantize_opts.speed)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    // At most 255, as with OKLab, so optimize keeps an index free for transparency
+    attr.set_max_colors(quantize_opts.palette_size.clamp(2, 255) as u32)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    Ok(attr)
+}
+
 /// Primary processing using imagequant library
+///
+/// `fixed_palette` skips palette building and remaps every frame against it,
+/// as the batch driver does for clips that share a palette.
 fn process_with_imagequant(
     frames: Vec<&[u8]>,
     width: u32,
     height: u32,
     quantize_opts: QuantizeOpts,
     gif_opts: GifOpts,
+    fixed_palette: Option<&[RGBA]>,
+    task: Option<&EncodeTask>,
+    stats: &Recorder,
 ) -> Result<ProcessResult> {
     let start = Instant::now();
 
     // Setup imagequant
-    let mut attr = imagequant::new();
-    attr.set_quality(quantize_opts.quality_min, quantize_opts.quality_max)
-        .map_err(|_| ProcessorError::QuantizationError)?;
-    attr.set_speed(quantize_opts.speed)
-        .map_err(|_| ProcessorError::QuantizationError)?;
-
-    // Convert frames to RGBA pixels
-    let mut images = Vec::new();
-    for frame_data in &frames {
-        let pixels: Vec<RGBA> = frame_data
-            .chunks_exact(4)
-            .map(|chunk| RGBA::new(chunk[0], chunk[1], chunk[2], chunk[3]))
-            .collect();
+    let attr = quantizer_attributes(&quantize_opts)?;
 
-        let img = attr.new_image(&pixels[..], width as usize, height as usize, 0.0)
-            .map_err(|_| ProcessorError::QuantizationError)?;
-        images.push(img);
-    }
-
-    // Quantize with shared palette
-    if images.is_empty() {
+    if frames.is_empty() {
         return Err(ProcessorError::InvalidInput);
     }
 
-    let mut quantization = attr.quantize(&mut images[0])
-        .map_err(|_| ProcessorError::QuantizationError)?;
-    quantization.set_dithering_level(quantize_opts.dithering_level)
-        .map_err(|_| ProcessorError::QuantizationError)?;
-
-    // Remap frames to palette indices
-    let mut indexed_frames = Vec::new();
-    for i in 0..images.len() {
-        let (_, indices) = quantization.remapped(&mut images[i])
-            .map_err(|_| ProcessorError::QuantizationError)?;
-        indexed_frames.push(indices);
-    }
-
-    // Get palette after remapping
-    let palette = quantization.palette();
-    let palette_size = palette.len() as u16;
-
-    // Convert palette for GIF
-    let srgb_palette: Vec<[u8; 4]> = palette.iter()
-        .map(|c| [c.r, c.g, c.b, c.a])
-        .collect();
+    // Remap frames to palette indices, each into its slot of one clip-wide volume
+    let frame_pixels = (width * height) as usize;
+    let mut index_volume = vec![0u8; frame_pixels * frames.len()];
+    stats.allocated(index_volume.len());
+    let srgb_palette = match fixed_palette {
+        Some(palette) => {
+            remap_with_palette(&attr, palette, &frames, width, height, &quantize_opts, &mut index_volume, task, stats)?
+        }
+        None if quantize_opts.shared_palette => {
+            remap_with_sampled_palette(&attr, &frames, width, height, &quantize_opts, &mut index_volume, task, stats)?
+        }
+        None => {
+            remap_with_first_frame_palette(&attr, &frames, width, height, &quantize_opts, &mut index_volume, task, stats)?
+        }
+    };
+    let palette_size = srgb_palette.len() as u16;
 
     // Encode GIF
-    let gif_buffer = encode_gif(&indexed_frames, &srgb_palette, &gif_opts)?;
-
-    // Generate tensor if requested
-    let tensor_data = if gif_opts.include_tensor {
-        eprintln!("[RUST] Building tensor for voxel visualization (imagequant path)...");
-        eprintln!("[RUST]   Frame count: {}", frames.len());
-        eprintln!("[RUST]   Frame dimensions: {}x{}", width, height);
-        let tensor = build_tensor_from_frames(&frames, width, height)?;
-        eprintln!("[RUST]   Tensor size: {} bytes", tensor.len());
-        eprintln!("[RUST]   Expected size for 128³: {} bytes", 128*128*128*4);
-
-        // Verify tensor is not empty
-        let has_data = tensor.iter().take(1000).any(|&b| b != 0);
-        eprintln!("[RUST]   Contains non-zero data: {}", has_data);
-
-        if !has_data {
-            eprintln!("[RUST] WARNING: Tensor appears to be all zeros!");
-        }
+    let indexed_frames: Vec<&[u8]> = index_volume.chunks_exact(frame_pixels).collect();
+    let gif_buffer = encode_gif(&indexed_frames, &srgb_palette, &gif_opts, task, stats)?;
+
+    // Indexed tensor: move the volume in rather than expanding it back to RGBA
+    let tensor_stage = stats.stage(Stage::Tensor);
+    let (tensor_indices, tensor_palette) = if gif_opts.include_tensor && gif_opts.indexed_tensor {
+        let indices = build_indexed_tensor(index_volume, frames.len(), width, height, gif_opts.tensor_layout)?;
+        stats.allocated(indices.len());
+        (Some(indices), Some(palette_bytes(&srgb_palette)))
+    } else {
+        (None, None)
+    };
 
+    // RGBA tensor for voxel visualization
+    let tensor_data = if gif_opts.include_tensor && !gif_opts.indexed_tensor {
+        let tensor = build_tensor_from_frames(&frames, width, height, gif_opts.tensor_layout)?;
+        stats.allocated(tensor.len());
         Some(tensor)
     } else {
-        eprintln!("[RUST] Tensor generation skipped (include_tensor = false)");
         None
     };
+    drop(tensor_stage);
 
     let file_size = gif_buffer.len() as u32;
     Ok(ProcessResult {
         gif_data: gif_buffer,
         tensor_data,
+        tensor_indices,
+        tensor_palette,
         final_file_size: file_size,
         processing_time_ms: start.elapsed().as_millis() as f32,
         actual_frame_count: frames.len() as u16,
         palette_size_used: palette_size,
+        stats: stats.finish(),
     })
 }
 
+/// Frames sampled for the shared palette, one from the middle of each equal stretch of the clip
+const SHARED_PALETTE_FRAMES: usize = 16;
+
+/// Shared palette from a stratified sample of frames, then a parallel remap
+///
+/// Pass 1 counts the colors of the sampled frames (subsampled to
+/// PALETTE_SAMPLE_BUDGET pixels) on all cores and quantizes the merged
+/// histogram once. Pass 2 remaps every frame on all cores. Each worker holds its
+/// own fixed-palette quantizer, so every frame sees exactly the same palette
+/// whatever order they run in.
+fn remap_with_sampled_palette(
+    attr: &imagequant::Attributes,
+    frames: &[&[u8]],
+    width: u32,
+    height: u32,
+    quantize_opts: &QuantizeOpts,
+    index_volume: &mut [u8],
+    task: Option<&EncodeTask>,
+    stats: &Recorder,
+) -> Result<Vec<[u8; 4]>> {
+    let palette = sampled_palette(attr, frames, width, height, stats)?;
+    remap_with_palette(attr, &palette, frames, width, height, quantize_opts, index_volume, task, stats)
+}
+
+/// Pass 1 of remap_with_sampled_palette: the palette for a clip's sampled frames
+fn sampled_palette(
+    attr: &imagequant::Attributes,
+    frames: &[&[u8]],
+    width: u32,
+    height: u32,
+    stats: &Recorder,
+) -> Result<Vec<RGBA>> {
+    use std::collections::HashMap;
+    use rayon::prelude::*;
+    use imagequant::{Histogram, HistogramEntry};
+
+    let (w, h) = (width as usize, height as usize);
+    let _palette_stage = stats.stage(Stage::Palette);
+    let samples = SHARED_PALETTE_FRAMES.min(frames.len());
+    let sampled: Vec<&[u8]> = (0..samples)
+        .map(|s| frames[(2 * s + 1) * frames.len() / (2 * samples)])
+        .collect();
+    let stride = oklab_quantization::sample_stride_for_budget(w * h * samples, PALETTE_SAMPLE_BUDGET);
+
+    let counts = sampled
+        .par_iter()
+        .fold(HashMap::new, |mut counts, frame| {
+            for row in frame.chunks_exact(w * 4).step_by(stride) {
+                for px in row.chunks_exact(4).step_by(stride) {
+                    *counts.entry([px[0], px[1], px[2], px[3]]).or_insert(0u32) += 1;
+                }
+            }
+            counts
+        })
+        .reduce(HashMap::new, |mut merged, counts| {
+            for (color, count) in counts {
+                *merged.entry(color).or_insert(0) += count;
+            }
+            merged
+        });
+
+    let entries: Vec<HistogramEntry> = counts
+        .into_iter()
+        .map(|(c, count)| HistogramEntry { color: RGBA::new(c[0], c[1], c[2], c[3]), count })
+        .collect();
+    let mut histogram = Histogram::new(attr);
+    histogram.add_colors(&entries, 0.0)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    let palette = histogram.quantize(attr)
+        .map_err(|_| ProcessorError::QuantizationError)?
+        .palette()
+        .to_vec();
+    Ok(palette)
+}
+
+/// Pass 2 of remap_with_sampled_palette: remap every frame against `palette`
+/// Returns the palette in the order the indices refer to
+fn remap_with_palette(
+    attr: &imagequant::Attributes,
+    palette: &[RGBA],
+    frames: &[&[u8]],
+    width: u32,
+    height: u32,
+    quantize_opts: &QuantizeOpts,
+    index_volume: &mut [u8],
+    task: Option<&EncodeTask>,
+    stats: &Recorder,
+) -> Result<Vec<[u8; 4]>> {
+    use rayon::prelude::*;
+
+    let (w, h) = (width as usize, height as usize);
+    // The palette was timed where it was built; setting up its remappers is remap work
+    let _remap_stage = stats.stage(Stage::Remap);
+
+    // Fixed colors can be reordered by imagequant; take the order the workers will see
+    let remapper = || fixed_palette_remapper(palette, quantize_opts.dithering_level);
+    let srgb_palette = remapper()?.palette().iter().map(|c| [c.r, c.g, c.b, c.a]).collect();
+
+    index_volume
+        .par_chunks_mut(w * h)
+        .zip(frames.par_iter())
+        .try_for_each_init(remapper, |remapper, (indices, frame)| {
+            task::check(task)?;
+            let remapper = remapper.as_mut().map_err(|err| *err)?;
+            let clock = stats.frame_clock();
+            let mut image = attr.new_image_borrowed(rgba_pixels(frame), w, h, 0.0)
+                .map_err(|_| ProcessorError::QuantizationError)?;
+            remapper.remap_into(&mut image, as_uninit(indices))
+                .map_err(|_| ProcessorError::QuantizationError)?;
+            stats.frame_remapped(clock);
+            task::frame_done(task, frames.len());
+            Ok(())
+        })?;
+
+    Ok(srgb_palette)
+}
+
+/// Quantization result whose palette is exactly `palette`, for remapping
+fn fixed_palette_remapper(palette: &[RGBA], dithering_level: f32) -> Result<imagequant::QuantizationResult> {
+    let mut attr = imagequant::new();
+    attr.set_max_colors(palette.len().max(2) as u32)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    let mut histogram = imagequant::Histogram::new(&attr);
+    for &color in palette {
+        histogram.add_fixed_color(color, 0.0)
+            .map_err(|_| ProcessorError::QuantizationError)?;
+    }
+    let mut result = histogram.quantize(&attr)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    result.set_dithering_level(dithering_level)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    Ok(result)
+}
+
+/// Palette from the first frame only, remapping frames in order
+/// Cheapest to build, but scene changes later in the clip are poorly covered
+fn remap_with_first_frame_palette(
+    attr: &imagequant::Attributes,
+    frames: &[&[u8]],
+    width: u32,
+    height: u32,
+    quantize_opts: &QuantizeOpts,
+    index_volume: &mut [u8],
+    task: Option<&EncodeTask>,
+    stats: &Recorder,
+) -> Result<Vec<[u8; 4]>> {
+    // Wrap each frame as a borrowed RGBA view over the caller's buffer (no per-frame copy)
+    let mut images = Vec::with_capacity(frames.len());
+    for frame_data in frames {
+        let pixels = rgba_pixels(frame_data);
+
+        let img = attr.new_image_borrowed(pixels, width as usize, height as usize, 0.0)
+            .map_err(|_| ProcessorError::QuantizationError)?;
+        images.push(img);
+    }
+
+    let palette_stage = stats.stage(Stage::Palette);
+    let mut quantization = attr.quantize(&mut images[0])
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    quantization.set_dithering_level(quantize_opts.dithering_level)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    drop(palette_stage);
+
+    let _remap_stage = stats.stage(Stage::Remap);
+    let frame_pixels = (width * height) as usize;
+    for (image, indices) in images.iter_mut().zip(index_volume.chunks_exact_mut(frame_pixels)) {
+        task::check(task)?;
+        let clock = stats.frame_clock();
+        quantization.remap_into(image, as_uninit(indices))
+            .map_err(|_| ProcessorError::QuantizationError)?;
+        stats.frame_remapped(clock);
+        task::frame_done(task, frames.len());
+    }
+
+    // Get palette after remapping
+    Ok(quantization.palette().iter().map(|c| [c.r, c.g, c.b, c.a]).collect())
+}
+
+/// View an initialized index buffer as the MaybeUninit slice imagequant remaps into
+fn as_uninit(buf: &mut [u8]) -> &mut [std::mem::MaybeUninit<u8>] {
+    // MaybeUninit<u8> has the layout of u8, and imagequant only writes valid indices
+    unsafe { &mut *(buf as *mut [u8] as *mut [std::mem::MaybeUninit<u8>]) }
+}
+
+/// Reinterpret raw RGBA bytes as imagequant pixels without copying
+/// RGBA is four u8 fields, so it has the same size and alignment as [u8; 4]
+fn rgba_pixels(frame_data: &[u8]) -> &[RGBA] {
+    unsafe {
+        std::slice::from_raw_parts(
+            frame_data.as_ptr() as *const RGBA,
+            frame_data.len() / 4,
+        )
+    }
+}
+
 // ============================================================================
 // GIF ENCODING
 // ============================================================================
 
 /// Encode indexed frames as GIF89a
+/// A cancelled `task` stops frames that haven't started compressing yet
 fn encode_gif(
-    indexed_frames: &[Vec<u8>],
+    indexed_frames: &[&[u8]],
     palette: &[[u8; 4]],
     opts: &GifOpts,
+    task: Option<&EncodeTask>,
+    stats: &Recorder,
 ) -> Result<Vec<u8>> {
-    use gif::{Encoder, Frame, Repeat};
+    use gif::Frame;
+    use rayon::prelude::*;
 
+    let _lzw_stage = stats.stage(Stage::Lzw);
     let mut gif_buffer = Vec::new();
-
-    // Convert palette to GIF format (RGB, no alpha)
-    let mut global_palette = Vec::with_capacity(768);
-    for color in palette.iter().take(256) {
-        global_palette.push(color[0]);
-        global_palette.push(color[1]);
-        global_palette.push(color[2]);
-    }
-
-    // Pad to 256 colors if needed
-    while global_palette.len() < 768 {
-        global_palette.push(0);
-    }
+    let global_palette = gif_global_palette(palette);
 
     // Encode in a block to ensure encoder is dropped
     {
-        let mut encoder = Encoder::new(
-            &mut gif_buffer,
-            opts.width,
-            opts.height,
-            &global_palette[0..768],
-        ).map_err(|_| ProcessorError::EncodingError)?;
-
-        // Set infinite loop
-        encoder.set_repeat(Repeat::Infinite)
-            .map_err(|_| ProcessorError::EncodingError)?;
+        let mut encoder = new_gif_encoder(&mut gif_buffer, &global_palette, opts)?;
+
+        // Optimize: crop each frame to what changed since the previous one and
+        // mark unchanged pixels with an index no frame uses (palette is 256 entries)
+        let transparent = if opts.optimize {
+            gif_optimize::unused_index(indexed_frames.iter().map(|f| &f[..]), 256)
+        } else {
+            None
+        };
+
+        // Frames are independent LZW streams: compress them on all cores,
+        // then write the pre-encoded blocks in order (same bytes as write_frame)
+        let encoded_frames: Vec<Frame> = (0..indexed_frames.len())
+            .into_par_iter()
+            .map(|i| {
+                task::check(task)?;
+                let prev = i.checked_sub(1).map(|p| &indexed_frames[p][..]);
+                let frame = encode_frame(indexed_frames[i], prev, transparent, opts);
+                stats.frame_encoded(frame.buffer.len());
+                Ok(frame)
+            })
+            .collect::<Result<_>>()?;
 
         // Write frames
-        for indices in indexed_frames {
-            let frame = Frame {
-                width: opts.width,
-                height: opts.height,
-                buffer: indices.clone().into(),
-                delay: 100 / opts.fps, // Convert FPS to centiseconds
-                ..Default::default()
-            };
-            encoder.write_frame(&frame)
+        for frame in &encoded_frames {
+            encoder.write_lzw_pre_encoded_frame(frame)
                 .map_err(|_| ProcessorError::EncodingError)?;
         }
     } // encoder is dropped here
 
+    stats.allocated(gif_buffer.len());
     Ok(gif_buffer)
 }
 
+/// GIF global color table: RGB triples (no alpha), padded to 256 colors
+fn gif_global_palette(palette: &[[u8; 4]]) -> Vec<u8> {
+    let mut global_palette = Vec::with_capacity(768);
+    for color in palette.iter().take(256) {
+        global_palette.extend_from_slice(&color[..3]);
+    }
+    global_palette.resize(768, 0);
+    global_palette
+}
+
+/// Encoder with the global palette written and infinite looping set
+fn new_gif_encoder<W: std::io::Write>(
+    writer: W,
+    global_palette: &[u8],
+    opts: &GifOpts,
+) -> Result<gif::Encoder<W>> {
+    let mut encoder = gif::Encoder::new(writer, opts.width, opts.height, global_palette)
+        .map_err(|_| ProcessorError::EncodingError)?;
+    encoder.set_repeat(gif::Repeat::Infinite)
+        .map_err(|_| ProcessorError::EncodingError)?;
+    Ok(encoder)
+}
+
+/// LZW-compress one indexed frame, cropped against `prev` when optimizing
+fn encode_frame<'a>(
+    indices: &'a [u8],
+    prev: Option<&[u8]>,
+    transparent: Option<u8>,
+    opts: &GifOpts,
+) -> gif::Frame<'a> {
+    let mut frame = if opts.optimize {
+        gif_optimize::delta_frame(prev, indices, opts.width, opts.height, transparent)
+    } else {
+        gif::Frame {
+            width: opts.width,
+            height: opts.height,
+            buffer: std::borrow::Cow::Borrowed(indices),
+            ..Default::default()
+        }
+    };
+    frame.delay = 100 / opts.fps; // Convert FPS to centiseconds
+    frame.make_lzw_pre_encoded();
+    frame
+}
+
 // ============================================================================
 // TENSOR GENERATION FOR VOXEL VISUALIZATION
 // ============================================================================
 
 /// Build 128×128×128 tensor from frames for voxel cube visualization (N=128 optimal)
 /// Optimal resolution tensor for exploring the voxel cube as a 3D object
-fn build_tensor_from_frames(frames: &[&[u8]], width: u32, height: u32) -> Result<Vec<u8>> {
-    eprintln!("[RUST] build_tensor_from_frames called");
-    eprintln!("[RUST]   Input: {} frames at {}x{}", frames.len(), width, height);
-
+fn build_tensor_from_frames(frames: &[&[u8]], width: u32, height: u32, layout: TensorLayout) -> Result<Vec<u8>> {
     // For 128×128×128 voxel cube, we need 128 frames at 128×128 resolution
     // If input is already 128×128, use directly; otherwise resample
+    let tensor = if width == 128 && height == 128 {
+        frames.concat()
+    } else {
+        let (w, h) = (width as usize, height as usize);
+        if frames.iter().any(|frame| frame.len() < w * h * 4) {
+            return Err(ProcessorError::InvalidInput);
+        }
 
-    if width == 128 && height == 128 {
-        eprintln!("[RUST]   Using direct copy (frames already 128x128)");
-        // Direct copy - frames are already the right size
-        let mut tensor = Vec::with_capacity(frames.len() * 128 * 128 * 4);
+        // Nearest-neighbor resampling to 128×128, one frame per worker
+        use rayon::prelude::*;
+        let plane = TENSOR_SIDE * TENSOR_SIDE * 4;
+        let resample = cube_kernels::kernels_for(w, h).resample_rgba;
+        let mut tensor = vec![0u8; plane * frames.len()];
+        tensor
+            .par_chunks_mut(plane)
+            .zip(frames.par_iter())
+            .for_each(|(out, frame)| resample(frame, w, h, out));
+        tensor
+    };
 
-        for (i, frame) in frames.iter().enumerate() {
-            // Verify frame has data
-            if i == 0 {
-                let has_data = frame.iter().take(100).any(|&b| b != 0);
-                eprintln!("[RUST]   First frame has data: {}", has_data);
-            }
-            tensor.extend_from_slice(frame);
-        }
+    match layout {
+        TensorLayout::FrameMajor => Ok(tensor),
+        layout => tensor::convert_layout(&tensor, tensor_shape(frames.len()), layout),
+    }
+}
 
-        eprintln!("[RUST]   Final tensor size: {} bytes", tensor.len());
-        Ok(tensor)
+/// Indexed 128×128×frames tensor from the clip's index volume
+/// 128×128 frame-major clips hand the volume over as is; other sizes are
+/// nearest-resampled like the RGBA tensor, at a quarter of its size
+fn build_indexed_tensor(
+    index_volume: Vec<u8>,
+    frame_count: usize,
+    width: u32,
+    height: u32,
+    layout: TensorLayout,
+) -> Result<Vec<u8>> {
+    let tensor = if width == 128 && height == 128 {
+        index_volume
     } else {
-        eprintln!("[RUST]   Resampling from {}x{} to 128x128", width, height);
-        // Need to resample to 128×128
-        let mut tensor = Vec::with_capacity(128 * 128 * frames.len() * 4);
-
-        for frame in frames {
-            // Simple nearest-neighbor resampling to 128×128
-            for y in 0..128 {
-                for x in 0..128 {
-                    // Map to source coordinates
-                    let src_x = (x as f32 * width as f32 / 128.0) as usize;
-                    let src_y = (y as f32 * height as f32 / 128.0) as usize;
-                    let src_idx = (src_y.min(height as usize - 1) * width as usize + src_x.min(width as usize - 1)) * 4;
-
-                    if src_idx + 3 < frame.len() {
-                        tensor.push(frame[src_idx]);     // R
-                        tensor.push(frame[src_idx + 1]); // G
-                        tensor.push(frame[src_idx + 2]); // B
-                        tensor.push(frame[src_idx + 3]); // A
-                    } else {
-                        tensor.extend_from_slice(&[0, 0, 0, 0]);
-                    }
-                }
-            }
-        }
+        use rayon::prelude::*;
+        let (w, h) = (width as usize, height as usize);
+        let plane = TENSOR_SIDE * TENSOR_SIDE;
+        let resample = cube_kernels::kernels_for(w, h).resample_indices;
+        let mut tensor = vec![0u8; plane * frame_count];
+        tensor
+            .par_chunks_mut(plane)
+            .zip(index_volume.par_chunks_exact(w * h))
+            .for_each(|(out, frame)| resample(frame, w, h, out));
+        tensor
+    };
 
-        Ok(tensor)
+    match layout {
+        TensorLayout::FrameMajor => Ok(tensor),
+        layout => tensor::convert_index_layout(&tensor, tensor_shape(frame_count), layout),
     }
 }
 
+/// Frame-major shape of a TENSOR_SIDE² × frame_count tensor
+fn tensor_shape(frame_count: usize) -> tensor::TensorShape {
+    tensor::TensorShape::new(TENSOR_SIDE as u32, TENSOR_SIDE as u32, frame_count as u32)
+}
+
+/// Flatten a palette to RGBA bytes for the indexed tensor
+fn palette_bytes(palette: &[[u8; 4]]) -> Vec<u8> {
+    palette.iter().flatten().copied().collect()
+}
+
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
@@ -2,11 +2,13 @@
 // Perceptually uniform color space for better gradients and skin tones
 
 use crate::{ProcessorError, Result};
+use crate::palette_lookup::PaletteIndex;
 use rayon::prelude::*;
 use std::collections::HashMap;
+use std::sync::OnceLock;
 
 /// OKLab color representation
-#[derive(Clone, Copy, Debug)]
+#[derive(Clone, Copy, Debug, PartialEq)]
 pub struct OklabColor {
     pub l: f32, // Lightness
     pub a: f32, // Green-red
@@ -15,46 +17,113 @@ pub struct OklabColor {
 
 /// Convert sRGB to OKLab for perceptually uniform processing
 pub fn srgb_to_oklab_batch(rgba: &[u8]) -> Vec<OklabColor> {
-    rgba.chunks_exact(4)
-        .map(|pixel| {
-            let r = pixel[0] as f32 / 255.0;
-            let g = pixel[1] as f32 / 255.0;
-            let b = pixel[2] as f32 / 255.0;
-
-            // Convert sRGB to linear RGB
-            let linear_r = if r <= 0.04045 {
-                r / 12.92
-            } else {
-                ((r + 0.055) / 1.055).powf(2.4)
-            };
-            let linear_g = if g <= 0.04045 {
-                g / 12.92
-            } else {
-                ((g + 0.055) / 1.055).powf(2.4)
-            };
-            let linear_b = if b <= 0.04045 {
-                b / 12.92
+    let mut out = vec![OklabColor { l: 0.0, a: 0.0, b: 0.0 }; rgba.len() / 4];
+    srgb_to_oklab_into(rgba, &mut out);
+    out
+}
+
+/// sRGB byte -> linear RGB, one entry per possible channel value
+fn srgb_to_linear_lut() -> &'static [f32; 256] {
+    static LUT: OnceLock<[f32; 256]> = OnceLock::new();
+    LUT.get_or_init(|| {
+        let mut lut = [0f32; 256];
+        for (v, entry) in lut.iter_mut().enumerate() {
+            let c = v as f32 / 255.0;
+            *entry = if c <= 0.04045 {
+                c / 12.92
             } else {
-                ((b + 0.055) / 1.055).powf(2.4)
+                ((c + 0.055) / 1.055).powf(2.4)
             };
+        }
+        lut
+    })
+}
 
-            // Manual OKLab conversion from linear RGB
-            // Based on OKLab paper: https://bottosson.github.io/posts/oklab/
-            let l_ = 0.4122214708 * linear_r + 0.5363325363 * linear_g + 0.0514459929 * linear_b;
-            let m = 0.2119034982 * linear_r + 0.6806995451 * linear_g + 0.1073969566 * linear_b;
-            let s = 0.0883024619 * linear_r + 0.2817188376 * linear_g + 0.6299787005 * linear_b;
+/// Pixels converted per kernel step; fixed-size lanes let LLVM emit NEON/SSE
+const LANES: usize = 8;
+
+/// Convert 4-channel sRGB pixels into a caller-provided buffer (`out.len()` pixels)
+///
+/// Linearization is a table lookup and the cube root uses a bit-level estimate
+/// refined by two Halley steps, so the hot loop has no powf/cbrt calls.
+/// Matches the libm path to within ~1e-6 per component.
+pub fn srgb_to_oklab_into(rgba: &[u8], out: &mut [OklabColor]) {
+    let lut = srgb_to_linear_lut();
+    let n = out.len().min(rgba.len() / 4);
+    let (rgba, out) = (&rgba[..n * 4], &mut out[..n]);
+
+    let mut src = rgba.chunks_exact(LANES * 4);
+    let mut dst = out.chunks_exact_mut(LANES);
+    for (px, lab) in (&mut src).zip(&mut dst) {
+        let mut r = [0f32; LANES];
+        let mut g = [0f32; LANES];
+        let mut b = [0f32; LANES];
+        for k in 0..LANES {
+            r[k] = lut[px[k * 4] as usize];
+            g[k] = lut[px[k * 4 + 1] as usize];
+            b[k] = lut[px[k * 4 + 2] as usize];
+        }
+        let (l, a, bb) = linear_to_oklab_lanes(&r, &g, &b);
+        for k in 0..LANES {
+            lab[k] = OklabColor { l: l[k], a: a[k], b: bb[k] };
+        }
+    }
 
-            let l_root = l_.cbrt();
-            let m_root = m.cbrt();
-            let s_root = s.cbrt();
+    // Remainder pixels go through the same kernel, zero-padded
+    let tail = src.remainder();
+    if !tail.is_empty() {
+        let mut r = [0f32; LANES];
+        let mut g = [0f32; LANES];
+        let mut b = [0f32; LANES];
+        for (k, p) in tail.chunks_exact(4).enumerate() {
+            r[k] = lut[p[0] as usize];
+            g[k] = lut[p[1] as usize];
+            b[k] = lut[p[2] as usize];
+        }
+        let (l, a, bb) = linear_to_oklab_lanes(&r, &g, &b);
+        for (k, lab) in dst.into_remainder().iter_mut().enumerate() {
+            *lab = OklabColor { l: l[k], a: a[k], b: bb[k] };
+        }
+    }
+}
 
-            OklabColor {
-                l: 0.2104542553 * l_root + 0.7936177850 * m_root - 0.0040720468 * s_root,
-                a: 1.9779984951 * l_root - 2.4285922050 * m_root + 0.4505937099 * s_root,
-                b: 0.0259040371 * l_root + 0.7827717662 * m_root - 0.8086757660 * s_root,
-            }
-        })
-        .collect()
+/// Linear RGB -> OKLab for LANES pixels at once
+/// Based on OKLab paper: https://bottosson.github.io/posts/oklab/
+#[inline(always)]
+fn linear_to_oklab_lanes(
+    r: &[f32; LANES],
+    g: &[f32; LANES],
+    b: &[f32; LANES],
+) -> ([f32; LANES], [f32; LANES], [f32; LANES]) {
+    let mut l = [0f32; LANES];
+    let mut a = [0f32; LANES];
+    let mut bb = [0f32; LANES];
+    for k in 0..LANES {
+        let l_ = 0.4122214708 * r[k] + 0.5363325363 * g[k] + 0.0514459929 * b[k];
+        let m = 0.2119034982 * r[k] + 0.6806995451 * g[k] + 0.1073969566 * b[k];
+        let s = 0.0883024619 * r[k] + 0.2817188376 * g[k] + 0.6299787005 * b[k];
+
+        let l_root = fast_cbrt(l_);
+        let m_root = fast_cbrt(m);
+        let s_root = fast_cbrt(s);
+
+        l[k] = 0.2104542553 * l_root + 0.7936177850 * m_root - 0.0040720468 * s_root;
+        a[k] = 1.9779984951 * l_root - 2.4285922050 * m_root + 0.4505937099 * s_root;
+        bb[k] = 0.0259040371 * l_root + 0.7827717662 * m_root - 0.8086757660 * s_root;
+    }
+    (l, a, bb)
+}
+
+/// Cube root for x in [0, 1]: exponent/3 bit estimate, then two Halley iterations
+#[inline(always)]
+fn fast_cbrt(x: f32) -> f32 {
+    let x = x.max(0.0);
+    let mut y = f32::from_bits(x.to_bits() / 3 + 709_921_077);
+    for _ in 0..2 {
+        let y3 = y * y * y;
+        y *= (y3 + 2.0 * x) / (2.0 * y3 + x);
+    }
+    if x > 0.0 { y } else { 0.0 }
 }
 
 /// Convert OKLab back to sRGB
@@ -111,8 +180,10 @@ pub fn quantize_in_oklab(
     // Convert to OKLab
     let oklab_pixels = srgb_to_oklab_batch(rgba_data);
 
-    // Build palette using median cut in OKLab space
-    let palette = build_oklab_palette(&oklab_pixels, palette_size);
+    // Build palette using median cut over the frame's color histogram
+    let mut histogram = ColorHistogram::new();
+    histogram.add_frame(rgba_data, width as usize, height as usize, 1, 0);
+    let palette = build_oklab_palette_from_histogram(&histogram, palette_size);
 
     // Map pixels to nearest palette colors
     let indices = map_to_palette(&oklab_pixels, &palette);
@@ -124,13 +195,184 @@ pub fn quantize_in_oklab(
 }
 
 /// Build optimal palette using median cut algorithm in OKLab space
+///
+/// Pixels are first collapsed into a sparse histogram of ~0.004-wide OKLab cells,
+/// so the median cut works on distinct colors rather than every pixel.
 pub fn build_oklab_palette(pixels: &[OklabColor], target_size: usize) -> Vec<OklabColor> {
     if pixels.is_empty() || target_size == 0 {
         return Vec::new();
     }
 
-    // Start with all pixels in one box
-    let mut boxes = vec![ColorBox::from_pixels(pixels)];
+    let mut cells: HashMap<(i32, i32, i32), (f64, f64, f64, u32)> = HashMap::new();
+    for p in pixels {
+        let key = ((p.l * 255.0) as i32, (p.a * 255.0) as i32, (p.b * 255.0) as i32);
+        let cell = cells.entry(key).or_insert((0.0, 0.0, 0.0, 0));
+        cell.0 += p.l as f64;
+        cell.1 += p.a as f64;
+        cell.2 += p.b as f64;
+        cell.3 += 1;
+    }
+
+    let entries = cells
+        .into_values()
+        .map(|(l, a, b, count)| {
+            let n = count as f64;
+            WeightedColor {
+                color: OklabColor { l: (l / n) as f32, a: (a / n) as f32, b: (b / n) as f32 },
+                weight: count,
+            }
+        })
+        .collect();
+
+    median_cut(entries, target_size)
+}
+
+/// Bits kept per sRGB channel when binning (32³ bins)
+const HISTOGRAM_BITS: u32 = 5;
+const HISTOGRAM_BINS: usize = 1 << (3 * HISTOGRAM_BITS);
+
+/// Fixed-size color histogram over sRGB bins
+///
+/// Memory is constant (32K bins) regardless of frame count or size. Each bin keeps
+/// the sum of the exact source bytes, so its mean color is not snapped to the bin grid.
+#[derive(Clone)]
+pub struct ColorHistogram {
+    counts: Vec<u32>,
+    sums: Vec<[u64; 3]>,
+}
+
+impl ColorHistogram {
+    pub fn new() -> Self {
+        Self {
+            counts: vec![0; HISTOGRAM_BINS],
+            sums: vec![[0; 3]; HISTOGRAM_BINS],
+        }
+    }
+
+    /// Accumulate one 4-channel frame
+    ///
+    /// With `sample_stride` > 1 only one pixel per stride×stride block is counted.
+    /// The pixel's offset inside the block moves with `frame_index`, so across a clip
+    /// every block position is sampled (stratified rather than a fixed grid).
+    pub fn add_frame(&mut self, rgba: &[u8], width: usize, height: usize, sample_stride: usize, frame_index: usize) {
+        let stride = sample_stride.max(1);
+        let (ox, oy) = (frame_index % stride, (frame_index / stride) % stride);
+        let shift = 8 - HISTOGRAM_BITS;
+        if ox >= width {
+            return;
+        }
+
+        for y in (oy..height).step_by(stride) {
+            let row = &rgba[y * width * 4..(y + 1) * width * 4];
+            for px in row[ox * 4..].chunks_exact(4).step_by(stride) {
+                let bin = ((px[0] as usize >> shift) << (2 * HISTOGRAM_BITS))
+                    | ((px[1] as usize >> shift) << HISTOGRAM_BITS)
+                    | (px[2] as usize >> shift);
+                self.counts[bin] += 1;
+                let sum = &mut self.sums[bin];
+                sum[0] += px[0] as u64;
+                sum[1] += px[1] as u64;
+                sum[2] += px[2] as u64;
+            }
+        }
+    }
+
+    /// Fold another histogram into this one
+    pub fn merge(mut self, other: &ColorHistogram) -> Self {
+        for bin in 0..HISTOGRAM_BINS {
+            self.counts[bin] += other.counts[bin];
+            for c in 0..3 {
+                self.sums[bin][c] += other.sums[bin][c];
+            }
+        }
+        self
+    }
+
+    /// Histogram of many frames, one partial histogram per rayon worker
+    pub fn from_frames(frames: &[&[u8]], width: usize, height: usize, sample_stride: usize) -> Self {
+        frames
+            .par_iter()
+            .enumerate()
+            .fold(ColorHistogram::new, |mut hist, (frame_index, frame)| {
+                hist.add_frame(frame, width, height, sample_stride, frame_index);
+                hist
+            })
+            .reduce(ColorHistogram::new, |a, b| a.merge(&b))
+    }
+
+    /// Total samples counted
+    pub fn total(&self) -> u64 {
+        self.counts.iter().map(|&c| c as u64).sum()
+    }
+
+    /// Non-empty bins as OKLab colors weighted by sample count
+    fn weighted_colors(&self) -> Vec<WeightedColor> {
+        let mut rgb = Vec::new();
+        let mut weights = Vec::new();
+        for (count, sum) in self.counts.iter().zip(&self.sums) {
+            if *count > 0 {
+                let n = *count as f32;
+                rgb.push([sum[0] as f32 / n, sum[1] as f32 / n, sum[2] as f32 / n]);
+                weights.push(*count);
+            }
+        }
+
+        rgb.iter()
+            .zip(weights)
+            .map(|(&[r, g, b], weight)| WeightedColor { color: srgb_f32_to_oklab(r, g, b), weight })
+            .collect()
+    }
+}
+
+impl Default for ColorHistogram {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Median cut over a histogram; build time depends only on the number of
+/// distinct bins (at most 32K), not on frame count
+pub fn build_oklab_palette_from_histogram(histogram: &ColorHistogram, target_size: usize) -> Vec<OklabColor> {
+    if target_size == 0 {
+        return Vec::new();
+    }
+    median_cut(histogram.weighted_colors(), target_size)
+}
+
+/// Sample stride that keeps a clip's histogram near `budget` samples (1 = every pixel)
+pub fn sample_stride_for_budget(total_pixels: usize, budget: usize) -> usize {
+    if budget == 0 || total_pixels <= budget {
+        return 1;
+    }
+    ((total_pixels as f64 / budget as f64).sqrt().ceil()) as usize
+}
+
+/// Fractional sRGB (0-255 per channel) to OKLab, for bin means
+fn srgb_f32_to_oklab(r: f32, g: f32, b: f32) -> OklabColor {
+    let lin = |v: f32| {
+        let c = v / 255.0;
+        if c <= 0.04045 { c / 12.92 } else { ((c + 0.055) / 1.055).powf(2.4) }
+    };
+    let (r, g, b) = (lin(r), lin(g), lin(b));
+    let (l, a, bb) = linear_to_oklab_lanes(&[r; LANES], &[g; LANES], &[b; LANES]);
+    OklabColor { l: l[0], a: a[0], b: bb[0] }
+}
+
+/// Distinct color with the number of pixels it stands for
+#[derive(Clone, Copy)]
+struct WeightedColor {
+    color: OklabColor,
+    weight: u32,
+}
+
+/// Weighted median cut: boxes are index ranges into one entry buffer, sorted in place
+fn median_cut(mut entries: Vec<WeightedColor>, target_size: usize) -> Vec<OklabColor> {
+    if entries.is_empty() {
+        return Vec::new();
+    }
+
+    // Start with all entries in one box
+    let mut boxes = vec![ColorBox::new(&entries, 0, entries.len())];
 
     // Split boxes until we reach target palette size
     while boxes.len() < target_size && boxes.iter().any(|b| b.can_split()) {
@@ -142,122 +384,129 @@ pub fn build_oklab_palette(pixels: &[OklabColor], target_size: usize) -> Vec<Okl
             .max_by_key(|(_, b)| (b.variance() * 1000.0) as u32)
             .unwrap();
 
-        let box_to_split = boxes.remove(split_idx);
-        let (box1, box2) = box_to_split.split();
+        let box_to_split = boxes.swap_remove(split_idx);
+        let (box1, box2) = box_to_split.split(&mut entries);
         boxes.push(box1);
         boxes.push(box2);
     }
 
-    // Get average color from each box
-    boxes.into_iter().map(|b| b.average()).collect()
+    // Get weighted average color from each box
+    boxes.iter().map(|b| b.average(&entries)).collect()
 }
 
-/// Color box for median cut algorithm
+/// Color box for median cut algorithm: entries[start..end]
 struct ColorBox {
-    pixels: Vec<OklabColor>,
-    min_l: f32,
-    max_l: f32,
-    min_a: f32,
-    max_a: f32,
-    min_b: f32,
-    max_b: f32,
+    start: usize,
+    end: usize,
+    min: [f32; 3],
+    max: [f32; 3],
 }
 
 impl ColorBox {
-    fn from_pixels(pixels: &[OklabColor]) -> Self {
-        let mut min_l = f32::MAX;
-        let mut max_l = f32::MIN;
-        let mut min_a = f32::MAX;
-        let mut max_a = f32::MIN;
-        let mut min_b = f32::MAX;
-        let mut max_b = f32::MIN;
-
-        for p in pixels {
-            min_l = min_l.min(p.l);
-            max_l = max_l.max(p.l);
-            min_a = min_a.min(p.a);
-            max_a = max_a.max(p.a);
-            min_b = min_b.min(p.b);
-            max_b = max_b.max(p.b);
+    fn new(entries: &[WeightedColor], start: usize, end: usize) -> Self {
+        let mut min = [f32::MAX; 3];
+        let mut max = [f32::MIN; 3];
+
+        for e in &entries[start..end] {
+            let c = [e.color.l, e.color.a, e.color.b];
+            for axis in 0..3 {
+                min[axis] = min[axis].min(c[axis]);
+                max[axis] = max[axis].max(c[axis]);
+            }
         }
 
-        Self {
-            pixels: pixels.to_vec(),
-            min_l, max_l,
-            min_a, max_a,
-            min_b, max_b,
-        }
+        Self { start, end, min, max }
     }
 
     fn can_split(&self) -> bool {
-        self.pixels.len() > 1
+        self.end - self.start > 1
     }
 
     fn variance(&self) -> f32 {
-        let l_range = self.max_l - self.min_l;
-        let a_range = self.max_a - self.min_a;
-        let b_range = self.max_b - self.min_b;
+        let l_range = self.max[0] - self.min[0];
+        let a_range = self.max[1] - self.min[1];
+        let b_range = self.max[2] - self.min[2];
 
         // Weight luminance more heavily (human vision is more sensitive to it)
         l_range * 2.0 + a_range + b_range
     }
 
-    fn split(mut self) -> (Self, Self) {
+    fn split(self, entries: &mut [WeightedColor]) -> (Self, Self) {
         // Determine longest axis
-        let l_range = self.max_l - self.min_l;
-        let a_range = self.max_a - self.min_a;
-        let b_range = self.max_b - self.min_b;
+        let l_range = self.max[0] - self.min[0];
+        let a_range = self.max[1] - self.min[1];
+        let b_range = self.max[2] - self.min[2];
 
-        // Sort along longest axis
+        // Sort this box's entries along longest axis
+        let range = &mut entries[self.start..self.end];
         if l_range >= a_range && l_range >= b_range {
-            self.pixels.sort_by(|a, b| a.l.partial_cmp(&b.l).unwrap());
+            range.sort_unstable_by(|a, b| a.color.l.total_cmp(&b.color.l));
         } else if a_range >= b_range {
-            self.pixels.sort_by(|a, b| a.a.partial_cmp(&b.a).unwrap());
+            range.sort_unstable_by(|a, b| a.color.a.total_cmp(&b.color.a));
         } else {
-            self.pixels.sort_by(|a, b| a.b.partial_cmp(&b.b).unwrap());
+            range.sort_unstable_by(|a, b| a.color.b.total_cmp(&b.color.b));
         }
 
-        // Split at median
-        let mid = self.pixels.len() / 2;
-        let second_half = self.pixels.split_off(mid);
+        // Split at the weighted median, keeping at least one entry on each side
+        let total: u64 = range.iter().map(|e| e.weight as u64).sum();
+        let mut acc = 0u64;
+        let mut mid = range.len() / 2;
+        for (i, e) in range.iter().enumerate() {
+            acc += e.weight as u64;
+            if acc * 2 >= total {
+                mid = i + 1;
+                break;
+            }
+        }
+        let mid = self.start + mid.clamp(1, range.len() - 1);
 
-        (Self::from_pixels(&self.pixels), Self::from_pixels(&second_half))
+        (Self::new(entries, self.start, mid), Self::new(entries, mid, self.end))
     }
 
-    fn average(&self) -> OklabColor {
-        let sum_l: f32 = self.pixels.iter().map(|p| p.l).sum();
-        let sum_a: f32 = self.pixels.iter().map(|p| p.a).sum();
-        let sum_b: f32 = self.pixels.iter().map(|p| p.b).sum();
-        let count = self.pixels.len() as f32;
+    fn average(&self, entries: &[WeightedColor]) -> OklabColor {
+        let mut sum = [0f64; 3];
+        let mut count = 0f64;
+        for e in &entries[self.start..self.end] {
+            let w = e.weight as f64;
+            sum[0] += e.color.l as f64 * w;
+            sum[1] += e.color.a as f64 * w;
+            sum[2] += e.color.b as f64 * w;
+            count += w;
+        }
 
         OklabColor {
-            l: sum_l / count,
-            a: sum_a / count,
-            b: sum_b / count,
+            l: (sum[0] / count) as f32,
+            a: (sum[1] / count) as f32,
+            b: (sum[2] / count) as f32,
         }
     }
 }
 
 /// Map pixels to nearest palette colors
 fn map_to_palette(pixels: &[OklabColor], palette: &[OklabColor]) -> Vec<u8> {
+    let index = oklab_palette_index(palette);
     pixels
         .par_iter()
-        .map(|pixel| {
-            palette
-                .iter()
-                .enumerate()
-                .min_by_key(|(_, p)| {
-                    let dl = pixel.l - p.l;
-                    let da = pixel.a - p.a;
-                    let db = pixel.b - p.b;
-                    ((dl * dl + da * da + db * db) * 1000.0) as u32
-                })
-                .map(|(idx, _)| idx as u8)
-                .unwrap_or(0)
-        })
+        .map(|pixel| index.nearest([pixel.l, pixel.a, pixel.b]) as u8)
         .collect()
 }
 
+/// Nearest-color index over an OKLab palette
+/// Grid spans the sRGB gamut (L 0..1, a/b within ±0.4) plus the palette itself;
+/// dithered values that land outside it are still exact via the linear fallback
+pub fn oklab_palette_index(palette: &[OklabColor]) -> PaletteIndex {
+    let colors: Vec<[f32; 3]> = palette.iter().map(|p| [p.l, p.a, p.b]).collect();
+    let mut lo = [0.0f32, -0.4, -0.4];
+    let mut hi = [1.0f32, 0.4, 0.4];
+    for c in &colors {
+        for axis in 0..3 {
+            lo[axis] = lo[axis].min(c[axis]);
+            hi[axis] = hi[axis].max(c[axis]);
+        }
+    }
+    PaletteIndex::new(&colors, lo, hi)
+}
+
 /// Convert OKLab palette to sRGB
 pub fn oklab_palette_to_srgb(palette: &[OklabColor]) -> Vec<[u8; 4]> {
     let rgba_bytes = oklab_to_srgb_batch(palette);
@@ -273,6 +522,7 @@ pub fn oklab_palette_to_srgb(palette: &[OklabColor]) -> Vec<[u8; 4]> {
 pub struct TemporalDither {
     prev_error: Option<Vec<f32>>,
     frame_index: usize,
+    index: Option<(Vec<OklabColor>, PaletteIndex)>, // Lookup for the last palette seen
 }
 
 impl TemporalDither {
@@ -280,9 +530,19 @@ impl TemporalDither {
         Self {
             prev_error: None,
             frame_index: 0,
+            index: None,
         }
     }
 
+    /// Nearest-color lookup for `palette`, rebuilt only when the palette changes
+    /// (a clip passes the same palette for every frame)
+    fn palette_index(&mut self, palette: &[OklabColor]) -> &PaletteIndex {
+        if !matches!(&self.index, Some((cached, _)) if cached.as_slice() == palette) {
+            self.index = Some((palette.to_vec(), oklab_palette_index(palette)));
+        }
+        &self.index.as_ref().unwrap().1
+    }
+
     /// Apply temporal dithering with motion compensation
     pub fn apply(
         &mut self,
@@ -292,6 +552,20 @@ impl TemporalDither {
         height: usize,
     ) -> Vec<u8> {
         let mut result = vec![0u8; width * height];
+        self.apply_into(pixels, palette, width, height, &mut result);
+        result
+    }
+
+    /// Same as `apply`, writing the width × height indices into `result`
+    /// (e.g. one frame's slot in a clip-wide index volume)
+    pub fn apply_into(
+        &mut self,
+        pixels: &[OklabColor],
+        palette: &[OklabColor],
+        width: usize,
+        height: usize,
+        result: &mut [u8],
+    ) {
         let mut errors = vec![0f32; width * height * 3]; // L, a, b components
 
         // Initialize with previous frame's error if available
@@ -308,78 +582,208 @@ impl TemporalDither {
         // Apply blue noise pattern offset based on frame index
         let pattern_offset = (self.frame_index * 17) % 64; // Prime number for good distribution
 
-        for y in 0..height {
-            for x in 0..width {
-                let idx = y * width + x;
-                let pixel = pixels[idx];
-
-                // Add error from previous pixels and frames
-                let err_idx = idx * 3;
-                let corrected = OklabColor {
-                    l: pixel.l + errors[err_idx] * 0.5,
-                    a: pixel.a + errors[err_idx + 1] * 0.5,
-                    b: pixel.b + errors[err_idx + 2] * 0.5,
-                };
-
-                // Find nearest palette color
-                let (palette_idx, nearest) = palette
-                    .iter()
-                    .enumerate()
-                    .min_by_key(|(_, p)| {
-                        let dl = corrected.l - p.l;
-                        let da = corrected.a - p.a;
-                        let db = corrected.b - p.b;
-                        ((dl * dl + da * da + db * db) * 1000.0) as u32
-                    })
-                    .map(|(idx, p)| (idx, *p))
-                    .unwrap();
-
-                result[idx] = palette_idx as u8;
-
-                // Calculate and distribute error
-                let err_l = pixel.l - nearest.l;
-                let err_a = pixel.a - nearest.a;
-                let err_b = pixel.b - nearest.b;
-
-                // Sierra dithering (better for animations than Floyd-Steinberg)
-                // Distributes error to fewer pixels, reducing crawling
-                if x + 1 < width {
-                    let idx = (y * width + x + 1) * 3;
-                    errors[idx] += err_l * 5.0 / 32.0;
-                    errors[idx + 1] += err_a * 5.0 / 32.0;
-                    errors[idx + 2] += err_b * 5.0 / 32.0;
-                }
-                if x + 2 < width {
-                    let idx = (y * width + x + 2) * 3;
-                    errors[idx] += err_l * 3.0 / 32.0;
-                    errors[idx + 1] += err_a * 3.0 / 32.0;
-                    errors[idx + 2] += err_b * 3.0 / 32.0;
+        // Square frames at the fixed cube sizes get a kernel with the side baked in
+        let remap = crate::cube_kernels::kernels_for(width, height).remap_oklab;
+        remap(pixels, palette, self.palette_index(palette), &mut errors, width, height, result);
+
+        // Save error for next frame
+        self.prev_error = Some(errors);
+        self.frame_index += 1;
+    }
+}
+
+/// Sierra error-diffusion remap of one frame, seeded with `errors`
+/// S is the side of a square frame known at compile time (0 = use `width` and
+/// `height`), so the fixed cube sizes get constant strides and edge tests
+pub(crate) fn sierra_remap<const S: usize>(
+    pixels: &[OklabColor],
+    palette: &[OklabColor],
+    index: &PaletteIndex,
+    errors: &mut [f32],
+    width: usize,
+    height: usize,
+    result: &mut [u8],
+) {
+    let (width, height) = if S == 0 { (width, height) } else { (S, S) };
+    // Sized up front so the per-pixel indexing below can drop most bounds checks
+    let pixels = &pixels[..width * height];
+    let errors = &mut errors[..width * height * 3];
+    let result = &mut result[..width * height];
+
+    for y in 0..height {
+        for x in 0..width {
+            let idx = y * width + x;
+            let pixel = pixels[idx];
+
+            // Add error from previous pixels and frames
+            let err_idx = idx * 3;
+            let corrected = OklabColor {
+                l: pixel.l + errors[err_idx] * 0.5,
+                a: pixel.a + errors[err_idx + 1] * 0.5,
+                b: pixel.b + errors[err_idx + 2] * 0.5,
+            };
+
+            // Find nearest palette color
+            let palette_idx = index.nearest([corrected.l, corrected.a, corrected.b]);
+            let nearest = palette[palette_idx];
+
+            result[idx] = palette_idx as u8;
+
+            // Calculate and distribute error
+            let err_l = pixel.l - nearest.l;
+            let err_a = pixel.a - nearest.a;
+            let err_b = pixel.b - nearest.b;
+
+            // Sierra dithering (better for animations than Floyd-Steinberg)
+            // Distributes error to fewer pixels, reducing crawling
+            if x + 1 < width {
+                let idx = (y * width + x + 1) * 3;
+                errors[idx] += err_l * 5.0 / 32.0;
+                errors[idx + 1] += err_a * 5.0 / 32.0;
+                errors[idx + 2] += err_b * 5.0 / 32.0;
+            }
+            if x + 2 < width {
+                let idx = (y * width + x + 2) * 3;
+                errors[idx] += err_l * 3.0 / 32.0;
+                errors[idx + 1] += err_a * 3.0 / 32.0;
+                errors[idx + 2] += err_b * 3.0 / 32.0;
+            }
+            if y + 1 < height {
+                if x > 1 {
+                    let idx = ((y + 1) * width + x - 2) * 3;
+                    errors[idx] += err_l * 2.0 / 32.0;
+                    errors[idx + 1] += err_a * 2.0 / 32.0;
+                    errors[idx + 2] += err_b * 2.0 / 32.0;
                 }
-                if y + 1 < height {
-                    if x > 1 {
-                        let idx = ((y + 1) * width + x - 2) * 3;
-                        errors[idx] += err_l * 2.0 / 32.0;
-                        errors[idx + 1] += err_a * 2.0 / 32.0;
-                        errors[idx + 2] += err_b * 2.0 / 32.0;
-                    }
-                    if x > 0 {
-                        let idx = ((y + 1) * width + x - 1) * 3;
-                        errors[idx] += err_l * 4.0 / 32.0;
-                        errors[idx + 1] += err_a * 4.0 / 32.0;
-                        errors[idx + 2] += err_b * 4.0 / 32.0;
-                    }
-                    let idx = ((y + 1) * width + x) * 3;
-                    errors[idx] += err_l * 5.0 / 32.0;
-                    errors[idx + 1] += err_a * 5.0 / 32.0;
-                    errors[idx + 2] += err_b * 5.0 / 32.0;
+                if x > 0 {
+                    let idx = ((y + 1) * width + x - 1) * 3;
+                    errors[idx] += err_l * 4.0 / 32.0;
+                    errors[idx + 1] += err_a * 4.0 / 32.0;
+                    errors[idx + 2] += err_b * 4.0 / 32.0;
                 }
+                let idx = ((y + 1) * width + x) * 3;
+                errors[idx] += err_l * 5.0 / 32.0;
+                errors[idx + 1] += err_a * 5.0 / 32.0;
+                errors[idx + 2] += err_b * 5.0 / 32.0;
             }
         }
+    }
+}
 
-        // Save error for next frame
-        self.prev_error = Some(errors);
-        self.frame_index += 1;
+#[cfg(test)]
+mod tests {
+    use super::*;
 
-        result
+    /// The original per-pixel powf/cbrt conversion
+    fn reference_oklab(p: &[u8]) -> OklabColor {
+        let lin = |v: u8| {
+            let c = v as f64 / 255.0;
+            if c <= 0.04045 { c / 12.92 } else { ((c + 0.055) / 1.055).powf(2.4) }
+        };
+        let (r, g, b) = (lin(p[0]), lin(p[1]), lin(p[2]));
+        let l = (0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b).cbrt();
+        let m = (0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b).cbrt();
+        let s = (0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b).cbrt();
+        OklabColor {
+            l: (0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s) as f32,
+            a: (1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s) as f32,
+            b: (0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s) as f32,
+        }
+    }
+
+    #[test]
+    fn test_fast_conversion_matches_reference() {
+        // Every grey level plus a spread of colors, with a non-multiple-of-8 length
+        let mut rgba = Vec::new();
+        for v in 0..=255u8 {
+            rgba.extend_from_slice(&[v, v, v, 255]);
+            rgba.extend_from_slice(&[v, v.wrapping_mul(7), 255 - v, 255]);
+        }
+        rgba.extend_from_slice(&[1, 2, 3, 255, 250, 128, 0, 255, 0, 0, 0, 255]);
+
+        let fast = srgb_to_oklab_batch(&rgba);
+        assert_eq!(fast.len(), rgba.len() / 4);
+        for (p, c) in rgba.chunks_exact(4).zip(&fast) {
+            let r = reference_oklab(p);
+            assert!((c.l - r.l).abs() < 2e-6, "L for {:?}: {} vs {}", p, c.l, r.l);
+            assert!((c.a - r.a).abs() < 2e-6, "a for {:?}: {} vs {}", p, c.a, r.a);
+            assert!((c.b - r.b).abs() < 2e-6, "b for {:?}: {} vs {}", p, c.b, r.b);
+        }
     }
-}
\ No newline at end of file
+
+    #[test]
+    fn test_histogram_is_constant_size_and_counts_samples() {
+        let (w, h) = (64usize, 48usize);
+        let frames: Vec<Vec<u8>> = (0..6u8)
+            .map(|f| (0..w * h).flat_map(|i| [(i % 256) as u8, f * 40, (i / 256) as u8 * 60, 255]).collect())
+            .collect();
+        let refs: Vec<&[u8]> = frames.iter().map(|f| &f[..]).collect();
+
+        let full = ColorHistogram::from_frames(&refs, w, h, 1);
+        assert_eq!(full.total(), (w * h * frames.len()) as u64);
+        assert_eq!(full.counts.len(), HISTOGRAM_BINS);
+
+        let sampled = ColorHistogram::from_frames(&refs, w, h, 4);
+        assert_eq!(sampled.total(), (w / 4 * h / 4 * frames.len()) as u64);
+        assert_eq!(sample_stride_for_budget(1_000_000, 250_000), 2);
+        assert_eq!(sample_stride_for_budget(1_000, 250_000), 1);
+    }
+
+    #[test]
+    fn test_histogram_palette_recovers_distinct_colors() {
+        // Four flat quadrants: a 4-color palette must reproduce them exactly
+        let colors = [[255u8, 0, 0], [0, 255, 0], [0, 0, 255], [200, 200, 200]];
+        let (w, h) = (32usize, 32usize);
+        let frame: Vec<u8> = (0..w * h)
+            .flat_map(|i| {
+                let c = colors[(i % w) / 16 + 2 * ((i / w) / 16)];
+                [c[0], c[1], c[2], 255]
+            })
+            .collect();
+
+        let mut histogram = ColorHistogram::new();
+        histogram.add_frame(&frame, w, h, 1, 0);
+        let palette = build_oklab_palette_from_histogram(&histogram, 4);
+        assert_eq!(palette.len(), 4);
+
+        for c in colors {
+            let lab = srgb_to_oklab_batch(&[c[0], c[1], c[2], 255])[0];
+            let best = palette
+                .iter()
+                .map(|p| (p.l - lab.l).powi(2) + (p.a - lab.a).powi(2) + (p.b - lab.b).powi(2))
+                .fold(f32::MAX, f32::min);
+            assert!(best < 1e-8, "color {:?} not in palette", c);
+        }
+
+        // Pixel-based entry point goes through the same weighted median cut
+        let pixels = srgb_to_oklab_batch(&frame);
+        assert_eq!(build_oklab_palette(&pixels, 4).len(), 4);
+    }
+
+    #[test]
+    fn test_black_and_white() {
+        let lab = srgb_to_oklab_batch(&[0, 0, 0, 255, 255, 255, 255, 255]);
+        assert_eq!(lab[0].l, 0.0);
+        assert!((lab[1].l - 1.0).abs() < 1e-4);
+        assert!(lab[1].a.abs() < 1e-4 && lab[1].b.abs() < 1e-4);
+    }
+
+    #[test]
+    fn test_temporal_dither_follows_palette_changes() {
+        let (width, height) = (16, 16);
+        let frame: Vec<u8> = (0..width * height).flat_map(|i| [(i % 256) as u8, 128, 64, 255]).collect();
+        let pixels = srgb_to_oklab_batch(&frame);
+        let wide = build_oklab_palette(&pixels, 16);
+        let narrow = build_oklab_palette(&pixels, 2);
+
+        let mut dither = TemporalDither::new();
+        let mut out = vec![0u8; width * height];
+        dither.apply_into(&pixels, &wide, width, height, &mut out);
+        dither.apply_into(&pixels, &wide, width, height, &mut out);
+        assert!(out.iter().any(|&i| i >= 2));
+
+        // A new palette replaces the cached lookup instead of reusing the old one
+        dither.apply_into(&pixels, &narrow, width, height, &mut out);
+        assert!(out.iter().all(|&i| (i as usize) < narrow.len()));
+    }
+}
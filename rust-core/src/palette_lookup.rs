@@ -0,0 +1,254 @@
+// Nearest-palette lookup shared by every remap and dither path
+// Built once per palette: a 3D grid over the color space where each cell keeps only
+// the palette entries that can be nearest to some point inside it
+//
+// Works on any 3-component space (sRGB bytes, OKLab) and returns exactly the same
+// index as a full linear scan, including ties (lowest index wins)
+
+/// Cells per axis; 16³ cells leaves ~6 candidates per cell for a 256-color palette
+const GRID: usize = 16;
+
+/// Relative slack on the pruning bound so f32 rounding never drops a true nearest entry
+const PRUNE_SLACK: f32 = 1e-4;
+
+/// Precomputed nearest-color structure for one palette
+pub struct PaletteIndex {
+    colors: Vec<[f32; 3]>,       // Palette entries in lookup space
+    lo: [f32; 3],                // Grid origin
+    inv_cell: [f32; 3],          // Cells per unit along each axis
+    cell_start: Vec<u32>,        // GRID³ + 1 offsets into the candidate arrays
+    cand_index: Vec<u8>,         // Candidate palette indices, ascending per cell
+    cand_color: Vec<[f32; 3]>,   // Candidate colors, contiguous per cell
+}
+
+impl PaletteIndex {
+    /// Build the index for `colors`; queries inside [`lo`, `hi`] use the grid,
+    /// anything outside falls back to a linear scan
+    pub fn new(colors: &[[f32; 3]], lo: [f32; 3], hi: [f32; 3]) -> Self {
+        let colors: Vec<[f32; 3]> = colors.iter().take(256).copied().collect();
+
+        let mut cell_size = [0f32; 3];
+        let mut inv_cell = [0f32; 3];
+        for c in 0..3 {
+            let extent = (hi[c] - lo[c]).max(f32::EPSILON);
+            cell_size[c] = extent / GRID as f32;
+            inv_cell[c] = GRID as f32 / extent;
+        }
+
+        // Box distances are separable: per axis, the squared gap to (and the squared
+        // span across) each cell slab depends only on the color and the slab index
+        let n = colors.len();
+        let mut near_axis = [vec![0f32; GRID * n], vec![0f32; GRID * n], vec![0f32; GRID * n]];
+        let mut far_axis = [vec![0f32; GRID * n], vec![0f32; GRID * n], vec![0f32; GRID * n]];
+        for slab in 0..GRID {
+            for (i, color) in colors.iter().enumerate() {
+                for c in 0..3 {
+                    let slab_lo = lo[c] + slab as f32 * cell_size[c];
+                    let slab_hi = slab_lo + cell_size[c];
+                    let gap = (slab_lo - color[c]).max(color[c] - slab_hi).max(0.0);
+                    let span = (color[c] - slab_lo).abs().max((slab_hi - color[c]).abs());
+                    near_axis[c][slab * n + i] = gap * gap;
+                    far_axis[c][slab * n + i] = span * span;
+                }
+            }
+        }
+
+        let mut cell_start = Vec::with_capacity(GRID * GRID * GRID + 1);
+        let mut cand_index = Vec::new();
+        let mut cand_color = Vec::new();
+        let mut min_dist = vec![0f32; n];
+        let mut max_dist = vec![0f32; n];
+
+        for cz in 0..GRID {
+            for cy in 0..GRID {
+                for cx in 0..GRID {
+                    cell_start.push(cand_index.len() as u32);
+
+                    let (nx, ny, nz) = (&near_axis[0][cx * n..][..n], &near_axis[1][cy * n..][..n], &near_axis[2][cz * n..][..n]);
+                    let (fx, fy, fz) = (&far_axis[0][cx * n..][..n], &far_axis[1][cy * n..][..n], &far_axis[2][cz * n..][..n]);
+                    for i in 0..n {
+                        min_dist[i] = nx[i] + ny[i] + nz[i];
+                        max_dist[i] = fx[i] + fy[i] + fz[i];
+                    }
+
+                    // Every point in the cell is within `bound` of some entry, so an
+                    // entry whose closest approach to the cell exceeds it never wins
+                    let bound = min_lanes(&max_dist);
+                    let bound = bound * (1.0 + PRUNE_SLACK) + f32::EPSILON;
+
+                    for (i, color) in colors.iter().enumerate() {
+                        if min_dist[i] <= bound {
+                            cand_index.push(i as u8);
+                            cand_color.push(*color);
+                        }
+                    }
+                }
+            }
+        }
+        cell_start.push(cand_index.len() as u32);
+
+        Self {
+            colors,
+            lo,
+            inv_cell,
+            cell_start,
+            cand_index,
+            cand_color,
+        }
+    }
+
+    /// Index over an sRGB palette, looking up in byte RGB space
+    pub fn from_rgba(palette: &[[u8; 4]]) -> Self {
+        let colors: Vec<[f32; 3]> = palette
+            .iter()
+            .map(|p| [p[0] as f32, p[1] as f32, p[2] as f32])
+            .collect();
+        Self::new(&colors, [0.0; 3], [256.0; 3])
+    }
+
+    /// Number of palette entries
+    pub fn len(&self) -> usize {
+        self.colors.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.colors.is_empty()
+    }
+
+    /// Palette entry in lookup space
+    pub fn color(&self, index: usize) -> [f32; 3] {
+        self.colors[index]
+    }
+
+    /// Nearest palette index by squared Euclidean distance (0 for an empty palette)
+    #[inline]
+    pub fn nearest(&self, p: [f32; 3]) -> usize {
+        let cx = ((p[0] - self.lo[0]) * self.inv_cell[0]).floor();
+        let cy = ((p[1] - self.lo[1]) * self.inv_cell[1]).floor();
+        let cz = ((p[2] - self.lo[2]) * self.inv_cell[2]).floor();
+
+        let g = GRID as f32;
+        if !(cx >= 0.0 && cx < g && cy >= 0.0 && cy < g && cz >= 0.0 && cz < g) {
+            return self.nearest_linear(p);
+        }
+
+        let cell = (cz as usize * GRID + cy as usize) * GRID + cx as usize;
+        let (start, end) = (self.cell_start[cell] as usize, self.cell_start[cell + 1] as usize);
+
+        let mut best = (f32::MAX, 0usize);
+        for (k, c) in self.cand_color[start..end].iter().enumerate() {
+            let d = dist2(&p, c);
+            if d < best.0 {
+                best = (d, k);
+            }
+        }
+
+        if start == end {
+            0
+        } else {
+            self.cand_index[start + best.1] as usize
+        }
+    }
+
+    /// Nearest palette index for a byte RGB(A) pixel
+    #[inline]
+    pub fn nearest_rgb(&self, pixel: &[u8]) -> usize {
+        self.nearest([pixel[0] as f32, pixel[1] as f32, pixel[2] as f32])
+    }
+
+    /// Reference full scan; also used for queries outside the grid
+    pub fn nearest_linear(&self, p: [f32; 3]) -> usize {
+        let mut best = (f32::MAX, 0usize);
+        for (i, c) in self.colors.iter().enumerate() {
+            let d = dist2(&p, c);
+            if d < best.0 {
+                best = (d, i);
+            }
+        }
+        best.1
+    }
+
+    /// Average candidates per cell, a measure of how well the grid prunes
+    pub fn mean_candidates(&self) -> f32 {
+        self.cand_index.len() as f32 / (GRID * GRID * GRID) as f32
+    }
+}
+
+/// Minimum of a slice, reduced in 8 independent lanes so it vectorizes
+#[inline]
+fn min_lanes(values: &[f32]) -> f32 {
+    let mut lanes = [f32::MAX; 8];
+    let mut chunks = values.chunks_exact(8);
+    for chunk in &mut chunks {
+        for (lane, &v) in lanes.iter_mut().zip(chunk) {
+            *lane = lane.min(v);
+        }
+    }
+    let tail = chunks.remainder().iter().fold(f32::MAX, |m, &v| m.min(v));
+    lanes.iter().fold(tail, |m, &v| m.min(v))
+}
+
+#[inline(always)]
+fn dist2(a: &[f32; 3], b: &[f32; 3]) -> f32 {
+    let d0 = a[0] - b[0];
+    let d1 = a[1] - b[1];
+    let d2 = a[2] - b[2];
+    d0 * d0 + d1 * d1 + d2 * d2
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Deterministic xorshift so the tests need no rand dependency
+    fn xorshift(state: &mut u32) -> u32 {
+        *state ^= *state << 13;
+        *state ^= *state >> 17;
+        *state ^= *state << 5;
+        *state
+    }
+
+    #[test]
+    fn test_rgb_matches_linear_scan() {
+        let mut seed = 0x1234_5678;
+        let palette: Vec<[u8; 4]> = (0..256)
+            .map(|_| {
+                let v = xorshift(&mut seed);
+                [v as u8, (v >> 8) as u8, (v >> 16) as u8, 255]
+            })
+            .collect();
+        let index = PaletteIndex::from_rgba(&palette);
+        assert!(index.mean_candidates() < 64.0, "grid should prune most of the palette");
+
+        for _ in 0..50_000 {
+            let v = xorshift(&mut seed);
+            let p = [v as u8 as f32, (v >> 8) as u8 as f32, (v >> 16) as u8 as f32];
+            assert_eq!(index.nearest(p), index.nearest_linear(p));
+        }
+    }
+
+    #[test]
+    fn test_ties_pick_lowest_index() {
+        // Duplicate entries: the first occurrence must win, as in a linear scan
+        let palette = [[10, 10, 10, 255], [200, 0, 0, 255], [10, 10, 10, 255]];
+        let index = PaletteIndex::from_rgba(&palette);
+        assert_eq!(index.nearest_rgb(&[12, 9, 11, 255]), 0);
+        assert_eq!(index.nearest_rgb(&[190, 5, 0, 255]), 1);
+    }
+
+    #[test]
+    fn test_out_of_range_falls_back() {
+        let colors = [[0.2f32, 0.0, 0.0], [0.8, 0.1, -0.1]];
+        let index = PaletteIndex::new(&colors, [0.0, -0.4, -0.4], [1.0, 0.4, 0.4]);
+        assert_eq!(index.nearest([1.5, 0.0, 0.0]), 1);
+        assert_eq!(index.nearest([-0.5, 0.0, 0.0]), 0);
+        assert_eq!(index.nearest([0.25, 0.01, 0.0]), 0);
+    }
+
+    #[test]
+    fn test_empty_palette() {
+        let index = PaletteIndex::from_rgba(&[]);
+        assert!(index.is_empty());
+        assert_eq!(index.nearest_rgb(&[1, 2, 3, 255]), 0);
+    }
+}
@@ -2,6 +2,8 @@
 // Provides work-stealing parallelism for frame and row processing
 
 use rayon::prelude::*;
+use std::collections::HashMap;
+use std::sync::{Arc, Mutex, OnceLock};
 
 /// Process frames in parallel with configurable chunk size
 pub fn process_frames_parallel<T, F, R>(
@@ -123,6 +125,41 @@ where
     })
 }
 
+/// Run `op` inside a pool with `num_threads` workers (0 = global pool)
+/// Pools are built once per size and cached, so FFI callers can pass a
+/// thread count on every call without paying thread spawn cost each time
+pub fn install_with_threads<OP, R>(num_threads: usize, op: OP) -> R
+where
+    OP: FnOnce() -> R + Send,
+    R: Send,
+{
+    if num_threads == 0 {
+        return op();
+    }
+
+    static POOLS: OnceLock<Mutex<HashMap<usize, Arc<rayon::ThreadPool>>>> = OnceLock::new();
+
+    let pool = {
+        let mut pools = POOLS
+            .get_or_init(|| Mutex::new(HashMap::new()))
+            .lock()
+            .unwrap();
+        pools
+            .entry(num_threads)
+            .or_insert_with(|| {
+                Arc::new(
+                    rayon::ThreadPoolBuilder::new()
+                        .num_threads(num_threads)
+                        .build()
+                        .unwrap(),
+                )
+            })
+            .clone()
+    };
+
+    pool.install(op)
+}
+
 /// Parallel pipeline with multiple stages
 pub fn parallel_pipeline<T1, T2, T3, F1, F2>(
     input: Vec<T1>,
@@ -207,6 +244,16 @@ mod tests {
         }
     }
 
+    #[test]
+    fn test_install_with_threads() {
+        let threads = install_with_threads(2, rayon::current_num_threads);
+        assert_eq!(threads, 2);
+
+        // Second call reuses the cached pool
+        let sum: i32 = install_with_threads(2, || (1..=4).into_par_iter().sum());
+        assert_eq!(sum, 10);
+    }
+
     #[test]
     fn test_batch_processor() {
         let processor = BatchProcessor::new(3, 2);
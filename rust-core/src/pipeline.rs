@@ -0,0 +1,411 @@
+// Streaming capture pipeline - frames are processed while the camera is still running
+// submit_frame → resize workers → quantize/remap (in order) → LZW workers
+//
+// Stages are joined by bounded queues, so a slow stage holds back capture instead
+// of the clip piling up in memory. finish() only drains what is still in flight,
+// then writes the header and the already-compressed frames.
+
+use std::borrow::Cow;
+use std::collections::BTreeMap;
+use std::sync::atomic::{AtomicU32, Ordering};
+use std::sync::mpsc::{sync_channel, Receiver, SyncSender};
+use std::sync::{Arc, Mutex};
+use std::thread::{self, JoinHandle};
+use std::time::Instant;
+
+use gif::Frame;
+
+use crate::stats::{Recorder, Stage};
+use crate::{
+    as_uninit, build_indexed_tensor, build_tensor_from_frames, encode_frame, gif_global_palette,
+    new_gif_encoder, palette_bytes, rgba_pixels, downsample,
+    GifOpts, PipelineOpts, ProcessResult, ProcessorError, QuantizeOpts, Result,
+};
+
+/// Reserved transparent index when optimizing: the palette is capped at 255
+/// colors, because a streamed clip can't be scanned for an unused index up front
+const TRANSPARENT_INDEX: u8 = 255;
+
+/// Queue depth used when PipelineOpts.queue_depth is 0
+const DEFAULT_QUEUE_DEPTH: usize = 4;
+
+type Shared<T> = Arc<Mutex<T>>;
+
+/// A remapped frame on its way to LZW, with its predecessor for delta cropping
+struct EncodeJob {
+    index: usize,
+    indices: Arc<Vec<u8>>,
+    prev: Option<Arc<Vec<u8>>>,
+}
+
+/// What the quantize stage hands back at finish
+struct Quantized {
+    frame_count: usize,
+    palette: Vec<[u8; 4]>,
+    index_volume: Vec<u8>,       // Only kept for the indexed tensor
+    rgba_frames: Vec<Vec<u8>>,   // Only kept for the RGBA tensor
+}
+
+struct Running {
+    input: SyncSender<(usize, Vec<u8>)>,
+    resize_workers: Vec<JoinHandle<()>>,
+    quantize: JoinHandle<Option<Quantized>>,
+    encode_workers: Vec<JoinHandle<()>>,
+    encoded: Shared<Vec<(usize, Frame<'static>)>>,
+}
+
+/// Frame-at-a-time GIF encoder for live capture
+///
+/// Each submitted frame is area-downsampled, remapped to the clip palette and
+/// LZW-compressed on worker threads while later frames are still being
+/// captured. The palette comes from the first frame (a stream can't be sampled
+/// ahead), and the output matches process_all_frames with `shared_palette` off.
+/// It is always built by imagequant: `oklab_palette` needs the whole clip's
+/// histogram, so a stream ignores it.
+/// With `optimize`, index 255 is reserved for transparency.
+/// Remapping stays on one thread, in frame order, because imagequant's result
+/// is stateful (imagequant parallelizes each remap internally).
+pub struct FramePipeline {
+    state: Mutex<Option<Running>>,
+    failure: Shared<Option<ProcessorError>>,
+    submitted: AtomicU32,
+    frame_len: usize,
+    gif_opts: GifOpts,
+    started: Instant,
+    stats: Arc<Recorder>,
+}
+
+impl FramePipeline {
+    pub fn new(pipeline_opts: PipelineOpts, quantize_opts: QuantizeOpts, gif_opts: GifOpts) -> Result<Self> {
+        let (src_w, src_h) = (pipeline_opts.source_width as usize, pipeline_opts.source_height as usize);
+        let (dst_w, dst_h) = (gif_opts.width as usize, gif_opts.height as usize);
+        if dst_w == 0 || dst_h == 0 || dst_w > src_w || dst_h > src_h || gif_opts.fps == 0 {
+            return Err(ProcessorError::InvalidInput);
+        }
+
+        let cores = thread::available_parallelism().map(|n| n.get()).unwrap_or(1);
+        let resize_workers = match pipeline_opts.resize_workers {
+            0 => (cores / 2).max(1),
+            n => n as usize,
+        };
+        let encode_workers = match pipeline_opts.encode_workers {
+            0 => cores,
+            n => n as usize,
+        };
+        let depth = match pipeline_opts.queue_depth {
+            0 => DEFAULT_QUEUE_DEPTH,
+            n => n as usize,
+        };
+
+        let failure: Shared<Option<ProcessorError>> = Arc::new(Mutex::new(None));
+        let stats = Arc::new(Recorder::new());
+        let encoded = Arc::new(Mutex::new(Vec::with_capacity(gif_opts.frame_count as usize)));
+
+        let (input, input_rx) = sync_channel::<(usize, Vec<u8>)>(depth);
+        let (resized_tx, resized_rx) = sync_channel::<(usize, Vec<u8>)>(depth);
+        let (encode_tx, encode_rx) = sync_channel::<EncodeJob>(depth);
+
+        let input_rx = Arc::new(Mutex::new(input_rx));
+        let resize_workers = (0..resize_workers)
+            .map(|_| {
+                let (rx, tx, stats) = (input_rx.clone(), resized_tx.clone(), stats.clone());
+                thread::spawn(move || resize_worker(rx, tx, (src_w, src_h), (dst_w, dst_h), &stats))
+            })
+            .collect();
+        drop(resized_tx);
+
+        let quantize = {
+            let (failure, gif_opts, stats) = (failure.clone(), gif_opts.clone(), stats.clone());
+            thread::spawn(move || {
+                match quantize_stage(resized_rx, encode_tx, &quantize_opts, &gif_opts, &stats) {
+                    Ok(quantized) => Some(quantized),
+                    Err(err) => {
+                        record_failure(&failure, err);
+                        None
+                    }
+                }
+            })
+        };
+
+        let encode_rx = Arc::new(Mutex::new(encode_rx));
+        let encode_workers = (0..encode_workers)
+            .map(|_| {
+                let (rx, encoded, gif_opts, stats) = (encode_rx.clone(), encoded.clone(), gif_opts.clone(), stats.clone());
+                thread::spawn(move || encode_worker(rx, encoded, &gif_opts, &stats))
+            })
+            .collect();
+
+        Ok(FramePipeline {
+            state: Mutex::new(Some(Running {
+                input,
+                resize_workers,
+                quantize,
+                encode_workers,
+                encoded,
+            })),
+            failure,
+            submitted: AtomicU32::new(0),
+            frame_len: src_w * src_h * 4,
+            gif_opts,
+            started: Instant::now(),
+            stats,
+        })
+    }
+
+    /// Queue one RGBA frame at the source resolution
+    /// Blocks while the first stage's queue is full (counted as ingest time)
+    pub fn submit_frame(&self, frame_rgba: Vec<u8>) -> Result<()> {
+        if frame_rgba.len() != self.frame_len {
+            return Err(ProcessorError::InvalidInput);
+        }
+        let _ingest = self.stats.stage(Stage::Ingest);
+        self.stats.allocated(frame_rgba.len());
+        let state = self.state.lock().unwrap();
+        let running = state.as_ref().ok_or(ProcessorError::InvalidInput)?;
+
+        let index = self.submitted.load(Ordering::Relaxed) as usize;
+        if running.input.send((index, frame_rgba)).is_err() {
+            // Every worker has exited, which only happens after a stage failed
+            return Err(self.failure.lock().unwrap().unwrap_or(ProcessorError::EncodingError));
+        }
+        self.submitted.fetch_add(1, Ordering::Relaxed);
+        Ok(())
+    }
+
+    /// Frames accepted so far
+    pub fn frames_submitted(&self) -> u32 {
+        self.submitted.load(Ordering::Relaxed)
+    }
+
+    /// Drain the stages and assemble the GIF; the pipeline can't be reused
+    pub fn finish(&self) -> Result<ProcessResult> {
+        let running = self.state.lock().unwrap().take().ok_or(ProcessorError::InvalidInput)?;
+
+        // Closing each stage's input lets its workers exit once the queue is empty
+        drop(running.input);
+        let mut panicked = false;
+        for worker in running.resize_workers {
+            panicked |= worker.join().is_err();
+        }
+        let quantized = running.quantize.join().unwrap_or(None);
+        for worker in running.encode_workers {
+            panicked |= worker.join().is_err();
+        }
+
+        if let Some(err) = *self.failure.lock().unwrap() {
+            return Err(err);
+        }
+        let quantized = match quantized {
+            Some(quantized) if !panicked => quantized,
+            _ => return Err(ProcessorError::EncodingError),
+        };
+        if quantized.frame_count == 0 {
+            return Err(ProcessorError::InvalidInput);
+        }
+
+        let mut encoded = std::mem::take(&mut *running.encoded.lock().unwrap());
+        if encoded.len() != quantized.frame_count {
+            return Err(ProcessorError::EncodingError);
+        }
+        encoded.sort_unstable_by_key(|(index, _)| *index);
+
+        let lzw_stage = self.stats.stage(Stage::Lzw);
+        let mut gif_buffer = Vec::new();
+        {
+            let global_palette = gif_global_palette(&quantized.palette);
+            let mut encoder = new_gif_encoder(&mut gif_buffer, &global_palette, &self.gif_opts)?;
+            for (_, frame) in &encoded {
+                encoder.write_lzw_pre_encoded_frame(frame)
+                    .map_err(|_| ProcessorError::EncodingError)?;
+            }
+        } // encoder is dropped here, writing the trailer
+        self.stats.allocated(gif_buffer.len());
+        drop(lzw_stage);
+
+        let tensor_stage = self.stats.stage(Stage::Tensor);
+        let (width, height) = (self.gif_opts.width as u32, self.gif_opts.height as u32);
+        let (tensor_indices, tensor_palette) = if self.gif_opts.include_tensor && self.gif_opts.indexed_tensor {
+            let indices = build_indexed_tensor(
+                quantized.index_volume,
+                quantized.frame_count,
+                width,
+                height,
+                self.gif_opts.tensor_layout,
+            )?;
+            self.stats.allocated(indices.len());
+            (Some(indices), Some(palette_bytes(&quantized.palette)))
+        } else {
+            (None, None)
+        };
+        let tensor_data = if self.gif_opts.include_tensor && !self.gif_opts.indexed_tensor {
+            let frames: Vec<&[u8]> = quantized.rgba_frames.iter().map(|f| &f[..]).collect();
+            let tensor = build_tensor_from_frames(&frames, width, height, self.gif_opts.tensor_layout)?;
+            self.stats.allocated(tensor.len());
+            Some(tensor)
+        } else {
+            None
+        };
+        drop(tensor_stage);
+
+        let file_size = gif_buffer.len() as u32;
+        Ok(ProcessResult {
+            gif_data: gif_buffer,
+            tensor_data,
+            tensor_indices,
+            tensor_palette,
+            final_file_size: file_size,
+            processing_time_ms: self.started.elapsed().as_millis() as f32,
+            actual_frame_count: quantized.frame_count as u16,
+            palette_size_used: quantized.palette.len() as u16,
+            stats: self.stats.finish(),
+        })
+    }
+}
+
+/// Keep the first error; later ones are usually its consequences
+fn record_failure(failure: &Shared<Option<ProcessorError>>, err: ProcessorError) {
+    failure.lock().unwrap().get_or_insert(err);
+}
+
+/// Next job from a queue shared by several workers; None once it is closed
+fn next_job<T>(queue: &Shared<Receiver<T>>) -> Option<T> {
+    queue.lock().unwrap().recv().ok()
+}
+
+fn resize_worker(
+    input: Shared<Receiver<(usize, Vec<u8>)>>,
+    output: SyncSender<(usize, Vec<u8>)>,
+    (src_w, src_h): (usize, usize),
+    (dst_w, dst_h): (usize, usize),
+    stats: &Recorder,
+) {
+    while let Some((index, frame)) = next_job(&input) {
+        let frame = if (src_w, src_h) == (dst_w, dst_h) {
+            frame
+        } else {
+            let _resize = stats.stage(Stage::Resize);
+            let mut resized = vec![0u8; dst_w * dst_h * 4];
+            // Sizes were validated at construction, so this can't fail
+            downsample::downsample_area_into(&frame, src_w, src_h, src_w * 4, &mut resized, dst_w, dst_h);
+            resized
+        };
+        if output.send((index, frame)).is_err() {
+            return;
+        }
+    }
+}
+
+/// Quantize from the first frame, then remap every frame in submission order
+fn quantize_stage(
+    input: Receiver<(usize, Vec<u8>)>,
+    output: SyncSender<EncodeJob>,
+    quantize_opts: &QuantizeOpts,
+    gif_opts: &GifOpts,
+    stats: &Recorder,
+) -> Result<Quantized> {
+    let (width, height) = (gif_opts.width as usize, gif_opts.height as usize);
+    let keep_indices = gif_opts.include_tensor && gif_opts.indexed_tensor;
+    let keep_rgba = gif_opts.include_tensor && !gif_opts.indexed_tensor;
+
+    let mut attr = imagequant::new();
+    attr.set_quality(quantize_opts.quality_min, quantize_opts.quality_max)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    attr.set_speed(quantize_opts.speed)
+        .map_err(|_| ProcessorError::QuantizationError)?;
+    if gif_opts.optimize {
+        attr.set_max_colors(TRANSPARENT_INDEX as u32)
+            .map_err(|_| ProcessorError::QuantizationError)?;
+    }
+
+    let mut quantization = None;
+    let mut out = Quantized {
+        frame_count: 0,
+        palette: Vec::new(),
+        index_volume: Vec::new(),
+        rgba_frames: Vec::new(),
+    };
+    let mut prev: Option<Arc<Vec<u8>>> = None;
+
+    // Resize workers finish out of order; hold frames until their turn
+    let mut pending = BTreeMap::new();
+    for (index, frame) in input {
+        pending.insert(index, frame);
+        while let Some(frame) = pending.remove(&out.frame_count) {
+            let mut image = attr.new_image_borrowed(rgba_pixels(&frame), width, height, 0.0)
+                .map_err(|_| ProcessorError::QuantizationError)?;
+
+            if quantization.is_none() {
+                let _palette = stats.stage(Stage::Palette);
+                let mut result = attr.quantize(&mut image)
+                    .map_err(|_| ProcessorError::QuantizationError)?;
+                result.set_dithering_level(quantize_opts.dithering_level)
+                    .map_err(|_| ProcessorError::QuantizationError)?;
+                quantization = Some(result);
+            }
+            let quantization = quantization.as_mut().unwrap();
+
+            let remap = stats.stage(Stage::Remap);
+            let clock = stats.frame_clock();
+            let mut indices = vec![0u8; width * height];
+            quantization.remap_into(&mut image, as_uninit(&mut indices))
+                .map_err(|_| ProcessorError::QuantizationError)?;
+            drop(image);
+            stats.frame_remapped(clock);
+            drop(remap);
+
+            if keep_indices {
+                out.index_volume.extend_from_slice(&indices);
+            }
+            if keep_rgba {
+                out.rgba_frames.push(frame);
+            }
+
+            let indices = Arc::new(indices);
+            let job = EncodeJob { index: out.frame_count, indices: indices.clone(), prev: prev.replace(indices) };
+            if output.send(job).is_err() {
+                return Err(ProcessorError::EncodingError);
+            }
+            out.frame_count += 1;
+        }
+    }
+
+    // Read after remapping, as the batch path does: remap refines the palette
+    if let Some(quantization) = quantization.as_mut() {
+        out.palette = quantization.palette().iter().map(|c| [c.r, c.g, c.b, c.a]).collect();
+    }
+    Ok(out)
+}
+
+fn encode_worker(
+    input: Shared<Receiver<EncodeJob>>,
+    encoded: Shared<Vec<(usize, Frame<'static>)>>,
+    gif_opts: &GifOpts,
+    stats: &Recorder,
+) {
+    let transparent = gif_opts.optimize.then_some(TRANSPARENT_INDEX);
+    while let Some(job) = next_job(&input) {
+        let lzw = stats.stage(Stage::Lzw);
+        let frame = encode_frame(&job.indices, job.prev.as_deref().map(|p| &p[..]), transparent, gif_opts);
+        let frame = into_owned_frame(frame);
+        stats.frame_encoded(frame.buffer.len());
+        drop(lzw);
+        encoded.lock().unwrap().push((job.index, frame));
+    }
+}
+
+/// Detach a pre-encoded frame from the index buffer it was built from
+fn into_owned_frame(frame: Frame<'_>) -> Frame<'static> {
+    Frame {
+        delay: frame.delay,
+        dispose: frame.dispose,
+        transparent: frame.transparent,
+        needs_user_input: frame.needs_user_input,
+        top: frame.top,
+        left: frame.left,
+        width: frame.width,
+        height: frame.height,
+        interlaced: frame.interlaced,
+        palette: frame.palette,
+        buffer: Cow::Owned(frame.buffer.into_owned()),
+    }
+}
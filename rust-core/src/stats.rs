@@ -0,0 +1,249 @@
+// Per-call instrumentation: stage timers, allocation totals, per-frame histograms
+// and os_signpost-style intervals
+//
+// Off by default. A disabled recorder costs one branch per stage or frame and never
+// reads the clock. Collection is switched on process-wide (like a log level) with
+// set_stats_enabled; intervals go to a listener installed with set_signpost_listener,
+// which the Swift side forwards to os_signpost(.begin/.end).
+
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, Ordering};
+use std::sync::{Arc, RwLock};
+use std::time::Instant;
+
+/// Pipeline stages that get their own timer and signpost interval
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Stage {
+    Ingest,  // Validating and splitting the caller's buffer, or queueing frames
+    Resize,  // Downsampling to the output size
+    Palette, // Building the palette
+    Remap,   // Mapping pixels to palette indices
+    Lzw,     // LZW compression and GIF assembly
+    Tensor,  // Voxel tensor build
+}
+
+const STAGES: usize = 6;
+
+/// Log2 buckets per histogram; the last one also holds everything larger
+pub const HISTOGRAM_BUCKETS: usize = 24;
+
+/// What one call spent, returned in ProcessResult.stats when collection is on
+#[derive(Debug, Clone, Default)]
+pub struct ProcessStats {
+    pub ingest_ns: u64,
+    pub resize_ns: u64,       // Summed over resize workers
+    pub palette_ns: u64,
+    pub remap_ns: u64,
+    pub lzw_ns: u64,
+    pub tensor_ns: u64,
+    pub bytes_allocated: u64, // Clip-sized buffers (frames, index volume, GIF, tensors), not every small allocation
+    pub frame_remap_us: Vec<u32>,  // Bucket k counts frames remapped in [2^k, 2^(k+1)) µs (bucket 0 includes < 1 µs)
+    pub frame_lzw_bytes: Vec<u32>, // Bucket k counts frames compressing to [2^k, 2^(k+1)) bytes
+}
+
+/// Interval callbacks, implemented on the foreign side
+/// `id` pairs a begin with its end; intervals of one stage may overlap across calls
+pub trait SignpostListener: Send + Sync {
+    fn on_interval_begin(&self, stage: Stage, id: u64);
+    fn on_interval_end(&self, stage: Stage, id: u64);
+}
+
+static COLLECT: AtomicBool = AtomicBool::new(false);
+static LISTENER: RwLock<Option<Arc<dyn SignpostListener>>> = RwLock::new(None);
+static NEXT_INTERVAL: AtomicU64 = AtomicU64::new(1);
+
+/// Turn stats collection on or off for calls that start afterwards
+pub fn set_stats_enabled(enabled: bool) {
+    COLLECT.store(enabled, Ordering::Relaxed);
+}
+
+pub fn set_signpost_listener(listener: Box<dyn SignpostListener>) {
+    *LISTENER.write().unwrap() = Some(Arc::from(listener));
+}
+
+pub fn clear_signpost_listener() {
+    *LISTENER.write().unwrap() = None;
+}
+
+/// Accumulates one call's stats; Sync, so stage workers can share it
+pub(crate) struct Recorder {
+    collect: bool,
+    listener: Option<Arc<dyn SignpostListener>>, // Snapshot, so a call never sees half a swap
+    stage_ns: [AtomicU64; STAGES],
+    bytes_allocated: AtomicU64,
+    frame_remap_us: [AtomicU32; HISTOGRAM_BUCKETS],
+    frame_lzw_bytes: [AtomicU32; HISTOGRAM_BUCKETS],
+}
+
+impl Recorder {
+    /// Recorder for a call starting now, following the process-wide switches
+    pub fn new() -> Self {
+        Recorder {
+            collect: COLLECT.load(Ordering::Relaxed),
+            listener: LISTENER.read().unwrap().clone(),
+            stage_ns: Default::default(),
+            bytes_allocated: AtomicU64::new(0),
+            frame_remap_us: Default::default(),
+            frame_lzw_bytes: Default::default(),
+        }
+    }
+
+    /// Time `stage` until the returned span is dropped
+    #[inline]
+    pub fn stage(&self, stage: Stage) -> Span<'_> {
+        if !self.collect && self.listener.is_none() {
+            return Span { recorder: self, stage, started: None, id: 0 };
+        }
+        let id = match &self.listener {
+            Some(listener) => {
+                let id = NEXT_INTERVAL.fetch_add(1, Ordering::Relaxed);
+                listener.on_interval_begin(stage, id);
+                id
+            }
+            None => 0,
+        };
+        Span { recorder: self, stage, started: Some(Instant::now()), id }
+    }
+
+    /// Count a clip-sized buffer
+    #[inline]
+    pub fn allocated(&self, bytes: usize) {
+        if self.collect {
+            self.bytes_allocated.fetch_add(bytes as u64, Ordering::Relaxed);
+        }
+    }
+
+    /// Start timing one frame's remap; None when collection is off
+    #[inline]
+    pub fn frame_clock(&self) -> Option<Instant> {
+        if self.collect { Some(Instant::now()) } else { None }
+    }
+
+    #[inline]
+    pub fn frame_remapped(&self, clock: Option<Instant>) {
+        if let Some(started) = clock {
+            let us = started.elapsed().as_micros() as u64;
+            self.frame_remap_us[bucket(us)].fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    #[inline]
+    pub fn frame_encoded(&self, lzw_bytes: usize) {
+        if self.collect {
+            self.frame_lzw_bytes[bucket(lzw_bytes as u64)].fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    /// The collected stats, or None when collection was off for this call
+    pub fn finish(&self) -> Option<ProcessStats> {
+        if !self.collect {
+            return None;
+        }
+        let ns = |stage: Stage| self.stage_ns[stage as usize].load(Ordering::Relaxed);
+        let histogram = |buckets: &[AtomicU32]| buckets.iter().map(|b| b.load(Ordering::Relaxed)).collect();
+        Some(ProcessStats {
+            ingest_ns: ns(Stage::Ingest),
+            resize_ns: ns(Stage::Resize),
+            palette_ns: ns(Stage::Palette),
+            remap_ns: ns(Stage::Remap),
+            lzw_ns: ns(Stage::Lzw),
+            tensor_ns: ns(Stage::Tensor),
+            bytes_allocated: self.bytes_allocated.load(Ordering::Relaxed),
+            frame_remap_us: histogram(&self.frame_remap_us),
+            frame_lzw_bytes: histogram(&self.frame_lzw_bytes),
+        })
+    }
+}
+
+/// Open stage interval; closes on drop
+pub(crate) struct Span<'a> {
+    recorder: &'a Recorder,
+    stage: Stage,
+    started: Option<Instant>,
+    id: u64,
+}
+
+impl Drop for Span<'_> {
+    #[inline]
+    fn drop(&mut self) {
+        if let Some(started) = self.started {
+            let ns = started.elapsed().as_nanos() as u64;
+            self.recorder.stage_ns[self.stage as usize].fetch_add(ns, Ordering::Relaxed);
+            if let Some(listener) = &self.recorder.listener {
+                listener.on_interval_end(self.stage, self.id);
+            }
+        }
+    }
+}
+
+/// Log2 histogram bucket: floor(log2(value)), with 0 and 1 in bucket 0
+#[inline]
+fn bucket(value: u64) -> usize {
+    ((63 - (value | 1).leading_zeros()) as usize).min(HISTOGRAM_BUCKETS - 1)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Mutex;
+
+    #[test]
+    fn test_buckets() {
+        assert_eq!(bucket(0), 0);
+        assert_eq!(bucket(1), 0);
+        assert_eq!(bucket(2), 1);
+        assert_eq!(bucket(1023), 9);
+        assert_eq!(bucket(1024), 10);
+        assert_eq!(bucket(u64::MAX), HISTOGRAM_BUCKETS - 1);
+    }
+
+    #[test]
+    fn test_recorder_collects_and_pairs_intervals() {
+        struct Log(Mutex<Vec<(bool, Stage, u64)>>);
+        impl SignpostListener for Arc<Log> {
+            fn on_interval_begin(&self, stage: Stage, id: u64) {
+                self.0.lock().unwrap().push((true, stage, id));
+            }
+            fn on_interval_end(&self, stage: Stage, id: u64) {
+                self.0.lock().unwrap().push((false, stage, id));
+            }
+        }
+
+        // Built by hand rather than through the process-wide switches, which
+        // other tests running in parallel would see
+        let log = Arc::new(Log(Mutex::new(Vec::new())));
+        let recorder = Recorder {
+            collect: true,
+            listener: Some(Arc::new(log.clone())),
+            ..Recorder::new()
+        };
+
+        {
+            let _lzw = recorder.stage(Stage::Lzw);
+            let clock = recorder.frame_clock();
+            std::thread::sleep(std::time::Duration::from_millis(2));
+            recorder.frame_remapped(clock);
+            recorder.frame_encoded(5000);
+            recorder.allocated(1 << 20);
+        }
+
+        let stats = recorder.finish().unwrap();
+        assert!(stats.lzw_ns >= 2_000_000);
+        assert_eq!(stats.remap_ns, 0);
+        assert_eq!(stats.bytes_allocated, 1 << 20);
+        assert_eq!(stats.frame_lzw_bytes[12], 1);
+        assert_eq!(stats.frame_remap_us.iter().sum::<u32>(), 1);
+
+        let log = log.0.lock().unwrap();
+        assert_eq!(log.len(), 2);
+        assert_eq!((log[0].0, log[0].1), (true, Stage::Lzw));
+        assert_eq!((log[1].0, log[1].1, log[1].2), (false, Stage::Lzw, log[0].2));
+    }
+
+    #[test]
+    fn test_disabled_recorder_reports_nothing() {
+        let recorder = Recorder { collect: false, listener: None, ..Recorder::new() };
+        drop(recorder.stage(Stage::Remap));
+        assert!(recorder.frame_clock().is_none());
+        assert!(recorder.finish().is_none());
+    }
+}
@@ -0,0 +1,140 @@
+// Cancellation, progress and background execution for the async exports
+// The encode runs on a plain thread; the future only waits for it, so it can be
+// polled by any executor (UniFFI drives it from Swift's concurrency runtime).
+
+use std::future::Future;
+use std::pin::Pin;
+use std::sync::atomic::{AtomicBool, AtomicU32, Ordering};
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Waker};
+use std::thread;
+
+use crate::{ProcessorError, Result};
+
+/// Progress callback, implemented on the foreign side
+pub trait ProgressListener: Send + Sync {
+    /// Called from a worker thread after each frame is remapped
+    fn on_progress(&self, frames_done: u32, frame_count: u32);
+}
+
+/// Cancellation flag and progress counter shared with one running encode
+pub struct EncodeTask {
+    cancelled: AtomicBool,
+    frames_done: AtomicU32,
+    listener: Mutex<Option<Box<dyn ProgressListener>>>,
+}
+
+impl EncodeTask {
+    pub fn new() -> Self {
+        EncodeTask {
+            cancelled: AtomicBool::new(false),
+            frames_done: AtomicU32::new(0),
+            listener: Mutex::new(None),
+        }
+    }
+
+    /// Ask the encode to stop; takes effect at the next frame boundary
+    pub fn cancel(&self) {
+        self.cancelled.store(true, Ordering::Relaxed);
+    }
+
+    pub fn is_cancelled(&self) -> bool {
+        self.cancelled.load(Ordering::Relaxed)
+    }
+
+    /// Frames remapped so far
+    pub fn frames_done(&self) -> u32 {
+        self.frames_done.load(Ordering::Relaxed)
+    }
+
+    pub fn set_listener(&self, listener: Box<dyn ProgressListener>) {
+        *self.listener.lock().unwrap() = Some(listener);
+    }
+}
+
+impl Default for EncodeTask {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Err(Cancelled) once `task` has been cancelled; no-op for blocking calls
+#[inline]
+pub(crate) fn check(task: Option<&EncodeTask>) -> Result<()> {
+    match task {
+        Some(task) if task.is_cancelled() => Err(ProcessorError::Cancelled),
+        _ => Ok(()),
+    }
+}
+
+/// Count one finished frame and notify the listener
+pub(crate) fn frame_done(task: Option<&EncodeTask>, frame_count: usize) {
+    if let Some(task) = task {
+        let done = task.frames_done.fetch_add(1, Ordering::Relaxed) + 1;
+        if let Some(listener) = task.listener.lock().unwrap().as_ref() {
+            listener.on_progress(done, frame_count as u32);
+        }
+    }
+}
+
+struct Slot<T> {
+    result: Option<Result<T>>,
+    waker: Option<Waker>,
+}
+
+/// Future for work running on a background thread
+/// Dropping it before completion cancels `task`, so an abandoned encode stops
+/// at its next frame instead of running to the end
+pub(crate) struct Background<T> {
+    slot: Arc<Mutex<Slot<T>>>,
+    task: Arc<EncodeTask>,
+    finished: bool,
+}
+
+/// Run `work` on a new thread
+pub(crate) fn background<T, F>(task: Arc<EncodeTask>, work: F) -> Background<T>
+where
+    T: Send + 'static,
+    F: FnOnce() -> Result<T> + Send + 'static,
+{
+    let slot = Arc::new(Mutex::new(Slot { result: None, waker: None }));
+    let thread_slot = slot.clone();
+    thread::spawn(move || {
+        // A panic still has to complete the future
+        let result = std::panic::catch_unwind(std::panic::AssertUnwindSafe(work))
+            .unwrap_or(Err(ProcessorError::EncodingError));
+        let mut slot = thread_slot.lock().unwrap();
+        slot.result = Some(result);
+        if let Some(waker) = slot.waker.take() {
+            waker.wake();
+        }
+    });
+    Background { slot, task, finished: false }
+}
+
+impl<T> Future for Background<T> {
+    type Output = Result<T>;
+
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Result<T>> {
+        let mut slot = self.slot.lock().unwrap();
+        match slot.result.take() {
+            Some(result) => {
+                drop(slot);
+                self.finished = true;
+                Poll::Ready(result)
+            }
+            None => {
+                slot.waker = Some(cx.waker().clone());
+                Poll::Pending
+            }
+        }
+    }
+}
+
+impl<T> Drop for Background<T> {
+    fn drop(&mut self) {
+        if !self.finished {
+            self.task.cancel();
+        }
+    }
+}
@@ -0,0 +1,115 @@
+// Temporal palette reuse for the per-frame NeuQuant batch (yx_proc_batch_rgba8_temporal)
+// Consecutive capture frames are nearly identical, so training a palette for every
+// frame is mostly wasted work. Each frame gets a coarse color histogram; while it
+// stays close to the histogram of the frame the current palette was trained on,
+// that palette is reused and the frame only pays for a remap.
+
+use std::ops::Range;
+
+/// Bits kept per channel; 3 bits (512 bins) is coarse enough to ignore sensor noise
+const SIGNATURE_BITS: u32 = 3;
+const SIGNATURE_BINS: usize = 1 << (3 * SIGNATURE_BITS);
+
+/// Pixels sampled per signature; the stride is fixed per frame size, so identical
+/// frames always produce identical signatures
+const SIGNATURE_SAMPLE_BUDGET: usize = 1 << 14;
+
+/// Default retrain threshold: a palette is kept until ~10% of pixels change bin
+pub const DEFAULT_REUSE_THRESHOLD: f32 = 0.1;
+
+/// Coarse RGB histogram of one frame
+pub struct ColorSignature {
+    bins: Vec<u32>,
+    total: u32,
+}
+
+impl ColorSignature {
+    /// Histogram of a strided sample of `pixels` (RGBA, `width` × `height`)
+    pub fn from_rgba(pixels: &[u8], width: usize, height: usize) -> Self {
+        let stride = crate::oklab_quantization::sample_stride_for_budget(width * height, SIGNATURE_SAMPLE_BUDGET);
+        let shift = 8 - SIGNATURE_BITS;
+
+        let mut bins = vec![0u32; SIGNATURE_BINS];
+        let mut total = 0u32;
+        for row in pixels.chunks_exact(width * 4).take(height).step_by(stride) {
+            for px in row.chunks_exact(4).step_by(stride) {
+                let bin = ((px[0] >> shift) as usize) << (2 * SIGNATURE_BITS)
+                    | ((px[1] >> shift) as usize) << SIGNATURE_BITS
+                    | (px[2] >> shift) as usize;
+                bins[bin] += 1;
+                total += 1;
+            }
+        }
+        ColorSignature { bins, total }
+    }
+
+    /// Fraction of pixels that would have to change bin to turn one histogram into
+    /// the other (half the L1 distance of the normalized histograms), 0-1
+    pub fn distance(&self, other: &ColorSignature) -> f32 {
+        if self.total == 0 || other.total == 0 {
+            return if self.total == other.total { 0.0 } else { 1.0 };
+        }
+        let (scale_a, scale_b) = (1.0 / self.total as f32, 1.0 / other.total as f32);
+        let l1: f32 = self.bins
+            .iter()
+            .zip(&other.bins)
+            .map(|(&a, &b)| (a as f32 * scale_a - b as f32 * scale_b).abs())
+            .sum();
+        0.5 * l1
+    }
+}
+
+/// Split a clip into runs that share one palette; each run starts at the frame
+/// the palette is trained on
+///
+/// A frame opens a new run once its distance to the run's first frame reaches
+/// `threshold`. Comparing against the keyframe rather than the previous frame
+/// means a slow pan still triggers a retrain. A threshold of 0 retrains every frame.
+pub fn keyframe_runs(signatures: &[ColorSignature], threshold: f32) -> Vec<Range<usize>> {
+    let mut runs = Vec::new();
+    let mut start = 0;
+    for i in 1..signatures.len() {
+        if signatures[i].distance(&signatures[start]) >= threshold {
+            runs.push(start..i);
+            start = i;
+        }
+    }
+    if !signatures.is_empty() {
+        runs.push(start..signatures.len());
+    }
+    runs
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn solid(width: usize, height: usize, rgb: [u8; 3]) -> Vec<u8> {
+        [rgb[0], rgb[1], rgb[2], 255].repeat(width * height)
+    }
+
+    #[test]
+    fn test_distance_bounds() {
+        let red = ColorSignature::from_rgba(&solid(32, 32, [250, 0, 0]), 32, 32);
+        let blue = ColorSignature::from_rgba(&solid(32, 32, [0, 0, 250]), 32, 32);
+        assert_eq!(red.distance(&red), 0.0);
+        assert!((red.distance(&blue) - 1.0).abs() < 1e-6);
+
+        // A quarter of the frame changing color moves a quarter of the mass
+        let mut mixed = solid(32, 32, [250, 0, 0]);
+        mixed[..32 * 8 * 4].copy_from_slice(&solid(32, 8, [0, 0, 250]));
+        let mixed = ColorSignature::from_rgba(&mixed, 32, 32);
+        assert!((red.distance(&mixed) - 0.25).abs() < 1e-6);
+    }
+
+    #[test]
+    fn test_runs_follow_scene_changes() {
+        let frames: Vec<ColorSignature> = [[250, 0, 0], [251, 2, 0], [0, 0, 250], [0, 0, 250], [0, 250, 0]]
+            .iter()
+            .map(|&rgb| ColorSignature::from_rgba(&solid(16, 16, rgb), 16, 16))
+            .collect();
+        assert_eq!(keyframe_runs(&frames, DEFAULT_REUSE_THRESHOLD), vec![0..2, 2..4, 4..5]);
+        assert_eq!(keyframe_runs(&frames, 0.0).len(), frames.len());
+        assert!(keyframe_runs(&[], DEFAULT_REUSE_THRESHOLD).is_empty());
+    }
+}
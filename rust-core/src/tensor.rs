@@ -1,28 +1,59 @@
 // Tensor module for 128×128×128 cube operations (N=128 optimal)
 // Handles frame-major layout and efficient memory access
 
+use crate::cube_kernels::TENSOR_SIDE;
 use crate::{ProcessorError, Result};
 use rayon::prelude::*;
 
+/// Voxel storage order for a cube tensor
+///
+/// Frame-major matches capture order and GIF frames, but a slice along X or Y
+/// touches one voxel per cache line. The tiled layouts keep spatial neighbours
+/// in all three axes close in memory, for axis-orthogonal slicing, ray marching
+/// and 3D texture upload.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TensorLayout {
+    /// [z][y][x][c]
+    FrameMajor,
+    /// BRICK_EDGE³ bricks ordered [bz][by][bx], each [z][y][x][c] inside;
+    /// axes are padded to whole bricks
+    Bricked,
+    /// Z-order curve over axes padded to powers of two
+    Morton,
+}
+
+/// Edge of one brick in the Bricked layout: 8³ RGBA voxels = 2 KB
+pub const BRICK_EDGE: u32 = 8;
+
+/// Slice orientation for `extract_slice`
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Axis {
+    X,
+    Y,
+    Z,
+}
+
 /// Tensor shape for 3D cube data
 #[derive(Debug, Clone, Copy)]
 pub struct TensorShape {
     pub width: u32,
     pub height: u32,
     pub frames: u32,
+    pub layout: TensorLayout,
 }
 
 impl TensorShape {
     pub fn new(width: u32, height: u32, frames: u32) -> Self {
-        Self { width, height, frames }
+        Self { width, height, frames, layout: TensorLayout::FrameMajor }
     }
 
     pub fn cube(size: u32) -> Self {
-        Self {
-            width: size,
-            height: size,
-            frames: size,
-        }
+        Self::new(size, size, size)
+    }
+
+    /// Same dimensions, different storage order
+    pub fn with_layout(self, layout: TensorLayout) -> Self {
+        Self { layout, ..self }
     }
 
     pub fn total_elements(&self) -> usize {
@@ -32,23 +63,245 @@ impl TensorShape {
     pub fn frame_size(&self) -> usize {
         (self.width * self.height) as usize
     }
+
+    /// Voxels actually stored, including layout padding (RGBA bytes = 4×)
+    pub fn storage_elements(&self) -> usize {
+        let [w, h, d] = padded_dims(*self);
+        w * h * d
+    }
 }
 
-/// Build tensor from RGBA frames (frame-major layout: [frame][y][x][channel])
+// Per-axis extents after layout padding
+fn padded_dims(shape: TensorShape) -> [usize; 3] {
+    let dims = [shape.width as usize, shape.height as usize, shape.frames as usize];
+    match shape.layout {
+        TensorLayout::FrameMajor => dims,
+        TensorLayout::Bricked => dims.map(|n| (n + BRICK_EDGE as usize - 1) / BRICK_EDGE as usize * BRICK_EDGE as usize),
+        TensorLayout::Morton => dims.map(|n| n.next_power_of_two()),
+    }
+}
+
+// Bit positions along the Z-order curve: bits are taken round-robin x, y, z,
+// skipping axes that have run out, so non-cube shapes stay dense
+fn morton_masks(shape: TensorShape) -> [u64; 3] {
+    let bits = padded_dims(shape.with_layout(TensorLayout::Morton)).map(|n| n.trailing_zeros());
+    let mut masks = [0u64; 3];
+    let mut position = 0;
+    for round in 0..bits.iter().copied().max().unwrap_or(0) {
+        for axis in 0..3 {
+            if round < bits[axis] {
+                masks[axis] |= 1 << position;
+                position += 1;
+            }
+        }
+    }
+    masks
+}
+
+// Scatter the low bits of `value` into the set bits of `mask`
+#[inline]
+fn deposit_bits(value: usize, mut mask: u64) -> usize {
+    let mut out = 0u64;
+    let mut bit = 0;
+    while mask != 0 {
+        let lowest = mask & mask.wrapping_neg();
+        if (value >> bit) & 1 != 0 {
+            out |= lowest;
+        }
+        bit += 1;
+        mask &= mask - 1;
+    }
+    out as usize
+}
+
+// Gather the bits of `index` under `mask` into a contiguous value
+#[inline]
+fn extract_bits(index: usize, mut mask: u64) -> usize {
+    let mut out = 0usize;
+    let mut bit = 0;
+    while mask != 0 {
+        let lowest = mask & mask.wrapping_neg();
+        if index as u64 & lowest != 0 {
+            out |= 1 << bit;
+        }
+        bit += 1;
+        mask &= mask - 1;
+    }
+    out
+}
+
+// Voxel addressing for one shape, with Morton offsets tabulated per axis
+// so bulk kernels pay a lookup instead of a bit loop
+struct Addressing {
+    shape: TensorShape,
+    padded: [usize; 3],
+    masks: [u64; 3],
+    tables: [Vec<usize>; 3],
+}
+
+impl Addressing {
+    fn new(shape: TensorShape) -> Self {
+        let padded = padded_dims(shape);
+        let mut masks = [0u64; 3];
+        let mut tables = [Vec::new(), Vec::new(), Vec::new()];
+        if shape.layout == TensorLayout::Morton {
+            masks = morton_masks(shape);
+            for axis in 0..3 {
+                tables[axis] = (0..padded[axis]).map(|v| deposit_bits(v, masks[axis])).collect();
+            }
+        }
+        Self { shape, padded, masks, tables }
+    }
+
+    // Storage voxel index of (x, y, z)
+    #[inline]
+    fn index(&self, x: usize, y: usize, z: usize) -> usize {
+        let [w, h, _] = self.padded;
+        match self.shape.layout {
+            TensorLayout::FrameMajor => (z * h + y) * w + x,
+            TensorLayout::Bricked => brick_index(x, y, z, w, h),
+            TensorLayout::Morton => self.tables[0][x] | self.tables[1][y] | self.tables[2][z],
+        }
+    }
+
+    // Inverse of `index` for the tiled layouts; coordinates may land in padding
+    #[inline]
+    fn coords(&self, index: usize) -> [usize; 3] {
+        let [w, h, _] = self.padded;
+        match self.shape.layout {
+            TensorLayout::FrameMajor => [index % w, index / w % h, index / (w * h)],
+            TensorLayout::Bricked => {
+                let edge = BRICK_EDGE as usize;
+                let (bricks_x, bricks_y) = (w / edge, h / edge);
+                let (brick, local) = (index / (edge * edge * edge), index % (edge * edge * edge));
+                [
+                    brick % bricks_x * edge + local % edge,
+                    brick / bricks_x % bricks_y * edge + local / edge % edge,
+                    brick / (bricks_x * bricks_y) * edge + local / (edge * edge),
+                ]
+            }
+            TensorLayout::Morton => self.masks.map(|mask| extract_bits(index, mask)),
+        }
+    }
+}
+
+#[inline(always)]
+fn brick_index(x: usize, y: usize, z: usize, padded_w: usize, padded_h: usize) -> usize {
+    let edge = BRICK_EDGE as usize;
+    let brick = ((z / edge) * (padded_h / edge) + y / edge) * (padded_w / edge) + x / edge;
+    brick * edge * edge * edge + ((z % edge) * edge + y % edge) * edge + x % edge
+}
+
+/// Build tensor from RGBA frames ([frame][y][x][channel]) in `shape`'s layout
 pub fn build_tensor(
     frames_rgba: &[u8],
     shape: TensorShape,
 ) -> Result<Vec<u8>> {
     let expected_size = shape.total_elements() * 4; // RGBA
     if frames_rgba.len() != expected_size {
-        return Err(ProcessorError::InvalidInput(
-            format!("Expected {} bytes, got {}", expected_size, frames_rgba.len())
-        ));
+        return Err(ProcessorError::InvalidInput);
+    }
+
+    match shape.layout {
+        // Data is already in the correct order; just return a copy
+        TensorLayout::FrameMajor => Ok(frames_rgba.to_vec()),
+        layout => convert_layout(frames_rgba, shape.with_layout(TensorLayout::FrameMajor), layout),
+    }
+}
+
+/// Re-order a tensor stored as `shape` into `layout`
+///
+/// Each output block is gathered from the source in parallel: bricks for
+/// Bricked, runs of 512 curve-consecutive voxels for Morton, rows for
+/// frame-major. Padding voxels are zero.
+pub fn convert_layout(tensor: &[u8], shape: TensorShape, layout: TensorLayout) -> Result<Vec<u8>> {
+    reorder_voxels::<4>(tensor, shape, layout)
+}
+
+/// convert_layout for one-byte voxels (indexed tensors)
+pub fn convert_index_layout(indices: &[u8], shape: TensorShape, layout: TensorLayout) -> Result<Vec<u8>> {
+    reorder_voxels::<1>(indices, shape, layout)
+}
+
+fn reorder_voxels<const B: usize>(tensor: &[u8], shape: TensorShape, layout: TensorLayout) -> Result<Vec<u8>> {
+    if tensor.len() != shape.storage_elements() * B {
+        return Err(ProcessorError::InvalidInput);
+    }
+    if shape.layout == layout {
+        return Ok(tensor.to_vec());
+    }
+
+    let src = Addressing::new(shape);
+    let dst = Addressing::new(shape.with_layout(layout));
+    let (w, h, d) = (shape.width as usize, shape.height as usize, shape.frames as usize);
+    let mut output = vec![0u8; dst.shape.storage_elements() * B];
+    if output.is_empty() {
+        return Ok(output);
+    }
+
+    let copy_voxel = |out: &mut [u8], [x, y, z]: [usize; 3]| {
+        if x < w && y < h && z < d {
+            let at = src.index(x, y, z) * B;
+            out.copy_from_slice(&tensor[at..at + B]);
+        }
+    };
+
+    if layout == TensorLayout::FrameMajor {
+        output.par_chunks_mut(w * B).enumerate().for_each(|(row, out_row)| {
+            let (y, z) = (row % h, row / h);
+            for (x, out) in out_row.chunks_exact_mut(B).enumerate() {
+                copy_voxel(out, [x, y, z]);
+            }
+        });
+        return Ok(output);
     }
 
-    // For frame-major layout, data is already in the correct order
-    // Just validate and return a copy
-    Ok(frames_rgba.to_vec())
+    // Both tiled layouts map index bits to coordinate bits additively within an
+    // aligned block, so one table of block-local offsets serves every block
+    const BLOCK: usize = 512;
+    let block = BLOCK.min(dst.shape.storage_elements());
+    let local: Vec<[usize; 3]> = (0..block).map(|i| dst.coords(i)).collect();
+    output.par_chunks_mut(block * B).enumerate().for_each(|(n, out_block)| {
+        let base = dst.coords(n * block);
+        for (offset, out) in local.iter().zip(out_block.chunks_exact_mut(B)) {
+            copy_voxel(out, [base[0] + offset[0], base[1] + offset[1], base[2] + offset[2]]);
+        }
+    });
+    Ok(output)
+}
+
+/// Extract an axis-orthogonal slice as a row-major RGBA image
+///
+/// Z slices are width × height (a capture frame), Y slices width × frames and
+/// X slices height × frames, with frames running down the rows.
+pub fn extract_slice(tensor: &[u8], shape: TensorShape, axis: Axis, index: u32) -> Result<Vec<u8>> {
+    if tensor.len() != shape.storage_elements() * 4 {
+        return Err(ProcessorError::InvalidInput);
+    }
+    let (cols, rows, depth) = match axis {
+        Axis::Z => (shape.width, shape.height, shape.frames),
+        Axis::Y => (shape.width, shape.frames, shape.height),
+        Axis::X => (shape.height, shape.frames, shape.width),
+    };
+    if index >= depth {
+        return Err(ProcessorError::InvalidInput);
+    }
+
+    let addressing = Addressing::new(shape);
+    let (cols, index) = (cols as usize, index as usize);
+    let mut slice = vec![0u8; cols * rows as usize * 4];
+    for (row, out_row) in slice.chunks_exact_mut(cols * 4).enumerate() {
+        for (col, out) in out_row.chunks_exact_mut(4).enumerate() {
+            let (x, y, z) = match axis {
+                Axis::Z => (col, row, index),
+                Axis::Y => (col, index, row),
+                Axis::X => (index, col, row),
+            };
+            let at = addressing.index(x, y, z) * 4;
+            out.copy_from_slice(&tensor[at..at + 4]);
+        }
+    }
+    Ok(slice)
 }
 
 /// Extract a single frame from tensor
@@ -58,9 +311,11 @@ pub fn extract_frame(
     frame_index: u32,
 ) -> Result<Vec<u8>> {
     if frame_index >= shape.frames {
-        return Err(ProcessorError::InvalidInput(
-            format!("Frame index {} out of range (0..{})", frame_index, shape.frames)
-        ));
+        return Err(ProcessorError::InvalidInput);
+    }
+
+    if shape.layout != TensorLayout::FrameMajor {
+        return extract_slice(tensor, shape, Axis::Z, frame_index);
     }
 
     let frame_size = shape.frame_size() * 4; // RGBA
@@ -68,22 +323,36 @@ pub fn extract_frame(
     let end = start + frame_size;
 
     if end > tensor.len() {
-        return Err(ProcessorError::TensorError("Tensor data too small".into()));
+        return Err(ProcessorError::InvalidInput);
     }
 
     Ok(tensor[start..end].to_vec())
 }
 
-/// Convert voxel coordinates to linear index
+/// Convert voxel coordinates to linear byte index in `shape`'s layout
 #[inline]
 pub fn voxel_to_index(x: u32, y: u32, z: u32, shape: TensorShape) -> usize {
-    let frame_offset = z as usize * shape.frame_size();
-    let row_offset = y as usize * shape.width as usize;
-    let col_offset = x as usize;
-    (frame_offset + row_offset + col_offset) * 4 // RGBA
+    let (x, y, z) = (x as usize, y as usize, z as usize);
+    let voxel = match shape.layout {
+        TensorLayout::FrameMajor => {
+            let frame_offset = z * shape.frame_size();
+            let row_offset = y * shape.width as usize;
+            frame_offset + row_offset + x
+        }
+        TensorLayout::Bricked => {
+            let [w, h, _] = padded_dims(shape);
+            brick_index(x, y, z, w, h)
+        }
+        TensorLayout::Morton => {
+            let masks = morton_masks(shape);
+            deposit_bits(x, masks[0]) | deposit_bits(y, masks[1]) | deposit_bits(z, masks[2])
+        }
+    };
+    voxel * 4 // RGBA
 }
 
 /// Parallel tensor processing with Rayon
+/// Chunks are frame_size voxels of storage, i.e. capture frames only for frame-major tensors
 pub fn process_tensor_parallel<F>(
     tensor: &mut [u8],
     shape: TensorShape,
@@ -98,7 +367,18 @@ pub fn process_tensor_parallel<F>(
         .for_each(|frame| processor(frame));
 }
 
-/// Apply 3D convolution kernel (for future voxel operations)
+/// Brick edge for the direct path: a 16³ output brick plus a 5³ kernel's halo is
+/// 20³ RGBA f32 voxels (128 KB), which stays resident in L2 across every tap
+const CONV_BRICK: usize = 16;
+
+/// Relative error allowed when factoring a kernel into three 1D kernels
+const SEPARABLE_TOLERANCE: f32 = 1e-5;
+
+/// Apply a 3D convolution kernel (kernel_size³ weights, index kz·k² + ky·k + kx)
+///
+/// Edges clamp to the nearest voxel. Kernels that factor into 1D x, y and z
+/// kernels (box, Gaussian, ...) run as three 1D passes, k taps per pass instead
+/// of k³; anything else uses the brick-blocked direct path.
 pub fn convolve_3d(
     tensor: &[u8],
     shape: TensorShape,
@@ -106,53 +386,277 @@ pub fn convolve_3d(
     kernel_size: u32,
 ) -> Result<Vec<u8>> {
     if kernel_size % 2 == 0 {
-        return Err(ProcessorError::InvalidInput("Kernel size must be odd".into()));
+        return Err(ProcessorError::InvalidInput);
+    }
+    let k = kernel_size as usize;
+    if kernel.len() != k * k * k {
+        return Err(ProcessorError::InvalidInput);
     }
+    if tensor.len() != shape.total_elements() * 4 {
+        return Err(ProcessorError::InvalidInput);
+    }
+    if shape.layout != TensorLayout::FrameMajor {
+        return Err(ProcessorError::InvalidInput);
+    }
+
+    match separate_kernel(kernel, k) {
+        Some([kx, ky, kz]) => convolve_3d_separable(tensor, shape, &kx, &ky, &kz),
+        None => Ok(convolve_3d_blocked(tensor, shape, kernel, k)),
+    }
+}
+
+/// Filter a ProcessResult.tensor_data volume (TENSOR_SIDE² × frame_count RGBA,
+/// stored as GifOpts.tensor_layout) with convolve_3d
+///
+/// Tiled input is converted to frame-major for the filter and back, so the
+/// result has the same layout and length as `tensor`.
+pub fn convolve_tensor(tensor: Vec<u8>, tensor_layout: TensorLayout, frame_count: u32, kernel: Vec<f32>, kernel_size: u32) -> Result<Vec<u8>> {
+    let shape = process_result_shape(tensor_layout, frame_count)?;
+    if tensor_layout == TensorLayout::FrameMajor {
+        return convolve_3d(&tensor, shape, &kernel, kernel_size);
+    }
+    let frame_major = convert_layout(&tensor, shape, TensorLayout::FrameMajor)?;
+    let filtered = convolve_3d(&frame_major, shape.with_layout(TensorLayout::FrameMajor), &kernel, kernel_size)?;
+    convert_layout(&filtered, shape.with_layout(TensorLayout::FrameMajor), tensor_layout)
+}
+
+/// Shape of a ProcessResult tensor with `frame_count` frames stored as `layout`
+pub fn process_result_shape(layout: TensorLayout, frame_count: u32) -> Result<TensorShape> {
+    if frame_count == 0 {
+        return Err(ProcessorError::InvalidInput);
+    }
+    Ok(TensorShape::new(TENSOR_SIDE as u32, TENSOR_SIDE as u32, frame_count).with_layout(layout))
+}
+
+/// Factor a k³ kernel into x, y and z kernels whose outer product reproduces it
+/// None if the kernel is not rank one
+pub fn separate_kernel(kernel: &[f32], k: usize) -> Option<[Vec<f32>; 3]> {
+    // Pivot on the largest weight so the division below is well conditioned
+    let (pivot, &peak) = kernel
+        .iter()
+        .enumerate()
+        .max_by(|a, b| a.1.abs().total_cmp(&b.1.abs()))?;
+    if peak == 0.0 {
+        return None;
+    }
+    let (pz, py, px) = (pivot / (k * k), pivot / k % k, pivot % k);
+    let at = |z: usize, y: usize, x: usize| kernel[(z * k + y) * k + x];
+
+    // x carries the pivot's magnitude; y and z are normalized to 1 at the pivot
+    let kx: Vec<f32> = (0..k).map(|x| at(pz, py, x)).collect();
+    let ky: Vec<f32> = (0..k).map(|y| at(pz, y, px) / peak).collect();
+    let kz: Vec<f32> = (0..k).map(|z| at(z, py, px) / peak).collect();
+
+    let tolerance = peak.abs() * SEPARABLE_TOLERANCE;
+    for z in 0..k {
+        for y in 0..k {
+            for x in 0..k {
+                if (kz[z] * ky[y] * kx[x] - at(z, y, x)).abs() > tolerance {
+                    return None;
+                }
+            }
+        }
+    }
+    Some([kx, ky, kz])
+}
 
-    let half_kernel = (kernel_size / 2) as i32;
+/// Separable convolution: per output frame, a z pass over the source frames
+/// into an f32 plane, then x and y passes within the plane
+/// Kernels may have different (odd) lengths per axis
+pub fn convolve_3d_separable(
+    tensor: &[u8],
+    shape: TensorShape,
+    kx: &[f32],
+    ky: &[f32],
+    kz: &[f32],
+) -> Result<Vec<u8>> {
+    if shape.layout != TensorLayout::FrameMajor {
+        return Err(ProcessorError::InvalidInput);
+    }
+    if kx.len() % 2 == 0 || ky.len() % 2 == 0 || kz.len() % 2 == 0 {
+        return Err(ProcessorError::InvalidInput);
+    }
+
+    let (w, h, d) = (shape.width as usize, shape.height as usize, shape.frames as usize);
+    let plane_len = w * h * 4;
     let mut output = vec![0u8; tensor.len()];
+    if plane_len == 0 {
+        return Ok(output);
+    }
 
-    // Parallel processing per frame
     output
-        .par_chunks_mut(shape.frame_size() * 4)
+        .par_chunks_mut(plane_len)
         .enumerate()
-        .for_each(|(z, out_frame)| {
-            for y in 0..shape.height {
-                for x in 0..shape.width {
-                    let mut accum = [0.0f32; 4]; // RGBA accumulator
-
-                    // Apply kernel
-                    for kz in -half_kernel..=half_kernel {
-                        for ky in -half_kernel..=half_kernel {
-                            for kx in -half_kernel..=half_kernel {
-                                let sz = (z as i32 + kz).clamp(0, shape.frames as i32 - 1) as u32;
-                                let sy = (y as i32 + ky).clamp(0, shape.height as i32 - 1) as u32;
-                                let sx = (x as i32 + kx).clamp(0, shape.width as i32 - 1) as u32;
-
-                                let kernel_idx = ((kz + half_kernel) * kernel_size as i32 * kernel_size as i32 +
-                                                 (ky + half_kernel) * kernel_size as i32 +
-                                                 (kx + half_kernel)) as usize;
-
-                                let pixel_idx = voxel_to_index(sx, sy, sz, shape);
-                                let weight = kernel[kernel_idx];
+        .for_each_init(
+            || (vec![0f32; plane_len], vec![0f32; plane_len]),
+            |(plane, scratch), (z, out_frame)| {
+                // z pass: straight multiply-adds over whole frames
+                plane.fill(0.0);
+                let hz = kz.len() / 2;
+                for (t, &weight) in kz.iter().enumerate() {
+                    if weight == 0.0 {
+                        continue;
+                    }
+                    let sz = clamp_offset(z, t, hz, d);
+                    let src = &tensor[sz * plane_len..(sz + 1) * plane_len];
+                    for (acc, &v) in plane.iter_mut().zip(src) {
+                        *acc += weight * v as f32;
+                    }
+                }
+
+                // x pass, row by row
+                scratch.fill(0.0);
+                for (src_row, dst_row) in plane.chunks_exact(w * 4).zip(scratch.chunks_exact_mut(w * 4)) {
+                    convolve_row(src_row, dst_row, kx);
+                }
+
+                // y pass: whole-row multiply-adds, written out as bytes
+                let hy = ky.len() / 2;
+                let mut row = vec![0f32; w * 4];
+                for (y, out_row) in out_frame.chunks_exact_mut(w * 4).enumerate() {
+                    row.fill(0.0);
+                    for (t, &weight) in ky.iter().enumerate() {
+                        if weight == 0.0 {
+                            continue;
+                        }
+                        let sy = clamp_offset(y, t, hy, h);
+                        for (acc, &v) in row.iter_mut().zip(&scratch[sy * w * 4..(sy + 1) * w * 4]) {
+                            *acc += weight * v;
+                        }
+                    }
+                    store_clamped(&row, out_row);
+                }
+            },
+        );
 
+    Ok(output)
+}
+
+/// Direct convolution over CONV_BRICK³ output bricks
+/// Each brick's input plus halo is gathered once with edge clamping, so the
+/// per-tap loop is a branch-free multiply-add over contiguous RGBA rows
+fn convolve_3d_blocked(tensor: &[u8], shape: TensorShape, kernel: &[f32], k: usize) -> Vec<u8> {
+    let (w, h, d) = (shape.width as usize, shape.height as usize, shape.frames as usize);
+    let half = k / 2;
+    let plane_len = w * h * 4;
+    let mut output = vec![0u8; tensor.len()];
+    if plane_len == 0 {
+        return output;
+    }
+
+    // Slabs of CONV_BRICK frames are disjoint in the output, so they run in parallel
+    output
+        .par_chunks_mut(plane_len * CONV_BRICK)
+        .enumerate()
+        .for_each(|(slab, out_slab)| {
+            let z0 = slab * CONV_BRICK;
+            let bd = (d - z0).min(CONV_BRICK);
+
+            let halo_edge = CONV_BRICK + 2 * half;
+            let mut halo = vec![0f32; halo_edge * halo_edge * halo_edge * 4];
+            let mut acc = vec![0f32; CONV_BRICK * CONV_BRICK * CONV_BRICK * 4];
+
+            for y0 in (0..h).step_by(CONV_BRICK) {
+                for x0 in (0..w).step_by(CONV_BRICK) {
+                    let bh = (h - y0).min(CONV_BRICK);
+                    let bw = (w - x0).min(CONV_BRICK);
+                    let (hd, hh, hw) = (bd + 2 * half, bh + 2 * half, bw + 2 * half);
+
+                    // Gather the brick and its halo, clamping coordinates once per voxel
+                    for hz in 0..hd {
+                        let sz = clamp_coord(z0 + hz, half, d);
+                        for hy in 0..hh {
+                            let sy = clamp_coord(y0 + hy, half, h);
+                            let dst = &mut halo[((hz * hh + hy) * hw) * 4..][..hw * 4];
+                            for (hx, px) in dst.chunks_exact_mut(4).enumerate() {
+                                let sx = clamp_coord(x0 + hx, half, w);
+                                let src = &tensor[((sz * h + sy) * w + sx) * 4..][..4];
                                 for c in 0..4 {
-                                    accum[c] += tensor[pixel_idx + c] as f32 * weight;
+                                    px[c] = src[c] as f32;
                                 }
                             }
                         }
                     }
 
-                    // Write result
-                    let out_idx = (y * shape.width + x) as usize * 4;
-                    for c in 0..4 {
-                        out_frame[out_idx + c] = accum[c].clamp(0.0, 255.0) as u8;
+                    // Every tap is one multiply-add per output row
+                    let acc = &mut acc[..bd * bh * bw * 4];
+                    acc.fill(0.0);
+                    for (tap, &weight) in kernel.iter().enumerate() {
+                        if weight == 0.0 {
+                            continue;
+                        }
+                        let (tz, ty, tx) = (tap / (k * k), tap / k % k, tap % k);
+                        for z in 0..bd {
+                            for y in 0..bh {
+                                let src = &halo[(((z + tz) * hh + y + ty) * hw + tx) * 4..][..bw * 4];
+                                let dst = &mut acc[((z * bh + y) * bw) * 4..][..bw * 4];
+                                for (a, &v) in dst.iter_mut().zip(src) {
+                                    *a += weight * v;
+                                }
+                            }
+                        }
+                    }
+
+                    for z in 0..bd {
+                        for y in 0..bh {
+                            let src = &acc[((z * bh + y) * bw) * 4..][..bw * 4];
+                            let dst = &mut out_slab[z * plane_len + ((y0 + y) * w + x0) * 4..][..bw * 4];
+                            store_clamped(src, dst);
+                        }
                     }
                 }
             }
         });
 
-    Ok(output)
+    output
+}
+
+/// 1D convolution along one RGBA row with edge clamping
+/// Interior taps are shifted slice multiply-adds; only the `half` voxels at
+/// each end take the clamped path
+#[inline]
+fn convolve_row(src: &[f32], dst: &mut [f32], kernel: &[f32]) {
+    let n = src.len() / 4;
+    let half = kernel.len() / 2;
+
+    for (t, &weight) in kernel.iter().enumerate() {
+        if weight == 0.0 {
+            continue;
+        }
+        // Output voxels x whose source x + t - half lies inside the row
+        let lo = half.saturating_sub(t).min(n);
+        let hi = (n + half).saturating_sub(t).min(n).max(lo);
+        let shift = (lo + t - half) * 4;
+        for (a, &v) in dst[lo * 4..hi * 4].iter_mut().zip(&src[shift..]) {
+            *a += weight * v;
+        }
+        for x in (0..lo).chain(hi..n) {
+            let sx = clamp_offset(x, t, half, n);
+            for c in 0..4 {
+                dst[x * 4 + c] += weight * src[sx * 4 + c];
+            }
+        }
+    }
+}
+
+/// Source index for output `i` and tap `t` of a kernel centered at `half`
+#[inline(always)]
+fn clamp_offset(i: usize, t: usize, half: usize, len: usize) -> usize {
+    (i + t).saturating_sub(half).min(len - 1)
+}
+
+/// Source index for halo position `i` (halo starts `half` before the brick)
+#[inline(always)]
+fn clamp_coord(i: usize, half: usize, len: usize) -> usize {
+    i.saturating_sub(half).min(len - 1)
+}
+
+/// Saturate accumulated channels to bytes (truncating, as the byte tensor always has)
+#[inline]
+fn store_clamped(src: &[f32], dst: &mut [u8]) {
+    for (d, &v) in dst.iter_mut().zip(src) {
+        *d = v.clamp(0.0, 255.0) as u8;
+    }
 }
 
 #[cfg(test)]
@@ -182,7 +686,7 @@ mod tests {
 
     #[test]
     fn test_frame_extraction() {
-        let shape = TensorShape { width: 2, height: 2, frames: 2 };
+        let shape = TensorShape::new(2, 2, 2);
         let tensor = vec![0u8; shape.total_elements() * 4];
 
         let frame = extract_frame(&tensor, shape, 0).unwrap();
@@ -194,4 +698,225 @@ mod tests {
         // Out of bounds
         assert!(extract_frame(&tensor, shape, 2).is_err());
     }
+
+    /// Textbook k³ loop the fast paths are checked against
+    fn convolve_reference(tensor: &[u8], shape: TensorShape, kernel: &[f32], k: usize) -> Vec<u8> {
+        let half = k as i32 / 2;
+        let (w, h, d) = (shape.width as i32, shape.height as i32, shape.frames as i32);
+        let mut out = vec![0u8; tensor.len()];
+        for z in 0..d {
+            for y in 0..h {
+                for x in 0..w {
+                    for c in 0..4 {
+                        let mut acc = 0f32;
+                        for kz in 0..k as i32 {
+                            for ky in 0..k as i32 {
+                                for kx in 0..k as i32 {
+                                    let sx = (x + kx - half).clamp(0, w - 1) as u32;
+                                    let sy = (y + ky - half).clamp(0, h - 1) as u32;
+                                    let sz = (z + kz - half).clamp(0, d - 1) as u32;
+                                    let weight = kernel[((kz * k as i32 + ky) * k as i32 + kx) as usize];
+                                    acc += weight * tensor[voxel_to_index(sx, sy, sz, shape) + c] as f32;
+                                }
+                            }
+                        }
+                        out[voxel_to_index(x as u32, y as u32, z as u32, shape) + c] = acc.clamp(0.0, 255.0) as u8;
+                    }
+                }
+            }
+        }
+        out
+    }
+
+    fn test_volume(shape: TensorShape) -> Vec<u8> {
+        let mut seed = 0x2545_f491u32;
+        (0..shape.total_elements() * 4)
+            .map(|_| {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                seed as u8
+            })
+            .collect()
+    }
+
+    /// Byte outputs may differ by one where f32 summation order moves a value across an integer
+    fn assert_close(a: &[u8], b: &[u8]) {
+        assert_eq!(a.len(), b.len());
+        for (i, (&x, &y)) in a.iter().zip(b).enumerate() {
+            assert!((x as i32 - y as i32).abs() <= 1, "voxel byte {}: {} vs {}", i, x, y);
+        }
+    }
+
+    #[test]
+    fn test_separable_kernel_detection() {
+        let g = [1.0f32, 2.0, 1.0];
+        let mut kernel = Vec::new();
+        for z in g {
+            for y in g {
+                for x in g {
+                    kernel.push(x * y * z / 64.0);
+                }
+            }
+        }
+        let [kx, ky, kz] = separate_kernel(&kernel, 3).unwrap();
+        for z in 0..3 {
+            for y in 0..3 {
+                for x in 0..3 {
+                    assert!((kx[x] * ky[y] * kz[z] - kernel[(z * 3 + y) * 3 + x]).abs() < 1e-6);
+                }
+            }
+        }
+
+        kernel[13] += 0.1; // Perturb the center: no longer rank one
+        assert!(separate_kernel(&kernel, 3).is_none());
+        assert!(separate_kernel(&[0.0; 27], 3).is_none());
+    }
+
+    #[test]
+    fn test_separable_matches_reference() {
+        // Non-cube and not a multiple of the brick edge, to exercise every clamp
+        let shape = TensorShape::new(21, 13, 9);
+        let tensor = test_volume(shape);
+        let kernel = vec![1.0f32 / 125.0; 125];
+
+        let fast = convolve_3d(&tensor, shape, &kernel, 5).unwrap();
+        assert_close(&fast, &convolve_reference(&tensor, shape, &kernel, 5));
+    }
+
+    #[test]
+    fn test_blocked_matches_reference() {
+        let shape = TensorShape::new(19, 34, 18);
+        let tensor = test_volume(shape);
+        // 3D Laplacian-style sharpen: not separable
+        let mut kernel = vec![0f32; 27];
+        kernel[13] = 7.0;
+        for tap in [4, 10, 12, 14, 16, 22] {
+            kernel[tap] = -1.0;
+        }
+        assert!(separate_kernel(&kernel, 3).is_none());
+
+        let fast = convolve_3d(&tensor, shape, &kernel, 3).unwrap();
+        assert_close(&fast, &convolve_reference(&tensor, shape, &kernel, 3));
+    }
+
+    #[test]
+    fn test_convolve_process_result_tensor() {
+        // A flat volume is a fixed point of any normalized kernel
+        let tensor = vec![90u8; TENSOR_SIDE * TENSOR_SIDE * 3 * 4];
+        let smoothed = convolve_tensor(tensor.clone(), TensorLayout::FrameMajor, 3, vec![1.0 / 27.0; 27], 3).unwrap();
+        assert_eq!(smoothed, tensor);
+
+        assert!(convolve_tensor(vec![0; 12], TensorLayout::FrameMajor, 1, vec![1.0], 1).is_err());
+        // The frame count must match the data, whatever the layout
+        assert!(convolve_tensor(tensor.clone(), TensorLayout::FrameMajor, 2, vec![1.0], 1).is_err());
+        assert!(convolve_tensor(tensor, TensorLayout::Bricked, 3, vec![1.0], 1).is_err());
+    }
+
+    #[test]
+    fn test_convolve_tiled_tensor_matches_frame_major() {
+        let frames = 5;
+        let shape = TensorShape::new(TENSOR_SIDE as u32, TENSOR_SIDE as u32, frames);
+        let tensor: Vec<u8> = (0..shape.total_elements() * 4).map(|i| (i * 7 % 253) as u8).collect();
+        let kernel = vec![1.0 / 27.0; 27];
+        let expected = convolve_tensor(tensor.clone(), TensorLayout::FrameMajor, frames, kernel.clone(), 3).unwrap();
+
+        for layout in [TensorLayout::Bricked, TensorLayout::Morton] {
+            let tiled = convert_layout(&tensor, shape, layout).unwrap();
+            let filtered = convolve_tensor(tiled.clone(), layout, frames, kernel.clone(), 3).unwrap();
+            assert_eq!(filtered.len(), tiled.len());
+            assert_eq!(convert_layout(&filtered, shape.with_layout(layout), TensorLayout::FrameMajor).unwrap(), expected);
+        }
+    }
+
+    #[test]
+    fn test_convolve_rejects_bad_kernels() {
+        let shape = TensorShape::cube(4);
+        let tensor = vec![0u8; shape.total_elements() * 4];
+        assert!(convolve_3d(&tensor, shape, &[0.0; 8], 2).is_err());
+        assert!(convolve_3d(&tensor, shape, &[0.0; 26], 3).is_err());
+        assert!(convolve_3d(&tensor[1..], shape, &[0.0; 27], 3).is_err());
+    }
+
+    #[test]
+    fn test_layout_roundtrip() {
+        // Odd, non-cube dimensions so every layout pads
+        let shape = TensorShape::new(13, 9, 6);
+        let tensor = test_volume(shape);
+
+        for layout in [TensorLayout::Bricked, TensorLayout::Morton] {
+            let tiled_shape = shape.with_layout(layout);
+            let tiled = build_tensor(&tensor, tiled_shape).unwrap();
+            assert_eq!(tiled.len(), tiled_shape.storage_elements() * 4);
+
+            for (z, y, x) in [(0, 0, 0), (5, 8, 12), (3, 1, 7), (2, 6, 9)] {
+                let at = voxel_to_index(x, y, z, shape);
+                let tiled_at = voxel_to_index(x, y, z, tiled_shape);
+                assert_eq!(&tiled[tiled_at..tiled_at + 4], &tensor[at..at + 4], "{:?} ({}, {}, {})", layout, x, y, z);
+            }
+
+            let back = convert_layout(&tiled, tiled_shape, TensorLayout::FrameMajor).unwrap();
+            assert_eq!(back, tensor, "{:?} roundtrip", layout);
+
+            let other = if layout == TensorLayout::Bricked { TensorLayout::Morton } else { TensorLayout::Bricked };
+            let direct = convert_layout(&tiled, tiled_shape, other).unwrap();
+            assert_eq!(direct, build_tensor(&tensor, shape.with_layout(other)).unwrap());
+        }
+    }
+
+    #[test]
+    fn test_tiled_layouts_are_local() {
+        let bricked = TensorShape::cube(128).with_layout(TensorLayout::Bricked);
+        assert_eq!(bricked.storage_elements(), 128 * 128 * 128);
+        // A whole 8³ brick is 2 KB of contiguous storage
+        assert_eq!(voxel_to_index(7, 7, 7, bricked), (8 * 8 * 8 - 1) * 4);
+        assert_eq!(voxel_to_index(8, 0, 0, bricked), 8 * 8 * 8 * 4);
+
+        let morton = TensorShape::cube(128).with_layout(TensorLayout::Morton);
+        assert_eq!(voxel_to_index(1, 0, 0, morton), 4);
+        assert_eq!(voxel_to_index(0, 1, 0, morton), 2 * 4);
+        assert_eq!(voxel_to_index(0, 0, 1, morton), 4 * 4);
+        assert_eq!(voxel_to_index(127, 127, 127, morton), (128 * 128 * 128 - 1) * 4);
+
+        // Non-cube Morton stays dense once the short axis runs out of bits
+        let flat = TensorShape::new(16, 4, 2).with_layout(TensorLayout::Morton);
+        assert_eq!(flat.storage_elements(), 16 * 4 * 2);
+        assert_eq!(voxel_to_index(15, 3, 1, flat), (16 * 4 * 2 - 1) * 4);
+    }
+
+    #[test]
+    fn test_slices_match_any_layout() {
+        let shape = TensorShape::new(11, 7, 5);
+        let tensor = test_volume(shape);
+        let expected = |axis: Axis, index: u32| -> Vec<u8> {
+            let mut slice = Vec::new();
+            let (cols, rows) = match axis {
+                Axis::Z => (shape.width, shape.height),
+                Axis::Y => (shape.width, shape.frames),
+                Axis::X => (shape.height, shape.frames),
+            };
+            for row in 0..rows {
+                for col in 0..cols {
+                    let (x, y, z) = match axis {
+                        Axis::Z => (col, row, index),
+                        Axis::Y => (col, index, row),
+                        Axis::X => (index, col, row),
+                    };
+                    let at = voxel_to_index(x, y, z, shape);
+                    slice.extend_from_slice(&tensor[at..at + 4]);
+                }
+            }
+            slice
+        };
+
+        for layout in [TensorLayout::FrameMajor, TensorLayout::Bricked, TensorLayout::Morton] {
+            let tiled_shape = shape.with_layout(layout);
+            let tiled = build_tensor(&tensor, tiled_shape).unwrap();
+            for (axis, index) in [(Axis::Z, 4), (Axis::Y, 6), (Axis::X, 10), (Axis::X, 0)] {
+                assert_eq!(extract_slice(&tiled, tiled_shape, axis, index).unwrap(), expected(axis, index), "{:?} {:?}", layout, axis);
+            }
+            assert_eq!(extract_frame(&tiled, tiled_shape, 2).unwrap(), expected(Axis::Z, 2));
+            assert!(extract_slice(&tiled, tiled_shape, Axis::X, 11).is_err());
+        }
+    }
 }
\ No newline at end of file
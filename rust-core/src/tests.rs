@@ -1,8 +1,7 @@
-// tests.rs - Comprehensive test suite for Rust FFI functions
+// tests.rs - Test suite for the batch C ABI (batch_ffi)
 
 #[cfg(test)]
 mod tests {
-    use super::super::*;
     use std::ptr;
 
     // Test data generator - creates synthetic RGBA frames
@@ -21,147 +20,12 @@ mod tests {
         frame
     }
 
-    // Test processor lifecycle
-    #[test]
-    fn test_processor_lifecycle() {
-        println!("Testing processor lifecycle...");
-
-        let processor = yingif_processor_new();
-        assert!(!processor.is_null(), "Processor creation failed");
-
-        yingif_processor_free(processor);
-        println!("✅ Processor lifecycle test passed");
-    }
-
-    // Test single frame processing
-    #[test]
-    fn test_single_frame_processing() {
-        println!("Testing single frame processing...");
-
-        let processor = unsafe { yingif_processor_new() };
-        assert!(!processor.is_null());
-
-        // Generate test frame (1080x1080 BGRA)
-        let width = 1080;
-        let height = 1080;
-        let target_size = 256;
-        let palette_size = 256;
-
-        let rgba_frame = generate_test_frame(width, height, 42);
-        // Convert RGBA to BGRA
-        let mut bgra_frame = Vec::with_capacity(rgba_frame.len());
-        for chunk in rgba_frame.chunks_exact(4) {
-            bgra_frame.push(chunk[2]); // B
-            bgra_frame.push(chunk[1]); // G
-            bgra_frame.push(chunk[0]); // R
-            bgra_frame.push(chunk[3]); // A
-        }
-
-        let mut indices = vec![0u8; (target_size * target_size) as usize];
-        let mut palette = vec![0u32; palette_size as usize];
-
-        let result = unsafe {
-            yingif_process_frame(
-                processor,
-                bgra_frame.as_ptr(),
-                width as i32,
-                height as i32,
-                target_size as i32,
-                palette_size as i32,
-                indices.as_mut_ptr(),
-                palette.as_mut_ptr()
-            )
-        };
-
-        assert_eq!(result, 0, "Frame processing failed with error: {}", result);
-
-        // Verify output
-        assert!(indices.iter().any(|&i| i > 0), "Indices should have non-zero values");
-        assert!(palette.iter().any(|&p| p != 0), "Palette should have non-zero colors");
-
-        // Check palette has alpha channel set
-        for &color in palette.iter().take(10) {
-            if color != 0 {
-                let alpha = (color >> 24) & 0xFF;
-                assert_eq!(alpha, 0xFF, "Palette colors should be opaque");
-            }
-        }
-
-        unsafe { yingif_processor_free(processor) };
-        println!("✅ Single frame processing test passed");
-    }
-
-    // Test GIF creation
-    #[test]
-    fn test_gif_creation() {
-        println!("Testing GIF89a creation...");
-
-        let cube_size = 32; // Smaller for testing
-        let palette_size = 256;
-        let frame_count = cube_size;
-
-        // Generate test indices (simulating processed frames)
-        let total_pixels = cube_size * cube_size * frame_count;
-        let mut indices = Vec::with_capacity(total_pixels as usize);
-        for frame in 0..frame_count {
-            for _pixel in 0..(cube_size * cube_size) {
-                indices.push((frame % 256) as u8);
-            }
-        }
-
-        // Generate test palette
-        let mut palette = Vec::with_capacity(palette_size as usize);
-        for i in 0..palette_size {
-            let r = (i * 7) as u32 & 0xFF;
-            let g = (i * 11) as u32 & 0xFF;
-            let b = (i * 13) as u32 & 0xFF;
-            palette.push(0xFF000000 | (r << 16) | (g << 8) | b);
-        }
-
-        // Estimate GIF size
-        let estimated_size = unsafe {
-            yingif_estimate_gif_size(cube_size, palette_size)
-        };
-        assert!(estimated_size > 0, "GIF size estimation failed");
-        println!("  Estimated GIF size: {} bytes", estimated_size);
-
-        // Create GIF
-        let mut gif_data = vec![0u8; (estimated_size * 2) as usize]; // 2x buffer
-        let mut actual_size = 0i32;
-
-        let result = unsafe {
-            yingif_create_gif89a(
-                indices.as_ptr(),
-                palette.as_ptr(),
-                cube_size,
-                palette_size,
-                40, // 40ms delay
-                gif_data.as_mut_ptr(),
-                gif_data.len() as i32,
-                &mut actual_size
-            )
-        };
-
-        assert_eq!(result, 0, "GIF creation failed with error: {}", result);
-        assert!(actual_size > 0, "GIF has zero size");
-
-        // Verify GIF header
-        assert_eq!(&gif_data[0..6], b"GIF89a", "Invalid GIF header");
-
-        // Verify GIF trailer exists
-        gif_data.truncate(actual_size as usize);
-        assert_eq!(gif_data[gif_data.len() - 1], 0x3B, "Missing GIF trailer");
-
-        println!("  Actual GIF size: {} bytes", actual_size);
-        println!("✅ GIF creation test passed");
-    }
-
     // Test batch processing for 256x256x256 cube
     #[test]
     fn test_batch_processing_256_cube() {
         println!("Testing 256×256×256 cube batch processing...");
 
-        use crate::ffi::yx_proc_batch_rgba8;
+        use crate::batch_ffi::yx_proc_batch_rgba8;
 
         let frame_count = 8; // Test with 8 frames (full 256 would be slow)
         let width = 1080;
@@ -226,72 +90,394 @@ mod tests {
         println!("✅ Batch processing test passed");
     }
 
-    // Test error handling
+    // Test parallel batch processing matches the sequential path
     #[test]
-    fn test_error_handling() {
-        println!("Testing error handling...");
+    fn test_batch_processing_parallel_matches_sequential() {
+        println!("Testing parallel batch processing...");
 
-        // Test null pointer handling
-        let result = unsafe {
-            yingif_process_frame(
-                ptr::null_mut(),
-                ptr::null(),
-                0, 0, 0, 0,
-                ptr::null_mut(),
-                ptr::null_mut()
-            )
-        };
-        assert_eq!(result, -1, "Should return -1 for null processor");
+        use crate::batch_ffi::{yx_proc_batch_rgba8, yx_proc_batch_rgba8_parallel};
 
-        // Test invalid dimensions
-        let processor = unsafe { yingif_processor_new() };
-        let result = unsafe {
-            yingif_process_frame(
-                processor,
-                ptr::null(),
-                -1, -1, 0, 300, // Invalid dims and palette size
-                ptr::null_mut(),
-                ptr::null_mut()
-            )
+        let frame_count = 6;
+        let width = 512;
+        let height = 512;
+        let target_side = 128;
+        let palette_size = 256;
+
+        let frames_data: Vec<Vec<u8>> = (0..frame_count)
+            .map(|i| generate_test_frame(width, height, i as u8 * 10))
+            .collect();
+        let frame_pointers: Vec<*const u8> = frames_data.iter().map(|f| f.as_ptr()).collect();
+
+        let indices_size = (target_side * target_side * frame_count) as usize;
+        let palettes_size = (palette_size * frame_count) as usize;
+
+        let mut seq_indices = vec![0u8; indices_size];
+        let mut seq_palettes = vec![0u32; palettes_size];
+        let result = yx_proc_batch_rgba8(
+            frame_pointers.as_ptr(),
+            frame_count as i32,
+            width as i32,
+            height as i32,
+            target_side as i32,
+            palette_size as i32,
+            seq_indices.as_mut_ptr(),
+            seq_palettes.as_mut_ptr()
+        );
+        assert_eq!(result, 0, "Sequential batch failed with error: {}", result);
+
+        // Default pool and an explicit 2-thread pool
+        for num_threads in [0, 2] {
+            let mut par_indices = vec![0u8; indices_size];
+            let mut par_palettes = vec![0u32; palettes_size];
+            let result = yx_proc_batch_rgba8_parallel(
+                frame_pointers.as_ptr(),
+                frame_count as i32,
+                width as i32,
+                height as i32,
+                target_side as i32,
+                palette_size as i32,
+                par_indices.as_mut_ptr(),
+                par_palettes.as_mut_ptr(),
+                num_threads
+            );
+            assert_eq!(result, 0, "Parallel batch failed with error: {}", result);
+            assert_eq!(par_indices, seq_indices, "Indices differ with {} threads", num_threads);
+            assert_eq!(par_palettes, seq_palettes, "Palettes differ with {} threads", num_threads);
+        }
+
+        // Null frame pointer is still reported
+        let mut bad_pointers = frame_pointers.clone();
+        bad_pointers[3] = ptr::null();
+        let mut indices = vec![0u8; indices_size];
+        let mut palettes = vec![0u32; palettes_size];
+        let result = yx_proc_batch_rgba8_parallel(
+            bad_pointers.as_ptr(),
+            frame_count as i32,
+            width as i32,
+            height as i32,
+            target_side as i32,
+            palette_size as i32,
+            indices.as_mut_ptr(),
+            palettes.as_mut_ptr(),
+            0
+        );
+        assert_eq!(result, -3, "Should return -3 for null frame pointer");
+
+        println!("✅ Parallel batch processing test passed");
+    }
+
+    // Test area-average filter through the batch entry point
+    #[test]
+    fn test_batch_processing_area_filter() {
+        println!("Testing area filter batch processing...");
+
+        use crate::batch_ffi::{yx_proc_batch_rgba8_ex, YX_RESIZE_AREA};
+
+        let frame_count = 4;
+        let target_side = 256;
+        let palette_size = 256;
+
+        let frames_data: Vec<Vec<u8>> = (0..frame_count)
+            .map(|i| generate_test_frame(1080, 1080, i as u8 * 10))
+            .collect();
+        let frame_pointers: Vec<*const u8> = frames_data.iter().map(|f| f.as_ptr()).collect();
+
+        let mut indices = vec![0u8; (target_side * target_side * frame_count) as usize];
+        let mut palettes = vec![0u32; (palette_size * frame_count) as usize];
+
+        let result = yx_proc_batch_rgba8_ex(
+            frame_pointers.as_ptr(),
+            frame_count as i32,
+            1080,
+            1080,
+            target_side as i32,
+            palette_size as i32,
+            indices.as_mut_ptr(),
+            palettes.as_mut_ptr(),
+            YX_RESIZE_AREA,
+            0
+        );
+        assert_eq!(result, 0, "Area batch failed with error: {}", result);
+        assert!(indices.iter().any(|&i| i > 0), "Indices should have non-zero values");
+
+        // Unknown filter is rejected as an invalid argument
+        let result = yx_proc_batch_rgba8_ex(
+            frame_pointers.as_ptr(),
+            frame_count as i32,
+            1080,
+            1080,
+            target_side as i32,
+            palette_size as i32,
+            indices.as_mut_ptr(),
+            palettes.as_mut_ptr(),
+            42,
+            0
+        );
+        assert_eq!(result, -2, "Should return -2 for unknown filter");
+
+        println!("✅ Area filter batch test passed");
+    }
+
+    // Test streaming GIF encoder against the one-shot encoder
+    #[test]
+    fn test_gif_stream_matches_one_shot() {
+        println!("Testing streaming GIF encoder...");
+
+        use crate::batch_ffi::*;
+
+        let frame_count = 6;
+        let side = 64;
+        let frame_pixels = side * side;
+
+        let indices: Vec<u8> = (0..frame_count * frame_pixels).map(|i| ((i * 7) % 256) as u8).collect();
+        let palettes: Vec<u32> = (0..frame_count * 256).map(|i| (i as u32).wrapping_mul(0x010307)).collect();
+
+        let mut one_shot = vec![0u8; 1024 * 1024];
+        let mut one_shot_len = one_shot.len();
+        let result = yx_gif_encode(
+            indices.as_ptr(),
+            palettes.as_ptr(),
+            frame_count as i32,
+            side as i32,
+            4,
+            one_shot.as_mut_ptr(),
+            &mut one_shot_len
+        );
+        assert_eq!(result, 0, "One-shot encode failed with error: {}", result);
+        one_shot.truncate(one_shot_len);
+
+        // One-shot path compresses frames in parallel; the stream pushes them
+        // one at a time, so equality also covers parallel vs sequential LZW.
+        // Drain after every frame through a small buffer
+        let stream = yx_gif_stream_open(side as i32, 4, 256, None, ptr::null_mut());
+        assert!(!stream.is_null(), "Failed to open stream");
+
+        let mut streamed = Vec::new();
+        let mut chunk = [0u8; 1000];
+        let mut drain = |streamed: &mut Vec<u8>| loop {
+            let mut len = chunk.len();
+            assert_eq!(yx_gif_stream_drain(stream, chunk.as_mut_ptr(), &mut len), 0);
+            if len == 0 {
+                break;
+            }
+            streamed.extend_from_slice(&chunk[..len]);
         };
-        assert_eq!(result, -2, "Should return -2 for invalid dimensions");
 
-        unsafe { yingif_processor_free(processor) };
-        println!("✅ Error handling test passed");
+        for f in 0..frame_count {
+            let result = yx_gif_stream_push_frame(
+                stream,
+                indices[f * frame_pixels..].as_ptr(),
+                palettes[f * 256..].as_ptr()
+            );
+            assert_eq!(result, 0, "Frame {} push failed", f);
+            assert!(yx_gif_stream_pending(stream) > 0);
+            drain(&mut streamed);
+        }
+
+        assert_eq!(yx_gif_stream_finish(stream), 0);
+        assert_eq!(yx_gif_stream_finish(stream), -2, "Second finish should be rejected");
+        drain(&mut streamed);
+        assert_eq!(yx_gif_stream_pending(stream), 0);
+        yx_gif_stream_free(stream);
+
+        assert_eq!(streamed, one_shot, "Streamed GIF should match one-shot output");
+        assert_eq!(streamed.last(), Some(&0x3B), "GIF should end with trailer");
+
+        println!("✅ Streaming GIF encoder test passed");
     }
 
-    // Test memory safety with large cube
+    // Test streaming GIF encoder through the write callback
     #[test]
-    fn test_memory_safety() {
-        println!("Testing memory safety with multiple operations...");
-
-        // Create and destroy multiple processors
-        for i in 0..10 {
-            let processor = unsafe { yingif_processor_new() };
-            assert!(!processor.is_null(), "Failed to create processor {}", i);
-            unsafe { yingif_processor_free(processor) };
+    fn test_gif_stream_write_callback() {
+        println!("Testing streaming GIF write callback...");
+
+        use crate::batch_ffi::*;
+        use std::ffi::c_void;
+
+        unsafe extern "C" fn collect(ctx: *mut c_void, data: *const u8, len: usize) -> i32 {
+            let out = &mut *(ctx as *mut Vec<u8>);
+            out.extend_from_slice(std::slice::from_raw_parts(data, len));
+            0
+        }
+        // Accepts writes until its byte budget runs out
+        unsafe extern "C" fn limited(ctx: *mut c_void, _data: *const u8, len: usize) -> i32 {
+            let budget = &mut *(ctx as *mut usize);
+            if len > *budget {
+                return -1;
+            }
+            *budget -= len;
+            0
+        }
+
+        let frame_count = 4;
+        let side = 32;
+        let frame_pixels = side * side;
+        let indices: Vec<u8> = (0..frame_count * frame_pixels).map(|i| ((i * 3) % 256) as u8).collect();
+        let palettes: Vec<u32> = (0..frame_count * 256).map(|i| (i as u32).wrapping_mul(0x010307)).collect();
+
+        let mut one_shot = vec![0u8; yx_gif_max_size(frame_count as i32, side as i32)];
+        let mut one_shot_len = one_shot.len();
+        let result = yx_gif_encode(
+            indices.as_ptr(),
+            palettes.as_ptr(),
+            frame_count as i32,
+            side as i32,
+            4,
+            one_shot.as_mut_ptr(),
+            &mut one_shot_len
+        );
+        assert_eq!(result, 0);
+        one_shot.truncate(one_shot_len);
+
+        let mut written: Vec<u8> = Vec::new();
+        let stream = yx_gif_stream_open(side as i32, 4, 256, Some(collect), &mut written as *mut Vec<u8> as *mut c_void);
+        assert!(!stream.is_null(), "Failed to open stream");
+        for f in 0..frame_count {
+            let result = yx_gif_stream_push_frame(
+                stream,
+                indices[f * frame_pixels..].as_ptr(),
+                palettes[f * 256..].as_ptr()
+            );
+            assert_eq!(result, 0, "Frame {} push failed", f);
+            assert_eq!(yx_gif_stream_pending(stream), 0, "Callback sinks buffer nothing");
         }
+        assert_eq!(yx_gif_stream_finish(stream), 0);
+        yx_gif_stream_free(stream);
+        assert_eq!(written, one_shot, "Callback output should match one-shot output");
+
+        // A sink that fails the header fails the open; one that fails later fails the push
+        let mut budget = 0usize;
+        let stream = yx_gif_stream_open(side as i32, 4, 256, Some(limited), &mut budget as *mut usize as *mut c_void);
+        assert!(stream.is_null(), "Header write should fail through the rejecting sink");
+
+        let mut budget = 1024usize;
+        let stream = yx_gif_stream_open(side as i32, 4, 256, Some(limited), &mut budget as *mut usize as *mut c_void);
+        assert!(!stream.is_null());
+        let result = yx_gif_stream_push_frame(stream, indices.as_ptr(), palettes.as_ptr());
+        assert_eq!(result, -3, "Should return -3 when the sink rejects a write");
+        yx_gif_stream_free(stream);
+
+        println!("✅ Streaming GIF write callback test passed");
+    }
+
+    // Test caller-buffer encoding against the size bound
+    #[test]
+    fn test_gif_encoder_blocks_and_bound() {
+        println!("Testing caller-buffer GIF encoder...");
+
+        use crate::batch_ffi::*;
+
+        let frame_count = 5;
+        let side = 48;
+        let frame_pixels = side * side;
+
+        // Noise doesn't compress, so every frame takes the uncompressed fallback
+        let mut seed = 0x9E37_79B9u32;
+        let noise: Vec<u8> = (0..frame_count * frame_pixels)
+            .map(|_| {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                seed as u8
+            })
+            .collect();
+        let gradient: Vec<u8> = (0..frame_count * frame_pixels).map(|i| ((i % side) * 4) as u8).collect();
+        let palettes: Vec<u32> = (0..frame_count * 256).map(|i| (i as u32).wrapping_mul(0x010307)).collect();
+
+        let max_size = yx_gif_max_size(frame_count as i32, side as i32);
+        assert_eq!(yx_gif_max_size(0, side as i32), 0);
+
+        let encode = |indices: &[u8], capacity: usize| {
+            let mut out = vec![0u8; capacity];
+            let mut len = capacity;
+            let result = yx_gif_encode(
+                indices.as_ptr(),
+                palettes.as_ptr(),
+                frame_count as i32,
+                side as i32,
+                4,
+                out.as_mut_ptr(),
+                &mut len
+            );
+            out.truncate(len);
+            (result, out)
+        };
 
-        // Process multiple frames with same processor
-        let processor = unsafe { yingif_processor_new() };
-        for i in 0..5 {
-            let frame = generate_test_frame(512, 512, i * 20);
-            let mut indices = vec![0u8; 128 * 128];
-            let mut palette = vec![0u32; 128];
-
-            let result = unsafe {
-                yingif_process_frame(
-                    processor,
-                    frame.as_ptr(),
-                    512, 512, 128, 128,
-                    indices.as_mut_ptr(),
-                    palette.as_mut_ptr()
-                )
-            };
-            assert_eq!(result, 0, "Frame {} processing failed", i);
+        let (result, one_shot) = encode(&noise, max_size);
+        assert_eq!(result, 0, "A max-size buffer must always fit");
+        assert_eq!(one_shot.len(), max_size, "Bound should be exact for uncompressed frames");
+        assert_eq!(encode(&noise, max_size - 1).0, -4, "Should return -4 for a short buffer");
+
+        let (result, compressed) = encode(&gradient, max_size);
+        assert_eq!(result, 0);
+        assert!(compressed.len() < max_size / 2, "Gradient should compress");
+
+        // Any chain of blocks reproduces the one-shot output
+        for block_size in [1, 255, 4096, max_size] {
+            let encoder = yx_gif_encoder_open(noise.as_ptr(), palettes.as_ptr(), frame_count as i32, side as i32, 4);
+            assert!(!encoder.is_null(), "Failed to open encoder");
+
+            let mut chained = Vec::new();
+            let mut block = vec![0u8; block_size];
+            loop {
+                let mut len = block.len();
+                let status = yx_gif_encoder_next(encoder, block.as_mut_ptr(), &mut len);
+                chained.extend_from_slice(&block[..len]);
+                if status == 0 {
+                    break;
+                }
+                assert_eq!(status, YX_GIF_NEED_SPACE, "Unexpected status {}", status);
+            }
+            yx_gif_encoder_free(encoder);
+            assert_eq!(chained, one_shot, "Block size {} changed the output", block_size);
         }
-        unsafe { yingif_processor_free(processor) };
 
-        println!("✅ Memory safety test passed");
+        println!("✅ Caller-buffer GIF encoder test passed");
+    }
+
+    // Test GPU texture export from the batch outputs
+    #[test]
+    fn test_texture_export_layout() {
+        println!("Testing GPU texture export...");
+
+        use crate::batch_ffi::*;
+
+        let (side, depth) = (132usize, 12usize);
+        let indices: Vec<u8> = (0..side * side * depth).map(|i| (i % 251) as u8).collect();
+        let palettes: Vec<u32> = (0..depth * 256).map(|i| (i as u32).wrapping_mul(0x010307)).collect();
+
+        let mut levels: Vec<YxTextureLevel> = (0..YX_TEXTURE_MAX_LEVELS)
+            .map(|_| YxTextureLevel { offset: 0, width: 0, height: 0, depth: 0, bytes_per_row: 0, bytes_per_image: 0 })
+            .collect();
+        let mut total = 0usize;
+        let count = yx_texture_layout(
+            YX_TEXTURE_R8_INDEX, side as i32, side as i32, depth as i32, 0, 256, levels.as_mut_ptr(), &mut total
+        );
+        assert_eq!(count, 8, "132 on the longest side is an 8-level chain");
+        assert_eq!(levels[0].bytes_per_row, 256, "Rows should pad to the alignment");
+        assert!(levels[..8].iter().all(|level| level.offset % 256 == 0));
+
+        let mut volume = vec![0u8; total];
+        let mut palette_texture = vec![0u8; depth * 256 * 4];
+        let write = |volume: &mut [u8], len: usize, palette_texture: &mut [u8]| {
+            yx_texture_write_indexed(
+                indices.as_ptr(), palettes.as_ptr(), depth as i32,
+                side as i32, side as i32, depth as i32,
+                YX_TEXTURE_R8_INDEX, 0, 256,
+                volume.as_mut_ptr(), len, palette_texture.as_mut_ptr()
+            )
+        };
+        assert_eq!(write(&mut volume, total, &mut palette_texture), 0);
+        assert_eq!(write(&mut volume, total - 1, &mut palette_texture), -4, "Should return -4 for a short buffer");
+
+        let row = &volume[5 * levels[0].bytes_per_image + 7 * levels[0].bytes_per_row..][..side];
+        assert_eq!(row, &indices[(5 * side + 7) * side..][..side]);
+        let color = palettes[3 * 256 + 9];
+        assert_eq!(
+            &palette_texture[(3 * 256 + 9) * 4..][..4],
+            &[(color >> 16) as u8, (color >> 8) as u8, color as u8, 255]
+        );
+
+        println!("✅ GPU texture export test passed");
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,468 @@
+// GPU upload layout for the voxel tensor
+// A 3D texture level is uploaded from a buffer described by an offset,
+// bytesPerRow and bytesPerImage (Metal's replace(region:) and buffer-to-texture
+// blits, Vulkan's buffer image copies). Writing the tensor straight into that
+// layout, mip chain included, lets the caller fill a shared MTLBuffer in place
+// and blit it into a private texture without another CPU pass.
+
+use rayon::prelude::*;
+
+use crate::cube_kernels::TENSOR_SIDE;
+use crate::tensor::{convert_index_layout, convert_layout, process_result_shape, TensorLayout};
+use crate::{ProcessorError, Result};
+
+/// Entries per palette in indexed sources, and the palette texture's width
+pub const PALETTE_ENTRIES: usize = 256;
+
+/// Voxel format of the uploaded volume
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TextureFormat {
+    Rgba8,   // Resolved colors, 4 bytes per voxel (RGBA8Unorm)
+    R8Index, // Palette index, 1 byte per voxel (R8Uint); colors come from the palette texture
+}
+
+impl TextureFormat {
+    pub fn bytes_per_voxel(self) -> usize {
+        match self {
+            TextureFormat::Rgba8 => 4,
+            TextureFormat::R8Index => 1,
+        }
+    }
+}
+
+/// Where one mip level sits in the upload buffer
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct TextureLevel {
+    pub offset: usize,
+    pub width: usize,
+    pub height: usize,
+    pub depth: usize,
+    pub bytes_per_row: usize,   // Row stride, a multiple of the row alignment
+    pub bytes_per_image: usize, // Slice stride, bytes_per_row × height
+}
+
+impl TextureLevel {
+    pub fn len(&self) -> usize {
+        self.bytes_per_image * self.depth
+    }
+}
+
+/// Upload layout of a volume and its mip chain
+#[derive(Debug, Clone)]
+pub struct TextureLayout {
+    pub format: TextureFormat,
+    pub levels: Vec<TextureLevel>,
+    pub total_bytes: usize,
+}
+
+impl TextureLayout {
+    /// Layout for a `width` × `height` × `depth` volume
+    ///
+    /// `mip_levels` 0 means the full chain down to 1×1×1. Rows and level offsets
+    /// are padded to `row_alignment` bytes (a power of two, 1 for tight packing;
+    /// 256 suits buffer-backed textures on every Apple GPU).
+    pub fn new(
+        format: TextureFormat,
+        width: usize,
+        height: usize,
+        depth: usize,
+        mip_levels: usize,
+        row_alignment: usize,
+    ) -> Result<Self> {
+        if width == 0 || height == 0 || depth == 0 || !row_alignment.is_power_of_two() {
+            return Err(ProcessorError::InvalidInput);
+        }
+        let full_chain = (usize::BITS - width.max(height).max(depth).leading_zeros()) as usize;
+        if mip_levels > full_chain {
+            return Err(ProcessorError::InvalidInput);
+        }
+        let level_count = if mip_levels == 0 { full_chain } else { mip_levels };
+
+        let align = |bytes: usize| (bytes + row_alignment - 1) & !(row_alignment - 1);
+        let mut levels = Vec::with_capacity(level_count);
+        let (mut w, mut h, mut d, mut offset) = (width, height, depth, 0);
+        for _ in 0..level_count {
+            let bytes_per_row = align(w * format.bytes_per_voxel());
+            let level = TextureLevel {
+                offset,
+                width: w,
+                height: h,
+                depth: d,
+                bytes_per_row,
+                bytes_per_image: bytes_per_row * h,
+            };
+            offset = align(offset + level.len());
+            levels.push(level);
+            (w, h, d) = ((w / 2).max(1), (h / 2).max(1), (d / 2).max(1));
+        }
+
+        Ok(TextureLayout { format, levels, total_bytes: offset })
+    }
+}
+
+/// Voxel data to upload; slices are z-major, rows tightly packed
+pub enum TextureSource<'a> {
+    /// RGBA8 voxels, e.g. ProcessResult.tensor_data
+    Rgba(&'a [u8]),
+    /// Palette indices with 256-entry 0x00RRGGBB palettes: one shared palette,
+    /// or one per slice as the batch path produces them
+    Indexed { indices: &'a [u8], palettes: &'a [u32], palette_count: usize },
+}
+
+/// Write `source` and its mip chain into `out` at `layout`'s offsets
+///
+/// Padding is zeroed. Each level is written slice-parallel; level n + 1 is
+/// reduced from level n as already written, so the source is read once.
+/// RGBA levels are 2×2×2 box filtered; index levels are point sampled, since
+/// averaging palette indices means nothing.
+pub fn write_texture(source: &TextureSource, layout: &TextureLayout, out: &mut [u8]) -> Result<()> {
+    let base = layout.levels[0];
+    let voxels = base.width * base.height * base.depth;
+    if out.len() < layout.total_bytes {
+        return Err(ProcessorError::MemoryError);
+    }
+    match *source {
+        TextureSource::Rgba(rgba) if rgba.len() >= voxels * 4 && layout.format == TextureFormat::Rgba8 => {}
+        TextureSource::Indexed { indices, palettes, palette_count }
+            if indices.len() >= voxels
+                && (palette_count == 1 || palette_count == base.depth)
+                && palettes.len() >= palette_count * PALETTE_ENTRIES => {}
+        _ => return Err(ProcessorError::InvalidInput),
+    }
+
+    let out = &mut out[..layout.total_bytes];
+    out.fill(0);
+
+    let bpv = layout.format.bytes_per_voxel();
+    let slice_voxels = base.width * base.height;
+    out[base.offset..base.offset + base.len()]
+        .par_chunks_mut(base.bytes_per_image)
+        .enumerate()
+        .for_each(|(z, image)| {
+            let rows = image.chunks_mut(base.bytes_per_row);
+            let first = z * slice_voxels;
+            match *source {
+                TextureSource::Rgba(rgba) => {
+                    let src_rows = rgba[first * 4..(first + slice_voxels) * 4].chunks_exact(base.width * 4);
+                    for (row, src) in rows.zip(src_rows) {
+                        row[..src.len()].copy_from_slice(src);
+                    }
+                }
+                TextureSource::Indexed { indices, palettes, palette_count } => {
+                    let src_rows = indices[first..first + slice_voxels].chunks_exact(base.width);
+                    let palette_start = if palette_count == 1 { 0 } else { z * PALETTE_ENTRIES };
+                    let palette = &palettes[palette_start..palette_start + PALETTE_ENTRIES];
+                    for (row, src) in rows.zip(src_rows) {
+                        if bpv == 1 {
+                            row[..src.len()].copy_from_slice(src);
+                        } else {
+                            for (texel, &index) in row.chunks_exact_mut(4).zip(src) {
+                                texel.copy_from_slice(&rgba_from_packed(palette[index as usize]));
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+    for pair in layout.levels.windows(2) {
+        let (src_level, dst_level) = (pair[0], pair[1]);
+        let (head, tail) = out.split_at_mut(dst_level.offset);
+        let src = &head[src_level.offset..src_level.offset + src_level.len()];
+        tail[..dst_level.len()]
+            .par_chunks_mut(dst_level.bytes_per_image)
+            .enumerate()
+            .for_each(|(z, image)| match layout.format {
+                TextureFormat::Rgba8 => box_reduce(src, &src_level, image, &dst_level, z),
+                TextureFormat::R8Index => point_reduce(src, &src_level, image, &dst_level, z),
+            });
+    }
+    Ok(())
+}
+
+/// Palette texture for R8Index volumes: PALETTE_ENTRIES wide, one row per
+/// palette, RGBA8 with opaque alpha (row stride PALETTE_ENTRIES × 4 bytes)
+pub fn write_palette_texture(palettes: &[u32], palette_count: usize, out: &mut [u8]) -> Result<()> {
+    let entries = palette_count * PALETTE_ENTRIES;
+    if palettes.len() < entries || out.len() < entries * 4 {
+        return Err(ProcessorError::InvalidInput);
+    }
+    for (texel, &color) in out.chunks_exact_mut(4).zip(&palettes[..entries]) {
+        texel.copy_from_slice(&rgba_from_packed(color));
+    }
+    Ok(())
+}
+
+/// Mip level of a TensorTexture (TextureLevel with UniFFI integer types)
+#[derive(Debug, Clone)]
+pub struct TensorTextureLevel {
+    pub offset: u64,
+    pub width: u32,
+    pub height: u32,
+    pub depth: u32,
+    pub bytes_per_row: u64,
+    pub bytes_per_image: u64,
+}
+
+/// A ProcessResult tensor laid out for upload, mip chain included
+#[derive(Debug, Clone)]
+pub struct TensorTexture {
+    pub data: Vec<u8>,                    // Upload buffer, TextureLayout.total_bytes long
+    pub levels: Vec<TensorTextureLevel>,
+    pub palette_texture: Option<Vec<u8>>, // 256×1 RGBA8, for indexed tensors
+}
+
+/// Lay out a TENSOR_SIDE² × frame_count tensor from process_all_frames for upload
+///
+/// `voxels` is ProcessResult.tensor_data (RGBA8), or tensor_indices with
+/// `palette` set to tensor_palette (R8Index plus a palette texture), stored as
+/// `tensor_layout` (GifOpts.tensor_layout); tiled tensors are reordered to
+/// frame-major first and their padding dropped. See TextureLayout::new for
+/// mip_levels and row_alignment.
+pub fn tensor_texture(
+    voxels: Vec<u8>,
+    palette: Option<Vec<u8>>,
+    tensor_layout: TensorLayout,
+    frame_count: u32,
+    mip_levels: u32,
+    row_alignment: u32,
+) -> Result<TensorTexture> {
+    let format = if palette.is_some() { TextureFormat::R8Index } else { TextureFormat::Rgba8 };
+    let shape = process_result_shape(tensor_layout, frame_count)?;
+    let voxels = match (tensor_layout, format) {
+        (TensorLayout::FrameMajor, _) if voxels.len() == shape.total_elements() * format.bytes_per_voxel() => voxels,
+        (TensorLayout::FrameMajor, _) => return Err(ProcessorError::InvalidInput),
+        (_, TextureFormat::Rgba8) => convert_layout(&voxels, shape, TensorLayout::FrameMajor)?,
+        (_, TextureFormat::R8Index) => convert_index_layout(&voxels, shape, TensorLayout::FrameMajor)?,
+    };
+    let depth = frame_count as usize;
+    let layout = TextureLayout::new(format, TENSOR_SIDE, TENSOR_SIDE, depth, mip_levels as usize, row_alignment as usize)?;
+
+    // Tensor palettes are RGBA bytes; pack them as the indexed source expects
+    let packed = match &palette {
+        Some(rgba) if rgba.len() % 4 == 0 && rgba.len() <= PALETTE_ENTRIES * 4 => {
+            let mut packed = vec![0u32; PALETTE_ENTRIES];
+            for (slot, color) in packed.iter_mut().zip(rgba.chunks_exact(4)) {
+                *slot = (color[0] as u32) << 16 | (color[1] as u32) << 8 | color[2] as u32;
+            }
+            Some(packed)
+        }
+        Some(_) => return Err(ProcessorError::InvalidInput),
+        None => None,
+    };
+    let source = match &packed {
+        Some(palettes) => TextureSource::Indexed { indices: &voxels, palettes, palette_count: 1 },
+        None => TextureSource::Rgba(&voxels),
+    };
+
+    let mut data = vec![0u8; layout.total_bytes];
+    write_texture(&source, &layout, &mut data)?;
+    let palette_texture = match &packed {
+        Some(palettes) => {
+            let mut texels = vec![0u8; PALETTE_ENTRIES * 4];
+            write_palette_texture(palettes, 1, &mut texels)?;
+            Some(texels)
+        }
+        None => None,
+    };
+
+    let levels = layout
+        .levels
+        .iter()
+        .map(|level| TensorTextureLevel {
+            offset: level.offset as u64,
+            width: level.width as u32,
+            height: level.height as u32,
+            depth: level.depth as u32,
+            bytes_per_row: level.bytes_per_row as u64,
+            bytes_per_image: level.bytes_per_image as u64,
+        })
+        .collect();
+    Ok(TensorTexture { data, levels, palette_texture })
+}
+
+#[inline]
+fn rgba_from_packed(color: u32) -> [u8; 4] {
+    [(color >> 16) as u8, (color >> 8) as u8, color as u8, 255]
+}
+
+/// Source coordinates averaged into destination coordinate `x`: 2x and 2x + 1,
+/// clamped so odd and already-1 dimensions stay in range
+#[inline]
+fn taps(x: usize, src_len: usize) -> [usize; 2] {
+    [(2 * x).min(src_len - 1), (2 * x + 1).min(src_len - 1)]
+}
+
+/// One destination slice of a 2×2×2 box-filtered RGBA level
+fn box_reduce(src: &[u8], src_level: &TextureLevel, image: &mut [u8], dst_level: &TextureLevel, z: usize) {
+    let zs = taps(z, src_level.depth);
+    for (y, row) in image.chunks_mut(dst_level.bytes_per_row).take(dst_level.height).enumerate() {
+        let ys = taps(y, src_level.height);
+        for (x, texel) in row.chunks_exact_mut(4).take(dst_level.width).enumerate() {
+            let xs = taps(x, src_level.width);
+            let mut sum = [4u32; 4]; // Rounds the /8 to nearest
+            for &sz in &zs {
+                for &sy in &ys {
+                    let line = sz * src_level.bytes_per_image + sy * src_level.bytes_per_row;
+                    for &sx in &xs {
+                        let s = &src[line + sx * 4..line + sx * 4 + 4];
+                        for c in 0..4 {
+                            sum[c] += s[c] as u32;
+                        }
+                    }
+                }
+            }
+            for c in 0..4 {
+                texel[c] = (sum[c] / 8) as u8;
+            }
+        }
+    }
+}
+
+/// One destination slice of a point-sampled index level
+fn point_reduce(src: &[u8], src_level: &TextureLevel, image: &mut [u8], dst_level: &TextureLevel, z: usize) {
+    let sz = taps(z, src_level.depth)[0];
+    for (y, row) in image.chunks_mut(dst_level.bytes_per_row).take(dst_level.height).enumerate() {
+        let line = sz * src_level.bytes_per_image + taps(y, src_level.height)[0] * src_level.bytes_per_row;
+        for (x, texel) in row[..dst_level.width].iter_mut().enumerate() {
+            *texel = src[line + taps(x, src_level.width)[0]];
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_layout_pads_rows_and_offsets() {
+        let layout = TextureLayout::new(TextureFormat::Rgba8, 132, 132, 40, 0, 256).unwrap();
+        // 132 → 66 → 33 → 16 → 8 → 4 → 2 → 1
+        assert_eq!(layout.levels.len(), 8);
+        let base = layout.levels[0];
+        assert_eq!(base.bytes_per_row, 768); // 528 rounded up to 256
+        assert_eq!(base.bytes_per_image, 768 * 132);
+        for level in &layout.levels {
+            assert_eq!(level.offset % 256, 0);
+            assert_eq!(level.bytes_per_row % 256, 0);
+            assert!(level.bytes_per_row >= level.width * 4);
+        }
+        let last = layout.levels.last().unwrap();
+        assert_eq!((last.width, last.height, last.depth), (1, 1, 1));
+        assert!(layout.total_bytes >= last.offset + last.len());
+
+        let tight = TextureLayout::new(TextureFormat::R8Index, 128, 128, 128, 1, 1).unwrap();
+        assert_eq!(tight.total_bytes, 128 * 128 * 128);
+        assert!(TextureLayout::new(TextureFormat::Rgba8, 128, 128, 128, 9, 1).is_err());
+        assert!(TextureLayout::new(TextureFormat::Rgba8, 128, 128, 128, 0, 3).is_err());
+    }
+
+    #[test]
+    fn test_rgba_volume_and_mips() {
+        let (w, h, d) = (6usize, 4usize, 3usize);
+        let rgba: Vec<u8> = (0..w * h * d * 4).map(|i| (i * 5 % 251) as u8).collect();
+        let layout = TextureLayout::new(TextureFormat::Rgba8, w, h, d, 0, 64).unwrap();
+        let mut out = vec![0xAAu8; layout.total_bytes + 7];
+        write_texture(&TextureSource::Rgba(&rgba), &layout, &mut out).unwrap();
+
+        // Level 0 copies every row, padding zeroed
+        let base = layout.levels[0];
+        for z in 0..d {
+            for y in 0..h {
+                let row = &out[z * base.bytes_per_image + y * base.bytes_per_row..][..base.bytes_per_row];
+                let src = &rgba[((z * h + y) * w) * 4..][..w * 4];
+                assert_eq!(&row[..w * 4], src);
+                assert!(row[w * 4..].iter().all(|&b| b == 0));
+            }
+        }
+
+        // Level 1 voxel (1, 0, 0) averages x 2-3, y 0-1, z 0-1
+        let level = layout.levels[1];
+        assert_eq!((level.width, level.height, level.depth), (3, 2, 1));
+        for c in 0..4 {
+            let mut sum = 4u32;
+            for z in 0..2 {
+                for y in 0..2 {
+                    for x in 2..4 {
+                        sum += rgba[((z * h + y) * w + x) * 4 + c] as u32;
+                    }
+                }
+            }
+            assert_eq!(out[level.offset + 4 + c] as u32, sum / 8);
+        }
+        assert_eq!(out[layout.total_bytes], 0xAA, "Nothing written past the layout");
+    }
+
+    #[test]
+    fn test_indexed_volume_formats() {
+        let (side, depth) = (4usize, 2usize);
+        let indices: Vec<u8> = (0..side * side * depth).map(|i| (i % 7) as u8).collect();
+        let palettes: Vec<u32> = (0..depth * PALETTE_ENTRIES).map(|i| (i as u32) * 0x010101).collect();
+        let source = TextureSource::Indexed { indices: &indices, palettes: &palettes, palette_count: depth };
+
+        // R8: indices as is, mips point sampled
+        let layout = TextureLayout::new(TextureFormat::R8Index, side, side, depth, 0, 1).unwrap();
+        let mut out = vec![0u8; layout.total_bytes];
+        write_texture(&source, &layout, &mut out).unwrap();
+        assert_eq!(&out[..indices.len()], &indices[..]);
+        let level = layout.levels[1];
+        assert_eq!(out[level.offset + 1], indices[2]);
+
+        // RGBA8: each slice resolved through its own palette
+        let layout = TextureLayout::new(TextureFormat::Rgba8, side, side, depth, 1, 1).unwrap();
+        let mut out = vec![0u8; layout.total_bytes];
+        write_texture(&source, &layout, &mut out).unwrap();
+        let voxel = side * side + 3; // Slice 1
+        let color = palettes[PALETTE_ENTRIES + indices[voxel] as usize];
+        assert_eq!(out[voxel * 4..voxel * 4 + 4], rgba_from_packed(color));
+
+        // A palette per slice must cover every slice
+        let short = TextureSource::Indexed { indices: &indices, palettes: &palettes[..PALETTE_ENTRIES], palette_count: depth };
+        assert_eq!(write_texture(&short, &layout, &mut out), Err(ProcessorError::InvalidInput));
+        assert_eq!(write_texture(&source, &layout, &mut out[..10]), Err(ProcessorError::MemoryError));
+
+        let mut texture = vec![0u8; depth * PALETTE_ENTRIES * 4];
+        write_palette_texture(&palettes, depth, &mut texture).unwrap();
+        assert_eq!(texture[(PALETTE_ENTRIES + 2) * 4..][..4], rgba_from_packed(palettes[PALETTE_ENTRIES + 2]));
+    }
+
+    #[test]
+    fn test_tensor_texture_from_process_result() {
+        let depth = 4;
+        let slice = TENSOR_SIDE * TENSOR_SIDE;
+        let rgba: Vec<u8> = (0..slice * depth * 4).map(|i| (i % 251) as u8).collect();
+
+        let texture = tensor_texture(rgba.clone(), None, TensorLayout::FrameMajor, depth as u32, 2, 256).unwrap();
+        assert_eq!(texture.levels.len(), 2);
+        assert_eq!(texture.levels[0].depth, depth as u32);
+        assert_eq!(texture.levels[0].bytes_per_row, (TENSOR_SIDE * 4) as u64);
+        assert_eq!(texture.levels[1].width, (TENSOR_SIDE / 2) as u32);
+        assert_eq!(texture.data[..TENSOR_SIDE * 4], rgba[..TENSOR_SIDE * 4]);
+        assert!(texture.palette_texture.is_none());
+
+        // Indexed tensor: a short RGBA palette is padded to the palette texture's width
+        let indices: Vec<u8> = (0..slice * depth).map(|i| (i % 3) as u8).collect();
+        let palette = vec![10, 20, 30, 255, 40, 50, 60, 255, 70, 80, 90, 255];
+        let texture = tensor_texture(indices.clone(), Some(palette.clone()), TensorLayout::FrameMajor, depth as u32, 1, 1).unwrap();
+        assert_eq!(texture.data, indices);
+        let texels = texture.palette_texture.unwrap();
+        assert_eq!(texels.len(), PALETTE_ENTRIES * 4);
+        assert_eq!(texels[4..8], [40, 50, 60, 255]);
+
+        // Tiled tensors upload as the same frame-major volume
+        let shape = process_result_shape(TensorLayout::Bricked, depth as u32).unwrap().with_layout(TensorLayout::FrameMajor);
+        for tensor_layout in [TensorLayout::Bricked, TensorLayout::Morton] {
+            let tiled = convert_index_layout(&indices, shape, tensor_layout).unwrap();
+            let texture = tensor_texture(tiled, Some(palette.clone()), tensor_layout, depth as u32, 1, 1).unwrap();
+            assert_eq!(texture.data, indices);
+        }
+
+        let err = Some(ProcessorError::InvalidInput);
+        assert_eq!(tensor_texture(vec![0; 10], None, TensorLayout::FrameMajor, 1, 0, 1).err(), err);
+        assert_eq!(tensor_texture(indices.clone(), Some(vec![0; 3]), TensorLayout::FrameMajor, depth as u32, 0, 1).err(), err);
+        // Frame count and layout must describe the data
+        assert_eq!(tensor_texture(rgba.clone(), None, TensorLayout::FrameMajor, depth as u32 - 1, 0, 1).err(), err);
+        assert_eq!(tensor_texture(rgba.clone(), None, TensorLayout::Bricked, depth as u32, 0, 1).err(), err);
+        assert_eq!(tensor_texture(rgba, None, TensorLayout::FrameMajor, 0, 0, 1).err(), err);
+    }
+}
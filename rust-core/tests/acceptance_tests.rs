@@ -1,7 +1,7 @@
 // Acceptance tests for RGB2GIF processor
 // Validates the single-FFI interface for quality, performance, and correctness
 
-use rgb2gif_processor::{process_all_frames, QuantizeOpts, GifOpts};
+use rgb2gif_processor::{process_all_frames, QuantizeOpts, GifOpts, TensorLayout};
 use std::time::Instant;
 
 fn create_test_frames(count: usize, width: u32, height: u32) -> Vec<u8> {
@@ -33,6 +33,8 @@ fn test_single_ffi_256_frames() {
         palette_size: 256,
         dithering_level: 1.0,
         shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
     };
 
     let gif_opts = GifOpts {
@@ -43,6 +45,8 @@ fn test_single_ffi_256_frames() {
         loop_count: 0,
         optimize: true,
         include_tensor: false,
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
     };
 
     let start = Instant::now();
@@ -84,6 +88,8 @@ fn test_with_tensor_output() {
         palette_size: 256,
         dithering_level: 0.5,
         shared_palette: false,
+        oklab_palette: false,
+        blue_noise_dither: false,
     };
 
     let gif_opts = GifOpts {
@@ -94,6 +100,8 @@ fn test_with_tensor_output() {
         loop_count: 0,
         optimize: false,
         include_tensor: true,  // Request tensor
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
     };
 
     let result = process_all_frames(
@@ -134,6 +142,8 @@ fn test_performance_targets() {
             palette_size: 256,
             dithering_level: 0.0,
             shared_palette: true,
+            oklab_palette: false,
+            blue_noise_dither: false,
         };
 
         let gif_opts = GifOpts {
@@ -144,6 +154,8 @@ fn test_performance_targets() {
             loop_count: 0,
             optimize: false,
             include_tensor: false,
+            indexed_tensor: false,
+            tensor_layout: TensorLayout::FrameMajor,
         };
 
         let start = Instant::now();
@@ -180,6 +192,8 @@ fn test_gif_validation() {
         palette_size: 128,
         dithering_level: 1.0,
         shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
     };
 
     let gif_opts = GifOpts {
@@ -190,6 +204,8 @@ fn test_gif_validation() {
         loop_count: 5,
         optimize: true,
         include_tensor: false,
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
     };
 
     let result = process_all_frames(
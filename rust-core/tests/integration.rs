@@ -1,7 +1,15 @@
 // Integration tests for RGB2GIF processor
 // Validates the complete pipeline works correctly
 
-use rgb2gif_processor::{process_all_frames, QuantizeOpts, GifOpts};
+use rgb2gif_processor::{
+    process_all_frames, process_all_frames_async, set_stats_enabled, transcode_batch, BatchOpts, Clip, ClipJob,
+    EncodeTask, FramePipeline, PipelineOpts, ProcessorError, ProgressListener, QuantizeOpts, GifOpts,
+    TensorLayout,
+};
+use std::future::Future;
+use std::sync::atomic::{AtomicU32, Ordering};
+use std::sync::Arc;
+use std::task::{Context, Poll, Wake, Waker};
 use std::time::Instant;
 
 fn create_test_frames(count: usize, width: u32, height: u32) -> Vec<u8> {
@@ -32,6 +40,8 @@ fn test_basic_processing() {
         palette_size: 256,
         dithering_level: 1.0,
         shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
     };
 
     let gif_opts = GifOpts {
@@ -42,6 +52,8 @@ fn test_basic_processing() {
         loop_count: 0,
         optimize: true,
         include_tensor: false,
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
     };
 
     let result = process_all_frames(frames, 256, 256, 32, quantize_opts, gif_opts);
@@ -53,6 +65,92 @@ fn test_basic_processing() {
     assert!(output.palette_size_used <= 256);
 }
 
+#[test]
+fn test_oklab_palette() {
+    let frames = create_test_frames(8, 64, 64);
+
+    let quantize_opts = QuantizeOpts {
+        quality_min: 70,
+        quality_max: 100,
+        speed: 5,
+        palette_size: 64,
+        dithering_level: 1.0,
+        shared_palette: true,
+        oklab_palette: true,
+        blue_noise_dither: false,
+    };
+
+    let gif_opts = GifOpts {
+        width: 64,
+        height: 64,
+        frame_count: 8,
+        fps: 30,
+        loop_count: 0,
+        optimize: false,
+        include_tensor: false,
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
+    };
+
+    let output = process_all_frames(frames, 64, 64, 8, quantize_opts, gif_opts).unwrap();
+    assert_eq!(&output.gif_data[..6], b"GIF89a");
+    assert_eq!(output.actual_frame_count, 8);
+    assert!(output.palette_size_used > 1 && output.palette_size_used <= 64);
+}
+
+#[test]
+fn test_oklab_blue_noise_dither() {
+    // A static gradient, so any change between frames comes from the dither pattern
+    let frame = create_test_frames(1, 128, 128);
+    let frames = frame.repeat(4);
+
+    let encode = |blue_noise_dither: bool| {
+        let quantize_opts = QuantizeOpts {
+            quality_min: 70,
+            quality_max: 100,
+            speed: 5,
+            palette_size: 16,
+            dithering_level: 1.0,
+            shared_palette: true,
+            oklab_palette: true,
+            blue_noise_dither,
+        };
+        let gif_opts = GifOpts {
+            width: 128,
+            height: 128,
+            frame_count: 4,
+            fps: 30,
+            loop_count: 0,
+            optimize: false,
+            include_tensor: true,
+            indexed_tensor: true,
+            tensor_layout: TensorLayout::FrameMajor,
+        };
+        process_all_frames(frames.clone(), 128, 128, 4, quantize_opts, gif_opts).unwrap()
+    };
+
+    let sierra = encode(false);
+    let output = encode(true);
+    assert_eq!(&output.gif_data[..6], b"GIF89a");
+    // The palette is built before the remap, so only the indices change
+    assert_eq!(output.tensor_palette, sierra.tensor_palette);
+    let indices = output.tensor_indices.unwrap();
+    assert_ne!(indices, sierra.tensor_indices.unwrap());
+
+    // The pattern rotates per frame
+    let plane = 128 * 128;
+    assert_ne!(indices[..plane], indices[plane..2 * plane]);
+
+    // Dithering keeps the frame's mean color
+    let palette = output.tensor_palette.unwrap();
+    for c in 0..3 {
+        let source: u64 = frame.chunks_exact(4).map(|px| px[c] as u64).sum();
+        let dithered: u64 = indices[..plane].iter().map(|&i| palette[i as usize * 4 + c] as u64).sum();
+        let (source, dithered) = (source / plane as u64, dithered / plane as u64);
+        assert!(source.abs_diff(dithered) <= 4, "channel {}: {} vs {}", c, source, dithered);
+    }
+}
+
 #[test]
 fn test_different_sizes() {
     let test_cases = vec![
@@ -71,6 +169,8 @@ fn test_different_sizes() {
             palette_size: 256,
             dithering_level: 0.5,
             shared_palette: true,
+            oklab_palette: false,
+            blue_noise_dither: false,
         };
 
         let gif_opts = GifOpts {
@@ -81,6 +181,8 @@ fn test_different_sizes() {
             loop_count: 0,
             optimize: false,
             include_tensor: false,
+            indexed_tensor: false,
+            tensor_layout: TensorLayout::FrameMajor,
         };
 
         let result = process_all_frames(
@@ -108,6 +210,8 @@ fn test_performance_256_frames() {
         palette_size: 256,
         dithering_level: 0.5,
         shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
     };
 
     let gif_opts = GifOpts {
@@ -118,6 +222,8 @@ fn test_performance_256_frames() {
         loop_count: 0,
         optimize: false, // Skip optimization for speed
         include_tensor: false,
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
     };
 
     let start = Instant::now();
@@ -156,6 +262,8 @@ fn test_error_handling() {
         palette_size: 256,
         dithering_level: 1.0,
         shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
     };
 
     let gif_opts = GifOpts {
@@ -166,8 +274,542 @@ fn test_error_handling() {
         loop_count: 0,
         optimize: true,
         include_tensor: false,
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
     };
 
     let result = process_all_frames(frames, 256, 256, 0, quantize_opts, gif_opts);
     assert!(result.is_err(), "Should fail with empty input");
-}
\ No newline at end of file
+}
+
+#[test]
+fn test_indexed_tensor() {
+    let frames = create_test_frames(16, 128, 128);
+
+    let quantize_opts = QuantizeOpts {
+        quality_min: 70,
+        quality_max: 100,
+        speed: 8,
+        palette_size: 256,
+        dithering_level: 0.0,
+        shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
+    };
+
+    let gif_opts = GifOpts {
+        width: 128,
+        height: 128,
+        frame_count: 16,
+        fps: 30,
+        loop_count: 0,
+        optimize: false,
+        include_tensor: true,
+        indexed_tensor: true,
+        tensor_layout: TensorLayout::FrameMajor,
+    };
+
+    let output = process_all_frames(frames, 128, 128, 16, quantize_opts, gif_opts).unwrap();
+    assert!(output.tensor_data.is_none(), "Indexed mode should not build the RGBA tensor");
+
+    // One byte per voxel, every index inside the returned palette
+    let indices = output.tensor_indices.expect("indexed tensor");
+    let palette = output.tensor_palette.expect("tensor palette");
+    assert_eq!(indices.len(), 128 * 128 * 16);
+    assert_eq!(palette.len(), output.palette_size_used as usize * 4);
+    assert!(indices.iter().all(|&i| (i as usize) < output.palette_size_used as usize));
+}
+
+#[test]
+fn test_tensor_layouts() {
+    use rgb2gif_processor::tensor::{convert_index_layout, convert_layout, TensorShape};
+
+    // 10 frames of 96×96: resampled to 128², and not a whole number of bricks deep
+    let frames = create_test_frames(10, 96, 96);
+    let shape = TensorShape::new(128, 128, 10);
+    let encode = |indexed_tensor: bool, tensor_layout: TensorLayout| {
+        let quantize_opts = QuantizeOpts {
+            quality_min: 70,
+            quality_max: 100,
+            speed: 8,
+            palette_size: 256,
+            dithering_level: 0.0,
+            shared_palette: true,
+            oklab_palette: false,
+            blue_noise_dither: false,
+        };
+        let gif_opts = GifOpts {
+            width: 96,
+            height: 96,
+            frame_count: 10,
+            fps: 30,
+            loop_count: 0,
+            optimize: false,
+            include_tensor: true,
+            indexed_tensor,
+            tensor_layout,
+        };
+        process_all_frames(frames.clone(), 96, 96, 10, quantize_opts, gif_opts).unwrap()
+    };
+
+    let rgba = encode(false, TensorLayout::FrameMajor).tensor_data.unwrap();
+    let indices = encode(true, TensorLayout::FrameMajor).tensor_indices.unwrap();
+    for layout in [TensorLayout::Bricked, TensorLayout::Morton] {
+        let tiled = encode(false, layout).tensor_data.unwrap();
+        assert_eq!(tiled.len(), shape.with_layout(layout).storage_elements() * 4);
+        assert_eq!(tiled, convert_layout(&rgba, shape, layout).unwrap(), "{:?} RGBA tensor", layout);
+
+        let tiled = encode(true, layout).tensor_indices.unwrap();
+        assert_eq!(tiled, convert_index_layout(&indices, shape, layout).unwrap(), "{:?} indexed tensor", layout);
+    }
+}
+
+#[test]
+fn test_bricked_result_feeds_texture_and_convolution() {
+    use rgb2gif_processor::tensor::{convert_layout, TensorShape};
+    use rgb2gif_processor::{convolve_tensor, tensor_texture};
+
+    // 10 frames pad to 16 in the Bricked layout
+    let frames = create_test_frames(10, 128, 128);
+    let encode = |indexed_tensor: bool, tensor_layout: TensorLayout| {
+        let quantize_opts = QuantizeOpts {
+            quality_min: 70,
+            quality_max: 100,
+            speed: 8,
+            palette_size: 256,
+            dithering_level: 0.0,
+            shared_palette: true,
+            oklab_palette: false,
+            blue_noise_dither: false,
+        };
+        let gif_opts = GifOpts {
+            width: 128,
+            height: 128,
+            frame_count: 10,
+            fps: 30,
+            loop_count: 0,
+            optimize: false,
+            include_tensor: true,
+            indexed_tensor,
+            tensor_layout,
+        };
+        process_all_frames(frames.clone(), 128, 128, 10, quantize_opts, gif_opts).unwrap()
+    };
+
+    let flat = encode(false, TensorLayout::FrameMajor);
+    let bricked = encode(false, TensorLayout::Bricked);
+    let depth = bricked.actual_frame_count as u32;
+    let (flat_rgba, bricked_rgba) = (flat.tensor_data.unwrap(), bricked.tensor_data.unwrap());
+    assert!(bricked_rgba.len() > flat_rgba.len());
+
+    let expected = tensor_texture(flat_rgba.clone(), None, TensorLayout::FrameMajor, depth, 2, 256).unwrap();
+    let texture = tensor_texture(bricked_rgba.clone(), None, TensorLayout::Bricked, depth, 2, 256).unwrap();
+    assert_eq!(texture.data, expected.data);
+    assert_eq!(texture.levels[0].depth, depth);
+
+    let flat = encode(true, TensorLayout::FrameMajor);
+    let bricked = encode(true, TensorLayout::Bricked);
+    let expected = tensor_texture(flat.tensor_indices.unwrap(), flat.tensor_palette, TensorLayout::FrameMajor, depth, 1, 1).unwrap();
+    let indices = bricked.tensor_indices.unwrap();
+    let texture = tensor_texture(indices.clone(), bricked.tensor_palette.clone(), TensorLayout::Bricked, depth, 1, 1).unwrap();
+    assert_eq!(texture.data, expected.data);
+    assert_eq!(texture.palette_texture, expected.palette_texture);
+
+    // Filtering keeps the caller's layout
+    let kernel = vec![1.0 / 27.0; 27];
+    let smoothed = convolve_tensor(flat_rgba, TensorLayout::FrameMajor, depth, kernel.clone(), 3).unwrap();
+    let bricked_smoothed = convolve_tensor(bricked_rgba.clone(), TensorLayout::Bricked, depth, kernel.clone(), 3).unwrap();
+    let shape = TensorShape::new(128, 128, depth);
+    assert_eq!(bricked_smoothed, convert_layout(&smoothed, shape, TensorLayout::Bricked).unwrap());
+
+    // Tiled bytes labelled frame-major are rejected instead of read scrambled
+    assert_eq!(
+        tensor_texture(bricked_rgba.clone(), None, TensorLayout::FrameMajor, depth, 1, 1).err(),
+        Some(ProcessorError::InvalidInput)
+    );
+    assert_eq!(
+        tensor_texture(indices, bricked.tensor_palette, TensorLayout::FrameMajor, depth, 1, 1).err(),
+        Some(ProcessorError::InvalidInput)
+    );
+    assert_eq!(
+        convolve_tensor(bricked_rgba, TensorLayout::FrameMajor, depth, kernel, 3).err(),
+        Some(ProcessorError::InvalidInput)
+    );
+}
+
+fn pipeline_opts(source_width: u32, source_height: u32) -> PipelineOpts {
+    PipelineOpts {
+        source_width,
+        source_height,
+        queue_depth: 2,
+        resize_workers: 3,
+        encode_workers: 3,
+    }
+}
+
+#[test]
+fn test_pipeline_matches_batch() {
+    let frames = create_test_frames(24, 128, 128);
+
+    let quantize_opts = QuantizeOpts {
+        quality_min: 70,
+        quality_max: 100,
+        speed: 8,
+        palette_size: 256,
+        dithering_level: 0.5,
+        shared_palette: false, // The pipeline's palette comes from the first frame
+        oklab_palette: false,
+        blue_noise_dither: false,
+    };
+
+    let gif_opts = GifOpts {
+        width: 128,
+        height: 128,
+        frame_count: 24,
+        fps: 30,
+        loop_count: 0,
+        optimize: false,
+        include_tensor: true,
+        indexed_tensor: true,
+        tensor_layout: TensorLayout::FrameMajor,
+    };
+
+    let pipeline = FramePipeline::new(pipeline_opts(128, 128), quantize_opts.clone(), gif_opts.clone()).unwrap();
+    for frame in frames.chunks_exact(128 * 128 * 4) {
+        pipeline.submit_frame(frame.to_vec()).unwrap();
+    }
+    assert_eq!(pipeline.frames_submitted(), 24);
+    let streamed = pipeline.finish().unwrap();
+
+    // Same quantizer fed the same frames in the same order: identical output
+    let batch = process_all_frames(frames, 128, 128, 24, quantize_opts, gif_opts).unwrap();
+    assert_eq!(streamed.gif_data, batch.gif_data);
+    assert_eq!(streamed.tensor_indices, batch.tensor_indices);
+    assert_eq!(streamed.actual_frame_count, 24);
+
+    // Finished pipelines reject further use
+    assert!(pipeline.submit_frame(vec![0; 128 * 128 * 4]).is_err());
+    assert!(pipeline.finish().is_err());
+}
+
+#[test]
+fn test_pipeline_downsamples_and_optimizes() {
+    let frames = create_test_frames(8, 256, 256);
+
+    let quantize_opts = QuantizeOpts {
+        quality_min: 50,
+        quality_max: 90,
+        speed: 8,
+        palette_size: 256,
+        dithering_level: 0.0,
+        shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
+    };
+
+    let gif_opts = GifOpts {
+        width: 128,
+        height: 128,
+        frame_count: 8,
+        fps: 24,
+        loop_count: 0,
+        optimize: true,
+        include_tensor: true,
+        indexed_tensor: true,
+        tensor_layout: TensorLayout::FrameMajor,
+    };
+
+    let pipeline = FramePipeline::new(pipeline_opts(256, 256), quantize_opts, gif_opts).unwrap();
+    assert!(pipeline.submit_frame(vec![0; 128 * 128 * 4]).is_err(), "Frames must be at the source size");
+    for frame in frames.chunks_exact(256 * 256 * 4) {
+        pipeline.submit_frame(frame.to_vec()).unwrap();
+    }
+    let output = pipeline.finish().unwrap();
+
+    assert_eq!(output.actual_frame_count, 8);
+    // Index 255 stays free for transparency
+    assert!(output.palette_size_used <= 255);
+    let indices = output.tensor_indices.expect("indexed tensor");
+    assert_eq!(indices.len(), 128 * 128 * 8);
+    assert!(indices.iter().all(|&i| i != 255));
+}
+
+#[test]
+fn test_pipeline_rejects_bad_options() {
+    let quantize_opts = QuantizeOpts {
+        quality_min: 70,
+        quality_max: 100,
+        speed: 5,
+        palette_size: 256,
+        dithering_level: 1.0,
+        shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
+    };
+
+    let gif_opts = GifOpts {
+        width: 256,
+        height: 256,
+        frame_count: 0,
+        fps: 30,
+        loop_count: 0,
+        optimize: true,
+        include_tensor: false,
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
+    };
+
+    // Upscaling is not supported
+    assert!(FramePipeline::new(pipeline_opts(128, 128), quantize_opts.clone(), gif_opts.clone()).is_err());
+
+    // No frames submitted
+    let pipeline = FramePipeline::new(pipeline_opts(256, 256), quantize_opts, gif_opts).unwrap();
+    assert!(pipeline.finish().is_err());
+}
+
+/// Wakes a parked test thread
+struct ThreadWaker(std::thread::Thread);
+
+impl Wake for ThreadWaker {
+    fn wake(self: Arc<Self>) {
+        self.0.unpark();
+    }
+}
+
+/// Minimal executor: park the test thread until the future wakes it
+fn block_on<F: Future>(future: F) -> F::Output {
+    let waker = Waker::from(Arc::new(ThreadWaker(std::thread::current())));
+    let mut cx = Context::from_waker(&waker);
+    let mut future = std::pin::pin!(future);
+    loop {
+        match future.as_mut().poll(&mut cx) {
+            Poll::Ready(output) => return output,
+            Poll::Pending => std::thread::park(),
+        }
+    }
+}
+
+fn async_opts(frame_count: u16) -> (QuantizeOpts, GifOpts) {
+    let quantize_opts = QuantizeOpts {
+        quality_min: 70,
+        quality_max: 100,
+        speed: 8,
+        palette_size: 256,
+        dithering_level: 0.5,
+        shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
+    };
+    let gif_opts = GifOpts {
+        width: 128,
+        height: 128,
+        frame_count,
+        fps: 30,
+        loop_count: 0,
+        optimize: true,
+        include_tensor: false,
+        indexed_tensor: false,
+        tensor_layout: TensorLayout::FrameMajor,
+    };
+    (quantize_opts, gif_opts)
+}
+
+#[test]
+fn test_async_matches_blocking_and_reports_progress() {
+    struct Counter(Arc<AtomicU32>);
+    impl ProgressListener for Counter {
+        fn on_progress(&self, frames_done: u32, frame_count: u32) {
+            assert_eq!(frame_count, 12);
+            self.0.fetch_max(frames_done, Ordering::Relaxed);
+        }
+    }
+
+    let frames = create_test_frames(12, 128, 128);
+    let (quantize_opts, gif_opts) = async_opts(12);
+
+    let progress = Arc::new(AtomicU32::new(0));
+    let task = Arc::new(EncodeTask::new());
+    task.set_listener(Box::new(Counter(progress.clone())));
+
+    let future = process_all_frames_async(frames.clone(), 128, 128, 12, quantize_opts.clone(), gif_opts.clone(), task.clone());
+    let streamed = block_on(future).unwrap();
+    let blocking = process_all_frames(frames, 128, 128, 12, quantize_opts, gif_opts).unwrap();
+
+    assert_eq!(streamed.gif_data, blocking.gif_data);
+    assert_eq!(progress.load(Ordering::Relaxed), 12);
+    assert_eq!(task.frames_done(), 12);
+    assert!(!task.is_cancelled());
+}
+
+#[test]
+fn test_async_cancellation() {
+    let frames = create_test_frames(12, 128, 128);
+    let (quantize_opts, gif_opts) = async_opts(12);
+
+    // Cancelled before it starts: no frame is remapped
+    let task = Arc::new(EncodeTask::new());
+    task.cancel();
+    let future = process_all_frames_async(frames.clone(), 128, 128, 12, quantize_opts.clone(), gif_opts.clone(), task.clone());
+    assert_eq!(block_on(future).unwrap_err(), ProcessorError::Cancelled);
+    assert_eq!(task.frames_done(), 0);
+
+    // Dropping the future abandons the encode
+    let task = Arc::new(EncodeTask::new());
+    let mut future = Box::pin(process_all_frames_async(frames, 128, 128, 12, quantize_opts, gif_opts, task.clone()));
+    let waker = Waker::from(Arc::new(ThreadWaker(std::thread::current())));
+    let _ = future.as_mut().poll(&mut Context::from_waker(&waker));
+    drop(future);
+    assert!(task.is_cancelled());
+}
+
+#[test]
+fn test_sampled_shared_palette_covers_scene_change() {
+    // Red first half, blue second half: a first-frame palette has no blues
+    let (side, count) = (64u32, 16usize);
+    let mut frames = Vec::new();
+    for i in 0..count {
+        for y in 0..side {
+            for x in 0..side {
+                let v = ((x + y) * 2) as u8;
+                let pixel = if i < count / 2 { [200, v / 2, 0, 255] } else { [0, v / 2, 200, 255] };
+                frames.extend_from_slice(&pixel);
+            }
+        }
+    }
+
+    let last_frame_error = |shared_palette: bool| -> u64 {
+        let quantize_opts = QuantizeOpts {
+            quality_min: 0,
+            quality_max: 100,
+            speed: 8,
+            palette_size: 256,
+            dithering_level: 0.0,
+            shared_palette,
+            oklab_palette: false,
+            blue_noise_dither: false,
+        };
+        let gif_opts = GifOpts {
+            width: side as u16,
+            height: side as u16,
+            frame_count: count as u16,
+            fps: 30,
+            loop_count: 0,
+            optimize: false,
+            include_tensor: true,
+            indexed_tensor: true,
+            tensor_layout: TensorLayout::FrameMajor,
+        };
+        let output = process_all_frames(frames.clone(), side, side, count as u32, quantize_opts, gif_opts).unwrap();
+
+        // The tensor is resampled to 128², so compare through the same nearest mapping
+        let indices = output.tensor_indices.unwrap();
+        let palette = output.tensor_palette.unwrap();
+        let last = &frames[(count - 1) * (side * side * 4) as usize..];
+        let mut error = 0u64;
+        for y in 0..128usize {
+            for x in 0..128usize {
+                let src = ((y * side as usize / 128) * side as usize + x * side as usize / 128) * 4;
+                let idx = indices[(count - 1) * 128 * 128 + y * 128 + x] as usize * 4;
+                for c in 0..3 {
+                    error += (last[src + c] as i64 - palette[idx + c] as i64).unsigned_abs();
+                }
+            }
+        }
+        error
+    };
+
+    assert!(last_frame_error(true) < last_frame_error(false) / 4);
+}
+
+#[test]
+fn test_stats_cover_every_stage() {
+    let frames = create_test_frames(8, 64, 64);
+
+    let quantize_opts = QuantizeOpts {
+        quality_min: 70,
+        quality_max: 100,
+        speed: 8,
+        palette_size: 256,
+        dithering_level: 0.5,
+        shared_palette: true,
+        oklab_palette: false,
+        blue_noise_dither: false,
+    };
+    let gif_opts = GifOpts {
+        width: 64,
+        height: 64,
+        frame_count: 8,
+        fps: 30,
+        loop_count: 0,
+        optimize: false,
+        include_tensor: true,
+        indexed_tensor: true,
+        tensor_layout: TensorLayout::FrameMajor,
+    };
+
+    // The switch is process-wide; other tests only ever see extra stats
+    set_stats_enabled(true);
+    let output = process_all_frames(frames, 64, 64, 8, quantize_opts, gif_opts).unwrap();
+    set_stats_enabled(false);
+
+    let stats = output.stats.expect("stats were enabled");
+    assert!(stats.palette_ns > 0 && stats.remap_ns > 0 && stats.lzw_ns > 0 && stats.tensor_ns > 0);
+    assert_eq!(stats.resize_ns, 0, "the batch path doesn't resize");
+    assert_eq!(stats.frame_remap_us.iter().sum::<u32>(), 8);
+    assert_eq!(stats.frame_lzw_bytes.iter().sum::<u32>(), 8);
+    assert!(stats.bytes_allocated >= (64 * 64 * 8 + output.gif_data.len()) as u64);
+}
+
+#[test]
+fn test_batch_shares_pool_palettes_and_buffers() {
+    let side = 64u32;
+    let (mut quantize_opts, mut gif_opts) = async_opts(0);
+    quantize_opts.shared_palette = false;
+    gif_opts.include_tensor = true;
+    gif_opts.indexed_tensor = true;
+
+    // Loaders record whether they were handed a recycled buffer
+    let recycled = Arc::new(AtomicU32::new(0));
+    let job = |name: &str, count: usize, shift: u8, palette_key: Option<&str>| {
+        let recycled = recycled.clone();
+        ClipJob {
+            name: name.to_string(),
+            load: Box::new(move |mut buffer: Vec<u8>| {
+                if buffer.capacity() > 0 {
+                    recycled.fetch_add(1, Ordering::Relaxed);
+                }
+                buffer.extend(create_test_frames(count, side, side).iter().map(|v| v.wrapping_add(shift)));
+                Ok(Clip { rgba: buffer, width: side, height: side, frame_count: count as u32, source_bytes: 1000 })
+            }),
+            quantize_opts: quantize_opts.clone(),
+            gif_opts: gif_opts.clone(),
+            palette_key: palette_key.map(str::to_string),
+        }
+    };
+
+    let mut jobs = vec![
+        job("a", 6, 0, Some("session")),
+        job("b", 4, 40, None),
+        job("c", 5, 90, Some("session")),
+    ];
+    jobs.push(ClipJob { name: "broken".to_string(), load: Box::new(|_| Err(ProcessorError::InvalidInput)), ..job("x", 1, 0, None) });
+
+    let mut outcomes = Vec::new();
+    let opts = BatchOpts { workers: 2, clips_in_flight: 1 };
+    let report = transcode_batch(jobs, &opts, |outcome| outcomes.push(outcome)).unwrap();
+
+    assert_eq!((report.clips, report.failed, report.frames), (4, 1, 15));
+    assert_eq!(report.source_bytes, 3000);
+    assert!(report.output_bytes > 0 && report.clips_per_sec() > 0.0);
+    assert!(recycled.load(Ordering::Relaxed) >= 2, "Later clips should reuse finished clips' buffers");
+
+    outcomes.sort_by_key(|outcome| outcome.index);
+    assert_eq!(outcomes[3].result.as_ref().err(), Some(&ProcessorError::InvalidInput));
+    let palette = |i: usize| outcomes[i].result.as_ref().unwrap().tensor_palette.clone().unwrap();
+    assert_eq!(palette(0), palette(2), "Clips sharing a key should share the palette");
+    assert_ne!(palette(0), palette(1));
+    for outcome in &outcomes[..3] {
+        let gif = &outcome.result.as_ref().unwrap().gif_data;
+        assert_eq!(&gif[..6], b"GIF89a", "{} should be a GIF", outcome.name);
+    }
+}
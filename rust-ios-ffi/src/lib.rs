@@ -6,15 +6,48 @@ use std::ptr;
 use std::slice;
 use std::sync::Mutex;
 use color_quant::NeuQuant;
-use image::{ImageBuffer, Rgba, DynamicImage};
+use image::{ImageBuffer, Rgba};
 use gif::{Encoder, Frame, Repeat};
 use std::io::Write;
 
-// Processor state for accumulating frames
+// Area-average downsampler shared with rust-core (std only, no crate dependency)
+#[path = "../../rust-core/src/downsample.rs"]
+#[allow(dead_code)]
+mod downsample;
+use downsample::{downsample_area_with, AreaScratch, ResizeFilter};
+
+// Processor state reused across frames
 pub struct YinGifProcessor {
-    frames: Vec<Vec<u8>>,  // Accumulated frames
     target_size: usize,     // Target dimension (e.g., 132)
     palette_size: usize,    // Palette size (e.g., 256)
+    scratch: ScratchPool,   // Frame-sized buffers reused across calls
+}
+
+/// Frame-sized scratch buffers owned by a processor handle
+/// Sized on first use and only grown when a larger frame arrives, so the
+/// area downsample of a steady-state capture loop does no heap allocation.
+/// The NeuQuant network is not pooled: color_quant can't retrain one in place,
+/// so quantize_neuquant_into still builds one per frame.
+#[derive(Default)]
+struct ScratchPool {
+    resized: Vec<u8>,   // Downsampled frame (target² × 4)
+    area: AreaScratch,  // Box edges and row accumulators for the area filter
+}
+
+impl ScratchPool {
+    /// Borrow the resize target for `len` bytes, with the area filter's working buffers
+    fn resized(&mut self, len: usize) -> (&mut [u8], &mut AreaScratch) {
+        if self.resized.len() < len {
+            self.resized.resize(len, 0);
+        }
+        (&mut self.resized[..len], &mut self.area)
+    }
+
+    /// Peak bytes reserved by the pool; buffers are never shrunk, so this is
+    /// just what they hold now
+    fn high_water(&self) -> usize {
+        self.resized.capacity() + self.area.reserved_bytes()
+    }
 }
 
 // Global processor storage (for simplicity)
@@ -36,9 +69,9 @@ pub extern "C" fn yingif_processor_new() -> *mut libc::c_void {
     ensure_initialized();
     
     let processor = YinGifProcessor {
-        frames: Vec::new(),
         target_size: 132,  // Default
         palette_size: 256, // Default
+        scratch: ScratchPool::default(),
     };
     
     unsafe {
@@ -80,10 +113,48 @@ pub extern "C" fn yingif_process_frame(
     palette_size: i32,
     out_indices: *mut u8,
     out_palette: *mut u32,
+) -> i32 {
+    yingif_process_frame_ex(
+        processor,
+        bgra_data,
+        width,
+        height,
+        target_size,
+        palette_size,
+        out_indices,
+        out_palette,
+        YX_RESIZE_LANCZOS3,
+    )
+}
+
+/// Resize filter: Lanczos3 (default, highest quality)
+pub const YX_RESIZE_LANCZOS3: i32 = 0;
+/// Resize filter: area average, SIMD box filter for large reduction ratios
+pub const YX_RESIZE_AREA: i32 = 1;
+
+/// Process a single BGRA frame with a per-call resize filter (YX_RESIZE_*)
+#[no_mangle]
+pub extern "C" fn yingif_process_frame_ex(
+    processor: *mut libc::c_void,
+    bgra_data: *const u8,
+    width: i32,
+    height: i32,
+    target_size: i32,
+    palette_size: i32,
+    out_indices: *mut u8,
+    out_palette: *mut u32,
+    filter: i32,
 ) -> i32 {
     if processor.is_null() || bgra_data.is_null() || out_indices.is_null() || out_palette.is_null() {
         return -1;
     }
+    if width <= 0 || height <= 0 || target_size <= 0 || palette_size <= 0 || palette_size > 256 {
+        return -2;
+    }
+    let filter = match ResizeFilter::from_raw(filter) {
+        Some(filter) => filter,
+        None => return -2,
+    };
     
     unsafe {
         let id = processor as usize;
@@ -93,39 +164,47 @@ pub extern "C" fn yingif_process_frame(
                 proc.target_size = target_size as usize;
                 proc.palette_size = palette_size as usize;
                 
-                // Convert BGRA to RGBA
+                // Borrow the camera's BGRA buffer in place; no full-resolution swizzle copy
                 let pixel_count = (width * height) as usize;
                 let bgra_slice = slice::from_raw_parts(bgra_data, pixel_count * 4);
-                let mut rgba_data = vec![0u8; pixel_count * 4];
-                
-                for i in 0..pixel_count {
-                    rgba_data[i * 4] = bgra_slice[i * 4 + 2];     // R
-                    rgba_data[i * 4 + 1] = bgra_slice[i * 4 + 1]; // G
-                    rgba_data[i * 4 + 2] = bgra_slice[i * 4];     // B
-                    rgba_data[i * 4 + 3] = bgra_slice[i * 4 + 3]; // A
-                }
                 
-                // Resize if needed
-                let resized = if width != target_size || height != target_size {
-                    resize_lanczos3(&rgba_data, width as u32, height as u32, target_size as u32)
+                // Resize if needed. Both filters work per channel, so the
+                // BGRA bytes can be resized as-is and stay in BGRA order.
+                // The area filter writes into the processor's pooled buffer.
+                let plane_size = (target_size * target_size) as usize;
+                let lanczos;
+                let pixels: &[u8] = if width != target_size || height != target_size {
+                    let area = if filter == ResizeFilter::Area {
+                        let (dst, working) = proc.scratch.resized(plane_size * 4);
+                        let ok = downsample_area_with(
+                            bgra_slice,
+                            width as usize,
+                            height as usize,
+                            width as usize * 4,
+                            dst,
+                            target_size as usize,
+                            target_size as usize,
+                            working,
+                        );
+                        if ok { Some(&*dst) } else { None }
+                    } else {
+                        None
+                    };
+                    match area {
+                        Some(pixels) => pixels,
+                        None => {
+                            lanczos = resize_lanczos3(bgra_slice, width as u32, height as u32, target_size as u32);
+                            &lanczos
+                        }
+                    }
                 } else {
-                    rgba_data
+                    bgra_slice
                 };
                 
-                // Quantize
-                let (palette, indices) = quantize_neuquant(&resized, target_size as u32, palette_size as usize);
-                
-                // Copy outputs
-                let out_indices_slice = slice::from_raw_parts_mut(out_indices, (target_size * target_size) as usize);
-                out_indices_slice.copy_from_slice(&indices);
-                
+                // Quantize straight into the caller's buffers, reading channels in BGRA order
+                let out_indices_slice = slice::from_raw_parts_mut(out_indices, plane_size);
                 let out_palette_slice = slice::from_raw_parts_mut(out_palette, palette_size as usize);
-                for (i, &color) in palette.iter().enumerate() {
-                    out_palette_slice[i] = color;
-                }
-                
-                // Store processed frame for later GIF creation
-                proc.frames.push(indices);
+                quantize_neuquant_into(pixels, PixelOrder::Bgra, out_indices_slice, out_palette_slice);
                 
                 return 0;
             }
@@ -135,6 +214,26 @@ pub extern "C" fn yingif_process_frame(
     -1
 }
 
+/// Peak bytes reserved by a processor's scratch pool (0 for unknown handles)
+/// Stays flat once the pool has been sized by the first frame
+#[no_mangle]
+pub extern "C" fn yingif_processor_scratch_high_water(processor: *mut libc::c_void) -> u64 {
+    if processor.is_null() {
+        return 0;
+    }
+    
+    unsafe {
+        let id = processor as usize;
+        if let Some(ref processors) = PROCESSORS {
+            if let Some(proc) = processors.lock().unwrap().get(&id) {
+                return proc.scratch.high_water() as u64;
+            }
+        }
+    }
+    
+    0
+}
+
 /// Create GIF from accumulated frames
 #[no_mangle]
 pub extern "C" fn yingif_create_gif89a(
@@ -219,48 +318,312 @@ pub extern "C" fn yingif_estimate_gif_size(cube_size: i32, palette_size: i32) ->
 
 // Helper functions
 
-fn resize_lanczos3(rgba: &[u8], width: u32, height: u32, target_size: u32) -> Vec<u8> {
-    let img = ImageBuffer::<Rgba<u8>, _>::from_raw(width, height, rgba.to_vec()).unwrap();
-    let resized = DynamicImage::ImageRgba8(img).resize_exact(
+/// Channel order of 4-byte input pixels
+#[derive(Clone, Copy, PartialEq)]
+enum PixelOrder {
+    Rgba,
+    Bgra,
+}
+
+impl PixelOrder {
+    /// Byte offsets of R, G, B within a pixel
+    fn rgb_offsets(self) -> (usize, usize, usize) {
+        match self {
+            PixelOrder::Rgba => (0, 1, 2),
+            PixelOrder::Bgra => (2, 1, 0),
+        }
+    }
+}
+
+/// Resize 4-channel pixels read in place from a borrowed buffer
+/// Channel order is preserved, so this works for both RGBA and BGRA input
+fn resize_lanczos3(pixels: &[u8], width: u32, height: u32, target_size: u32) -> Vec<u8> {
+    let view = ImageBuffer::<Rgba<u8>, &[u8]>::from_raw(width, height, pixels).unwrap();
+    image::imageops::resize(
+        &view,
         target_size,
         target_size,
         image::imageops::FilterType::Lanczos3,
-    );
-    resized.to_rgba8().into_raw()
+    )
+    .into_raw()
 }
 
-fn quantize_neuquant(rgba: &[u8], size: u32, colors: usize) -> (Vec<u32>, Vec<u8>) {
-    let pixel_count = (size * size) as usize;
-    
-    // Extract RGB data (skip alpha)
-    let mut rgb = vec![0u8; pixel_count * 3];
-    for i in 0..pixel_count {
-        rgb[i * 3] = rgba[i * 4];
-        rgb[i * 3 + 1] = rgba[i * 4 + 1];
-        rgb[i * 3 + 2] = rgba[i * 4 + 2];
-    }
+/// Quantize 4-channel pixels straight into the caller's index plane and palette
+/// NeuQuant treats the four bytes as an opaque vector, so BGRA input is learned
+/// as-is and only the palette is swizzled to 0x00RRGGBB on output
+fn quantize_neuquant_into(pixels: &[u8], order: PixelOrder, out_indices: &mut [u8], out_palette: &mut [u32]) {
+    let (r_off, g_off, b_off) = order.rgb_offsets();
     
     // Quantize
-    let mut quantizer = NeuQuant::new(10, colors, &rgb);
+    let quantizer = NeuQuant::new(10, out_palette.len(), pixels);
     
     // Build palette
-    let mut palette = vec![0u32; colors];
-    for i in 0..colors {
-        let [r, g, b, _] = quantizer.color(i);
-        palette[i] = ((r as u32) << 16) | ((g as u32) << 8) | (b as u32);
+    for (i, slot) in out_palette.iter_mut().enumerate() {
+        let color = quantizer.lookup(i).unwrap_or([0; 4]);
+        *slot = ((color[r_off] as u32) << 16) | ((color[g_off] as u32) << 8) | (color[b_off] as u32);
     }
     
     // Map pixels to indices
-    let mut indices = vec![0u8; pixel_count];
-    for i in 0..pixel_count {
-        let r = rgb[i * 3];
-        let g = rgb[i * 3 + 1];
-        let b = rgb[i * 3 + 2];
-        indices[i] = quantizer.index_of(&[r, g, b, 255]) as u8;
+    for (slot, pixel) in out_indices.iter_mut().zip(pixels.chunks_exact(4)) {
+        *slot = quantizer.index_of(pixel) as u8;
     }
-    
-    (palette, indices)
 }
 
 // Add libc for C types
-extern crate libc;
\ No newline at end of file
+extern crate libc;
+#[cfg(test)]
+#[allow(unused_unsafe)] // Calls are written as a C caller would make them
+mod tests {
+    use super::*;
+
+    // Test data generator - creates synthetic RGBA frames
+    fn generate_test_frame(width: u32, height: u32, seed: u8) -> Vec<u8> {
+        let mut frame = Vec::with_capacity((width * height * 4) as usize);
+        for y in 0..height {
+            for x in 0..width {
+                // Create a gradient pattern with the seed
+                let r = ((x * 255 / width) as u8).wrapping_add(seed);
+                let g = ((y * 255 / height) as u8).wrapping_add(seed);
+                let b = (((x + y) * 255 / (width + height)) as u8).wrapping_add(seed);
+                let a = 255;
+                frame.extend_from_slice(&[r, g, b, a]);
+            }
+        }
+        frame
+    }
+
+    // Test processor lifecycle
+    #[test]
+    fn test_processor_lifecycle() {
+        println!("Testing processor lifecycle...");
+
+        let processor = yingif_processor_new();
+        assert!(!processor.is_null(), "Processor creation failed");
+
+        yingif_processor_free(processor);
+        println!("✅ Processor lifecycle test passed");
+    }
+
+    // Test single frame processing
+    #[test]
+    fn test_single_frame_processing() {
+        println!("Testing single frame processing...");
+
+        let processor = unsafe { yingif_processor_new() };
+        assert!(!processor.is_null());
+
+        // Generate test frame (1080x1080 BGRA)
+        let width = 1080;
+        let height = 1080;
+        let target_size = 256;
+        let palette_size = 256;
+
+        let rgba_frame = generate_test_frame(width, height, 42);
+        // Convert RGBA to BGRA
+        let mut bgra_frame = Vec::with_capacity(rgba_frame.len());
+        for chunk in rgba_frame.chunks_exact(4) {
+            bgra_frame.push(chunk[2]); // B
+            bgra_frame.push(chunk[1]); // G
+            bgra_frame.push(chunk[0]); // R
+            bgra_frame.push(chunk[3]); // A
+        }
+
+        let mut indices = vec![0u8; (target_size * target_size) as usize];
+        let mut palette = vec![0u32; palette_size as usize];
+
+        let result = unsafe {
+            yingif_process_frame(
+                processor,
+                bgra_frame.as_ptr(),
+                width as i32,
+                height as i32,
+                target_size as i32,
+                palette_size as i32,
+                indices.as_mut_ptr(),
+                palette.as_mut_ptr()
+            )
+        };
+
+        assert_eq!(result, 0, "Frame processing failed with error: {}", result);
+
+        // Verify output
+        assert!(indices.iter().any(|&i| i > 0), "Indices should have non-zero values");
+        assert!(palette.iter().any(|&p| p != 0), "Palette should have non-zero colors");
+
+        // Check palette is packed as 0x00RRGGBB (yingif_ffi.h)
+        for &color in palette.iter() {
+            assert_eq!(color >> 24, 0, "Palette colors should leave the top byte clear");
+        }
+
+        unsafe { yingif_processor_free(processor) };
+        println!("✅ Single frame processing test passed");
+    }
+
+    // Test GIF creation
+    #[test]
+    fn test_gif_creation() {
+        println!("Testing GIF89a creation...");
+
+        let cube_size = 32; // Smaller for testing
+        let palette_size = 256;
+        let frame_count = cube_size;
+
+        // Generate test indices (simulating processed frames)
+        let total_pixels = cube_size * cube_size * frame_count;
+        let mut indices = Vec::with_capacity(total_pixels as usize);
+        for frame in 0..frame_count {
+            for _pixel in 0..(cube_size * cube_size) {
+                indices.push((frame % 256) as u8);
+            }
+        }
+
+        // Generate test palette
+        let mut palette = Vec::with_capacity(palette_size as usize);
+        for i in 0..palette_size {
+            let r = (i * 7) as u32 & 0xFF;
+            let g = (i * 11) as u32 & 0xFF;
+            let b = (i * 13) as u32 & 0xFF;
+            palette.push(0xFF000000 | (r << 16) | (g << 8) | b);
+        }
+
+        // Estimate GIF size
+        let estimated_size = unsafe {
+            yingif_estimate_gif_size(cube_size, palette_size)
+        };
+        assert!(estimated_size > 0, "GIF size estimation failed");
+        println!("  Estimated GIF size: {} bytes", estimated_size);
+
+        // Create GIF
+        let mut gif_data = vec![0u8; (estimated_size * 2) as usize]; // 2x buffer
+        let mut actual_size = 0i32;
+
+        let result = unsafe {
+            yingif_create_gif89a(
+                indices.as_ptr(),
+                palette.as_ptr(),
+                cube_size,
+                palette_size,
+                40, // 40ms delay
+                gif_data.as_mut_ptr(),
+                gif_data.len() as i32,
+                &mut actual_size
+            )
+        };
+
+        assert_eq!(result, 0, "GIF creation failed with error: {}", result);
+        assert!(actual_size > 0, "GIF has zero size");
+
+        // Verify GIF header
+        assert_eq!(&gif_data[0..6], b"GIF89a", "Invalid GIF header");
+
+        // Verify GIF trailer exists
+        gif_data.truncate(actual_size as usize);
+        assert_eq!(gif_data[gif_data.len() - 1], 0x3B, "Missing GIF trailer");
+
+        println!("  Actual GIF size: {} bytes", actual_size);
+        println!("✅ GIF creation test passed");
+    }
+
+    // Test error handling
+    #[test]
+    fn test_error_handling() {
+        println!("Testing error handling...");
+
+        // Test null pointer handling
+        let result = unsafe {
+            yingif_process_frame(
+                ptr::null_mut(),
+                ptr::null(),
+                0, 0, 0, 0,
+                ptr::null_mut(),
+                ptr::null_mut()
+            )
+        };
+        assert_eq!(result, -1, "Should return -1 for null processor");
+
+        // Test invalid dimensions (valid buffers, so only the sizes are rejected)
+        let processor = unsafe { yingif_processor_new() };
+        let frame = [0u8; 4];
+        let mut indices = [0u8; 1];
+        let mut palette = [0u32; 256];
+        let result = unsafe {
+            yingif_process_frame(
+                processor,
+                frame.as_ptr(),
+                -1, -1, 0, 300, // Invalid dims and palette size
+                indices.as_mut_ptr(),
+                palette.as_mut_ptr()
+            )
+        };
+        assert_eq!(result, -2, "Should return -2 for invalid dimensions");
+
+        unsafe { yingif_processor_free(processor) };
+        println!("✅ Error handling test passed");
+    }
+
+    // Test memory safety with large cube
+    #[test]
+    fn test_memory_safety() {
+        println!("Testing memory safety with multiple operations...");
+
+        // Create and destroy multiple processors
+        for i in 0..10 {
+            let processor = unsafe { yingif_processor_new() };
+            assert!(!processor.is_null(), "Failed to create processor {}", i);
+            unsafe { yingif_processor_free(processor) };
+        }
+
+        // Process multiple frames with same processor
+        let processor = unsafe { yingif_processor_new() };
+        for i in 0..5 {
+            let frame = generate_test_frame(512, 512, i * 20);
+            let mut indices = vec![0u8; 128 * 128];
+            let mut palette = vec![0u32; 128];
+
+            let result = unsafe {
+                yingif_process_frame(
+                    processor,
+                    frame.as_ptr(),
+                    512, 512, 128, 128,
+                    indices.as_mut_ptr(),
+                    palette.as_mut_ptr()
+                )
+            };
+            assert_eq!(result, 0, "Frame {} processing failed", i);
+        }
+        unsafe { yingif_processor_free(processor) };
+
+        println!("✅ Memory safety test passed");
+    }
+
+    // Test that the area path's scratch pool is sized once
+    #[test]
+    fn test_scratch_pool_stays_flat() {
+        let processor = unsafe { yingif_processor_new() };
+        let mut indices = vec![0u8; 128 * 128];
+        let mut palette = vec![0u32; 256];
+
+        let mut high_water = Vec::new();
+        for i in 0..4 {
+            let frame = generate_test_frame(1080, 1080, i * 40);
+            let result = unsafe {
+                yingif_process_frame_ex(
+                    processor,
+                    frame.as_ptr(),
+                    1080, 1080, 128, 256,
+                    indices.as_mut_ptr(),
+                    palette.as_mut_ptr(),
+                    YX_RESIZE_AREA,
+                )
+            };
+            assert_eq!(result, 0, "Frame {} processing failed", i);
+            high_water.push(unsafe { yingif_processor_scratch_high_water(processor) });
+        }
+
+        // The resize target plus the box edges and a source-row accumulator
+        assert!(high_water[0] >= (128 * 128 * 4 + 1080 * 4 * 2) as u64, "{:?}", high_water);
+        assert!(high_water.iter().all(|&h| h == high_water[0]), "{:?}", high_water);
+
+        unsafe { yingif_processor_free(processor) };
+    }
+}
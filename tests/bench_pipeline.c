@@ -0,0 +1,541 @@
+/*
+ * bench_pipeline.c - Time the native C ABI (Rust processor + Zig frame storage)
+ * Compile with:
+ *   clang -O2 -o bench_pipeline bench_pipeline.c \
+ *     ../zig-core/zig-out/lib/libyxcbor.a \
+ *     ../rust-core/target/release/librgb2gif_processor.a \
+ *     ../rust-ios-ffi/target/release/libyingif.dylib \
+ *     -Wl,-rpath,../rust-ios-ffi/target/release \
+ *     -framework CoreFoundation -framework Security -framework SystemConfiguration
+ * yx_* come from rust-core, yingif_* from rust-ios-ffi (linked shared, since
+ * two Rust static libraries collide on the standard library they both carry).
+ *
+ * Run from tests/ so the gradient fixture resolves:
+ *   ./bench_pipeline [--quick] [--iterations N] [--json results.json]
+ *
+ * Every case runs over a frame-count × source-size × palette-size matrix on two
+ * clips: the recorded gradient fixture (test_data/gradient, cycled to the frame
+ * count) and a synthetic camera-like clip (slow pan, moving subject, sensor
+ * noise). Both are deterministic, so numbers from two builds are comparable.
+ * Scripts/run_native_benchmarks.sh runs this and the Rust benches together.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "../yxcbor.h"
+#include "../rust-core/include/yingif_ffi.h"
+
+#define TARGET_SIDE 132          // Batch path output size
+#define PALETTE_STRIDE 256       // yx_* palettes are always 256 entries per frame
+#define MAX_RESULTS 512
+#define MAX_ITERATIONS 64
+
+#define GRADIENT_DIR "test_data/gradient/raw"
+#define GRADIENT_FRAMES 10
+#define GRADIENT_SIDE 1080
+
+// ============================================================================
+// TIMING
+// ============================================================================
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    char name[48];
+    const char* clip;
+    int frames;
+    int source_side;
+    int palette_size;
+    int iterations;
+    double min_ms;
+    double median_ms;
+    double mean_ms;
+    uint64_t bytes;              // Output size (GIF, indices or frames on disk)
+} bench_result;
+
+static bench_result results[MAX_RESULTS];
+static int result_count = 0;
+static int iterations = 5;
+static int failures = 0;
+
+typedef struct {
+    const char* clip;
+    int frames;
+    int source_side;
+    int palette_size;
+    const uint8_t* const* rgba;  // frames pointers, source_side² RGBA each
+    uint8_t* indices;            // frames × TARGET_SIDE² scratch
+    uint32_t* palettes;          // frames × 256 scratch
+} bench_case;
+
+// One timed call; returns 0 on success and sets *bytes to the output size
+typedef int (*bench_fn)(const bench_case* c, uint64_t* bytes);
+
+// One warm-up call, then `iterations` timed calls
+static void run_bench(const char* name, bench_fn fn, const bench_case* c) {
+    double samples[MAX_ITERATIONS];
+    uint64_t bytes = 0;
+
+    if (fn(c, &bytes) != 0) {
+        printf("  ❌ %-24s %-8s %4d × %4d  p%-3d failed\n",
+               name, c->clip, c->frames, c->source_side, c->palette_size);
+        failures++;
+        return;
+    }
+
+    double total = 0;
+    for (int i = 0; i < iterations; i++) {
+        double start = now_ms();
+        fn(c, &bytes);
+        samples[i] = now_ms() - start;
+        total += samples[i];
+    }
+    qsort(samples, iterations, sizeof(double), compare_doubles);
+
+    if (result_count == MAX_RESULTS) return;
+    bench_result* r = &results[result_count++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->clip = c->clip;
+    r->frames = c->frames;
+    r->source_side = c->source_side;
+    r->palette_size = c->palette_size;
+    r->iterations = iterations;
+    r->min_ms = samples[0];
+    r->median_ms = samples[iterations / 2];
+    r->mean_ms = total / iterations;
+    r->bytes = bytes;
+
+    printf("  %-24s %-8s %4d × %4d  p%-3d %9.2f ms  %8.1f fps\n",
+           name, c->clip, c->frames, c->source_side, c->palette_size,
+           r->median_ms, c->frames * 1000.0 / r->median_ms);
+}
+
+// ============================================================================
+// FIXTURES
+// ============================================================================
+
+static uint32_t xorshift(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static uint8_t clamp_u8(int v) {
+    return v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v;
+}
+
+// Camera-like frame: a lit backdrop panning slowly, a subject crossing the
+// frame, and per-pixel sensor noise so no two frames are identical
+static void generate_camera_frame(uint8_t* frame, int side, int index, uint32_t* seed) {
+    int pan = index * side / 256;
+    int cx = side / 4 + index * side / 96 % (side / 2);
+    int cy = side / 2;
+    int radius = side / 6;
+
+    for (int y = 0; y < side; y++) {
+        for (int x = 0; x < side; x++) {
+            uint8_t* px = frame + ((size_t)y * side + x) * 4;
+            int u = (x + pan) * 255 / side;
+            int v = y * 255 / side;
+            int r = 90 + u / 2, g = 110 + v / 3, b = 150 - v / 4;
+
+            int dx = x - cx, dy = y - cy;
+            if (dx * dx + dy * dy < radius * radius) {
+                r = 200 - dy * 40 / radius;
+                g = 140 - dy * 30 / radius;
+                b = 110;
+            }
+
+            int noise = (int)(xorshift(seed) & 15) - 8;
+            px[0] = clamp_u8(r + noise);
+            px[1] = clamp_u8(g + noise);
+            px[2] = clamp_u8(b + noise);
+            px[3] = 255;
+        }
+    }
+}
+
+// Nearest resample of a square RGBA frame
+static void resample_frame(const uint8_t* src, int src_side, uint8_t* dst, int dst_side) {
+    for (int y = 0; y < dst_side; y++) {
+        const uint8_t* row = src + (size_t)(y * src_side / dst_side) * src_side * 4;
+        for (int x = 0; x < dst_side; x++) {
+            memcpy(dst + ((size_t)y * dst_side + x) * 4, row + (size_t)(x * src_side / dst_side) * 4, 4);
+        }
+    }
+}
+
+// Gradient fixture frames, resampled to `side`; NULL if the fixture is missing
+static uint8_t** load_gradient(int side, int count) {
+    size_t src_len = (size_t)GRADIENT_SIDE * GRADIENT_SIDE * 4;
+    uint8_t* src = malloc(src_len);
+    uint8_t* unique[GRADIENT_FRAMES];
+
+    for (int i = 0; i < GRADIENT_FRAMES; i++) {
+        char path[256];
+        snprintf(path, sizeof(path), GRADIENT_DIR "/frame_%03d.rgba", i);
+        FILE* f = fopen(path, "rb");
+        size_t got = f ? fread(src, 1, src_len, f) : 0;
+        if (f) fclose(f);
+        if (got != src_len) {
+            for (int j = 0; j < i; j++) free(unique[j]);
+            free(src);
+            return NULL;
+        }
+        unique[i] = malloc((size_t)side * side * 4);
+        resample_frame(src, GRADIENT_SIDE, unique[i], side);
+    }
+    free(src);
+
+    // Cycle the recorded frames up to the requested count
+    uint8_t** frames = malloc(count * sizeof(uint8_t*));
+    for (int i = 0; i < count; i++) {
+        frames[i] = malloc((size_t)side * side * 4);
+        memcpy(frames[i], unique[i % GRADIENT_FRAMES], (size_t)side * side * 4);
+    }
+    for (int i = 0; i < GRADIENT_FRAMES; i++) free(unique[i]);
+    return frames;
+}
+
+static uint8_t** make_camera_clip(int side, int count) {
+    uint32_t seed = 0x9E3779B9;
+    uint8_t** frames = malloc(count * sizeof(uint8_t*));
+    for (int i = 0; i < count; i++) {
+        frames[i] = malloc((size_t)side * side * 4);
+        generate_camera_frame(frames[i], side, i, &seed);
+    }
+    return frames;
+}
+
+static void free_clip(uint8_t** frames, int count) {
+    for (int i = 0; i < count; i++) free(frames[i]);
+    free(frames);
+}
+
+// ============================================================================
+// RUST PROCESSOR
+// ============================================================================
+
+static int bench_batch(const bench_case* c, uint64_t* bytes) {
+    *bytes = (uint64_t)c->frames * TARGET_SIDE * TARGET_SIDE;
+    return yx_proc_batch_rgba8(c->rgba, c->frames, c->source_side, c->source_side,
+                               TARGET_SIDE, c->palette_size, c->indices, c->palettes);
+}
+
+static int bench_batch_area(const bench_case* c, uint64_t* bytes) {
+    *bytes = (uint64_t)c->frames * TARGET_SIDE * TARGET_SIDE;
+    return yx_proc_batch_rgba8_ex(c->rgba, c->frames, c->source_side, c->source_side,
+                                  TARGET_SIDE, c->palette_size, c->indices, c->palettes,
+                                  YX_RESIZE_AREA, 0);
+}
+
+static int bench_batch_temporal(const bench_case* c, uint64_t* bytes) {
+    *bytes = (uint64_t)c->frames * TARGET_SIDE * TARGET_SIDE;
+    return yx_proc_batch_rgba8_temporal(c->rgba, c->frames, c->source_side, c->source_side,
+                                        TARGET_SIDE, c->palette_size, c->indices, c->palettes,
+                                        YX_RESIZE_AREA, 0, 0.1f);
+}
+
+static uint8_t* gif_buffer(size_t capacity) {
+    static uint8_t* out = NULL;
+    static size_t out_capacity = 0;
+    if (capacity > out_capacity) {
+        free(out);
+        out = malloc(capacity);
+        out_capacity = capacity;
+    }
+    return out;
+}
+
+// Encodes whatever the last batch call left in the case's index/palette buffers
+static int bench_gif_encode(const bench_case* c, uint64_t* bytes) {
+    uintptr_t len = yx_gif_max_size(c->frames, TARGET_SIDE);
+    uint8_t* out = gif_buffer(len);
+    int rc = yx_gif_encode(c->indices, c->palettes, c->frames, TARGET_SIDE, 4, out, &len);
+    *bytes = len;
+    return rc;
+}
+
+// Same clip through the caller-buffer encoder, in 64 KB chained blocks
+static int bench_gif_encoder_blocks(const bench_case* c, uint64_t* bytes) {
+    const size_t block_size = 64 * 1024;
+    size_t capacity = yx_gif_max_size(c->frames, TARGET_SIDE);
+    uint8_t* out = gif_buffer(capacity);
+    YxGifEncoder* encoder = yx_gif_encoder_open(c->indices, c->palettes, c->frames, TARGET_SIDE, 4);
+    if (!encoder) return -1;
+
+    int rc;
+    size_t total = 0;
+    do {
+        uintptr_t len = capacity - total < block_size ? capacity - total : block_size;
+        rc = yx_gif_encoder_next(encoder, out + total, &len);
+        total += len;
+    } while (rc == YX_GIF_NEED_SPACE);
+    yx_gif_encoder_free(encoder);
+    *bytes = total;
+    return rc;
+}
+
+// Single-frame processor path, one call per frame
+static int bench_process_frame(const bench_case* c, uint64_t* bytes) {
+    YinGifProcessor* processor = yingif_processor_new();
+    if (!processor) return -1;
+
+    int rc = 0;
+    for (int i = 0; i < c->frames && rc == 0; i++) {
+        rc = yingif_process_frame(processor, c->rgba[i], c->source_side, c->source_side,
+                                  TARGET_SIDE, c->palette_size,
+                                  c->indices + (size_t)i * TARGET_SIDE * TARGET_SIDE,
+                                  c->palettes + (size_t)i * PALETTE_STRIDE);
+    }
+    yingif_processor_free(processor);
+    *bytes = (uint64_t)c->frames * TARGET_SIDE * TARGET_SIDE;
+    return rc;
+}
+
+// ============================================================================
+// ZIG FRAME STORAGE
+// ============================================================================
+
+static char storage_dir[256];
+
+static yx_frame_manifest manifest_for(const bench_case* c) {
+    yx_frame_manifest manifest = {
+        .width = c->source_side,
+        .height = c->source_side,
+        .channels = 4,
+        .frame_count = c->frames,
+    };
+    return manifest;
+}
+
+static uint32_t frame_len(const bench_case* c) {
+    return (uint32_t)c->source_side * c->source_side * 4;
+}
+
+static int bench_cbor_write(const bench_case* c, uint64_t* bytes) {
+    yx_frame_manifest manifest = manifest_for(c);
+    yxcbor_writer* writer = NULL;
+    int rc = yxcbor_writer_open(storage_dir, &manifest, &writer);
+    for (int i = 0; i < c->frames && rc == 0; i++) {
+        rc = yxcbor_writer_write_frame(writer, c->rgba[i], frame_len(c));
+    }
+    if (writer) {
+        int close_rc = yxcbor_writer_close(writer);
+        if (rc == 0) rc = close_rc;
+    }
+    *bytes = (uint64_t)c->frames * frame_len(c);
+    return rc;
+}
+
+static int bench_cbor_write_async(const bench_case* c, uint64_t* bytes) {
+    yx_frame_manifest manifest = manifest_for(c);
+    yxcbor_async_options options = {
+        .queue_depth = 8,
+        .fsync_policy = YXCBOR_FSYNC_ON_CLOSE,
+        .on_complete = NULL,
+        .ctx = NULL,
+        .copy_frames = 0,
+    };
+    yxcbor_async_writer* writer = NULL;
+    int rc = yxcbor_async_writer_open(storage_dir, &manifest, &options, &writer);
+    for (int i = 0; i < c->frames && rc == 0; i++) {
+        rc = yxcbor_async_writer_submit(writer, c->rgba[i], frame_len(c));
+    }
+    if (writer) {
+        int close_rc = yxcbor_async_writer_close(writer);
+        if (rc == 0) rc = close_rc;
+    }
+    *bytes = (uint64_t)c->frames * frame_len(c);
+    return rc;
+}
+
+// Reads back what bench_cbor_write left in storage_dir
+static int bench_cbor_read(const bench_case* c, uint64_t* bytes) {
+    yx_frame_manifest manifest;
+    yxcbor_reader* reader = NULL;
+    int rc = yxcbor_reader_open(storage_dir, &manifest, &reader);
+    if (rc != 0) return rc;
+
+    uint8_t* frame = malloc(frame_len(c));
+    for (uint32_t i = 0; i < manifest.frame_count && rc == 0; i++) {
+        rc = yxcbor_reader_read_frame(reader, i, frame, frame_len(c));
+    }
+    free(frame);
+    yxcbor_reader_close(reader);
+    *bytes = (uint64_t)manifest.frame_count * frame_len(c);
+    return rc;
+}
+
+// Mapped reader: touches one byte per page so the mapping is actually faulted in
+static int bench_cbor_read_mapped(const bench_case* c, uint64_t* bytes) {
+    yx_frame_manifest manifest;
+    yxcbor_reader* reader = NULL;
+    int rc = yxcbor_reader_open_mapped(storage_dir, &manifest, &reader);
+    if (rc != 0) return rc;
+
+    volatile uint32_t checksum = 0;
+    for (uint32_t i = 0; i < manifest.frame_count && rc == 0; i++) {
+        const uint8_t* ptr = NULL;
+        uint32_t len = 0;
+        rc = yxcbor_reader_frame_ptr(reader, i, &ptr, &len);
+        for (uint32_t offset = 0; rc == 0 && offset < len; offset += 4096) {
+            checksum += ptr[offset];
+        }
+    }
+    yxcbor_reader_close(reader);
+    *bytes = (uint64_t)manifest.frame_count * frame_len(c);
+    return rc;
+}
+
+// ============================================================================
+// MATRIX
+// ============================================================================
+
+static void run_clip(const char* clip, uint8_t** rgba, int frames, int source_side,
+                     const int* palettes, int palette_count) {
+    bench_case c = {
+        .clip = clip,
+        .frames = frames,
+        .source_side = source_side,
+        .rgba = (const uint8_t* const*)rgba,
+        .indices = malloc((size_t)frames * TARGET_SIDE * TARGET_SIDE),
+        .palettes = malloc((size_t)frames * PALETTE_STRIDE * sizeof(uint32_t)),
+    };
+
+    for (int p = 0; p < palette_count; p++) {
+        c.palette_size = palettes[p];
+        run_bench("yingif_process_frame", bench_process_frame, &c);
+        run_bench("yx_proc_batch_rgba8_ex", bench_batch_area, &c);
+        run_bench("yx_proc_batch_temporal", bench_batch_temporal, &c);
+        run_bench("yx_proc_batch_rgba8", bench_batch, &c);
+        run_bench("yx_gif_encode", bench_gif_encode, &c);
+        run_bench("yx_gif_encoder_blocks", bench_gif_encoder_blocks, &c);
+    }
+
+    // Storage cost doesn't depend on the palette
+    c.palette_size = 0;
+    run_bench("yxcbor_writer", bench_cbor_write, &c);
+    run_bench("yxcbor_reader", bench_cbor_read, &c);
+    run_bench("yxcbor_reader_mapped", bench_cbor_read_mapped, &c);
+    run_bench("yxcbor_async_writer", bench_cbor_write_async, &c);
+
+    free(c.indices);
+    free(c.palettes);
+}
+
+static int write_json(const char* path, int quick) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+    const char* revision = getenv("BENCH_REVISION");
+    fprintf(f, "{\n  \"suite\": \"c_abi\",\n  \"revision\": \"%s\",\n  \"quick\": %s,\n  \"target_side\": %d,\n  \"results\": [\n",
+            revision ? revision : "", quick ? "true" : "false", TARGET_SIDE);
+    for (int i = 0; i < result_count; i++) {
+        const bench_result* r = &results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"clip\": \"%s\", \"frames\": %d, \"source_side\": %d, "
+                   "\"palette_size\": %d, \"iterations\": %d, \"min_ms\": %.3f, \"median_ms\": %.3f, "
+                   "\"mean_ms\": %.3f, \"bytes\": %llu}%s\n",
+                r->name, r->clip, r->frames, r->source_side, r->palette_size, r->iterations,
+                r->min_ms, r->median_ms, r->mean_ms, (unsigned long long)r->bytes,
+                i + 1 < result_count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f);
+}
+
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    int quick = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            quick = 1;
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--quick] [--iterations N] [--json path]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (quick && iterations == 5) iterations = 2;
+    if (iterations < 1) iterations = 1;
+    if (iterations > MAX_ITERATIONS) iterations = MAX_ITERATIONS;
+
+    static const int full_frames[] = {16, 64, 128};
+    static const int full_sides[] = {256, 1080};
+    static const int full_palettes[] = {64, 256};
+    static const int quick_frames[] = {16};
+    static const int quick_sides[] = {256};
+    static const int quick_palettes[] = {256};
+
+    const int* frame_counts = quick ? quick_frames : full_frames;
+    const int* sides = quick ? quick_sides : full_sides;
+    const int* palettes = quick ? quick_palettes : full_palettes;
+    int frame_count_n = quick ? 1 : 3;
+    int side_n = quick ? 1 : 2;
+    int palette_n = quick ? 1 : 2;
+
+    snprintf(storage_dir, sizeof(storage_dir), "/tmp/yx_bench_XXXXXX");
+    if (!mkdtemp(storage_dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    printf("🚀 Native C ABI benchmark (%d iterations, target %d)\n", iterations, TARGET_SIDE);
+    for (int s = 0; s < side_n; s++) {
+        for (int f = 0; f < frame_count_n; f++) {
+            int side = sides[s], frames = frame_counts[f];
+
+            uint8_t** gradient = load_gradient(side, frames);
+            if (gradient) {
+                run_clip("gradient", gradient, frames, side, palettes, palette_n);
+                free_clip(gradient, frames);
+            } else if (s == 0 && f == 0) {
+                printf("  ⚠️  %s not found, skipping the gradient clip\n", GRADIENT_DIR);
+            }
+
+            uint8_t** camera = make_camera_clip(side, frames);
+            run_clip("camera", camera, frames, side, palettes, palette_n);
+            free_clip(camera, frames);
+        }
+    }
+
+    // The writers leave one clip behind; remove it with the directory
+    char command[300];
+    snprintf(command, sizeof(command), "rm -rf %s", storage_dir);
+    if (system(command) != 0) {
+        fprintf(stderr, "could not remove %s\n", storage_dir);
+    }
+
+    if (json_path) {
+        if (write_json(json_path, quick) != 0) {
+            perror(json_path);
+            return 1;
+        }
+        printf("\n📄 Wrote %d results to %s\n", result_count, json_path);
+    }
+
+    if (failures) {
+        printf("\n❌ %d benchmark(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+// YXV container write/read time over a cube-size × compression × keyframe matrix
+// Run with: cargo bench --bench yxv_io -- [--quick] [--json out.json]
+//
+// Volumes are indexed camera-like clips (slow pan, moving subject, sensor noise),
+// so delta frames and the compressors see realistic frame-to-frame change.
+
+use std::path::PathBuf;
+use std::time::Instant;
+
+use anyhow::Result;
+use yinvxl::{Compression, YxvContainer, YxvReader};
+
+fn xorshift(state: &mut u32) -> u32 {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    *state
+}
+
+/// N×N×N indexed volume: frame z is one N×N slice of palette indices
+fn camera_volume(side: usize) -> YxvContainer {
+    let mut seed = 0x9E37_79B9;
+    let radius = (side / 6) as i32;
+    let frames = (0..side)
+        .map(|z| {
+            let pan = z * side / 256;
+            let (cx, cy) = ((side / 4 + z * side / 96 % (side / 2)) as i32, (side / 2) as i32);
+            let mut slice = Vec::with_capacity(side * side);
+            for y in 0..side {
+                for x in 0..side {
+                    let (dx, dy) = (x as i32 - cx, y as i32 - cy);
+                    let base = if dx * dx + dy * dy < radius * radius {
+                        200 + dy * 24 / radius
+                    } else {
+                        (((x + pan) * 96 / side) + y * 96 / side) as i32
+                    };
+                    // Noise flips the low index bit on roughly one pixel in eight
+                    let noise = (xorshift(&mut seed) & 7 == 0) as i32;
+                    slice.push((base ^ noise).clamp(0, 255) as u8);
+                }
+            }
+            slice
+        })
+        .collect();
+
+    let mut container = YxvContainer::new((side as u32, side as u32, side as u32));
+    container.palette = (0..=255u8).map(|i| [i, i / 2, 255 - i]).collect();
+    container.frames = frames;
+    container
+}
+
+/// Median of `iterations` runs after one warm-up, in milliseconds
+fn time(iterations: usize, mut run: impl FnMut() -> Result<()>) -> Result<(f64, f64)> {
+    run()?;
+    let mut samples = Vec::with_capacity(iterations);
+    for _ in 0..iterations {
+        let start = Instant::now();
+        run()?;
+        samples.push(start.elapsed().as_secs_f64() * 1000.0);
+    }
+    samples.sort_by(|a, b| a.partial_cmp(b).unwrap());
+    Ok((samples[0], samples[samples.len() / 2]))
+}
+
+fn main() -> Result<()> {
+    // cargo passes --bench; anything else unknown is ignored the same way
+    let args: Vec<String> = std::env::args().collect();
+    let quick = args.iter().any(|a| a == "--quick");
+    let json_path = args.iter().position(|a| a == "--json").and_then(|i| args.get(i + 1));
+    let iterations = if quick { 2 } else { 5 };
+
+    let sides: &[usize] = if quick { &[64] } else { &[64, 128, 256] };
+    let compressions: &[Compression] = if quick {
+        &[Compression::Lz4]
+    } else {
+        &[Compression::None, Compression::Lz4, Compression::Zstd]
+    };
+    let keyframe_intervals: &[u32] = if quick { &[0] } else { &[0, 8] };
+
+    let path: PathBuf = std::env::temp_dir().join(format!("yxv_bench_{}.yxv", std::process::id()));
+    let mut results = Vec::new();
+
+    for &side in sides {
+        let mut container = camera_volume(side);
+        let raw_bytes = side * side * side;
+
+        for &compression in compressions {
+            for &keyframe_interval in keyframe_intervals {
+                container.compression = compression;
+                container.keyframe_interval = keyframe_interval;
+
+                let write = time(iterations, || container.write_to_file(&path))?;
+                let file_bytes = std::fs::metadata(&path)?.len();
+                let read = time(iterations, || YxvContainer::read_from_file(&path).map(drop))?;
+                // Lazy reader, cold cache: open and decode every slice in order
+                let scrub = time(iterations, || {
+                    let reader = YxvReader::open(&path)?;
+                    for index in 0..reader.frame_count() {
+                        reader.frame(index)?;
+                    }
+                    Ok(())
+                })?;
+
+                for (name, (min_ms, median_ms)) in [("write", write), ("read", read), ("reader_scrub", scrub)] {
+                    println!(
+                        "{:<14} {:>3}³  {:<6} key {:<2} {:>9.2} ms  {:>8.1} MB/s  {:>5.1}%",
+                        name,
+                        side,
+                        format!("{:?}", compression),
+                        keyframe_interval,
+                        median_ms,
+                        raw_bytes as f64 / median_ms / 1000.0,
+                        file_bytes as f64 * 100.0 / raw_bytes as f64
+                    );
+                    results.push(format!(
+                        "{{\"name\": \"{}\", \"side\": {}, \"compression\": \"{:?}\", \"keyframe_interval\": {}, \
+                         \"iterations\": {}, \"min_ms\": {:.3}, \"median_ms\": {:.3}, \"raw_bytes\": {}, \"bytes\": {}}}",
+                        name, side, compression, keyframe_interval, iterations, min_ms, median_ms, raw_bytes, file_bytes
+                    ));
+                }
+            }
+        }
+    }
+    let _ = std::fs::remove_file(&path);
+
+    if let Some(out) = json_path {
+        let json = format!(
+            "{{\n  \"suite\": \"yxv_io\",\n  \"revision\": \"{}\",\n  \"quick\": {},\n  \"results\": [\n    {}\n  ]\n}}\n",
+            std::env::var("BENCH_REVISION").unwrap_or_default(),
+            quick,
+            results.join(",\n    ")
+        );
+        std::fs::write(out, json)?;
+        println!("\nWrote {} results to {}", results.len(), out);
+    }
+    Ok(())
+}
@@ -3,9 +3,13 @@
 
 use clap::{Parser, Subcommand};
 use anyhow::Result;
-use yinvxl::{YxvContainer, Compression};
+use yinvxl::{YxvContainer, YxvReader, Compression};
 use std::path::PathBuf;
 
+#[cfg(feature = "gif")]
+#[path = "yxv/transcode.rs"]
+mod transcode;
+
 #[derive(Parser)]
 #[command(name = "yxv")]
 #[command(about = "YinVoxel (YXV) format tool", long_about = None)]
@@ -45,6 +49,10 @@ enum Commands {
         /// Palette file (768 bytes RGB)
         #[arg(short, long)]
         palette: Option<PathBuf>,
+
+        /// Store every Nth frame whole and the rest as deltas (0 = all whole)
+        #[arg(short, long, default_value = "0")]
+        keyframe_interval: u32,
     },
 
     /// Unpack YXV file to raw voxel data
@@ -104,6 +112,34 @@ enum Commands {
         #[arg(short, long, default_value = "40")]
         delay: u16,
     },
+
+    /// Transcode many clips (.yxv cubes or yxcbor directories) into GIFs on one shared pool
+    #[cfg(feature = "gif")]
+    Transcode {
+        /// Manifest: one clip per line, `input output [key=value ...]`
+        /// (colors, fps, dither, palette=shared|first, key=<palette group>)
+        manifest: PathBuf,
+
+        /// Worker threads shared by every clip (0 = all cores)
+        #[arg(short, long, default_value = "0")]
+        workers: u32,
+
+        /// Decoded clips held at once; loading waits beyond this (0 = 4)
+        #[arg(long, default_value = "0")]
+        in_flight: u32,
+
+        /// Default palette colors (at most 255)
+        #[arg(long, default_value = "255")]
+        colors: u16,
+
+        /// Default frames per second
+        #[arg(long, default_value = "25")]
+        fps: u16,
+
+        /// Default dithering level (0.0-1.0)
+        #[arg(long, default_value = "0.5")]
+        dither: f32,
+    },
 }
 
 fn main() -> Result<()> {
@@ -118,6 +154,7 @@ fn main() -> Result<()> {
             depth,
             compression,
             palette,
+            keyframe_interval,
         } => {
             println!("Packing voxel data to YXV...");
 
@@ -139,6 +176,7 @@ fn main() -> Result<()> {
             // Create container
             let mut container = YxvContainer::new((width, height, depth));
             container.compression = comp;
+            container.keyframe_interval = keyframe_interval;
 
             // Load palette if provided
             if let Some(palette_path) = palette {
@@ -199,19 +237,21 @@ fn main() -> Result<()> {
             let metadata = std::fs::metadata(&input)?;
             println!("   File size: {} bytes", metadata.len());
 
-            let container = YxvContainer::read_from_file(&input)?;
+            // Header and chunk table only; no frame is decoded
+            let reader = YxvReader::open(&input)?;
+            let dimensions = reader.dimensions();
             println!("   Dimensions: {}×{}×{}",
-                container.dimensions.0,
-                container.dimensions.1,
-                container.dimensions.2
+                dimensions.0,
+                dimensions.1,
+                dimensions.2
             );
-            println!("   Compression: {:?}", container.compression);
-            println!("   Palette colors: {}", container.palette.len());
-            println!("   Frames: {}", container.frames.len());
+            println!("   Compression: {:?}", reader.compression());
+            println!("   Palette colors: {}", reader.palette().len());
+            println!("   Frames: {}", reader.frame_count());
 
-            let voxel_count = container.dimensions.0 *
-                              container.dimensions.1 *
-                              container.dimensions.2;
+            let voxel_count = dimensions.0 *
+                              dimensions.1 *
+                              dimensions.2;
             println!("   Total voxels: {}", voxel_count);
         }
 
@@ -246,23 +286,55 @@ fn main() -> Result<()> {
         Commands::Extract { input, frame, output } => {
             println!("Extracting frame {} from YXV...", frame);
 
-            let container = YxvContainer::read_from_file(&input)?;
+            let reader = YxvReader::open_with_cache(&input, 0)?;
 
-            if frame >= container.frames.len() {
+            if frame >= reader.frame_count() {
                 eprintln!("Frame index {} out of range (0-{})",
-                    frame, container.frames.len() - 1);
+                    frame, reader.frame_count().saturating_sub(1));
                 std::process::exit(1);
             }
 
-            std::fs::write(&output, &container.frames[frame])?;
+            std::fs::write(&output, &*reader.frame(frame)?)?;
             println!("✅ Frame saved to: {}", output.display());
         }
 
         #[cfg(feature = "gif")]
         Commands::ToGif { input, output, delay } => {
             println!("Converting YXV to GIF...");
-            // TODO: Implement GIF conversion
-            println!("GIF conversion not yet implemented");
+
+            let settings = transcode::ClipSettings {
+                colors: 255,
+                fps: (1000 / delay.max(1)).max(1),
+                dither: 0.5,
+                shared_palette: true,
+                palette_key: None,
+            };
+            let entry = transcode::Entry { input, output, settings };
+            let report = transcode::run(vec![entry], &Default::default())?;
+            if report.failed > 0 {
+                std::process::exit(1);
+            }
+        }
+
+        #[cfg(feature = "gif")]
+        Commands::Transcode { manifest, workers, in_flight, colors, fps, dither } => {
+            let defaults = transcode::ClipSettings { colors, fps, dither, shared_palette: true, palette_key: None };
+            let entries = transcode::read_manifest(&manifest, &defaults)?;
+            println!("Transcoding {} clips...", entries.len());
+
+            let opts = rgb2gif_processor::BatchOpts { workers, clips_in_flight: in_flight };
+            let report = transcode::run(entries, &opts)?;
+
+            println!("✅ Transcoded {} of {} clips in {:.2} s", report.clips - report.failed, report.clips, report.elapsed_ms / 1000.0);
+            println!("   Throughput: {:.2} clips/s, {:.1} MB/s read, {:.0} frames/s",
+                report.clips_per_sec(),
+                report.mb_per_sec(),
+                report.frames as f64 * 1000.0 / report.elapsed_ms.max(1e-3)
+            );
+            println!("   Output: {} bytes from {} bytes of frames", report.output_bytes, report.decoded_bytes);
+            if report.failed > 0 {
+                std::process::exit(1);
+            }
         }
     }
 
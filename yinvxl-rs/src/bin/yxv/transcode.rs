@@ -0,0 +1,463 @@
+// Batch transcoding of stored captures into GIFs
+// Inputs are .yxv cubes or yxcbor frame directories (manifest.cbor + frames.cbor);
+// every clip runs on one shared pool (rgb2gif_processor::transcode_batch).
+
+use std::path::{Path, PathBuf};
+use std::sync::{Arc, Mutex};
+
+use anyhow::{bail, Context, Result};
+use rgb2gif_processor::{
+    transcode_batch, BatchOpts, BatchReport, Clip, ClipJob, GifOpts, ProcessorError, QuantizeOpts,
+    TensorLayout,
+};
+use yinvxl::YxvReader;
+
+// yxcbor record tags (zig-core/yxcbor.zig)
+const TAG_RGBA_FRAME: u64 = 0x1001;
+const TAG_FRAME_MANIFEST: u64 = 0x1002;
+
+/// Per-clip settings; manifest lines override the command-line defaults
+#[derive(Clone)]
+pub struct ClipSettings {
+    pub colors: u16,
+    pub fps: u16,
+    pub dither: f32,
+    pub shared_palette: bool,
+    pub palette_key: Option<String>,
+}
+
+/// One manifest entry
+pub struct Entry {
+    pub input: PathBuf,
+    pub output: PathBuf,
+    pub settings: ClipSettings,
+}
+
+/// Parse a manifest: one clip per line, `input output [key=value ...]`
+/// Keys: colors, fps, dither, palette (shared | first) and key (clips with the
+/// same key reuse one palette). Relative paths are relative to the manifest;
+/// blank lines and lines starting with # are skipped.
+pub fn read_manifest(path: &Path, defaults: &ClipSettings) -> Result<Vec<Entry>> {
+    let text = std::fs::read_to_string(path).with_context(|| format!("Reading {}", path.display()))?;
+    let base = path.parent().unwrap_or(Path::new("."));
+    let mut entries = Vec::new();
+
+    for (number, line) in text.lines().enumerate() {
+        let line = line.trim();
+        if line.is_empty() || line.starts_with('#') {
+            continue;
+        }
+        let mut fields = line.split_whitespace();
+        let (input, output) = match (fields.next(), fields.next()) {
+            (Some(input), Some(output)) => (base.join(input), base.join(output)),
+            _ => bail!("{}:{}: expected `input output [key=value ...]`", path.display(), number + 1),
+        };
+
+        let mut settings = defaults.clone();
+        for option in fields {
+            let parsed = match option.split_once('=') {
+                Some(("colors", v)) => v.parse().map(|v| settings.colors = v).is_ok(),
+                Some(("fps", v)) => v.parse().map(|v| settings.fps = v).is_ok(),
+                Some(("dither", v)) => v.parse().map(|v| settings.dither = v).is_ok(),
+                Some(("palette", "shared")) => { settings.shared_palette = true; true }
+                Some(("palette", "first")) => { settings.shared_palette = false; true }
+                Some(("key", v)) if !v.is_empty() => { settings.palette_key = Some(v.to_string()); true }
+                _ => false,
+            };
+            if !parsed {
+                bail!("{}:{}: invalid option `{}`", path.display(), number + 1, option);
+            }
+        }
+        entries.push(Entry { input, output, settings });
+    }
+    Ok(entries)
+}
+
+/// Transcode `entries`, writing each GIF as its clip finishes
+pub fn run(entries: Vec<Entry>, opts: &BatchOpts) -> Result<BatchReport> {
+    let outputs: Vec<PathBuf> = entries.iter().map(|entry| entry.output.clone()).collect();
+    // The batch only sees ProcessorError; loaders leave the full reason here
+    let load_errors = Arc::new(Mutex::new(vec![None; entries.len()]));
+    let jobs = entries.into_iter().enumerate().map(|(index, entry)| job(entry, index, &load_errors)).collect();
+
+    let mut write_error = None;
+    let report = transcode_batch(jobs, opts, |outcome| {
+        let output = &outputs[outcome.index];
+        let load_error = load_errors.lock().unwrap()[outcome.index].take();
+        match outcome.result {
+            Ok(result) => match std::fs::write(output, &result.gif_data) {
+                Ok(()) => println!(
+                    "   ✅ {} → {} ({} frames, {} bytes, read {:.1} ms, encode {:.1} ms)",
+                    outcome.name,
+                    output.display(),
+                    result.actual_frame_count,
+                    result.gif_data.len(),
+                    outcome.load_ms,
+                    result.processing_time_ms
+                ),
+                Err(err) => {
+                    eprintln!("   ❌ {}: writing {}: {}", outcome.name, output.display(), err);
+                    write_error.get_or_insert(err);
+                }
+            },
+            Err(err) => match load_error {
+                Some(reason) => eprintln!("   ❌ {}: {}", outcome.name, reason),
+                None => eprintln!("   ❌ {}: {}", outcome.name, err),
+            },
+        }
+    })?;
+
+    if let Some(err) = write_error {
+        return Err(err).context("Writing output");
+    }
+    Ok(report)
+}
+
+fn job(entry: Entry, index: usize, load_errors: &Arc<Mutex<Vec<Option<String>>>>) -> ClipJob {
+    let settings = entry.settings;
+    let input = entry.input;
+    let load_errors = load_errors.clone();
+
+    ClipJob {
+        name: input.display().to_string(),
+        load: Box::new(move |buffer| {
+            load_clip(&input, buffer).map_err(|err| {
+                load_errors.lock().unwrap()[index] = Some(format!("{:#}", err));
+                ProcessorError::InvalidInput
+            })
+        }),
+        quantize_opts: QuantizeOpts {
+            quality_min: 70,
+            quality_max: 100,
+            speed: 8,
+            palette_size: settings.colors,
+            dithering_level: settings.dither,
+            shared_palette: settings.shared_palette,
+            oklab_palette: false,
+            blue_noise_dither: false,
+        },
+        gif_opts: GifOpts {
+            width: 0,
+            height: 0,
+            frame_count: 0,
+            fps: settings.fps,
+            loop_count: 0,
+            optimize: true,
+            include_tensor: false,
+            indexed_tensor: false,
+            tensor_layout: TensorLayout::FrameMajor,
+        },
+        palette_key: settings.palette_key,
+    }
+}
+
+/// Read a .yxv cube or a yxcbor directory into `buffer` as RGBA
+fn load_clip(input: &Path, buffer: Vec<u8>) -> Result<Clip> {
+    if input.is_dir() {
+        load_yxcbor(input, buffer)
+    } else {
+        load_yxv(input, buffer)
+    }
+}
+
+/// Z-slices become frames, expanded through the container palette
+fn load_yxv(path: &Path, mut rgba: Vec<u8>) -> Result<Clip> {
+    let reader = YxvReader::open_with_cache(path, 0)?;
+    let (width, height, _) = reader.dimensions();
+    let palette = reader.palette();
+    if palette.is_empty() {
+        bail!("No palette to expand indices with");
+    }
+
+    let frames = reader.frames(0..reader.frame_count())?;
+    rgba.reserve(frames.len() * width as usize * height as usize * 4);
+    for frame in &frames {
+        for &index in frame.iter() {
+            let [r, g, b] = palette.get(index as usize).copied().unwrap_or([0, 0, 0]);
+            rgba.extend_from_slice(&[r, g, b, 255]);
+        }
+    }
+
+    Ok(Clip {
+        rgba,
+        width,
+        height,
+        frame_count: frames.len() as u32,
+        source_bytes: std::fs::metadata(path)?.len(),
+    })
+}
+
+/// Frames are copied out of one sequential read of frames.cbor
+fn load_yxcbor(dir: &Path, mut rgba: Vec<u8>) -> Result<Clip> {
+    let manifest = std::fs::read(dir.join("manifest.cbor")).context("manifest.cbor")?;
+    let (width, height, channels, frame_count) = parse_manifest(&manifest).context("manifest.cbor")?;
+    if channels != 3 && channels != 4 {
+        bail!("Unsupported channel count {}", channels);
+    }
+
+    let store = std::fs::read(dir.join("frames.cbor")).context("frames.cbor")?;
+    let mut cursor = Cbor { bytes: &store, pos: 0 };
+    let (major, count) = cursor.head()?;
+    if major != MAJOR_ARRAY || count != frame_count as u64 {
+        bail!("frames.cbor holds {} frames, manifest says {}", count, frame_count);
+    }
+
+    let frame_bytes = width as usize * height as usize * channels as usize;
+    rgba.reserve(frame_count as usize * width as usize * height as usize * 4);
+    for index in 0..frame_count {
+        let pixels = cursor.frame(frame_bytes).with_context(|| format!("Frame {}", index))?;
+        if channels == 4 {
+            rgba.extend_from_slice(pixels);
+        } else {
+            for px in pixels.chunks_exact(3) {
+                rgba.extend_from_slice(&[px[0], px[1], px[2], 255]);
+            }
+        }
+    }
+
+    Ok(Clip { rgba, width, height, frame_count, source_bytes: (manifest.len() + store.len()) as u64 })
+}
+
+const MAJOR_UNSIGNED: u8 = 0x00;
+const MAJOR_BYTES: u8 = 0x40;
+const MAJOR_TEXT: u8 = 0x60;
+const MAJOR_ARRAY: u8 = 0x80;
+const MAJOR_MAP: u8 = 0xA0;
+const MAJOR_TAG: u8 = 0xC0;
+
+/// The subset of CBOR yxcbor writes: definite-length heads, text keys,
+/// unsigned values, tagged byte strings
+struct Cbor<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Cbor<'a> {
+    fn take(&mut self, n: usize) -> Result<&'a [u8]> {
+        let end = self.pos.checked_add(n).filter(|&end| end <= self.bytes.len());
+        let end = end.context("Truncated CBOR")?;
+        let bytes = &self.bytes[self.pos..end];
+        self.pos = end;
+        Ok(bytes)
+    }
+
+    /// Major type and argument of the next item
+    fn head(&mut self) -> Result<(u8, u64)> {
+        let initial = self.take(1)?[0];
+        let value = match initial & 0x1F {
+            n @ 0..=23 => n as u64,
+            24 => self.take(1)?[0] as u64,
+            25 => u16::from_be_bytes(self.take(2)?.try_into()?) as u64,
+            26 => u32::from_be_bytes(self.take(4)?.try_into()?) as u64,
+            27 => u64::from_be_bytes(self.take(8)?.try_into()?),
+            _ => bail!("Unsupported CBOR item"),
+        };
+        Ok((initial & 0xE0, value))
+    }
+
+    fn expect(&mut self, major: u8) -> Result<u64> {
+        match self.head()? {
+            (m, value) if m == major => Ok(value),
+            (m, _) => bail!("Expected CBOR major type {:#x}, found {:#x}", major, m),
+        }
+    }
+
+    /// One tagged frame record of exactly `len` pixel bytes
+    fn frame(&mut self, len: usize) -> Result<&'a [u8]> {
+        if self.expect(MAJOR_TAG)? != TAG_RGBA_FRAME {
+            bail!("Not a frame record");
+        }
+        let data_len = self.expect(MAJOR_BYTES)? as usize;
+        if data_len != len {
+            bail!("Frame is {} bytes, expected {}", data_len, len);
+        }
+        self.take(data_len)
+    }
+}
+
+/// width, height, channels and frame_count from a tagged manifest map
+fn parse_manifest(bytes: &[u8]) -> Result<(u32, u32, u32, u32)> {
+    let mut cursor = Cbor { bytes, pos: 0 };
+    if cursor.expect(MAJOR_TAG)? != TAG_FRAME_MANIFEST {
+        bail!("Not a frame manifest");
+    }
+
+    let mut fields = [0u32; 4];
+    for _ in 0..cursor.expect(MAJOR_MAP)? {
+        let key_len = cursor.expect(MAJOR_TEXT)? as usize;
+        let key = cursor.take(key_len)?;
+        let value = cursor.expect(MAJOR_UNSIGNED)?;
+        let slot = match key {
+            b"width" => 0,
+            b"height" => 1,
+            b"channels" => 2,
+            b"frame_count" => 3,
+            _ => continue, // yxcbor only writes unsigned values, so unknown keys skip cleanly
+        };
+        fields[slot] = u32::try_from(value)?;
+    }
+    Ok((fields[0], fields[1], fields[2], fields[3]))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn defaults() -> ClipSettings {
+        ClipSettings { colors: 255, fps: 25, dither: 0.5, shared_palette: true, palette_key: None }
+    }
+
+    /// A scratch directory under the system temp dir, removed once the test is done
+    struct Scratch(PathBuf);
+
+    impl Scratch {
+        fn new(name: &str) -> Self {
+            let dir = std::env::temp_dir().join(format!("yxv_transcode_{}_{}", name, std::process::id()));
+            let _ = std::fs::remove_dir_all(&dir);
+            std::fs::create_dir_all(&dir).unwrap();
+            Scratch(dir)
+        }
+    }
+
+    impl Drop for Scratch {
+        fn drop(&mut self) {
+            let _ = std::fs::remove_dir_all(&self.0);
+        }
+    }
+
+    /// Definite-length CBOR head, shortest form
+    fn head(out: &mut Vec<u8>, major: u8, value: u64) {
+        match value {
+            0..=23 => out.push(major | value as u8),
+            24..=0xFF => out.extend_from_slice(&[major | 24, value as u8]),
+            0x100..=0xFFFF => {
+                out.push(major | 25);
+                out.extend_from_slice(&(value as u16).to_be_bytes());
+            }
+            0x1_0000..=0xFFFF_FFFF => {
+                out.push(major | 26);
+                out.extend_from_slice(&(value as u32).to_be_bytes());
+            }
+            _ => {
+                out.push(major | 27);
+                out.extend_from_slice(&value.to_be_bytes());
+            }
+        }
+    }
+
+    fn manifest(fields: &[(&str, u64)]) -> Vec<u8> {
+        let mut out = Vec::new();
+        head(&mut out, MAJOR_TAG, TAG_FRAME_MANIFEST);
+        head(&mut out, MAJOR_MAP, fields.len() as u64);
+        for (key, value) in fields {
+            head(&mut out, MAJOR_TEXT, key.len() as u64);
+            out.extend_from_slice(key.as_bytes());
+            head(&mut out, MAJOR_UNSIGNED, *value);
+        }
+        out
+    }
+
+    fn frame_store(frames: &[Vec<u8>]) -> Vec<u8> {
+        let mut out = Vec::new();
+        head(&mut out, MAJOR_ARRAY, frames.len() as u64);
+        for frame in frames {
+            head(&mut out, MAJOR_TAG, TAG_RGBA_FRAME);
+            head(&mut out, MAJOR_BYTES, frame.len() as u64);
+            out.extend_from_slice(frame);
+        }
+        out
+    }
+
+    #[test]
+    fn test_read_manifest() {
+        let scratch = Scratch::new("manifest");
+        let path = scratch.0.join("clips.txt");
+        std::fs::write(
+            &path,
+            "# archive\n\n  a.yxv a.gif\nb b.gif colors=64 fps=12 dither=0 palette=first key=lobby\n",
+        )
+        .unwrap();
+
+        let entries = read_manifest(&path, &defaults()).unwrap();
+        assert_eq!(entries.len(), 2);
+        assert_eq!(entries[0].input, scratch.0.join("a.yxv"));
+        assert_eq!(entries[0].output, scratch.0.join("a.gif"));
+        assert_eq!(entries[0].settings.colors, 255);
+        assert!(entries[0].settings.shared_palette);
+        assert_eq!(entries[0].settings.palette_key, None);
+
+        let settings = &entries[1].settings;
+        assert_eq!((settings.colors, settings.fps, settings.dither), (64, 12, 0.0));
+        assert!(!settings.shared_palette);
+        assert_eq!(settings.palette_key.as_deref(), Some("lobby"));
+    }
+
+    #[test]
+    fn test_read_manifest_rejects_bad_lines() {
+        let scratch = Scratch::new("manifest_errors");
+        let path = scratch.0.join("clips.txt");
+        for line in ["a.yxv\n", "a.yxv a.gif colors=lots\n", "a.yxv a.gif palette=local\n", "a.yxv a.gif key=\n"] {
+            std::fs::write(&path, format!("ok.yxv ok.gif\n{}", line)).unwrap();
+            let err = read_manifest(&path, &defaults()).err().expect(line);
+            assert!(err.to_string().contains(":2:"), "{}: {}", line, err);
+        }
+        assert!(read_manifest(&scratch.0.join("missing.txt"), &defaults()).is_err());
+    }
+
+    #[test]
+    fn test_parse_manifest() {
+        // Unknown keys are skipped and wide heads decode like short ones
+        let bytes = manifest(&[("width", 640), ("version", 2), ("height", 480), ("channels", 3), ("frame_count", 300)]);
+        assert_eq!(parse_manifest(&bytes).unwrap(), (640, 480, 3, 300));
+
+        let mut untagged = Vec::new();
+        head(&mut untagged, MAJOR_MAP, 0);
+        assert!(parse_manifest(&untagged).is_err());
+
+        let mut wrong_tag = bytes.clone();
+        wrong_tag[2] = 0x01; // 0x1001, a frame record
+        assert!(parse_manifest(&wrong_tag).is_err());
+
+        assert!(parse_manifest(&bytes[..bytes.len() - 1]).is_err());
+        assert!(parse_manifest(&manifest(&[("width", u64::MAX)])).is_err());
+    }
+
+    #[test]
+    fn test_cbor_frames() {
+        let store = frame_store(&[vec![1, 2, 3], vec![4, 5, 6]]);
+        let mut cursor = Cbor { bytes: &store, pos: 0 };
+        assert_eq!(cursor.head().unwrap(), (MAJOR_ARRAY, 2));
+        assert_eq!(cursor.frame(3).unwrap(), &[1, 2, 3]);
+        assert!(cursor.frame(4).is_err());
+
+        let mut truncated = Cbor { bytes: &store[..store.len() - 1], pos: 0 };
+        truncated.head().unwrap();
+        truncated.frame(3).unwrap();
+        assert!(truncated.frame(3).is_err());
+
+        // Indefinite lengths are not something yxcbor writes
+        let mut indefinite = Cbor { bytes: &[0x9F], pos: 0 };
+        assert!(indefinite.head().is_err());
+    }
+
+    #[test]
+    fn test_load_yxcbor_expands_rgb() {
+        let scratch = Scratch::new("yxcbor");
+        let frames = vec![vec![10, 20, 30, 40, 50, 60], vec![70, 80, 90, 100, 110, 120]];
+        let fields = [("width", 2), ("height", 1), ("channels", 3), ("frame_count", 2)];
+        std::fs::write(scratch.0.join("manifest.cbor"), manifest(&fields)).unwrap();
+        std::fs::write(scratch.0.join("frames.cbor"), frame_store(&frames)).unwrap();
+
+        let clip = load_clip(&scratch.0, Vec::new()).unwrap();
+        assert_eq!((clip.width, clip.height, clip.frame_count), (2, 1, 2));
+        assert_eq!(
+            clip.rgba,
+            [10, 20, 30, 255, 40, 50, 60, 255, 70, 80, 90, 255, 100, 110, 120, 255]
+        );
+
+        // The manifest and the store must agree on the frame count
+        let fields = [("width", 2), ("height", 1), ("channels", 3), ("frame_count", 3)];
+        std::fs::write(scratch.0.join("manifest.cbor"), manifest(&fields)).unwrap();
+        assert!(load_clip(&scratch.0, Vec::new()).is_err());
+    }
+}
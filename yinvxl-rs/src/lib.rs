@@ -2,15 +2,17 @@
 // Reader/Writer for N×N×N voxel containers
 
 use std::fs::File;
-use std::io::{Read, Write, Seek, SeekFrom, BufReader, BufWriter};
+use std::io::{Read, Write, BufWriter};
 use std::path::Path;
 use anyhow::{Result, Context, bail};
 use byteorder::{LittleEndian, ReadBytesExt, WriteBytesExt};
 use lz4;
 use crc32fast::Hasher;
+use rayon::prelude::*;
 
 #[cfg(target_os = "macos")]
 use lzfse;
+use zstd;
 
 // Include FlatBuffers generated code
 // This will be generated by flatc from yinvxl.fbs
@@ -18,10 +20,18 @@ use lzfse;
 mod yinvxl_generated;
 use yinvxl_generated::yin_voxel::*;
 
+mod reader;
+pub use reader::YxvReader;
+
 // Constants
 const MAGIC: &[u8; 4] = b"YXV\0";
 const VERSION: u32 = 1;
 const CHUNK_ALIGNMENT: u64 = 64;
+const CHUNK_RECORD_SIZE: usize = 24;
+const ZSTD_LEVEL: i32 = 3;
+
+// Chunk flags (first byte after the checksum, zero in files from older writers)
+const CHUNK_FLAG_DELTA: u8 = 0x01;  // Frame stored XOR the previous frame
 
 // Compression types
 #[derive(Debug, Clone, Copy, PartialEq)]
@@ -44,6 +54,53 @@ impl From<CompressionType> for Compression {
     }
 }
 
+impl Compression {
+    // Compression
+    pub fn compress(self, data: &[u8]) -> Result<Vec<u8>> {
+        match self {
+            Compression::None => Ok(data.to_vec()),
+            Compression::Lz4 => {
+                let compressed = lz4::block::compress(data, None, false)?;
+                Ok(compressed)
+            }
+            #[cfg(target_os = "macos")]
+            Compression::Lzfse => {
+                // Use lzfse crate on macOS
+                Ok(lzfse::encode(data))
+            }
+            #[cfg(not(target_os = "macos"))]
+            Compression::Lzfse => {
+                bail!("LZFSE compression not available on this platform")
+            }
+            Compression::Zstd => {
+                Ok(zstd::bulk::compress(data, ZSTD_LEVEL)?)
+            }
+        }
+    }
+
+    // Decompression
+    pub fn decompress(self, data: &[u8], expected_size: usize) -> Result<Vec<u8>> {
+        match self {
+            Compression::None => Ok(data.to_vec()),
+            Compression::Lz4 => {
+                let decompressed = lz4::block::decompress(data, Some(expected_size as i32))?;
+                Ok(decompressed)
+            }
+            #[cfg(target_os = "macos")]
+            Compression::Lzfse => {
+                Ok(lzfse::decode(data))
+            }
+            #[cfg(not(target_os = "macos"))]
+            Compression::Lzfse => {
+                bail!("LZFSE decompression not available on this platform")
+            }
+            Compression::Zstd => {
+                Ok(zstd::bulk::decompress(data, expected_size)?)
+            }
+        }
+    }
+}
+
 // Chunk types
 #[derive(Debug, Clone, Copy, PartialEq)]
 pub enum ChunkType {
@@ -61,6 +118,7 @@ pub struct ChunkRecord {
     pub compressed_size: u32,
     pub uncompressed_size: u32,
     pub checksum: u32,
+    pub flags: u8,                    // CHUNK_FLAG_*
 }
 
 impl ChunkRecord {
@@ -80,9 +138,14 @@ impl ChunkRecord {
             compressed_size: reader.read_u32::<LittleEndian>()?,
             uncompressed_size: reader.read_u32::<LittleEndian>()?,
             checksum: reader.read_u32::<LittleEndian>()?,
+            flags: reader.read_u8()?,
         })
     }
 
+    fn is_delta(&self) -> bool {
+        self.flags & CHUNK_FLAG_DELTA != 0
+    }
+
     fn write_to<W: Write>(&self, writer: &mut W) -> Result<()> {
         let type_byte = match self.chunk_type {
             ChunkType::Palette => 0u8,
@@ -96,20 +159,32 @@ impl ChunkRecord {
         writer.write_u32::<LittleEndian>(self.compressed_size)?;
         writer.write_u32::<LittleEndian>(self.uncompressed_size)?;
         writer.write_u32::<LittleEndian>(self.checksum)?;
+        writer.write_u8(self.flags)?;
 
         // Pad to 24 bytes
-        writer.write_all(&[0u8; 3])?;
+        writer.write_all(&[0u8; 2])?;
 
         Ok(())
     }
 }
 
+// Chunk compressed and checksummed, ready to be placed in the file
+struct EncodedChunk {
+    chunk_type: ChunkType,
+    uncompressed_size: u32,
+    checksum: u32,
+    flags: u8,
+    data: Vec<u8>,
+}
+
 // YXV Container
 pub struct YxvContainer {
     pub dimensions: (u32, u32, u32),  // width, height, depth
     pub palette: Vec<[u8; 3]>,        // RGB palette
     pub frames: Vec<Vec<u8>>,         // Frame data (indexed)
+    pub thumbnail: Option<Vec<u8>>,   // Preview image, stored as its own chunk
     pub compression: Compression,
+    pub keyframe_interval: u32,       // 0: every frame standalone; N: every Nth frame, others XOR the previous
 }
 
 impl YxvContainer {
@@ -118,66 +193,64 @@ impl YxvContainer {
             dimensions,
             palette: Vec::new(),
             frames: Vec::new(),
+            thumbnail: None,
             compression: Compression::Lz4,
+            keyframe_interval: 0,
         }
     }
 
     // Write to file
+    // Chunks are independent, so they are compressed and checksummed across
+    // cores first; the layout then follows from the sizes and is written in order
     pub fn write_to_file<P: AsRef<Path>>(&self, path: P) -> Result<()> {
+        let chunks = self.encode_chunks()?;
+
+        // Header size does not depend on the table offset value, so build it
+        // once to measure the layout and again with the real offset
+        let timestamp = std::time::SystemTime::now()
+            .duration_since(std::time::UNIX_EPOCH)
+            .unwrap()
+            .as_secs();
+        let header_len = self.build_header(chunks.len() as u32, u64::MAX, timestamp)?.len() as u64;
+
+        let mut records = Vec::with_capacity(chunks.len());
+        let mut offset = align_up(8 + header_len, CHUNK_ALIGNMENT);
+        for chunk in &chunks {
+            records.push(ChunkRecord {
+                chunk_type: chunk.chunk_type,
+                offset,
+                compressed_size: chunk.data.len() as u32,
+                uncompressed_size: chunk.uncompressed_size,
+                checksum: chunk.checksum,
+                flags: chunk.flags,
+            });
+            offset = align_up(offset + chunk.data.len() as u64, CHUNK_ALIGNMENT);
+        }
+        let table_offset = offset;
+
+        let header_data = self.build_header(chunks.len() as u32, table_offset, timestamp)?;
+        debug_assert_eq!(header_data.len() as u64, header_len);
+
         let file = File::create(path)?;
         let mut writer = BufWriter::new(file);
 
-        // Write magic
+        // Write magic, header size and header
         writer.write_all(MAGIC)?;
-
-        // Build FlatBuffers header
-        let header_data = self.build_header()?;
-
-        // Write header size and data
         writer.write_u32::<LittleEndian>(header_data.len() as u32)?;
         writer.write_all(&header_data)?;
 
-        let mut chunks = Vec::new();
-        let mut current_offset = writer.seek(SeekFrom::Current(0))?;
-
-        // Write palette chunk
-        if !self.palette.is_empty() {
-            let palette_data = self.encode_palette();
-            let compressed = self.compress(&palette_data)?;
-            let checksum = calculate_crc32(&compressed);
-
-            chunks.push(ChunkRecord {
-                chunk_type: ChunkType::Palette,
-                offset: current_offset,
-                compressed_size: compressed.len() as u32,
-                uncompressed_size: palette_data.len() as u32,
-                checksum,
-            });
-
-            writer.write_all(&compressed)?;
-            current_offset = align_offset(&mut writer, CHUNK_ALIGNMENT)?;
-        }
-
-        // Write frame chunks
-        for frame in &self.frames {
-            let compressed = self.compress(frame)?;
-            let checksum = calculate_crc32(&compressed);
-
-            chunks.push(ChunkRecord {
-                chunk_type: ChunkType::Frame,
-                offset: current_offset,
-                compressed_size: compressed.len() as u32,
-                uncompressed_size: frame.len() as u32,
-                checksum,
-            });
-
-            writer.write_all(&compressed)?;
-            current_offset = align_offset(&mut writer, CHUNK_ALIGNMENT)?;
+        // Write chunks at their aligned offsets
+        let mut position = 8 + header_len;
+        for (chunk, record) in chunks.iter().zip(&records) {
+            write_padding(&mut writer, record.offset - position)?;
+            writer.write_all(&chunk.data)?;
+            position = record.offset + chunk.data.len() as u64;
         }
+        write_padding(&mut writer, table_offset - position)?;
 
         // Write chunk table
-        for chunk in &chunks {
-            chunk.write_to(&mut writer)?;
+        for record in &records {
+            record.write_to(&mut writer)?;
         }
 
         writer.flush()?;
@@ -185,50 +258,110 @@ impl YxvContainer {
     }
 
     // Read from file
+    // Every chunk is located through the table, then checksummed and
+    // decompressed across cores. Use YxvReader to decode slices on demand.
     pub fn read_from_file<P: AsRef<Path>>(path: P) -> Result<Self> {
-        let file = File::open(path)?;
-        let mut reader = BufReader::new(file);
-
-        // Read and verify magic
-        let mut magic = [0u8; 4];
-        reader.read_exact(&mut magic)?;
-        if &magic != MAGIC {
-            bail!("Invalid YXV file magic");
+        let mut data = Vec::new();
+        File::open(path)?.read_to_end(&mut data)?;
+
+        let info = HeaderInfo::parse(&data)?;
+
+        // Read chunk table; files without an offset keep the table at the end
+        let table_offset = info.table_offset(data.len() as u64)? as usize;
+        let table = data
+            .get(table_offset..table_offset + info.table_len())
+            .context("Truncated chunk table")?;
+        let records = parse_chunk_table(table)?;
+
+        let mut container = YxvContainer::new(info.dimensions);
+        container.compression = info.compression;
+
+        let decoded = records
+            .par_iter()
+            .enumerate()
+            .map(|(i, record)| {
+                let start = record.offset as usize;
+                let compressed = data
+                    .get(start..start + record.compressed_size as usize)
+                    .context("Chunk extends past end of file")?;
+                decode_chunk(info.compression, compressed, record).with_context(|| format!("Chunk {}", i))
+            })
+            .collect::<Result<Vec<_>>>()?;
+
+        for (record, mut chunk) in records.iter().zip(decoded) {
+            match record.chunk_type {
+                ChunkType::Palette => container.palette = decode_palette(&chunk),
+                ChunkType::Thumbnail => container.thumbnail = Some(chunk),
+                ChunkType::Frame => {
+                    // Deltas chain back to a keyframe, so resolve them in file order
+                    if record.is_delta() {
+                        let base = container.frames.last().context("Delta frame without a previous frame")?;
+                        xor_in_place(&mut chunk, base)?;
+                    }
+                    container.frames.push(chunk);
+                }
+                ChunkType::Metadata => {}
+            }
         }
 
-        // Read header
-        let header_size = reader.read_u32::<LittleEndian>()?;
-        let mut header_data = vec![0u8; header_size as usize];
-        reader.read_exact(&mut header_data)?;
-
-        // Parse header with FlatBuffers
-        let header = flatbuffers::root::<VoxelHeader>(&header_data)
-            .context("Failed to parse FlatBuffers header")?;
-
-        // Extract dimensions
-        let dims = header.dimensions()
-            .context("Missing dimensions in header")?;
-        let dimensions = (
-            dims.get(0) as u32,
-            dims.get(1) as u32,
-            dims.get(2) as u32,
-        );
+        Ok(container)
+    }
 
-        // Extract compression
-        let compression = Compression::from(header.compression());
+    // Compress and checksum the palette, thumbnail and every frame in parallel, in file order
+    // Small chunks come first so a lazy reader's first render touches the start of the file
+    fn encode_chunks(&self) -> Result<Vec<EncodedChunk>> {
+        let palette_data = self.encode_palette();
 
-        // Read chunk table (simplified for now)
-        // In production, read from header.chunk_table_offset()
+        // (type, bytes, previous frame when stored as a delta)
+        let mut sources: Vec<(ChunkType, &[u8], Option<&[u8]>)> = Vec::with_capacity(2 + self.frames.len());
+        if !self.palette.is_empty() {
+            sources.push((ChunkType::Palette, palette_data.as_slice(), None));
+        }
+        if let Some(thumbnail) = &self.thumbnail {
+            sources.push((ChunkType::Thumbnail, thumbnail.as_slice(), None));
+        }
+        for (i, frame) in self.frames.iter().enumerate() {
+            sources.push((ChunkType::Frame, frame.as_slice(), self.delta_base(i)));
+        }
 
-        let mut container = YxvContainer::new(dimensions);
-        container.compression = compression;
+        sources
+            .par_iter()
+            .map(|&(chunk_type, raw, base)| {
+                let delta;
+                let (payload, flags) = match base {
+                    Some(base) => {
+                        delta = xor_bytes(raw, base);
+                        (delta.as_slice(), CHUNK_FLAG_DELTA)
+                    }
+                    None => (raw, 0),
+                };
+
+                let data = self.compression.compress(payload)?;
+                Ok(EncodedChunk {
+                    chunk_type,
+                    uncompressed_size: raw.len() as u32,
+                    checksum: calculate_crc32(&data),
+                    flags,
+                    data,
+                })
+            })
+            .collect()
+    }
 
-        Ok(container)
+    // Previous frame for frames stored as deltas; keyframes (and size changes) stand alone
+    fn delta_base(&self, index: usize) -> Option<&[u8]> {
+        let interval = self.keyframe_interval as usize;
+        if interval == 0 || index % interval == 0 {
+            return None;
+        }
+        let base = &self.frames[index - 1];
+        (base.len() == self.frames[index].len()).then(|| base.as_slice())
     }
 
     // Build FlatBuffers header
-    fn build_header(&self) -> Result<Vec<u8>> {
+    fn build_header(&self, chunk_count: u32, chunk_table_offset: u64, timestamp: u64) -> Result<Vec<u8>> {
         let mut builder = flatbuffers::FlatBufferBuilder::new();
+        let creator = builder.create_string("yinvxl-rs");
 
         // Create dimensions vector
         let dims = builder.create_vector(&[
@@ -249,14 +382,11 @@ impl YxvContainer {
                 Compression::Lzfse => CompressionType::LZFSE,
                 Compression::Zstd => CompressionType::ZSTD,
             },
-            chunk_count: (1 + self.frames.len()) as u32,  // palette + frames
-            chunk_table_offset: 0,  // Will be set later
+            chunk_count,
+            chunk_table_offset,
             view_hints: None,
-            creator: Some(builder.create_string("yinvxl-rs")),
-            creation_timestamp: Some(std::time::SystemTime::now()
-                .duration_since(std::time::UNIX_EPOCH)
-                .unwrap()
-                .as_secs()),
+            creator: Some(creator),
+            creation_timestamp: Some(timestamp),
             frame_rate: 30,
             metadata: None,
         });
@@ -273,84 +403,116 @@ impl YxvContainer {
         }
         data
     }
+}
 
-    // Compression
-    fn compress(&self, data: &[u8]) -> Result<Vec<u8>> {
-        match self.compression {
-            Compression::None => Ok(data.to_vec()),
-            Compression::Lz4 => {
-                let compressed = lz4::block::compress(data, None, false)?;
-                Ok(compressed)
-            }
-            #[cfg(target_os = "macos")]
-            Compression::Lzfse => {
-                // Use lzfse crate on macOS
-                Ok(lzfse::encode(data))
-            }
-            #[cfg(not(target_os = "macos"))]
-            Compression::Lzfse => {
-                bail!("LZFSE compression not available on this platform")
-            }
-            Compression::Zstd => {
-                #[cfg(any(target_os = "windows", target_os = "linux"))]
-                {
-                    Ok(zstd::encode_all(data, 3)?)
-                }
-                #[cfg(not(any(target_os = "windows", target_os = "linux")))]
-                {
-                    bail!("ZSTD compression not available on this platform")
-                }
-            }
+// Header fields needed to locate and decode chunks
+struct HeaderInfo {
+    dimensions: (u32, u32, u32),
+    compression: Compression,
+    chunk_count: u32,
+    chunk_table_offset: u64,
+}
+
+impl HeaderInfo {
+    // Parse magic, header size and the FlatBuffers header from the start of a file
+    fn parse(prefix: &[u8]) -> Result<Self> {
+        // Read and verify magic
+        if prefix.len() < 8 || &prefix[0..4] != MAGIC {
+            bail!("Invalid YXV file magic");
         }
+
+        // Read header
+        let header_size = (&prefix[4..8]).read_u32::<LittleEndian>()? as usize;
+        let header_data = prefix.get(8..8 + header_size).context("Truncated YXV header")?;
+
+        // Parse header with FlatBuffers
+        let header = flatbuffers::root::<VoxelHeader>(header_data)
+            .context("Failed to parse FlatBuffers header")?;
+
+        // Extract dimensions
+        let dims = header.dimensions()
+            .context("Missing dimensions in header")?;
+        let dimensions = (
+            dims.get(0) as u32,
+            dims.get(1) as u32,
+            dims.get(2) as u32,
+        );
+
+        Ok(HeaderInfo {
+            dimensions,
+            compression: Compression::from(header.compression()),
+            chunk_count: header.chunk_count(),
+            chunk_table_offset: header.chunk_table_offset(),
+        })
     }
 
-    // Decompression
-    fn decompress(&self, data: &[u8], expected_size: usize) -> Result<Vec<u8>> {
-        match self.compression {
-            Compression::None => Ok(data.to_vec()),
-            Compression::Lz4 => {
-                let decompressed = lz4::block::decompress(data, Some(expected_size as i32))?;
-                Ok(decompressed)
-            }
-            #[cfg(target_os = "macos")]
-            Compression::Lzfse => {
-                Ok(lzfse::decode(data))
-            }
-            #[cfg(not(target_os = "macos"))]
-            Compression::Lzfse => {
-                bail!("LZFSE decompression not available on this platform")
-            }
-            Compression::Zstd => {
-                #[cfg(any(target_os = "windows", target_os = "linux"))]
-                {
-                    Ok(zstd::decode_all(data)?)
-                }
-                #[cfg(not(any(target_os = "windows", target_os = "linux")))]
-                {
-                    bail!("ZSTD decompression not available on this platform")
-                }
-            }
+    fn table_len(&self) -> usize {
+        self.chunk_count as usize * CHUNK_RECORD_SIZE
+    }
+
+    // Files without an offset keep the table at the end
+    fn table_offset(&self, file_len: u64) -> Result<u64> {
+        match self.chunk_table_offset {
+            0 => file_len.checked_sub(self.table_len() as u64).context("Truncated chunk table"),
+            offset => Ok(offset),
         }
     }
 }
 
 // Utility functions
 
+fn parse_chunk_table(table: &[u8]) -> Result<Vec<ChunkRecord>> {
+    table
+        .chunks_exact(CHUNK_RECORD_SIZE)
+        .map(|mut record| ChunkRecord::read_from(&mut record))
+        .collect()
+}
+
+// Verify one chunk's checksum and decompress it
+fn decode_chunk(compression: Compression, compressed: &[u8], record: &ChunkRecord) -> Result<Vec<u8>> {
+    if calculate_crc32(compressed) != record.checksum {
+        bail!("Checksum mismatch");
+    }
+
+    let decompressed = compression.decompress(compressed, record.uncompressed_size as usize)?;
+    if decompressed.len() != record.uncompressed_size as usize {
+        bail!("Expected {} bytes, decompressed {}", record.uncompressed_size, decompressed.len());
+    }
+    Ok(decompressed)
+}
+
+// Restore a delta frame against its decoded predecessor
+fn xor_in_place(delta: &mut [u8], base: &[u8]) -> Result<()> {
+    if delta.len() != base.len() {
+        bail!("Delta frame is {} bytes, previous frame {}", delta.len(), base.len());
+    }
+    for (d, &b) in delta.iter_mut().zip(base) {
+        *d ^= b;
+    }
+    Ok(())
+}
+
+fn xor_bytes(a: &[u8], b: &[u8]) -> Vec<u8> {
+    a.iter().zip(b).map(|(&x, &y)| x ^ y).collect()
+}
+
+fn decode_palette(data: &[u8]) -> Vec<[u8; 3]> {
+    data.chunks_exact(3).map(|c| [c[0], c[1], c[2]]).collect()
+}
+
 fn calculate_crc32(data: &[u8]) -> u32 {
     let mut hasher = Hasher::new();
     hasher.update(data);
     hasher.finalize()
 }
 
-fn align_offset<W: Write + Seek>(writer: &mut W, alignment: u64) -> Result<u64> {
-    let current = writer.seek(SeekFrom::Current(0))?;
-    let padding = (alignment - (current % alignment)) % alignment;
-
-    if padding > 0 {
-        writer.write_all(&vec![0u8; padding as usize])?;
-    }
+fn align_up(offset: u64, alignment: u64) -> u64 {
+    (offset + alignment - 1) / alignment * alignment
+}
 
-    Ok(writer.seek(SeekFrom::Current(0))?)
+fn write_padding<W: Write>(writer: &mut W, padding: u64) -> Result<()> {
+    writer.write_all(&[0u8; CHUNK_ALIGNMENT as usize][..padding as usize])?;
+    Ok(())
 }
 
 // FFI exports for iOS/macOS integration
@@ -383,4 +545,129 @@ mod ffi {
         // Implementation for FFI read
         0
     }
-}
\ No newline at end of file
+}
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Scratch file under the system temp dir, removed when dropped
+    pub(crate) struct TempFile(pub std::path::PathBuf);
+
+    impl TempFile {
+        pub(crate) fn new(name: &str) -> Self {
+            TempFile(std::env::temp_dir().join(format!("yxv_test_{}_{}.yxv", name, std::process::id())))
+        }
+    }
+
+    impl Drop for TempFile {
+        fn drop(&mut self) {
+            let _ = std::fs::remove_file(&self.0);
+        }
+    }
+
+    /// A side³ cube whose slices drift a little each frame, like a capture
+    pub(crate) fn test_container(side: u32, keyframe_interval: u32) -> YxvContainer {
+        let mut container = YxvContainer::new((side, side, side));
+        container.palette = (0..=255u8).map(|i| [i, 255 - i, i / 2]).collect();
+        container.frames = (0..side as usize)
+            .map(|z| (0..(side * side) as usize).map(|i| ((i / 7 + z) % 251) as u8).collect())
+            .collect();
+        container.keyframe_interval = keyframe_interval;
+        container
+    }
+
+    fn chunk_table(path: &Path) -> Vec<ChunkRecord> {
+        let data = std::fs::read(path).unwrap();
+        let info = HeaderInfo::parse(&data).unwrap();
+        let offset = info.table_offset(data.len() as u64).unwrap() as usize;
+        parse_chunk_table(&data[offset..offset + info.table_len()]).unwrap()
+    }
+
+    #[test]
+    fn test_round_trip_keyframe_intervals() {
+        let file = TempFile::new("keyframes");
+        for keyframe_interval in [0, 1, 3, 8] {
+            for compression in [Compression::None, Compression::Lz4, Compression::Zstd] {
+                let mut container = test_container(16, keyframe_interval);
+                container.compression = compression;
+                container.write_to_file(&file.0).unwrap();
+
+                let read = YxvContainer::read_from_file(&file.0).unwrap();
+                assert_eq!(read.dimensions, container.dimensions);
+                assert_eq!(read.compression, compression);
+                assert_eq!(read.palette, container.palette);
+                assert_eq!(read.frames, container.frames, "interval {}, {:?}", keyframe_interval, compression);
+
+                // Every Nth frame stands alone; 0 and 1 store no deltas at all
+                let deltas: Vec<bool> = chunk_table(&file.0)
+                    .iter()
+                    .filter(|record| record.chunk_type == ChunkType::Frame)
+                    .map(ChunkRecord::is_delta)
+                    .collect();
+                let expected: Vec<bool> = (0..16)
+                    .map(|i| keyframe_interval > 1 && i % keyframe_interval as usize != 0)
+                    .collect();
+                assert_eq!(deltas, expected);
+            }
+        }
+    }
+
+    #[test]
+    fn test_legacy_chunk_table_without_flags() {
+        // Writers before ChunkRecord.flags padded each record with three zero bytes
+        // after the checksum and had no delta frames
+        let file = TempFile::new("legacy");
+        let mut container = test_container(8, 0);
+        container.thumbnail = Some(vec![7; 48]);
+        container.write_to_file(&file.0).unwrap();
+
+        let records = chunk_table(&file.0);
+        let mut legacy_table = Vec::with_capacity(records.len() * CHUNK_RECORD_SIZE);
+        for record in &records {
+            let type_byte = match record.chunk_type {
+                ChunkType::Palette => 0u8,
+                ChunkType::Frame => 1,
+                ChunkType::Metadata => 2,
+                ChunkType::Thumbnail => 3,
+            };
+            legacy_table.push(type_byte);
+            legacy_table.write_u64::<LittleEndian>(record.offset).unwrap();
+            legacy_table.write_u32::<LittleEndian>(record.compressed_size).unwrap();
+            legacy_table.write_u32::<LittleEndian>(record.uncompressed_size).unwrap();
+            legacy_table.write_u32::<LittleEndian>(record.checksum).unwrap();
+            legacy_table.extend_from_slice(&[0u8; 3]);
+        }
+
+        let mut data = std::fs::read(&file.0).unwrap();
+        let table_start = data.len() - legacy_table.len();
+        assert_eq!(&data[table_start..], &legacy_table[..], "standalone frames keep the legacy layout");
+        data[table_start..].copy_from_slice(&legacy_table);
+        std::fs::write(&file.0, &data).unwrap();
+
+        let read = YxvContainer::read_from_file(&file.0).unwrap();
+        assert_eq!(read.frames, container.frames);
+        assert_eq!(read.thumbnail, container.thumbnail);
+
+        let reader = YxvReader::open(&file.0).unwrap();
+        assert_eq!(reader.frames(0..8).unwrap().iter().map(|f| f.to_vec()).collect::<Vec<_>>(), container.frames);
+        assert_eq!(*reader.frame(5).unwrap(), container.frames[5]);
+        assert_eq!(reader.thumbnail().unwrap(), container.thumbnail);
+    }
+
+    #[test]
+    fn test_delta_needs_a_previous_frame() {
+        let file = TempFile::new("orphan_delta");
+        test_container(4, 2).write_to_file(&file.0).unwrap();
+
+        // Mark the first frame as a delta: there's nothing before it to resolve against
+        let mut data = std::fs::read(&file.0).unwrap();
+        let info = HeaderInfo::parse(&data).unwrap();
+        let table_start = info.table_offset(data.len() as u64).unwrap() as usize;
+        let first_frame = chunk_table(&file.0).iter().position(|r| r.chunk_type == ChunkType::Frame).unwrap();
+        data[table_start + first_frame * CHUNK_RECORD_SIZE + 21] = CHUNK_FLAG_DELTA;
+        std::fs::write(&file.0, &data).unwrap();
+
+        assert!(YxvContainer::read_from_file(&file.0).is_err());
+        assert!(YxvReader::open(&file.0).unwrap().frame(1).is_err());
+    }
+}
@@ -0,0 +1,350 @@
+// Lazy YXV reader
+// Opens only the header and chunk table; frames and the thumbnail are read and
+// decoded on demand, with recently used slices kept in a small LRU cache.
+// Delta frames cost at most keyframe_interval - 1 extra decodes on a cold seek.
+
+use std::fs::File;
+use std::io::{Read, Seek, SeekFrom};
+use std::ops::Range;
+use std::path::Path;
+use std::sync::{Arc, Mutex};
+use anyhow::{Result, Context, bail};
+use rayon::prelude::*;
+
+use super::{ChunkRecord, ChunkType, Compression, HeaderInfo, decode_chunk, decode_palette, parse_chunk_table, xor_in_place};
+
+/// Decoded slices kept by default; a few screens of scrubbing at 256³
+const DEFAULT_SLICE_CACHE: usize = 16;
+
+/// Largest magic + size + FlatBuffers header read up front
+const MAX_HEADER_PREFIX: u64 = 64 * 1024;
+
+// Least-recently-used cache of decoded frames, keyed by frame index
+// Capacity is small, so a linear scan beats any map
+struct SliceCache {
+    capacity: usize,
+    tick: u64,
+    entries: Vec<(usize, u64, Arc<Vec<u8>>)>,  // index, last use, slice
+}
+
+impl SliceCache {
+    fn new(capacity: usize) -> Self {
+        SliceCache {
+            capacity,
+            tick: 0,
+            entries: Vec::with_capacity(capacity),
+        }
+    }
+
+    fn get(&mut self, index: usize) -> Option<Arc<Vec<u8>>> {
+        self.tick += 1;
+        let tick = self.tick;
+        self.entries.iter_mut().find(|e| e.0 == index).map(|e| {
+            e.1 = tick;
+            e.2.clone()
+        })
+    }
+
+    fn insert(&mut self, index: usize, slice: Arc<Vec<u8>>) {
+        if self.capacity == 0 {
+            return;
+        }
+        self.tick += 1;
+        if let Some(entry) = self.entries.iter_mut().find(|e| e.0 == index) {
+            *entry = (index, self.tick, slice);
+            return;
+        }
+        if self.entries.len() == self.capacity {
+            let oldest = (0..self.entries.len()).min_by_key(|&i| self.entries[i].1).unwrap();
+            self.entries.swap_remove(oldest);
+        }
+        self.entries.push((index, self.tick, slice));
+    }
+}
+
+/// On-demand view of a YXV file
+///
+/// Opening costs one header read and one chunk table read regardless of cube
+/// size; memory is bounded by the slice cache. All methods take `&self` and
+/// may be called from several threads.
+pub struct YxvReader {
+    file: Mutex<File>,
+    dimensions: (u32, u32, u32),
+    compression: Compression,
+    palette: Vec<[u8; 3]>,
+    frame_records: Vec<ChunkRecord>,
+    thumbnail_record: Option<ChunkRecord>,
+    cache: Mutex<SliceCache>,
+}
+
+impl YxvReader {
+    pub fn open<P: AsRef<Path>>(path: P) -> Result<Self> {
+        Self::open_with_cache(path, DEFAULT_SLICE_CACHE)
+    }
+
+    /// Open with room for `cache_slices` decoded frames (0 disables caching)
+    pub fn open_with_cache<P: AsRef<Path>>(path: P, cache_slices: usize) -> Result<Self> {
+        let mut file = File::open(path)?;
+        let file_len = file.metadata()?.len();
+
+        // Magic, header size and header
+        let mut prefix = vec![0u8; file_len.min(MAX_HEADER_PREFIX) as usize];
+        file.read_exact(&mut prefix)?;
+        let info = match HeaderInfo::parse(&prefix) {
+            Ok(info) => info,
+            Err(_) if file_len > MAX_HEADER_PREFIX => {
+                // Uncommonly large header: fetch exactly what it declares
+                let header_size = u32::from_le_bytes([prefix[4], prefix[5], prefix[6], prefix[7]]) as usize;
+                prefix.resize(8 + header_size, 0);
+                file.seek(SeekFrom::Start(0))?;
+                file.read_exact(&mut prefix)?;
+                HeaderInfo::parse(&prefix)?
+            }
+            Err(err) => return Err(err),
+        };
+
+        // Chunk table
+        let mut table = vec![0u8; info.table_len()];
+        file.seek(SeekFrom::Start(info.table_offset(file_len)?))?;
+        file.read_exact(&mut table).context("Truncated chunk table")?;
+        let records = parse_chunk_table(&table)?;
+
+        let mut reader = YxvReader {
+            file: Mutex::new(file),
+            dimensions: info.dimensions,
+            compression: info.compression,
+            palette: Vec::new(),
+            frame_records: Vec::new(),
+            thumbnail_record: None,
+            cache: Mutex::new(SliceCache::new(cache_slices)),
+        };
+
+        // The palette is a few hundred bytes and needed for any render, so decode it now
+        for record in records {
+            match record.chunk_type {
+                ChunkType::Palette => reader.palette = decode_palette(&reader.decode(&record)?),
+                ChunkType::Thumbnail => reader.thumbnail_record = Some(record),
+                ChunkType::Frame => reader.frame_records.push(record),
+                ChunkType::Metadata => {}
+            }
+        }
+
+        Ok(reader)
+    }
+
+    pub fn dimensions(&self) -> (u32, u32, u32) {
+        self.dimensions
+    }
+
+    pub fn compression(&self) -> Compression {
+        self.compression
+    }
+
+    pub fn palette(&self) -> &[[u8; 3]] {
+        &self.palette
+    }
+
+    pub fn frame_count(&self) -> usize {
+        self.frame_records.len()
+    }
+
+    /// Decode one Z-slice, or return it from the cache
+    /// A delta frame is rebuilt from the nearest cached slice or keyframe before it
+    pub fn frame(&self, index: usize) -> Result<Arc<Vec<u8>>> {
+        self.frame_record(index)?;
+        if let Some(slice) = self.cache.lock().unwrap().get(index) {
+            return Ok(slice);
+        }
+
+        // Walk back to a starting point, then decode forward
+        let mut first = index;
+        let mut base: Option<Arc<Vec<u8>>> = None;
+        while self.frame_records[first].is_delta() {
+            if first == 0 {
+                bail!("Frame 0 is a delta frame");
+            }
+            first -= 1;
+            if let Some(slice) = self.cache.lock().unwrap().get(first) {
+                base = Some(slice);
+                first += 1;
+                break;
+            }
+        }
+
+        for k in first..=index {
+            let slice = self.decode(&self.frame_records[k]).with_context(|| format!("Frame {}", k))?;
+            base = Some(self.resolve(k, slice, base.as_deref())?);
+        }
+        Ok(base.unwrap())
+    }
+
+    /// Decode a run of Z-slices; cache misses are read in file order and
+    /// decompressed across cores
+    pub fn frames(&self, range: Range<usize>) -> Result<Vec<Arc<Vec<u8>>>> {
+        if range.end > self.frame_records.len() {
+            bail!("Frame range {:?} out of bounds ({} frames)", range, self.frame_records.len());
+        }
+
+        let mut slices: Vec<Option<Arc<Vec<u8>>>> = {
+            let mut cache = self.cache.lock().unwrap();
+            range.clone().map(|index| cache.get(index)).collect()
+        };
+
+        let mut misses = Vec::new();
+        for (index, slice) in range.clone().zip(&slices) {
+            if slice.is_none() {
+                misses.push((index, self.read_compressed(&self.frame_records[index])?));
+            }
+        }
+
+        let decoded = misses
+            .par_iter()
+            .map(|(index, compressed)| {
+                decode_chunk(self.compression, compressed, &self.frame_records[*index])
+                    .with_context(|| format!("Frame {}", index))
+            })
+            .collect::<Result<Vec<_>>>()?;
+
+        // Resolve deltas in order; the first one in the range may need its predecessor
+        let mut decoded = decoded.into_iter();
+        for (index, _) in &misses {
+            let offset = index - range.start;
+            let base = match offset {
+                0 if self.frame_records[*index].is_delta() => Some(self.frame(index - 1)?),
+                0 => None,
+                _ => slices[offset - 1].clone(),
+            };
+            slices[offset] = Some(self.resolve(*index, decoded.next().unwrap(), base.as_deref())?);
+        }
+
+        Ok(slices.into_iter().map(|slice| slice.unwrap()).collect())
+    }
+
+    /// Decode the thumbnail chunk, if the file has one; not cached
+    pub fn thumbnail(&self) -> Result<Option<Vec<u8>>> {
+        match &self.thumbnail_record {
+            Some(record) => Ok(Some(self.decode(record).context("Thumbnail")?)),
+            None => Ok(None),
+        }
+    }
+
+    /// Decoded slices currently held
+    pub fn cached_slices(&self) -> usize {
+        self.cache.lock().unwrap().entries.len()
+    }
+
+    fn frame_record(&self, index: usize) -> Result<&ChunkRecord> {
+        self.frame_records
+            .get(index)
+            .with_context(|| format!("Frame {} out of bounds ({} frames)", index, self.frame_records.len()))
+    }
+
+    // Apply a delta against the previous slice if needed, then cache the result
+    fn resolve(&self, index: usize, mut slice: Vec<u8>, previous: Option<&Vec<u8>>) -> Result<Arc<Vec<u8>>> {
+        if self.frame_records[index].is_delta() {
+            let base = previous.with_context(|| format!("Frame {} has no base frame", index))?;
+            xor_in_place(&mut slice, base)?;
+        }
+        let slice = Arc::new(slice);
+        self.cache.lock().unwrap().insert(index, slice.clone());
+        Ok(slice)
+    }
+
+    fn read_compressed(&self, record: &ChunkRecord) -> Result<Vec<u8>> {
+        let mut compressed = vec![0u8; record.compressed_size as usize];
+        let mut file = self.file.lock().unwrap();
+        file.seek(SeekFrom::Start(record.offset))?;
+        file.read_exact(&mut compressed).context("Chunk extends past end of file")?;
+        Ok(compressed)
+    }
+
+    fn decode(&self, record: &ChunkRecord) -> Result<Vec<u8>> {
+        let compressed = self.read_compressed(record)?;
+        decode_chunk(self.compression, &compressed, record)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::tests::{test_container, TempFile};
+
+    fn owned(slices: Vec<Arc<Vec<u8>>>) -> Vec<Vec<u8>> {
+        slices.iter().map(|slice| slice.to_vec()).collect()
+    }
+
+    #[test]
+    fn test_cold_seek_into_delta_run() {
+        let file = TempFile::new("cold_seek");
+        let container = test_container(16, 4);
+        container.write_to_file(&file.0).unwrap();
+
+        // Each frame from a freshly opened reader: deltas rebuild from their keyframe
+        for cache_slices in [0, 1, DEFAULT_SLICE_CACHE] {
+            for index in [1, 2, 3, 6, 15] {
+                let reader = YxvReader::open_with_cache(&file.0, cache_slices).unwrap();
+                assert_eq!(*reader.frame(index).unwrap(), container.frames[index], "frame {}, cache {}", index, cache_slices);
+                assert!(reader.cached_slices() <= cache_slices);
+            }
+        }
+        let reader = YxvReader::open(&file.0).unwrap();
+        assert!(reader.frame(16).is_err());
+    }
+
+    #[test]
+    fn test_range_reads_with_small_caches() {
+        let file = TempFile::new("ranges");
+        let mut container = test_container(16, 4);
+        container.thumbnail = Some((0..64).collect());
+        container.write_to_file(&file.0).unwrap();
+
+        for cache_slices in [0, 1] {
+            let reader = YxvReader::open_with_cache(&file.0, cache_slices).unwrap();
+            // Starts mid-run, so the first slice needs its predecessors
+            assert_eq!(owned(reader.frames(6..11).unwrap()), container.frames[6..11]);
+            assert_eq!(owned(reader.frames(0..16).unwrap()), container.frames);
+            assert!(reader.frames(10..10).unwrap().is_empty());
+            assert!(reader.frames(12..17).is_err());
+            assert_eq!(reader.cached_slices(), cache_slices);
+
+            // Walking forward with one cached slice reuses it as each delta's base
+            for index in 0..16 {
+                assert_eq!(*reader.frame(index).unwrap(), container.frames[index]);
+            }
+            assert_eq!(reader.thumbnail().unwrap(), container.thumbnail);
+            assert_eq!(reader.palette(), &container.palette[..]);
+        }
+
+        test_container(4, 0).write_to_file(&file.0).unwrap();
+        assert_eq!(YxvReader::open_with_cache(&file.0, 0).unwrap().thumbnail().unwrap(), None);
+    }
+
+    #[test]
+    fn test_slice_cache_evicts_least_recently_used() {
+        let slice = |v: u8| Arc::new(vec![v]);
+        let mut cache = SliceCache::new(2);
+        cache.insert(0, slice(0));
+        cache.insert(1, slice(1));
+        assert!(cache.get(0).is_some()); // 1 is now the oldest
+        cache.insert(2, slice(2));
+        assert!(cache.get(1).is_none());
+        assert_eq!(*cache.get(0).unwrap(), vec![0]);
+        assert_eq!(*cache.get(2).unwrap(), vec![2]);
+
+        // Reinserting an index replaces it in place
+        cache.insert(2, slice(9));
+        assert_eq!(cache.entries.len(), 2);
+        assert_eq!(*cache.get(2).unwrap(), vec![9]);
+
+        let mut single = SliceCache::new(1);
+        single.insert(3, slice(3));
+        single.insert(4, slice(4));
+        assert!(single.get(3).is_none());
+        assert!(single.get(4).is_some());
+
+        let mut disabled = SliceCache::new(0);
+        disabled.insert(0, slice(0));
+        assert!(disabled.get(0).is_none());
+        assert!(disabled.entries.is_empty());
+    }
+}
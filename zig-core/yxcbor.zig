@@ -16,23 +16,33 @@ pub const FrameManifest = extern struct {
     frame_count: u32,
 };
 
-// Global writer state for streaming API
-var g_writer: ?Writer = null;
-var g_reader: ?Reader = null;
-
-const Writer = struct {
+// Process-wide handles behind the legacy single-stream API
+var g_writer: ?*Writer = null;
+var g_async_writer: ?*AsyncWriter = null;
+var g_reader: ?*Reader = null;
+
+// Streaming writer handle. Every frame record has the same encoded size, so
+// a frame's file offset follows from its index and frames are written with
+// positional I/O: no shared cursor, safe to call from several threads.
+pub const Writer = struct {
     dir_path: []u8,
     manifest: FrameManifest,
-    frames_file: ?std.fs.File,
-    current_frame: u32,
+    frames_file: std.fs.File,
+    header_len: u64,               // Bytes before frame 0 (array header)
+    record_len: u64,               // Tag + byte-string header + pixel bytes
+    next_frame: std.atomic.Value(u32), // Next index claimed by write_frame
+    frames_written: std.atomic.Value(u32),
     allocator: std.mem.Allocator,
 };
 
-const Reader = struct {
+// Streaming reader handle. Frames are read with positional I/O from a
+// prebuilt offset table, so concurrent reads on one handle are safe.
+pub const Reader = struct {
     dir_path: []u8,
     manifest: FrameManifest,
-    frames_file: ?std.fs.File,
-    frame_offsets: []u64,
+    frames_file: std.fs.File,
+    frame_offsets: []u64,          // Offset of each frame's pixel bytes
+    mapped: ?[]align(std.heap.page_size_min) const u8, // Whole frames.cbor when opened mapped
     allocator: std.mem.Allocator,
 };
 
@@ -212,8 +222,8 @@ fn loadManifest(allocator: std.mem.Allocator, dir_path: []const u8) !FrameManife
     const file = try std.fs.cwd().openFile(manifest_path, .{});
     defer file.close();
 
-    var read_buf: [4096]u8 = undefined;
-    const reader = file.reader(&read_buf);
+    var buffered = std.io.bufferedReader(file.reader());
+    const reader = buffered.reader();
 
     // Read tag
     const tag = try cbor.readTag(reader);
@@ -249,11 +259,24 @@ fn loadManifest(allocator: std.mem.Allocator, dir_path: []const u8) !FrameManife
     return manifest;
 }
 
+// Encode the tag and byte-string header that precede a frame's pixels
+fn framePrefix(buf: *[16]u8, frame_len: u64) ![]const u8 {
+    var stream = std.io.fixedBufferStream(buf);
+    const writer = stream.writer();
+    try cbor.writeTag(writer, TAG_RGBA_FRAME);
+    try cbor.writeTypeAndValue(writer, cbor.MAJOR_BYTES, frame_len);
+    return stream.getWritten();
+}
+
+fn frameLen(manifest: *const FrameManifest) u64 {
+    return @as(u64, manifest.width) * manifest.height * manifest.channels;
+}
+
 // ============ C API Implementation ============
 
-// Writer API
-export fn yxcbor_open_writer(dir_path: [*:0]const u8, manifest: *const FrameManifest) c_int {
-    if (g_writer != null) return -1; // Already open
+// Handle-based writer API
+export fn yxcbor_writer_open(dir_path: [*:0]const u8, manifest: *const FrameManifest, out_writer: *?*Writer) c_int {
+    out_writer.* = null;
 
     const allocator = std.heap.raw_c_allocator;
     const dir_slice = std.mem.span(dir_path);
@@ -268,12 +291,22 @@ export fn yxcbor_open_writer(dir_path: [*:0]const u8, manifest: *const FrameMani
     var path_buf: [4096]u8 = undefined;
     const frames_path = std.fmt.bufPrint(&path_buf, "{s}/frames.cbor", .{dir_slice}) catch return -4;
 
-    const frames_file = std.fs.cwd().createFile(frames_path, .{}) catch return -5;
+    const frames_file = std.fs.cwd().createFile(frames_path, .{ .read = true }) catch return -5;
 
     // Write CBOR array header for frames
-    var write_buf: [4096]u8 = undefined;
-    const writer = frames_file.writer(&write_buf);
-    cbor.writeArrayHeader(writer, manifest.frame_count) catch {
+    var header_buf: [16]u8 = undefined;
+    var header = std.io.fixedBufferStream(&header_buf);
+    cbor.writeArrayHeader(header.writer(), manifest.frame_count) catch {
+        frames_file.close();
+        return -6;
+    };
+    frames_file.pwriteAll(header.getWritten(), 0) catch {
+        frames_file.close();
+        return -6;
+    };
+
+    var prefix_buf: [16]u8 = undefined;
+    const prefix = framePrefix(&prefix_buf, frameLen(manifest)) catch {
         frames_file.close();
         return -6;
     };
@@ -285,54 +318,360 @@ export fn yxcbor_open_writer(dir_path: [*:0]const u8, manifest: *const FrameMani
     };
     @memcpy(dir_copy, dir_slice);
 
-    g_writer = Writer{
+    const writer_state = allocator.create(Writer) catch {
+        allocator.free(dir_copy);
+        frames_file.close();
+        return -7;
+    };
+    writer_state.* = Writer{
         .dir_path = dir_copy,
         .manifest = manifest.*,
         .frames_file = frames_file,
-        .current_frame = 0,
+        .header_len = header.getWritten().len,
+        .record_len = prefix.len + frameLen(manifest),
+        .next_frame = std.atomic.Value(u32).init(0),
+        .frames_written = std.atomic.Value(u32).init(0),
         .allocator = allocator,
     };
 
+    out_writer.* = writer_state;
     return 0; // Success
 }
 
-export fn yxcbor_write_frame(rgba_ptr: [*]const u8, len: u32) c_int {
-    const writer_state = g_writer orelse return -1;
+// Write frame `index` (any order, any thread). Each index should be written once.
+export fn yxcbor_writer_write_frame_at(writer_state: ?*Writer, index: u32, rgba_ptr: [*]const u8, len: u32) c_int {
+    const w = writer_state orelse return -1;
+
+    if (index >= w.manifest.frame_count) return -2;
+    if (len != frameLen(&w.manifest)) return -3;
+
+    var prefix_buf: [16]u8 = undefined;
+    const prefix = framePrefix(&prefix_buf, len) catch return -5;
 
-    if (writer_state.current_frame >= writer_state.manifest.frame_count) return -2;
+    // Tagged frame data at its fixed slot
+    const offset = w.header_len + @as(u64, index) * w.record_len;
+    w.frames_file.pwriteAll(prefix, offset) catch return -5;
+    w.frames_file.pwriteAll(rgba_ptr[0..len], offset + prefix.len) catch return -6;
 
-    const expected_len = writer_state.manifest.width * writer_state.manifest.height * writer_state.manifest.channels;
-    if (len != expected_len) return -3;
+    _ = w.frames_written.fetchAdd(1, .release);
+    return 0; // Success
+}
 
-    const file = writer_state.frames_file orelse return -4;
-    var write_buf: [262144]u8 = undefined; // 256KB buffer for frame data
-    const writer = file.writer(&write_buf);
+// Append the next frame; concurrent callers each claim a distinct index
+export fn yxcbor_writer_write_frame(writer_state: ?*Writer, rgba_ptr: [*]const u8, len: u32) c_int {
+    const w = writer_state orelse return -1;
 
-    // Write tagged frame data
-    const rgba_slice = rgba_ptr[0..len];
-    cbor.writeTag(writer, TAG_RGBA_FRAME) catch return -5;
-    cbor.writeBytes(writer, rgba_slice) catch return -6;
+    if (len != frameLen(&w.manifest)) return -3;
 
-    g_writer.?.current_frame += 1;
+    const index = w.next_frame.fetchAdd(1, .monotonic);
+    if (index >= w.manifest.frame_count) {
+        _ = w.next_frame.fetchSub(1, .monotonic);
+        return -2;
+    }
 
-    return 0; // Success
+    return yxcbor_writer_write_frame_at(w, index, rgba_ptr, len);
 }
 
-export fn yxcbor_close_writer() c_int {
-    if (g_writer) |*writer_state| {
-        if (writer_state.frames_file) |file| {
-            file.close();
+// Frames completed so far
+export fn yxcbor_writer_frames_written(writer_state: ?*Writer) u32 {
+    const w = writer_state orelse return 0;
+    return w.frames_written.load(.acquire);
+}
+
+// Close the file and free the handle; no writes may be in flight
+export fn yxcbor_writer_close(writer_state: ?*Writer) c_int {
+    const w = writer_state orelse return -1;
+    const allocator = w.allocator;
+
+    w.frames_file.close();
+    allocator.free(w.dir_path);
+    allocator.destroy(w);
+    return 0;
+}
+
+// fsync policies for the write-behind writer
+pub const FSYNC_ON_CLOSE: u32 = 0;  // One fsync when the writer is closed
+pub const FSYNC_PER_BATCH: u32 = 1; // fsync after every coalesced write
+pub const FSYNC_PER_FRAME: u32 = 2; // Write and fsync frames one at a time
+
+const MAX_QUEUE_DEPTH: u32 = 256;
+const DEFAULT_QUEUE_DEPTH: u32 = 8;
+
+// Called on the flusher thread once a frame is on disk (per the fsync policy);
+// the caller's buffer may be reused from then on
+pub const CompleteFn = *const fn (ctx: ?*anyopaque, index: u32, rgba_ptr: [*]const u8, status: c_int) callconv(.C) void;
+
+pub const AsyncOptions = extern struct {
+    queue_depth: u32,            // Frames in flight before submit blocks (1-256, 0 = default)
+    fsync_policy: u32,           // FSYNC_*
+    on_complete: ?CompleteFn,
+    ctx: ?*anyopaque,
+    copy_frames: u32,            // Nonzero: copy into owned ring buffers, caller buffers are free on return
+};
+
+const PendingFrame = struct {
+    index: u32,
+    rgba_ptr: [*]const u8,
+};
+
+// Write-behind writer: submit queues the frame in a bounded ring and returns,
+// a flusher thread drains the ring and writes every queued run of consecutive
+// frames with one pwritev. Borrowed buffers stay in use until their completion
+// callback, so a full ring is the back-pressure signal.
+pub const AsyncWriter = struct {
+    writer: *Writer,
+    options: AsyncOptions,
+    ring: []PendingFrame,
+    slots: []u8,                 // queue_depth frame copies when copy_frames is set
+    head: usize,                 // Oldest frame not yet completed
+    count: usize,                // Queued plus in-flight frames
+    closing: bool,
+    status: c_int,               // First write error, sticky
+    mutex: std.Thread.Mutex,
+    not_empty: std.Thread.Condition,
+    not_full: std.Thread.Condition,
+    thread: std.Thread,
+    allocator: std.mem.Allocator,
+};
+
+// Write one run of consecutive frames, honoring the fsync policy
+fn flushRun(aw: *AsyncWriter, run: []const PendingFrame, prefix: []const u8, iovecs: []std.posix.iovec_const) c_int {
+    const w = aw.writer;
+    const len: usize = @intCast(frameLen(&w.manifest));
+
+    for (run, 0..) |frame, k| {
+        iovecs[2 * k] = .{ .base = prefix.ptr, .len = prefix.len };
+        iovecs[2 * k + 1] = .{ .base = frame.rgba_ptr, .len = len };
+    }
+
+    const offset = w.header_len + @as(u64, run[0].index) * w.record_len;
+    w.frames_file.pwritevAll(iovecs[0 .. 2 * run.len], offset) catch return -6;
+    if (aw.options.fsync_policy != FSYNC_ON_CLOSE) {
+        w.frames_file.sync() catch return -13;
+    }
+
+    _ = w.frames_written.fetchAdd(@intCast(run.len), .release);
+    return 0;
+}
+
+fn flushLoop(aw: *AsyncWriter) void {
+    var batch: [MAX_QUEUE_DEPTH]PendingFrame = undefined;
+    var iovecs: [2 * MAX_QUEUE_DEPTH]std.posix.iovec_const = undefined;
+    var prefix_buf: [16]u8 = undefined;
+    const prefix = framePrefix(&prefix_buf, frameLen(&aw.writer.manifest)) catch unreachable;
+
+    while (true) {
+        // Snapshot everything queued; slots stay owned until the batch completes
+        aw.mutex.lock();
+        while (aw.count == 0 and !aw.closing) aw.not_empty.wait(&aw.mutex);
+        const n = aw.count;
+        if (n == 0) {
+            aw.mutex.unlock();
+            return;
         }
-        writer_state.allocator.free(writer_state.dir_path);
-        g_writer = null;
-        return 0;
+        for (batch[0..n], 0..) |*frame, k| frame.* = aw.ring[(aw.head + k) % aw.ring.len];
+        aw.mutex.unlock();
+
+        // Coalesce consecutive indices; per-frame policy keeps every frame its own run
+        var status: c_int = 0;
+        var start: usize = 0;
+        while (start < n) {
+            var end = start + 1;
+            if (aw.options.fsync_policy != FSYNC_PER_FRAME) {
+                while (end < n and batch[end].index == batch[end - 1].index + 1) end += 1;
+            }
+            const rc = flushRun(aw, batch[start..end], prefix, &iovecs);
+            if (rc != 0 and status == 0) status = rc;
+            if (aw.options.on_complete) |on_complete| {
+                for (batch[start..end]) |frame| on_complete(aw.options.ctx, frame.index, frame.rgba_ptr, rc);
+            }
+            start = end;
+        }
+
+        aw.mutex.lock();
+        aw.head = (aw.head + n) % aw.ring.len;
+        aw.count -= n;
+        if (status != 0 and aw.status == 0) aw.status = status;
+        aw.not_full.broadcast();
+        aw.mutex.unlock();
     }
-    return -1; // Not open
 }
 
-// Reader API
-export fn yxcbor_open_reader(dir_path: [*:0]const u8, out_manifest: *FrameManifest) c_int {
-    if (g_reader != null) return -1; // Already open
+// Open a write-behind writer; `options` may be NULL for the defaults
+export fn yxcbor_async_writer_open(
+    dir_path: [*:0]const u8,
+    manifest: *const FrameManifest,
+    options: ?*const AsyncOptions,
+    out_writer: *?*AsyncWriter,
+) c_int {
+    out_writer.* = null;
+
+    var opts = if (options) |o| o.* else AsyncOptions{
+        .queue_depth = 0,
+        .fsync_policy = FSYNC_ON_CLOSE,
+        .on_complete = null,
+        .ctx = null,
+        .copy_frames = 0,
+    };
+    if (opts.queue_depth == 0) opts.queue_depth = DEFAULT_QUEUE_DEPTH;
+    if (opts.queue_depth > MAX_QUEUE_DEPTH or opts.fsync_policy > FSYNC_PER_FRAME) return -1;
+
+    var writer: ?*Writer = null;
+    const rc = yxcbor_writer_open(dir_path, manifest, &writer);
+    if (rc != 0) return rc;
+
+    const allocator = std.heap.raw_c_allocator;
+    const ring = allocator.alloc(PendingFrame, opts.queue_depth) catch {
+        _ = yxcbor_writer_close(writer);
+        return -7;
+    };
+    const slot_bytes = if (opts.copy_frames != 0) @as(usize, opts.queue_depth) * @as(usize, @intCast(frameLen(manifest))) else 0;
+    const slots = allocator.alloc(u8, slot_bytes) catch {
+        allocator.free(ring);
+        _ = yxcbor_writer_close(writer);
+        return -7;
+    };
+    const aw = allocator.create(AsyncWriter) catch {
+        allocator.free(slots);
+        allocator.free(ring);
+        _ = yxcbor_writer_close(writer);
+        return -7;
+    };
+    aw.* = .{
+        .writer = writer.?,
+        .options = opts,
+        .ring = ring,
+        .slots = slots,
+        .head = 0,
+        .count = 0,
+        .closing = false,
+        .status = 0,
+        .mutex = .{},
+        .not_empty = .{},
+        .not_full = .{},
+        .thread = undefined,
+        .allocator = allocator,
+    };
+
+    aw.thread = std.Thread.spawn(.{}, flushLoop, .{aw}) catch {
+        allocator.free(slots);
+        allocator.free(ring);
+        allocator.destroy(aw);
+        _ = yxcbor_writer_close(writer);
+        return -14;
+    };
+
+    out_writer.* = aw;
+    return 0;
+}
+
+fn submitFrame(aw: *AsyncWriter, rgba_ptr: [*]const u8, len: u32, block: bool) c_int {
+    const w = aw.writer;
+    if (len != frameLen(&w.manifest)) return -3;
+
+    aw.mutex.lock();
+    defer aw.mutex.unlock();
+
+    if (aw.closing) return -1;
+    if (aw.status != 0) return aw.status;
+    while (aw.count == aw.ring.len) {
+        if (!block) return -8; // Ring full
+        aw.not_full.wait(&aw.mutex);
+    }
+
+    // Indices are claimed under the lock so ring order matches file order
+    const index = w.next_frame.fetchAdd(1, .monotonic);
+    if (index >= w.manifest.frame_count) {
+        _ = w.next_frame.fetchSub(1, .monotonic);
+        return -2;
+    }
+
+    const slot = (aw.head + aw.count) % aw.ring.len;
+    var frame_ptr = rgba_ptr;
+    if (aw.slots.len != 0) {
+        const copy = aw.slots[slot * len ..][0..len];
+        @memcpy(copy, rgba_ptr[0..len]);
+        frame_ptr = copy.ptr;
+    }
+
+    aw.ring[slot] = .{ .index = index, .rgba_ptr = frame_ptr };
+    aw.count += 1;
+    aw.not_empty.signal();
+    return 0;
+}
+
+// Queue the next frame, blocking while the ring is full
+// Without copy_frames the buffer must stay valid until its completion callback
+export fn yxcbor_async_writer_submit(aw: ?*AsyncWriter, rgba_ptr: [*]const u8, len: u32) c_int {
+    return submitFrame(aw orelse return -1, rgba_ptr, len, true);
+}
+
+// Queue the next frame, or return -8 at once if the ring is full
+export fn yxcbor_async_writer_try_submit(aw: ?*AsyncWriter, rgba_ptr: [*]const u8, len: u32) c_int {
+    return submitFrame(aw orelse return -1, rgba_ptr, len, false);
+}
+
+// Frames submitted but not yet completed
+export fn yxcbor_async_writer_pending(aw: ?*AsyncWriter) u32 {
+    const w = aw orelse return 0;
+    w.mutex.lock();
+    defer w.mutex.unlock();
+    return @intCast(w.count);
+}
+
+// Block until every submitted frame has completed, then fsync
+// Returns the first write error seen so far, or 0
+export fn yxcbor_async_writer_flush(aw: ?*AsyncWriter) c_int {
+    const w = aw orelse return -1;
+    w.mutex.lock();
+    while (w.count != 0) w.not_full.wait(&w.mutex);
+    const status = w.status;
+    w.mutex.unlock();
+
+    if (status != 0) return status;
+    w.writer.frames_file.sync() catch return -13;
+    return 0;
+}
+
+// Drain the ring, stop the flusher, fsync and free the handle
+// Returns the first write error seen, or 0
+export fn yxcbor_async_writer_close(aw: ?*AsyncWriter) c_int {
+    const w = aw orelse return -1;
+
+    w.mutex.lock();
+    w.closing = true;
+    w.not_empty.signal();
+    w.mutex.unlock();
+    w.thread.join();
+
+    var status = w.status;
+    if (status == 0) {
+        w.writer.frames_file.sync() catch {
+            status = -13;
+        };
+    }
+
+    _ = yxcbor_writer_close(w.writer);
+    w.allocator.free(w.slots);
+    w.allocator.free(w.ring);
+    w.allocator.destroy(w);
+    return status;
+}
+
+// Parse the tag and byte-string header at the start of `bytes`
+// Returns the header length and the pixel byte count
+fn parseFrameHeader(bytes: []const u8) !struct { header_len: usize, data_len: u64 } {
+    var record = std.io.fixedBufferStream(bytes);
+    const tag = try cbor.readTag(record.reader());
+    if (tag != TAG_RGBA_FRAME) return error.ExpectedTag;
+    const tv = try cbor.readTypeAndValue(record.reader());
+    if (tv.major != cbor.MAJOR_BYTES) return error.ExpectedBytes;
+    return .{ .header_len = record.pos, .data_len = tv.value };
+}
+
+// Handle-based reader API
+fn openReader(dir_path: [*:0]const u8, out_manifest: *FrameManifest, out_reader: *?*Reader, map: bool) c_int {
+    out_reader.* = null;
 
     const allocator = std.heap.raw_c_allocator;
     const dir_slice = std.mem.span(dir_path);
@@ -347,102 +686,214 @@ export fn yxcbor_open_reader(dir_path: [*:0]const u8, out_manifest: *FrameManife
 
     const frames_file = std.fs.cwd().openFile(frames_path, .{}) catch return -4;
 
-    // Read array header and build offset table
-    var read_buf: [4096]u8 = undefined;
-    const reader = frames_file.reader(&read_buf);
-    const array_size = cbor.readArrayHeader(reader) catch {
+    // Map the whole store read-only; headers are then parsed straight from memory
+    var mapped: ?[]align(std.heap.page_size_min) const u8 = null;
+    if (map) {
+        const size = frames_file.getEndPos() catch {
+            frames_file.close();
+            return -12;
+        };
+        if (size == 0) {
+            frames_file.close();
+            return -5;
+        }
+        mapped = std.posix.mmap(null, @intCast(size), std.posix.PROT.READ, .{ .TYPE = .PRIVATE }, frames_file.handle, 0) catch {
+            frames_file.close();
+            return -12;
+        };
+    }
+    const rc = buildReader(allocator, dir_slice, manifest, frames_file, mapped, out_reader);
+    if (rc != 0) {
+        if (mapped) |m| std.posix.munmap(m);
         frames_file.close();
-        return -5;
+    }
+    return rc;
+}
+
+// Build the frame offset table and the handle; the caller cleans up the file on failure
+fn buildReader(
+    allocator: std.mem.Allocator,
+    dir_slice: []const u8,
+    manifest: FrameManifest,
+    frames_file: std.fs.File,
+    mapped: ?[]align(std.heap.page_size_min) const u8,
+    out_reader: *?*Reader,
+) c_int {
+    // Header bytes at `pos`: a slice of the mapping, or a small pread
+    var head_buf: [16]u8 = undefined;
+    const Source = struct {
+        fn at(file: std.fs.File, m: ?[]align(std.heap.page_size_min) const u8, buf: *[16]u8, pos: u64) ![]const u8 {
+            if (m) |bytes| {
+                if (pos >= bytes.len) return error.EndOfStream;
+                return bytes[@intCast(pos)..@min(bytes.len, @as(usize, @intCast(pos)) + buf.len)];
+            }
+            const n = try file.preadAll(buf, pos);
+            return buf[0..n];
+        }
     };
 
-    if (array_size != manifest.frame_count) {
-        frames_file.close();
-        return -6;
-    }
+    // Read array header
+    const head = Source.at(frames_file, mapped, &head_buf, 0) catch return -5;
+    var head_stream = std.io.fixedBufferStream(head);
+    const array_size = cbor.readArrayHeader(head_stream.reader()) catch return -5;
+    if (array_size != manifest.frame_count) return -6;
 
     // Build frame offset table for random access
-    const frame_offsets = allocator.alloc(u64, manifest.frame_count) catch {
-        frames_file.close();
-        return -7;
-    };
+    const frame_offsets = allocator.alloc(u64, manifest.frame_count) catch return -7;
 
+    // Walk the frame headers only; pixel bytes are skipped by offset
+    var pos: u64 = head_stream.pos;
     var i: u32 = 0;
     while (i < manifest.frame_count) : (i += 1) {
-        frame_offsets[i] = frames_file.getPos() catch {
+        const bytes = Source.at(frames_file, mapped, &head_buf, pos) catch {
             allocator.free(frame_offsets);
-            frames_file.close();
             return -8;
         };
-
-        // Skip frame data
-        cbor.skipValue(reader) catch {
+        const header = parseFrameHeader(bytes) catch {
             allocator.free(frame_offsets);
-            frames_file.close();
             return -9;
         };
+
+        frame_offsets[i] = pos + header.header_len;
+        pos += header.header_len + header.data_len;
+    }
+
+    // A mapped store must hold every frame it indexes
+    if (mapped) |m| {
+        if (pos > m.len) {
+            allocator.free(frame_offsets);
+            return -9;
+        }
     }
 
     // Initialize reader state
     const dir_copy = allocator.alloc(u8, dir_slice.len) catch {
         allocator.free(frame_offsets);
-        frames_file.close();
         return -10;
     };
     @memcpy(dir_copy, dir_slice);
 
-    g_reader = Reader{
+    const reader_state = allocator.create(Reader) catch {
+        allocator.free(dir_copy);
+        allocator.free(frame_offsets);
+        return -10;
+    };
+    reader_state.* = Reader{
         .dir_path = dir_copy,
         .manifest = manifest,
         .frames_file = frames_file,
         .frame_offsets = frame_offsets,
+        .mapped = mapped,
         .allocator = allocator,
     };
 
+    out_reader.* = reader_state;
     return 0; // Success
 }
 
-export fn yxcbor_read_frame(index: u32, out_rgba: [*]u8, len: u32) c_int {
-    const reader_state = g_reader orelse return -1;
+export fn yxcbor_reader_open(dir_path: [*:0]const u8, out_manifest: *FrameManifest, out_reader: *?*Reader) c_int {
+    return openReader(dir_path, out_manifest, out_reader, false);
+}
 
-    if (index >= reader_state.manifest.frame_count) return -2;
+// Open a reader over a read-only mapping of the store
+export fn yxcbor_reader_open_mapped(dir_path: [*:0]const u8, out_manifest: *FrameManifest, out_reader: *?*Reader) c_int {
+    return openReader(dir_path, out_manifest, out_reader, true);
+}
 
-    const expected_len = reader_state.manifest.width * reader_state.manifest.height * reader_state.manifest.channels;
-    if (len != expected_len) return -3;
+export fn yxcbor_reader_read_frame(reader_state: ?*Reader, index: u32, out_rgba: [*]u8, len: u32) c_int {
+    const r = reader_state orelse return -1;
 
-    const file = reader_state.frames_file orelse return -4;
+    if (index >= r.manifest.frame_count) return -2;
+    if (len != frameLen(&r.manifest)) return -3;
 
-    // Seek to frame position
-    file.seekTo(reader_state.frame_offsets[index]) catch return -5;
+    const out_slice = out_rgba[0..len];
+    const offset = r.frame_offsets[index];
 
-    var read_buf: [262144]u8 = undefined; // 256KB buffer for frame data
-    const reader = file.reader(&read_buf);
+    // Mapped: a single memcpy, no syscall
+    if (r.mapped) |m| {
+        @memcpy(out_slice, m[@intCast(offset)..][0..len]);
+        return 0;
+    }
 
-    // Read tag and verify
-    const tag = cbor.readTag(reader) catch return -6;
-    if (tag != TAG_RGBA_FRAME) return -7;
+    // Read frame data from its recorded offset
+    const n = r.frames_file.preadAll(out_slice, offset) catch return -11;
+    if (n != len) return -11;
 
-    // Read frame data
-    const tv = cbor.readTypeAndValue(reader) catch return -8;
-    if (tv.major != cbor.MAJOR_BYTES) return -9;
-    if (tv.value != len) return -10;
+    return 0; // Success
+}
 
-    const out_slice = out_rgba[0..len];
-    _ = reader.readAll(out_slice) catch return -11;
+// Borrow frame `index` in place: *out_ptr points into the mapped CBOR byte string
+// Valid until yxcbor_reader_close; only for readers from yxcbor_reader_open_mapped
+export fn yxcbor_reader_frame_ptr(reader_state: ?*Reader, index: u32, out_ptr: *?[*]const u8, out_len: *u32) c_int {
+    out_ptr.* = null;
+    out_len.* = 0;
 
-    return 0; // Success
+    const r = reader_state orelse return -1;
+    if (index >= r.manifest.frame_count) return -2;
+    const m = r.mapped orelse return -4; // Not a mapped reader
+
+    const len = frameLen(&r.manifest);
+    out_ptr.* = m[@intCast(r.frame_offsets[index])..].ptr;
+    out_len.* = @intCast(len);
+    return 0;
 }
 
-export fn yxcbor_close_reader() c_int {
-    if (g_reader) |*reader_state| {
-        if (reader_state.frames_file) |file| {
-            file.close();
-        }
-        reader_state.allocator.free(reader_state.frame_offsets);
-        reader_state.allocator.free(reader_state.dir_path);
-        g_reader = null;
-        return 0;
+export fn yxcbor_reader_close(reader_state: ?*Reader) c_int {
+    const r = reader_state orelse return -1;
+    const allocator = r.allocator;
+
+    if (r.mapped) |m| std.posix.munmap(m);
+    r.frames_file.close();
+    allocator.free(r.frame_offsets);
+    allocator.free(r.dir_path);
+    allocator.destroy(r);
+    return 0;
+}
+
+// Legacy single-stream API: thin wrappers over one process-wide handle each.
+// Not thread-safe; use the handle API for concurrent streams.
+export fn yxcbor_open_writer(dir_path: [*:0]const u8, manifest: *const FrameManifest) c_int {
+    if (g_writer != null or g_async_writer != null) return -1; // Already open
+    return yxcbor_writer_open(dir_path, manifest, &g_writer);
+}
+
+// Same stream written behind: frames are copied into the ring, so callers keep
+// reusing their buffer as with the synchronous writer
+export fn yxcbor_open_writer_async(dir_path: [*:0]const u8, manifest: *const FrameManifest, options: ?*const AsyncOptions) c_int {
+    if (g_writer != null or g_async_writer != null) return -1; // Already open
+    var opts = if (options) |o| o.* else std.mem.zeroes(AsyncOptions);
+    opts.copy_frames = 1;
+    return yxcbor_async_writer_open(dir_path, manifest, &opts, &g_async_writer);
+}
+
+export fn yxcbor_write_frame(rgba_ptr: [*]const u8, len: u32) c_int {
+    if (g_async_writer) |aw| return yxcbor_async_writer_submit(aw, rgba_ptr, len);
+    return yxcbor_writer_write_frame(g_writer, rgba_ptr, len);
+}
+
+export fn yxcbor_close_writer() c_int {
+    if (g_async_writer) |aw| {
+        g_async_writer = null;
+        return yxcbor_async_writer_close(aw);
     }
-    return -1; // Not open
+    const rc = yxcbor_writer_close(g_writer);
+    g_writer = null;
+    return rc;
+}
+
+export fn yxcbor_open_reader(dir_path: [*:0]const u8, out_manifest: *FrameManifest) c_int {
+    if (g_reader != null) return -1; // Already open
+    return yxcbor_reader_open(dir_path, out_manifest, &g_reader);
+}
+
+export fn yxcbor_read_frame(index: u32, out_rgba: [*]u8, len: u32) c_int {
+    return yxcbor_reader_read_frame(g_reader, index, out_rgba, len);
+}
+
+export fn yxcbor_close_reader() c_int {
+    const rc = yxcbor_reader_close(g_reader);
+    g_reader = null;
+    return rc;
 }
 
 // Legacy batch API for compatibility
@@ -460,12 +911,11 @@ export fn yxcbor_save_frame(
     const file = std.fs.cwd().createFile(path_slice, .{}) catch return -1;
     defer file.close();
 
-    var write_buf: [262144]u8 = undefined;
-    const writer = file.writer(&write_buf);
-
     // Write simple CBOR byte string
-    cbor.writeTag(writer, TAG_RGBA_FRAME) catch return -2;
-    cbor.writeBytes(writer, data_slice) catch return -3;
+    var prefix_buf: [16]u8 = undefined;
+    const prefix = framePrefix(&prefix_buf, data_slice.len) catch return -2;
+    file.pwriteAll(prefix, 0) catch return -2;
+    file.pwriteAll(data_slice, prefix.len) catch return -3;
 
     return 0;
 }
@@ -482,17 +932,13 @@ export fn yxcbor_load_frame(
     const file = std.fs.cwd().openFile(path_slice, .{}) catch return -1;
     defer file.close();
 
-    var read_buf: [262144]u8 = undefined;
-    const reader = file.reader(&read_buf);
-
-    // Read tag
-    const tag = cbor.readTag(reader) catch return -2;
-    if (tag != TAG_RGBA_FRAME) return -3;
-
-    // Read byte data
-    const allocator = std.heap.raw_c_allocator;
-    const data = cbor.readBytes(allocator, reader) catch return -4;
-    defer allocator.free(data);
+    // Read tag and byte-string header
+    var head_buf: [16]u8 = undefined;
+    const n = file.preadAll(&head_buf, 0) catch return -2;
+    const header = parseFrameHeader(head_buf[0..n]) catch |err| switch (err) {
+        error.ExpectedTag => return -3,
+        else => return -2,
+    };
 
     // Assume 256x256 for now
     out_width.* = 256;
@@ -500,9 +946,11 @@ export fn yxcbor_load_frame(
     out_index.* = 0;
 
     const expected_size = 256 * 256 * 4;
-    if (data.len != expected_size) return -5;
+    if (header.data_len != expected_size) return -5;
 
-    @memcpy(out_rgba[0..expected_size], data);
+    // Pixels go straight into the caller's buffer
+    const read = file.preadAll(out_rgba[0..expected_size], header.header_len) catch return -4;
+    if (read != expected_size) return -4;
 
     return 0;
 }
@@ -548,4 +996,214 @@ test "CBOR encode/decode roundtrip" {
     }
 
     try std.testing.expectEqual(@as(c_int, 0), yxcbor_close_reader());
-}
\ No newline at end of file
+}
+
+test "independent handles from several threads" {
+    const side = 64;
+    const frame_len = side * side * 4;
+    const frame_count = 8;
+    const manifest = FrameManifest{
+        .width = side,
+        .height = side,
+        .channels = 4,
+        .frame_count = frame_count,
+    };
+
+    const dir_a = "test_cbor_handles_a";
+    const dir_b = "test_cbor_handles_b";
+    defer std.fs.cwd().deleteTree(dir_a) catch {};
+    defer std.fs.cwd().deleteTree(dir_b) catch {};
+
+    // Two writers open at once; frames of A are fanned out over worker threads
+    var writer_a: ?*Writer = null;
+    var writer_b: ?*Writer = null;
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_writer_open(dir_a, &manifest, &writer_a));
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_writer_open(dir_b, &manifest, &writer_b));
+
+    const Worker = struct {
+        fn run(w: *Writer, first: u32) void {
+            var data: [64 * 64 * 4]u8 = undefined;
+            var index = first;
+            while (index < w.manifest.frame_count) : (index += 2) {
+                @memset(&data, @intCast(index + 1));
+                std.debug.assert(yxcbor_writer_write_frame_at(w, index, &data, data.len) == 0);
+            }
+        }
+    };
+    const t0 = try std.Thread.spawn(.{}, Worker.run, .{ writer_a.?, 0 });
+    const t1 = try std.Thread.spawn(.{}, Worker.run, .{ writer_a.?, 1 });
+
+    var data_b: [frame_len]u8 = undefined;
+    var i: u32 = 0;
+    while (i < frame_count) : (i += 1) {
+        @memset(&data_b, @intCast(0x80 + i));
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_writer_write_frame(writer_b, &data_b, frame_len));
+    }
+    try std.testing.expectEqual(@as(c_int, -2), yxcbor_writer_write_frame(writer_b, &data_b, frame_len));
+
+    t0.join();
+    t1.join();
+    try std.testing.expectEqual(@as(u32, frame_count), yxcbor_writer_frames_written(writer_a));
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_writer_close(writer_a));
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_writer_close(writer_b));
+
+    // Replay both clips through independent readers
+    var reader_a: ?*Reader = null;
+    var reader_b: ?*Reader = null;
+    var read_manifest: FrameManifest = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_open(dir_a, &read_manifest, &reader_a));
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_open(dir_b, &read_manifest, &reader_b));
+    try std.testing.expectEqual(manifest, read_manifest);
+
+    var out: [frame_len]u8 = undefined;
+    i = frame_count;
+    while (i > 0) : (i -= 1) {
+        const index = i - 1;
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_read_frame(reader_a, index, &out, frame_len));
+        try std.testing.expect(std.mem.allEqual(u8, &out, @intCast(index + 1)));
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_read_frame(reader_b, index, &out, frame_len));
+        try std.testing.expect(std.mem.allEqual(u8, &out, @intCast(0x80 + index)));
+    }
+
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_close(reader_a));
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_close(reader_b));
+}
+
+test "mapped reader hands out frames in place" {
+    const side = 256; // One full 256² RGBA frame, larger than the old 256 KB buffer
+    const frame_len = side * side * 4;
+    const manifest = FrameManifest{
+        .width = side,
+        .height = side,
+        .channels = 4,
+        .frame_count = 3,
+    };
+
+    const dir = "test_cbor_mapped";
+    defer std.fs.cwd().deleteTree(dir) catch {};
+
+    var writer: ?*Writer = null;
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_writer_open(dir, &manifest, &writer));
+    const data = try std.testing.allocator.alloc(u8, frame_len);
+    defer std.testing.allocator.free(data);
+    var i: u32 = 0;
+    while (i < manifest.frame_count) : (i += 1) {
+        for (data, 0..) |*b, k| b.* = @truncate(k + i * 3);
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_writer_write_frame(writer, data.ptr, frame_len));
+    }
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_writer_close(writer));
+
+    var reader: ?*Reader = null;
+    var read_manifest: FrameManifest = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_open_mapped(dir, &read_manifest, &reader));
+    defer _ = yxcbor_reader_close(reader);
+
+    i = 0;
+    while (i < manifest.frame_count) : (i += 1) {
+        var ptr: ?[*]const u8 = null;
+        var len: u32 = 0;
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_frame_ptr(reader, i, &ptr, &len));
+        try std.testing.expectEqual(@as(u32, frame_len), len);
+        for (ptr.?[0..len], 0..) |b, k| {
+            try std.testing.expectEqual(@as(u8, @truncate(k + i * 3)), b);
+        }
+    }
+
+    // Copying reads work on mapped handles too
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_read_frame(reader, 2, data.ptr, frame_len));
+    try std.testing.expectEqual(@as(u8, 6), data[0]);
+
+    // Unmapped readers have no stable pointer to hand out
+    var plain: ?*Reader = null;
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_open(dir, &read_manifest, &plain));
+    var ptr: ?[*]const u8 = null;
+    var len: u32 = 0;
+    try std.testing.expectEqual(@as(c_int, -4), yxcbor_reader_frame_ptr(plain, 0, &ptr, &len));
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_close(plain));
+}
+
+test "write-behind writer coalesces and reports completions" {
+    const side = 32;
+    const frame_len = side * side * 4;
+    const frame_count = 12;
+    const manifest = FrameManifest{
+        .width = side,
+        .height = side,
+        .channels = 4,
+        .frame_count = frame_count,
+    };
+
+    const Completions = struct {
+        var done = std.atomic.Value(u32).init(0);
+        var failed = std.atomic.Value(u32).init(0);
+
+        fn onComplete(ctx: ?*anyopaque, index: u32, rgba_ptr: [*]const u8, status: c_int) callconv(.C) void {
+            _ = ctx;
+            if (status != 0 or rgba_ptr[0] != @as(u8, @intCast(index + 1))) _ = failed.fetchAdd(1, .monotonic);
+            _ = done.fetchAdd(1, .release);
+        }
+    };
+
+    const policies = [_]u32{ FSYNC_ON_CLOSE, FSYNC_PER_BATCH, FSYNC_PER_FRAME };
+    for (policies) |policy| {
+        const dir = "test_cbor_async";
+        defer std.fs.cwd().deleteTree(dir) catch {};
+        Completions.done.store(0, .monotonic);
+
+        // Borrowed buffers: one per frame, left untouched until completion
+        var frames: [frame_count][frame_len]u8 = undefined;
+        const options = AsyncOptions{
+            .queue_depth = 4,
+            .fsync_policy = policy,
+            .on_complete = Completions.onComplete,
+            .ctx = null,
+            .copy_frames = 0,
+        };
+        var writer: ?*AsyncWriter = null;
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_async_writer_open(dir, &manifest, &options, &writer));
+
+        for (&frames, 0..) |*frame, i| {
+            @memset(frame, @intCast(i + 1));
+            try std.testing.expectEqual(@as(c_int, 0), yxcbor_async_writer_submit(writer, frame, frame_len));
+            try std.testing.expect(yxcbor_async_writer_pending(writer) <= 4);
+        }
+        try std.testing.expectEqual(@as(c_int, -2), yxcbor_async_writer_submit(writer, &frames[0], frame_len));
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_async_writer_flush(writer));
+        try std.testing.expectEqual(@as(u32, frame_count), Completions.done.load(.acquire));
+        try std.testing.expectEqual(@as(u32, frame_count), yxcbor_writer_frames_written(writer.?.writer));
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_async_writer_close(writer));
+
+        var reader: ?*Reader = null;
+        var read_manifest: FrameManifest = undefined;
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_open(dir, &read_manifest, &reader));
+        var out: [frame_len]u8 = undefined;
+        var i: u32 = 0;
+        while (i < frame_count) : (i += 1) {
+            try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_read_frame(reader, i, &out, frame_len));
+            try std.testing.expect(std.mem.allEqual(u8, &out, @intCast(i + 1)));
+        }
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_reader_close(reader));
+    }
+    try std.testing.expectEqual(@as(u32, 0), Completions.failed.load(.monotonic));
+
+    // Legacy stream routed through a copying ring: one buffer reused for every frame
+    const dir = "test_cbor_async_legacy";
+    defer std.fs.cwd().deleteTree(dir) catch {};
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_open_writer_async(dir, &manifest, null));
+    var frame: [frame_len]u8 = undefined;
+    var i: u32 = 0;
+    while (i < frame_count) : (i += 1) {
+        @memset(&frame, @intCast(0x40 + i));
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_write_frame(&frame, frame_len));
+    }
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_close_writer());
+
+    var read_manifest: FrameManifest = undefined;
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_open_reader(dir, &read_manifest));
+    i = 0;
+    while (i < frame_count) : (i += 1) {
+        try std.testing.expectEqual(@as(c_int, 0), yxcbor_read_frame(i, &frame, frame_len));
+        try std.testing.expect(std.mem.allEqual(u8, &frame, @intCast(0x40 + i)));
+    }
+    try std.testing.expectEqual(@as(c_int, 0), yxcbor_close_reader());
+}
@@ -15,6 +15,8 @@ const c = @cImport({
 const MAGIC: [4]u8 = .{ 'Y', 'X', 'V', 0 };
 const VERSION: u32 = 1;
 const CHUNK_ALIGNMENT: u64 = 64;
+const CHUNK_RECORD_SIZE: usize = 24;
+const HEADER_SIZE: usize = 64;
 
 // Error types
 const YXVError = error{
@@ -64,7 +66,8 @@ const ChunkRecord = struct {
 
     pub fn read(reader: anytype) !ChunkRecord {
         const type_byte = try reader.readByte();
-        return ChunkRecord{
+        if (type_byte > @enumToInt(ChunkType.thumbnail)) return YXVError.InvalidChunkRecord;
+        const record = ChunkRecord{
             .chunk_type = @intToEnum(ChunkType, type_byte),
             .offset = try reader.readIntLittle(u64),
             .compressed_size = try reader.readIntLittle(u32),
@@ -72,9 +75,22 @@ const ChunkRecord = struct {
             .checksum = try reader.readIntLittle(u32),
             ._padding = .{ 0, 0, 0 },
         };
+        var padding: [3]u8 = undefined;
+        try reader.readNoEof(&padding);
+        return record;
     }
 };
 
+// One chunk for the parallel codec: the input slice and, once a worker has
+// run, the owned output (compressed or decompressed) or the error it hit
+const ChunkJob = struct {
+    input: []const u8,
+    expected_size: usize = 0,  // Decompression only
+    checksum: u32 = 0,         // Output of compression, expected value for decompression
+    output: []u8 = &.{},
+    err: ?anyerror = null,
+};
+
 // YXV Container
 pub const YXVContainer = struct {
     allocator: std.mem.Allocator,
@@ -106,113 +122,229 @@ pub const YXVContainer = struct {
     }
 
     // Read YXV file
+    // Chunks are located through the table at the end of the file, then
+    // checksummed and decompressed across cores
     pub fn readFile(allocator: std.mem.Allocator, path: []const u8) !YXVContainer {
         const file = try std.fs.cwd().openFile(path, .{});
         defer file.close();
 
-        var reader = file.reader();
+        const data = try file.readToEndAlloc(allocator, std.math.maxInt(u32));
+        defer allocator.free(data);
 
         // Read and verify magic
-        var magic: [4]u8 = undefined;
-        _ = try reader.read(&magic);
-        if (!std.mem.eql(u8, &magic, &MAGIC)) {
+        if (data.len < 8 or !std.mem.eql(u8, data[0..4], &MAGIC)) {
             return YXVError.InvalidMagic;
         }
 
-        // Read header size
-        const header_size = try reader.readIntLittle(u32);
-
-        // Read header data
-        const header_data = try allocator.alloc(u8, header_size);
-        defer allocator.free(header_data);
-        _ = try reader.read(header_data);
+        // Read header
+        const header_size = std.mem.readIntLittle(u32, data[4..8]);
+        if (header_size < HEADER_SIZE or data.len < 8 + header_size) return YXVError.InvalidChunkRecord;
+        const header = data[8 .. 8 + HEADER_SIZE];
 
         // Parse FlatBuffers header using C++ runtime
         // const header = c.YinVoxel_GetVoxelHeader(header_data.ptr);
+        if (std.mem.readIntLittle(u32, header[0..4]) != VERSION) return YXVError.UnsupportedVersion;
 
-        // For now, create a dummy container
         var container = YXVContainer.init(allocator);
+        errdefer container.deinit();
+        container.dimensions = .{
+            .width = std.mem.readIntLittle(u16, header[4..6]),
+            .height = std.mem.readIntLittle(u16, header[6..8]),
+            .depth = std.mem.readIntLittle(u16, header[8..10]),
+        };
+        if (header[10] > @enumToInt(CompressionType.zstd)) return YXVError.DecompressionFailed;
+        container.compression = @intToEnum(CompressionType, header[10]);
+
+        // Read chunk table
+        const chunk_count = std.mem.readIntLittle(u32, header[12..16]);
+        const table_len = @as(usize, chunk_count) * CHUNK_RECORD_SIZE;
+        if (data.len < 8 + header_size + table_len) return YXVError.InvalidChunkRecord;
+        var table = std.io.fixedBufferStream(data[data.len - table_len ..]);
+
+        const records = try allocator.alloc(ChunkRecord, chunk_count);
+        defer allocator.free(records);
+        const jobs = try allocator.alloc(ChunkJob, chunk_count);
+        defer allocator.free(jobs);
+
+        var frame_count: usize = 0;
+        for (records) |*record, i| {
+            record.* = try ChunkRecord.read(table.reader());
+            if (record.offset + record.compressed_size > data.len) return YXVError.InvalidChunkRecord;
+            if (record.chunk_type == .frame) frame_count += 1;
+
+            const start = @intCast(usize, record.offset);
+            jobs[i] = .{
+                .input = data[start .. start + record.compressed_size],
+                .expected_size = record.uncompressed_size,
+                .checksum = record.checksum,
+            };
+        }
 
-        // TODO: Parse header and read chunks
+        try container.runChunkJobs(jobs, .decompress);
+        defer {
+            for (jobs) |job| allocator.free(job.output);
+        }
+
+        // Hand the decoded chunks over to the container
+        const frames = try allocator.alloc([]const u8, frame_count);
+        for (frames) |*frame| frame.* = &.{};
+        container.frames = frames;
+
+        var next_frame: usize = 0;
+        for (records) |record, i| {
+            switch (record.chunk_type) {
+                .palette => {
+                    if (container.palette.len > 0) continue;
+                    const palette = try allocator.alloc([3]u8, jobs[i].output.len / 3);
+                    for (palette) |*color, k| {
+                        color.* = .{ jobs[i].output[k * 3], jobs[i].output[k * 3 + 1], jobs[i].output[k * 3 + 2] };
+                    }
+                    container.palette = palette;
+                },
+                .frame => {
+                    frames[next_frame] = jobs[i].output;
+                    jobs[i].output = &.{};
+                    next_frame += 1;
+                },
+                .metadata, .thumbnail => {},
+            }
+        }
 
         return container;
     }
 
     // Write YXV file
+    // Chunks are compressed and checksummed across cores first; the layout
+    // then follows from the sizes and chunks are written at aligned offsets
     pub fn writeFile(self: *const YXVContainer, path: []const u8) !void {
+        const palette_data = try self.encodePalette();
+        defer self.allocator.free(palette_data);
+
+        const has_palette = self.palette.len > 0;
+        const chunk_count = self.frames.len + @boolToInt(has_palette);
+
+        const jobs = try self.allocator.alloc(ChunkJob, chunk_count);
+        defer self.allocator.free(jobs);
+        if (has_palette) jobs[0] = .{ .input = palette_data };
+        for (self.frames) |frame, i| {
+            jobs[i + @boolToInt(has_palette)] = .{ .input = frame };
+        }
+
+        try self.runChunkJobs(jobs, .compress);
+        defer {
+            for (jobs) |job| self.allocator.free(job.output);
+        }
+
         const file = try std.fs.cwd().createFile(path, .{});
         defer file.close();
 
-        var writer = file.writer();
+        var buffered = std.io.bufferedWriter(file.writer());
+        var writer = buffered.writer();
 
         // Write magic
         try writer.writeAll(&MAGIC);
 
         // Build FlatBuffers header
-        const header_data = try self.buildHeader();
+        const header_data = try self.buildHeader(@intCast(u32, chunk_count));
         defer self.allocator.free(header_data);
 
         // Write header size and data
         try writer.writeIntLittle(u32, @intCast(u32, header_data.len));
         try writer.writeAll(header_data);
 
-        var chunks = std.ArrayList(ChunkRecord).init(self.allocator);
+        var chunks = try std.ArrayList(ChunkRecord).initCapacity(self.allocator, chunk_count);
         defer chunks.deinit();
 
-        var current_offset = try file.getPos();
-
-        // Write palette chunk
-        if (self.palette.len > 0) {
-            const palette_data = try self.encodePalette();
-            defer self.allocator.free(palette_data);
-
-            const compressed = try self.compress(palette_data);
-            defer self.allocator.free(compressed);
-
-            const checksum = calculateCRC32(compressed);
-
-            try chunks.append(.{
-                .chunk_type = .palette,
+        // Write chunks, each starting on an aligned offset
+        var current_offset: u64 = 8 + header_data.len;
+        for (jobs) |job, i| {
+            current_offset = try writePadding(writer, current_offset, CHUNK_ALIGNMENT);
+            chunks.appendAssumeCapacity(.{
+                .chunk_type = if (has_palette and i == 0) .palette else .frame,
                 .offset = current_offset,
-                .compressed_size = @intCast(u32, compressed.len),
-                .uncompressed_size = @intCast(u32, palette_data.len),
-                .checksum = checksum,
+                .compressed_size = @intCast(u32, job.output.len),
+                .uncompressed_size = @intCast(u32, job.input.len),
+                .checksum = job.checksum,
             });
 
-            try writer.writeAll(compressed);
-            current_offset = try alignFile(file, CHUNK_ALIGNMENT);
+            try writer.writeAll(job.output);
+            current_offset += job.output.len;
         }
+        _ = try writePadding(writer, current_offset, CHUNK_ALIGNMENT);
 
-        // Write frame chunks
-        for (self.frames) |frame| {
-            const compressed = try self.compress(frame);
-            defer self.allocator.free(compressed);
+        // Write chunk table
+        for (chunks.items) |chunk| {
+            try chunk.write(writer);
+        }
 
-            const checksum = calculateCRC32(compressed);
+        try buffered.flush();
+    }
 
-            try chunks.append(.{
-                .chunk_type = .frame,
-                .offset = current_offset,
-                .compressed_size = @intCast(u32, compressed.len),
-                .uncompressed_size = @intCast(u32, frame.len),
-                .checksum = checksum,
-            });
+    const CodecDirection = enum { compress, decompress };
+
+    // Run every job across worker threads; jobs are independent, so each worker
+    // takes a strided share. On error all outputs are freed and the first error
+    // is returned. The container allocator must be thread-safe.
+    fn runChunkJobs(self: *const YXVContainer, jobs: []ChunkJob, direction: CodecDirection) !void {
+        const cpu_count = std.Thread.getCpuCount() catch 1;
+        const worker_count = std.math.max(1, std.math.min(cpu_count, jobs.len));
 
-            try writer.writeAll(compressed);
-            current_offset = try alignFile(file, CHUNK_ALIGNMENT);
+        var threads: [64]std.Thread = undefined;
+        var spawned: usize = 0;
+        while (spawned + 1 < std.math.min(worker_count, threads.len)) : (spawned += 1) {
+            threads[spawned] = std.Thread.spawn(.{}, runChunkWorker, .{ self, jobs, direction, spawned + 1, worker_count }) catch break;
         }
 
-        // Write chunk table
-        for (chunks.items) |chunk| {
-            try chunk.write(writer);
+        // The calling thread takes share 0, and any share whose thread failed to spawn
+        runChunkWorker(self, jobs, direction, 0, worker_count);
+        var share = spawned + 1;
+        while (share < worker_count) : (share += 1) {
+            runChunkWorker(self, jobs, direction, share, worker_count);
+        }
+        for (threads[0..spawned]) |thread| thread.join();
+
+        for (jobs) |job| {
+            if (job.err) |err| {
+                for (jobs) |*other| {
+                    self.allocator.free(other.output);
+                    other.output = &.{};
+                }
+                return err;
+            }
+        }
+    }
+
+    fn runChunkWorker(self: *const YXVContainer, jobs: []ChunkJob, direction: CodecDirection, share: usize, share_count: usize) void {
+        var i = share;
+        while (i < jobs.len) : (i += share_count) {
+            const job = &jobs[i];
+            switch (direction) {
+                .compress => {
+                    job.output = self.compress(job.input) catch |err| {
+                        job.err = err;
+                        continue;
+                    };
+                    job.checksum = calculateCRC32(job.output);
+                },
+                .decompress => {
+                    if (calculateCRC32(job.input) != job.checksum) {
+                        job.err = YXVError.ChecksumMismatch;
+                        continue;
+                    }
+                    job.output = self.decompress(job.input, job.expected_size) catch |err| {
+                        job.err = err;
+                        continue;
+                    };
+                },
+            }
         }
     }
 
     // Build FlatBuffers header
-    fn buildHeader(self: *const YXVContainer) ![]u8 {
+    fn buildHeader(self: *const YXVContainer, chunk_count: u32) ![]u8 {
         // TODO: Use FlatBuffers C++ API via @cImport
         // For now, return a dummy header
-        var header = try self.allocator.alloc(u8, 64);
+        var header = try self.allocator.alloc(u8, HEADER_SIZE);
         @memset(header, 0);
 
         // Write basic info
@@ -220,6 +352,8 @@ pub const YXVContainer = struct {
         std.mem.writeIntLittle(u16, header[4..6], @intCast(u16, self.dimensions.width));
         std.mem.writeIntLittle(u16, header[6..8], @intCast(u16, self.dimensions.height));
         std.mem.writeIntLittle(u16, header[8..10], @intCast(u16, self.dimensions.depth));
+        header[10] = @enumToInt(self.compression);
+        std.mem.writeIntLittle(u32, header[12..16], chunk_count);
 
         return header;
     }
@@ -300,25 +434,20 @@ pub const YXVContainer = struct {
 // Utility functions
 
 fn calculateCRC32(data: []const u8) u32 {
-    // Simple CRC32 implementation or use a library
-    // For now, return a simple checksum
-    var sum: u32 = 0;
-    for (data) |byte| {
-        sum = sum +% byte;
-    }
-    return sum;
+    // IEEE CRC32, the same checksum crc32fast computes in yinvxl-rs
+    return std.hash.Crc32.hash(data);
 }
 
-fn alignFile(file: std.fs.File, alignment: u64) !u64 {
-    const current = try file.getPos();
+// Pad from `current` up to the next multiple of `alignment`; returns the new offset
+fn writePadding(writer: anytype, current: u64, alignment: u64) !u64 {
     const padding = (alignment - (current % alignment)) % alignment;
 
     if (padding > 0) {
         const zeros = [_]u8{0} ** 64;
-        try file.writer().writeAll(zeros[0..padding]);
+        try writer.writeAll(zeros[0..padding]);
     }
 
-    return try file.getPos();
+    return current + padding;
 }
 
 // Test
@@ -344,4 +473,52 @@ test "YXV basic operations" {
 
     try chunk.write(buffer.writer());
     try std.testing.expectEqual(@as(usize, 24), buffer.items.len);
-}
\ No newline at end of file
+}
+
+test "YXV parallel chunk roundtrip" {
+    const allocator = std.testing.allocator;
+
+    var container = YXVContainer.init(allocator);
+    defer container.deinit();
+    container.dimensions = .{ .width = 16, .height = 16, .depth = 24 };
+    container.compression = .none;
+
+    const palette = try allocator.alloc([3]u8, 4);
+    for (palette) |*color, i| color.* = .{ @intCast(u8, i), 0, 255 };
+    container.palette = palette;
+
+    const frames = try allocator.alloc([]const u8, 24);
+    for (frames) |*frame, i| {
+        const data = try allocator.alloc(u8, 16 * 16);
+        for (data) |*b, k| b.* = @truncate(u8, k * 7 + i);
+        frame.* = data;
+    }
+    container.frames = frames;
+
+    const path = "test_parallel.yxv";
+    defer std.fs.cwd().deleteFile(path) catch {};
+    try container.writeFile(path);
+
+    var loaded = try YXVContainer.readFile(allocator, path);
+    defer loaded.deinit();
+
+    try std.testing.expectEqual(container.dimensions.depth, loaded.dimensions.depth);
+    try std.testing.expectEqualSlices([3]u8, container.palette, loaded.palette);
+    try std.testing.expectEqual(container.frames.len, loaded.frames.len);
+    for (container.frames) |frame, i| {
+        try std.testing.expectEqualSlices(u8, frame, loaded.frames[i]);
+    }
+
+    // Chunks start on aligned offsets and a corrupted chunk fails its checksum
+    const file = try std.fs.cwd().openFile(path, .{ .mode = .read_write });
+    defer file.close();
+    const size = try file.getEndPos();
+    var record_bytes: [CHUNK_RECORD_SIZE]u8 = undefined;
+    _ = try file.preadAll(&record_bytes, size - CHUNK_RECORD_SIZE);
+    var stream = std.io.fixedBufferStream(&record_bytes);
+    const last = try ChunkRecord.read(stream.reader());
+    try std.testing.expectEqual(@as(u64, 0), last.offset % CHUNK_ALIGNMENT);
+
+    try file.pwriteAll(&[_]u8{0xFF}, last.offset);
+    try std.testing.expectError(YXVError.ChecksumMismatch, YXVContainer.readFile(allocator, path));
+}